@@ -0,0 +1,260 @@
+#include "BsBenchmarkLog.h"
+#include "FileSystem/BsFileSystem.h"
+#include "FileSystem/BsDataStream.h"
+#include "Utility/BsTime.h"
+
+namespace bs
+{
+	/** Value stored for frames in which a metric wasn't recorded. */
+	constexpr double MISSING_VALUE = std::numeric_limits<double>::quiet_NaN();
+
+	/** Escapes a string so it can be written as a JSON string value. */
+	String escapeJson(const String& value)
+	{
+		String output;
+		output.reserve(value.size());
+
+		for(auto& entry : value)
+		{
+			switch(entry)
+			{
+			case '"': output += "\\\""; break;
+			case '\\': output += "\\\\"; break;
+			case '\n': output += "\\n"; break;
+			case '\t': output += "\\t"; break;
+			default: output += entry; break;
+			}
+		}
+
+		return output;
+	}
+
+	/** Writes a floating point value as a JSON number, or as null if the value is missing. */
+	void writeJsonNumber(StringStream& stream, double value)
+	{
+		if(std::isnan(value) || std::isinf(value))
+			stream << "null";
+		else
+			stream << value;
+	}
+
+	BenchmarkLog::BenchmarkLog(const String& name)
+		:mName(name)
+	{ }
+
+	void BenchmarkLog::beginRun(const String& name)
+	{
+		endRun();
+
+		mRuns.push_back(Run());
+		mRuns.back().name = name;
+		mRunActive = true;
+	}
+
+	void BenchmarkLog::endRun()
+	{
+		mRunActive = false;
+	}
+
+	void BenchmarkLog::setRunProperty(const String& name, const String& value)
+	{
+		Run& run = getActiveRun();
+		for(auto& entry : run.properties)
+		{
+			if(entry.first == name)
+			{
+				entry.second = value;
+				return;
+			}
+		}
+
+		run.properties.push_back(std::make_pair(name, value));
+	}
+
+	void BenchmarkLog::record(const String& metric, double value)
+	{
+		record(metric, value, gTime().getFrameIdx());
+	}
+
+	void BenchmarkLog::record(const String& metric, double value, UINT64 frameIdx)
+	{
+		Run& run = getActiveRun();
+
+		// Find the metric, or register it if this is the first time it's being recorded
+		UINT32 metricIdx = (UINT32)run.metrics.size();
+		for(UINT32 i = 0; i < (UINT32)run.metrics.size(); i++)
+		{
+			if(run.metrics[i] == metric)
+			{
+				metricIdx = i;
+				break;
+			}
+		}
+
+		if(metricIdx == (UINT32)run.metrics.size())
+		{
+			run.metrics.push_back(metric);
+			run.values.push_back(Vector<double>(run.frames.size(), MISSING_VALUE));
+		}
+
+		// Start a new row if this is the first value recorded this frame
+		if(run.frames.empty() || run.frames.back() != frameIdx)
+		{
+			run.frames.push_back(frameIdx);
+
+			for(auto& entry : run.values)
+				entry.push_back(MISSING_VALUE);
+		}
+
+		run.values[metricIdx].back() = value;
+	}
+
+	UINT32 BenchmarkLog::getNumFrames() const
+	{
+		if(mRuns.empty())
+			return 0;
+
+		return (UINT32)mRuns.back().frames.size();
+	}
+
+	BenchmarkMetricSummary BenchmarkLog::getSummary(const String& metric) const
+	{
+		if(mRuns.empty())
+			return BenchmarkMetricSummary();
+
+		const Run& run = mRuns.back();
+		for(UINT32 i = 0; i < (UINT32)run.metrics.size(); i++)
+		{
+			if(run.metrics[i] == metric)
+				return calculateSummary(run, i);
+		}
+
+		return BenchmarkMetricSummary();
+	}
+
+	bool BenchmarkLog::save(const Path& path) const
+	{
+		StringStream stream;
+		stream << "{\n";
+		stream << "\t\"benchmark\": \"" << escapeJson(mName) << "\",\n";
+		stream << "\t\"runs\": [\n";
+
+		for(UINT32 runIdx = 0; runIdx < (UINT32)mRuns.size(); runIdx++)
+		{
+			const Run& run = mRuns[runIdx];
+
+			stream << "\t\t{\n";
+			stream << "\t\t\t\"name\": \"" << escapeJson(run.name) << "\",\n";
+
+			// Properties
+			stream << "\t\t\t\"properties\": {";
+			for(UINT32 i = 0; i < (UINT32)run.properties.size(); i++)
+			{
+				stream << (i > 0 ? ", " : " ");
+				stream << "\"" << escapeJson(run.properties[i].first) << "\": \"" <<
+					escapeJson(run.properties[i].second) << "\"";
+			}
+			stream << " },\n";
+
+			// Summaries
+			stream << "\t\t\t\"summary\": {\n";
+			for(UINT32 i = 0; i < (UINT32)run.metrics.size(); i++)
+			{
+				BenchmarkMetricSummary summary = calculateSummary(run, i);
+
+				stream << "\t\t\t\t\"" << escapeJson(run.metrics[i]) << "\": { ";
+				stream << "\"count\": " << summary.count << ", ";
+				stream << "\"min\": "; writeJsonNumber(stream, summary.min); stream << ", ";
+				stream << "\"max\": "; writeJsonNumber(stream, summary.max); stream << ", ";
+				stream << "\"mean\": "; writeJsonNumber(stream, summary.mean); stream << ", ";
+				stream << "\"p50\": "; writeJsonNumber(stream, summary.p50); stream << ", ";
+				stream << "\"p95\": "; writeJsonNumber(stream, summary.p95); stream << ", ";
+				stream << "\"p99\": "; writeJsonNumber(stream, summary.p99);
+				stream << " }" << (i + 1 < (UINT32)run.metrics.size() ? "," : "") << "\n";
+			}
+			stream << "\t\t\t},\n";
+
+			// Per-frame values
+			stream << "\t\t\t\"frames\": {\n";
+			stream << "\t\t\t\t\"frameIdx\": [";
+			for(UINT32 i = 0; i < (UINT32)run.frames.size(); i++)
+				stream << (i > 0 ? ", " : "") << run.frames[i];
+			stream << "]" << (run.metrics.empty() ? "" : ",") << "\n";
+
+			for(UINT32 i = 0; i < (UINT32)run.metrics.size(); i++)
+			{
+				stream << "\t\t\t\t\"" << escapeJson(run.metrics[i]) << "\": [";
+				for(UINT32 j = 0; j < (UINT32)run.values[i].size(); j++)
+				{
+					if(j > 0)
+						stream << ", ";
+
+					writeJsonNumber(stream, run.values[i][j]);
+				}
+				stream << "]" << (i + 1 < (UINT32)run.metrics.size() ? "," : "") << "\n";
+			}
+			stream << "\t\t\t}\n";
+
+			stream << "\t\t}" << (runIdx + 1 < (UINT32)mRuns.size() ? "," : "") << "\n";
+		}
+
+		stream << "\t]\n";
+		stream << "}\n";
+
+		SPtr<DataStream> file = FileSystem::createAndOpenFile(path);
+		if(!file)
+			return false;
+
+		const String output = stream.str();
+		file->write(output.data(), output.size());
+		file->close();
+
+		return true;
+	}
+
+	BenchmarkLog::Run& BenchmarkLog::getActiveRun()
+	{
+		if(!mRunActive)
+			beginRun("Run " + toString((UINT32)mRuns.size()));
+
+		return mRuns.back();
+	}
+
+	BenchmarkMetricSummary BenchmarkLog::calculateSummary(const Run& run, UINT32 metricIdx)
+	{
+		Vector<double> values;
+		values.reserve(run.values[metricIdx].size());
+
+		for(auto& entry : run.values[metricIdx])
+		{
+			if(!std::isnan(entry))
+				values.push_back(entry);
+		}
+
+		BenchmarkMetricSummary summary;
+		if(values.empty())
+			return summary;
+
+		std::sort(values.begin(), values.end());
+
+		double total = 0.0;
+		for(auto& entry : values)
+			total += entry;
+
+		auto percentile = [&values](double fraction)
+		{
+			const UINT32 idx = (UINT32)std::round(fraction * (values.size() - 1));
+			return values[idx];
+		};
+
+		summary.count = (UINT32)values.size();
+		summary.min = values.front();
+		summary.max = values.back();
+		summary.mean = total / values.size();
+		summary.p50 = percentile(0.5);
+		summary.p95 = percentile(0.95);
+		summary.p99 = percentile(0.99);
+
+		return summary;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+
+namespace bs
+{
+	/** Summary of all values recorded for a single metric during a benchmark run. */
+	struct BenchmarkMetricSummary
+	{
+		UINT32 count = 0; /**< Number of frames the metric was recorded in. */
+		double min = 0.0;
+		double max = 0.0;
+		double mean = 0.0;
+		double p50 = 0.0; /**< Median value. */
+		double p95 = 0.0; /**< Value below which 95% of the recorded values fall. */
+		double p99 = 0.0; /**< Value below which 99% of the recorded values fall. */
+	};
+
+	/**
+	 * Collects per-frame metrics recorded by the benchmark modes of the examples, and saves them in JSON format. Values
+	 * are grouped into rows by the frame they were recorded on, so different systems can record their own metrics without
+	 * needing to coordinate. A single log can contain multiple runs, each with its own set of properties, which is
+	 * useful for benchmarks that sweep over a range of settings.
+	 */
+	class BenchmarkLog
+	{
+	public:
+		BenchmarkLog(const String& name);
+
+		/** Starts a new run. Any values recorded from now on will be associated with the run. Ends the previous run. */
+		void beginRun(const String& name);
+
+		/** Ends the current run. Values recorded after this call start a new run automatically. */
+		void endRun();
+
+		/** Sets a property describing the current run (e.g. a setting used for the run). */
+		void setRunProperty(const String& name, const String& value);
+
+		/** Records a value of the metric with the provided name, for the current frame. */
+		void record(const String& metric, double value);
+
+		/**
+		 * Records a value of the metric with the provided name, for the frame with the provided index. Useful for values
+		 * measured on a thread other than the main thread, which would otherwise be recorded for the wrong frame. Frames
+		 * are expected to be recorded in increasing order.
+		 */
+		void record(const String& metric, double value, UINT64 frameIdx);
+
+		/** Returns the number of frames recorded in the current run, or in the last run if no run is active. */
+		UINT32 getNumFrames() const;
+
+		/** 
+		 * Calculates a summary of all values recorded for the metric in the current run, or in the last run if no run is
+		 * active.
+		 */
+		BenchmarkMetricSummary getSummary(const String& metric) const;
+
+		/** Saves all the runs, including their per-frame values and summaries, as a JSON file at the provided path. */
+		bool save(const Path& path) const;
+
+	private:
+		/** Values recorded during a single run. */
+		struct Run
+		{
+			String name;
+			Vector<std::pair<String, String>> properties;
+			Vector<String> metrics;
+			Vector<Vector<double>> values; /**< One entry per metric, containing one value per frame. */
+			Vector<UINT64> frames; /**< Frame index of each of the recorded rows. */
+		};
+
+		/** Returns the current run, starting a new one if needed. */
+		Run& getActiveRun();
+
+		/** Calculates a summary of the values recorded for the metric with the provided index. */
+		static BenchmarkMetricSummary calculateSummary(const Run& run, UINT32 metricIdx);
+
+		String mName;
+		Vector<Run> mRuns;
+		bool mRunActive = false;
+	};
+}
\ No newline at end of file
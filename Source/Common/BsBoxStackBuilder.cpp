@@ -0,0 +1,124 @@
+#include "BsBoxStackBuilder.h"
+#include "Scene/BsSceneObject.h"
+#include "Components/BsCRenderable.h"
+#include "Components/BsCBoxCollider.h"
+#include "Components/BsCRigidbody.h"
+#include "Math/BsMath.h"
+
+namespace bs
+{
+	/** Size of a single box, in meters. Matches the size of the builtin box mesh. */
+	constexpr float BOX_SIZE = 1.0f;
+
+	/** Distance between centers of neighbouring boxes. Slightly larger than the box so they don't start out touching. */
+	constexpr float BOX_SPACING = BOX_SIZE * 1.05f;
+
+	/** Empty space left between two neighbouring walls or pyramids in the same row. */
+	constexpr float STRUCTURE_GAP_X = 3.0f;
+
+	/** Distance between two neighbouring rows of walls or pyramids. */
+	constexpr float STRUCTURE_GAP_Z = 4.0f;
+
+	BoxStackBuilder::BoxStackBuilder(const HMesh& mesh, const HMaterial& material,
+		const HPhysicsMaterial& physicsMaterial)
+		:mMesh(mesh), mMaterial(material), mPhysicsMaterial(physicsMaterial)
+	{ }
+
+	BoxStack BoxStackBuilder::build(const BOX_STACK_DESC& desc) const
+	{
+		BoxStack output;
+		output.root = SceneObject::create("Box stacks");
+		output.bodies.reserve(desc.numBoxes);
+
+		const UINT32 width = std::max(desc.width, 1U);
+		const UINT32 height = desc.layout == BoxStackLayout::Pyramid ? width : std::max(desc.height, 1U);
+
+		// Returns the number of boxes in a specific row of a single wall or pyramid, and the offset of the first box
+		auto getRowInfo = [&desc, width](UINT32 row, float& offset)
+		{
+			if(desc.layout == BoxStackLayout::Pyramid)
+			{
+				offset = row * BOX_SPACING * 0.5f;
+				return width - row;
+			}
+
+			// Every other row of a wall is offset by half a box, same as bricks
+			if((row % 2) == 1)
+			{
+				offset = BOX_SPACING * 0.5f;
+				return std::max(width - 1, 1U);
+			}
+
+			offset = 0.0f;
+			return width;
+		};
+
+		// Determine how many walls or pyramids are needed, and arrange them in a square grid
+		UINT32 boxesPerStructure = 0;
+		for(UINT32 row = 0; row < height; row++)
+		{
+			float offset;
+			boxesPerStructure += getRowInfo(row, offset);
+		}
+
+		const UINT32 numStructures = Math::divideAndRoundUp(std::max(desc.numBoxes, 1U), boxesPerStructure);
+		const UINT32 structuresPerRow = (UINT32)Math::ceilToInt(Math::sqrt((float)numStructures));
+
+		const float stepX = width * BOX_SPACING + STRUCTURE_GAP_X;
+		const float stepZ = STRUCTURE_GAP_Z;
+
+		Vector3 gridStart = desc.origin;
+		gridStart.x -= ((structuresPerRow - 1) * stepX + (width - 1) * BOX_SPACING) * 0.5f;
+
+		// Create the boxes, one structure at a time, going from the bottom row up
+		UINT32 numCreated = 0;
+		for(UINT32 structure = 0; structure < numStructures && numCreated < desc.numBoxes; structure++)
+		{
+			const Vector3 structureStart = gridStart + Vector3(
+				(structure % structuresPerRow) * stepX,
+				0.0f,
+				-(float)(structure / structuresPerRow) * stepZ);
+
+			for(UINT32 row = 0; row < height && numCreated < desc.numBoxes; row++)
+			{
+				float offset;
+				const UINT32 numInRow = getRowInfo(row, offset);
+
+				for(UINT32 column = 0; column < numInRow && numCreated < desc.numBoxes; column++)
+				{
+					Vector3 position = structureStart;
+					position.x += offset + column * BOX_SPACING;
+					position.y += BOX_SIZE * 0.5f + 0.05f + row * BOX_SPACING;
+
+					output.bodies.push_back(createBox(output.root, position, desc));
+					numCreated++;
+				}
+			}
+		}
+
+		return output;
+	}
+
+	HRigidbody BoxStackBuilder::createBox(const HSceneObject& parent, const Vector3& position,
+		const BOX_STACK_DESC& desc) const
+	{
+		HSceneObject boxSO = SceneObject::create("Box");
+		boxSO->setParent(parent);
+		boxSO->setWorldPosition(position);
+
+		if(desc.render)
+		{
+			HRenderable boxRenderable = boxSO->addComponent<CRenderable>();
+			boxRenderable->setMesh(mMesh);
+			boxRenderable->setMaterial(mMaterial);
+		}
+
+		// All boxes use the same collider dimensions and the shared physics material
+		HBoxCollider boxCollider = boxSO->addComponent<CBoxCollider>();
+		boxCollider->setExtents(Vector3::ONE * BOX_SIZE * 0.5f);
+		boxCollider->setMaterial(mPhysicsMaterial);
+		boxCollider->setMass(desc.mass);
+
+		return boxSO->addComponent<CRigidbody>();
+	}
+}
\ No newline at end of file
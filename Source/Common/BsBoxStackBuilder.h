@@ -0,0 +1,74 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+
+namespace bs
+{
+	/** Determines how are the boxes created by BoxStackBuilder arranged. */
+	enum class BoxStackLayout
+	{
+		/** Walls of boxes laid out in a brick pattern. */
+		Wall,
+		/** Two dimensional pyramids, each row having one box less than the row below it. */
+		Pyramid
+	};
+
+	/** Information used for building a set of box stacks through BoxStackBuilder. */
+	struct BOX_STACK_DESC
+	{
+		/** Determines how are the boxes arranged. */
+		BoxStackLayout layout = BoxStackLayout::Wall;
+
+		/** Total number of boxes to create. Boxes are split into as many walls or pyramids as needed. */
+		UINT32 numBoxes = 1000;
+
+		/** Number of boxes in the bottom row of a single wall or pyramid. */
+		UINT32 width = 20;
+
+		/** Number of rows in a single wall. Pyramid height is determined by its width. */
+		UINT32 height = 10;
+
+		/**
+		 * Position of the front center of the area covered by the walls or pyramids. Rows of walls or pyramids are
+		 * centered around it along the X axis, and are added further along the negative Z axis.
+		 */
+		Vector3 origin = Vector3::ZERO;
+
+		/** Mass of a single box, in kilograms. */
+		float mass = 25.0f;
+
+		/** If false, boxes will only have physical representation. Useful for measuring physics cost in isolation. */
+		bool render = true;
+	};
+
+	/** Scene objects and rigidbodies of the boxes created by BoxStackBuilder. */
+	struct BoxStack
+	{
+		/** Parent of all the boxes. Destroying it destroys all the boxes. */
+		HSceneObject root;
+
+		/** Rigidbodies of all the boxes, in creation order. */
+		Vector<HRigidbody> bodies;
+	};
+
+	/**
+	 * Creates large numbers of physical boxes arranged in walls or pyramids. All boxes share the same mesh, material,
+	 * physics material and collider dimensions, so the only per-box cost is the scene object and its components.
+	 */
+	class BoxStackBuilder
+	{
+	public:
+		BoxStackBuilder(const HMesh& mesh, const HMaterial& material, const HPhysicsMaterial& physicsMaterial);
+
+		/** Creates the boxes as specified by the provided descriptor. */
+		BoxStack build(const BOX_STACK_DESC& desc) const;
+
+	private:
+		/** Creates a single box at the provided position, as a child of the provided parent. */
+		HRigidbody createBox(const HSceneObject& parent, const Vector3& position, const BOX_STACK_DESC& desc) const;
+
+		HMesh mMesh;
+		HMaterial mMaterial;
+		HPhysicsMaterial mPhysicsMaterial;
+	};
+}
\ No newline at end of file
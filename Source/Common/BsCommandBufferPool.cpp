@@ -0,0 +1,37 @@
+#include "BsCommandBufferPool.h"
+
+namespace bs { namespace ct
+{
+	CommandBufferPool::CommandBufferPool(GpuQueueType type, UINT32 deviceIdx, UINT32 queueIdx)
+		:mType(type), mDeviceIdx(deviceIdx), mQueueIdx(queueIdx)
+	{ }
+
+	void CommandBufferPool::beginFrame()
+	{
+		for(auto& entry : mEntries)
+			entry.acquired = false;
+
+		mNumFrameCreated = 0;
+	}
+
+	SPtr<CommandBuffer> CommandBufferPool::acquire()
+	{
+		for(auto& entry : mEntries)
+		{
+			if(entry.acquired || entry.buffer->getState() == CommandBufferState::Executing)
+				continue;
+
+			entry.acquired = true;
+			return entry.buffer;
+		}
+
+		Entry entry;
+		entry.buffer = CommandBuffer::create(mType, mDeviceIdx, mQueueIdx);
+		entry.acquired = true;
+
+		mEntries.push_back(entry);
+		mNumFrameCreated++;
+
+		return entry.buffer;
+	}
+}}
\ No newline at end of file
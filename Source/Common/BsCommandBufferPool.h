@@ -0,0 +1,45 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "RenderAPI/BsCommandBuffer.h"
+
+namespace bs { namespace ct
+{
+	/**
+	 * Keeps a set of command buffers that are reused from frame to frame, instead of creating new ones every frame. A
+	 * command buffer is only handed out again once it has finished executing on the GPU, and once per frame at most, so
+	 * the command buffers of a frame are always distinct.
+	 */
+	class CommandBufferPool
+	{
+	public:
+		CommandBufferPool(GpuQueueType type = GQT_GRAPHICS, UINT32 deviceIdx = 0, UINT32 queueIdx = 0);
+
+		/** Starts a new frame. Command buffers handed out during the previous frame can be handed out again. */
+		void beginFrame();
+
+		/** Returns a command buffer that's not in use, creating a new one only if all of them are. */
+		SPtr<CommandBuffer> acquire();
+
+		/** Returns the total number of command buffers created by the pool. */
+		UINT32 getNumCreated() const { return (UINT32)mEntries.size(); }
+
+		/** Returns the number of command buffers created during the current frame. */
+		UINT32 getNumFrameCreated() const { return mNumFrameCreated; }
+
+	private:
+		/** Command buffer owned by the pool. */
+		struct Entry
+		{
+			SPtr<CommandBuffer> buffer;
+			bool acquired = false; /**< True if the buffer was handed out during the current frame. */
+		};
+
+		GpuQueueType mType;
+		UINT32 mDeviceIdx;
+		UINT32 mQueueIdx;
+
+		Vector<Entry> mEntries;
+		UINT32 mNumFrameCreated = 0;
+	};
+}}
\ No newline at end of file
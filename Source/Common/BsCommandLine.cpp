@@ -0,0 +1,66 @@
+#include "BsCommandLine.h"
+
+namespace bs
+{
+	UnorderedMap<String, String> CommandLine::options;
+
+	void CommandLine::parse(int argc, char* argv[])
+	{
+		// Skip the first argument, as it's the executable path
+		for(int i = 1; i < argc; i++)
+		{
+			String arg = argv[i];
+			if(!StringUtil::startsWith(arg, "--"))
+				continue;
+
+			arg = arg.substr(2);
+
+			const String::size_type separator = arg.find('=');
+			if(separator == String::npos)
+				options[arg] = StringUtil::BLANK;
+			else
+				options[arg.substr(0, separator)] = arg.substr(separator + 1);
+		}
+	}
+
+	bool CommandLine::hasOption(const String& name)
+	{
+		return options.find(name) != options.end();
+	}
+
+	String CommandLine::getString(const String& name, const String& defaultValue)
+	{
+		auto iterFind = options.find(name);
+		if(iterFind == options.end() || iterFind->second.empty())
+			return defaultValue;
+
+		return iterFind->second;
+	}
+
+	INT32 CommandLine::getInt(const String& name, INT32 defaultValue)
+	{
+		auto iterFind = options.find(name);
+		if(iterFind == options.end())
+			return defaultValue;
+
+		return parseINT32(iterFind->second, defaultValue);
+	}
+
+	UINT32 CommandLine::getUInt(const String& name, UINT32 defaultValue)
+	{
+		auto iterFind = options.find(name);
+		if(iterFind == options.end())
+			return defaultValue;
+
+		return parseUINT32(iterFind->second, defaultValue);
+	}
+
+	float CommandLine::getFloat(const String& name, float defaultValue)
+	{
+		auto iterFind = options.find(name);
+		if(iterFind == options.end())
+			return defaultValue;
+
+		return parseFloat(iterFind->second, defaultValue);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+
+namespace bs
+{
+	/**
+	 * Provides access to the options the example was launched with. Options are expected in the "--name=value" form, or
+	 * as "--name" for options that act as simple on/off flags.
+	 */
+	class CommandLine
+	{
+	public:
+		/** Parses the arguments passed to the application entry point. Should be called once, before any other method. */
+		static void parse(int argc, char* argv[]);
+
+		/** Checks was the option with the provided name specified, with or without a value. */
+		static bool hasOption(const String& name);
+
+		/** Returns the value of the option with the provided name, or the default value if the option is not present. */
+		static String getString(const String& name, const String& defaultValue = StringUtil::BLANK);
+
+		/** @copydoc getString */
+		static INT32 getInt(const String& name, INT32 defaultValue);
+
+		/** @copydoc getString */
+		static UINT32 getUInt(const String& name, UINT32 defaultValue);
+
+		/** @copydoc getString */
+		static float getFloat(const String& name, float defaultValue);
+
+	private:
+		static UnorderedMap<String, String> options;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "BsCoreThreadProfiler.h"
+#include "CoreThread/BsCoreThread.h"
+#include "Utility/BsTime.h"
+
+namespace bs
+{
+	CoreThreadProfiler::CoreThreadProfiler(UINT32 historySize)
+		:mHistorySize(std::max(historySize, 1U))
+	{ }
+
+	void CoreThreadProfiler::beginFrame()
+	{
+		const UINT64 time = mTimer.getMicroseconds();
+
+		if(!mFrames.empty())
+		{
+			PendingFrame& previous = mFrames.back();
+			previous.endTime = time;
+			previous.ended = true;
+		}
+
+		PendingFrame frame;
+		frame.stats.frameIdx = gTime().getFrameIdx();
+		frame.startTime = time;
+		frame.updateEndTime = time;
+
+		mFrames.push_back(frame);
+		gatherFinishedCommands();
+	}
+
+	void CoreThreadProfiler::endUpdate()
+	{
+		if(!mFrames.empty())
+			mFrames.back().updateEndTime = mTimer.getMicroseconds();
+	}
+
+	void CoreThreadProfiler::queueCommand(const std::function<void()>& command)
+	{
+		if(mFrames.empty())
+		{
+			gCoreThread().queueCommand(command);
+			return;
+		}
+
+		PendingFrame& frame = mFrames.back();
+		frame.stats.numCommands++;
+
+		{
+			Lock lock(mMutex);
+			mNumQueued++;
+
+			frame.stats.maxQueueDepth = std::max(frame.stats.maxQueueDepth, mNumQueued - mNumStarted);
+		}
+
+		const UINT64 frameIdx = frame.stats.frameIdx;
+		const UINT64 queueTime = mTimer.getMicroseconds();
+
+		gCoreThread().queueCommand([this, command, frameIdx, queueTime]()
+		{
+			const UINT64 startTime = mTimer.getMicroseconds();
+
+			{
+				Lock lock(mMutex);
+				mNumStarted++;
+			}
+
+			command();
+
+			CommandTiming timing;
+			timing.frameIdx = frameIdx;
+			timing.queueTime = queueTime;
+			timing.startTime = startTime;
+			timing.finishTime = mTimer.getMicroseconds();
+
+			Lock lock(mMutex);
+			mFinishedCommands.push_back(timing);
+		});
+	}
+
+	void CoreThreadProfiler::takeFrameStats(Vector<CoreThreadFrameStats>& output)
+	{
+		output.clear();
+		std::swap(output, mFinishedFrames);
+	}
+
+	void CoreThreadProfiler::gatherFinishedCommands()
+	{
+		// Swap the buffers rather than copying, so the core thread holds the lock as briefly as possible
+		mTimings.clear();
+
+		{
+			Lock lock(mMutex);
+			std::swap(mTimings, mFinishedCommands);
+		}
+
+		// Frames are sorted by index, and most commands belong to one of the last few
+		for(auto& entry : mTimings)
+		{
+			for(auto iter = mFrames.rbegin(); iter != mFrames.rend(); ++iter)
+			{
+				if(iter->stats.frameIdx != entry.frameIdx)
+					continue;
+
+				CoreThreadFrameStats& stats = iter->stats;
+				const float waitTime = (entry.startTime - entry.queueTime) / 1000.0f;
+
+				stats.avgWaitTime += waitTime; // Summed for now, divided once the frame is done
+				stats.maxWaitTime = std::max(stats.maxWaitTime, waitTime);
+				stats.executeTime += (entry.finishTime - entry.startTime) / 1000.0f;
+
+				iter->numFinished++;
+				break;
+			}
+		}
+
+		// Frames are done once the next one has started, and all of their commands have finished
+		while(!mFrames.empty())
+		{
+			PendingFrame& frame = mFrames.front();
+			if(!frame.ended || frame.numFinished < frame.stats.numCommands)
+				break;
+
+			CoreThreadFrameStats& stats = frame.stats;
+			const UINT64 frameTime = std::max(frame.endTime - frame.startTime, (UINT64)1);
+
+			if(stats.numCommands > 0)
+				stats.avgWaitTime /= stats.numCommands;
+
+			stats.frameTime = frameTime / 1000.0f;
+			stats.mainIdleRatio = 1.0f - (frame.updateEndTime - frame.startTime) / (float)frameTime;
+			stats.coreIdleRatio = std::max(1.0f - stats.executeTime / stats.frameTime, 0.0f);
+
+			mFinishedFrames.push_back(stats);
+
+			mHistory.push_back(stats);
+			if((UINT32)mHistory.size() > mHistorySize)
+				mHistory.pop_front();
+
+			mFrames.pop_front();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "Utility/BsTimer.h"
+
+namespace bs
+{
+	/** Timings of the profiled core thread commands queued during a single main thread frame. */
+	struct CoreThreadFrameStats
+	{
+		UINT64 frameIdx = 0; /**< Index of the main thread frame the commands were queued during. */
+		UINT32 numCommands = 0; /**< Number of profiled commands queued during the frame. */
+		UINT32 maxQueueDepth = 0; /**< Most profiled commands queued but not yet started, seen when queuing one. */
+		float avgWaitTime = 0.0f; /**< Average time between queuing a command and it starting, in milliseconds. */
+		float maxWaitTime = 0.0f; /**< Longest time between queuing a command and it starting, in milliseconds. */
+		float executeTime = 0.0f; /**< Total time spent executing the commands, in milliseconds. */
+		float frameTime = 0.0f; /**< Time between the start of the frame and the start of the next one, in milliseconds. */
+		float mainIdleRatio = 0.0f; /**< Fraction of the frame the main thread spent outside of the update. */
+		float coreIdleRatio = 0.0f; /**< Fraction of the frame the core thread spent not executing the commands. */
+	};
+
+	/**
+	 * Measures how work flows from the main thread to the core thread. Commands queued through the profiler are
+	 * timestamped when they are queued on the main thread, and when they start & finish executing on the core thread.
+	 * The timestamps are gathered per main thread frame, giving the depth of the queue, how long commands wait in it, and
+	 * how much of the frame each thread spends idle.
+	 *
+	 * The core thread's own loop isn't visible from the outside, so its idle ratio only counts the profiled commands as
+	 * work, and is an upper bound when other commands are queued as well. The main thread counts as idle outside of the
+	 * beginFrame() / endUpdate() interval, which is where it submits the queued commands, and waits on the core thread
+	 * when it falls behind.
+	 *
+	 * Must be used from the main thread, apart from the queued commands. Must outlive the commands it queues.
+	 */
+	class CoreThreadProfiler
+	{
+	public:
+		/** Creates a new profiler, keeping the statistics of the provided number of frames for getHistory(). */
+		CoreThreadProfiler(UINT32 historySize = 128);
+
+		/** Starts a new main thread frame. Commands queued from now on belong to it. */
+		void beginFrame();
+
+		/** Marks the end of the main thread's update for the current frame. */
+		void endUpdate();
+
+		/**
+		 * Queues a command for execution on the core thread, timestamping it when queued, started and finished. Commands
+		 * queued before the first call to beginFrame() are queued without profiling.
+		 */
+		void queueCommand(const std::function<void()>& command);
+
+		/**
+		 * Outputs the statistics of the frames whose commands have all finished executing since the last call, oldest
+		 * first.
+		 */
+		void takeFrameStats(Vector<CoreThreadFrameStats>& output);
+
+		/** Returns the statistics of the most recent finished frames, oldest first. */
+		const Deque<CoreThreadFrameStats>& getHistory() const { return mHistory; }
+
+	private:
+		/** Timestamps of a single command, in microseconds since the profiler was created. */
+		struct CommandTiming
+		{
+			UINT64 frameIdx;
+			UINT64 queueTime;
+			UINT64 startTime;
+			UINT64 finishTime;
+		};
+
+		/** Frame whose commands may still be waiting or executing. */
+		struct PendingFrame
+		{
+			CoreThreadFrameStats stats;
+			UINT64 startTime = 0;
+			UINT64 updateEndTime = 0;
+			UINT64 endTime = 0;
+			UINT32 numFinished = 0;
+			bool ended = false;
+		};
+
+		/** Adds the timings of the commands that finished since the last call to their frames. */
+		void gatherFinishedCommands();
+
+		Timer mTimer;
+		UINT32 mHistorySize;
+
+		Deque<PendingFrame> mFrames;
+		Vector<CoreThreadFrameStats> mFinishedFrames;
+		Deque<CoreThreadFrameStats> mHistory;
+		Vector<CommandTiming> mTimings;
+
+		// Shared with the core thread
+		Mutex mMutex;
+		Vector<CommandTiming> mFinishedCommands;
+		UINT32 mNumQueued = 0;
+		UINT32 mNumStarted = 0;
+	};
+}
\ No newline at end of file
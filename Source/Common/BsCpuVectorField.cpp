@@ -0,0 +1,508 @@
+#include "BsCpuVectorField.h"
+#include "FileSystem/BsFileSystem.h"
+#include "FileSystem/BsDataStream.h"
+#include "Math/BsMath.h"
+#include "Utility/BsBitwise.h"
+#include "Particles/BsVectorField.h"
+#include "BsParallelFor.h"
+
+namespace bs
+{
+	/** Size of the chunks, in bytes, FGA files are split into for parsing in parallel. */
+	constexpr UINT32 FGA_CHUNK_SIZE = 1024 * 1024;
+
+	/** Identifier at the start of every vector field cache file. */
+	constexpr UINT32 CACHE_MAGIC = 0x43465642; // "BVFC"
+
+	/** Version of the vector field cache format. Increment when the format changes, so old caches are re-created. */
+	constexpr UINT32 CACHE_VERSION = 1;
+
+	/** Header at the start of a vector field cache file, followed by the X, Y and Z components of all the values. */
+	struct VectorFieldCacheHeader
+	{
+		UINT32 magic = CACHE_MAGIC;
+		UINT32 version = CACHE_VERSION;
+		UINT32 countX = 0;
+		UINT32 countY = 0;
+		UINT32 countZ = 0;
+		UINT32 halfPrecision = 0;
+		float boundsMin[3];
+		float boundsMax[3];
+	};
+
+	/** Checks is the provided character one of the characters separating numbers in an FGA file. */
+	bool isFGASeparator(char value)
+	{
+		return value == ',' || value == ' ' || value == '\t' || value == '\r' || value == '\n';
+	}
+
+	/** Powers of ten, used for scaling parsed mantissas by their exponent. */
+	struct FGAPowersOfTen
+	{
+		FGAPowersOfTen()
+		{
+			values[0] = 1.0;
+			for(UINT32 i = 1; i < COUNT; i++)
+				values[i] = values[i - 1] * 10.0;
+		}
+
+		static constexpr UINT32 COUNT = 64;
+		double values[COUNT];
+	};
+
+	/**
+	 * Skips any separators and parses the next number in an FGA file, advancing the cursor past it. Returns false if
+	 * there are no more numbers before @p end, or if the next value isn't a number.
+	 *
+	 * Numbers are parsed by hand, rather than using strtof(), which depends on the locale's decimal separator and needs a
+	 * null terminated string. The digits are accumulated as an integer and scaled by a power of ten in double precision,
+	 * which is exact enough for 32-bit floats.
+	 */
+	bool parseFGANumber(const char*& cursor, const char* end, float& value)
+	{
+		while(cursor < end && isFGASeparator(*cursor))
+			cursor++;
+
+		bool negative = false;
+		if(cursor < end && (*cursor == '+' || *cursor == '-'))
+		{
+			negative = *cursor == '-';
+			cursor++;
+		}
+
+		// Digits beyond the 19th don't fit in the mantissa, and are too small to matter for a float
+		UINT64 mantissa = 0;
+		INT32 exponent = 0;
+		UINT32 numDigits = 0;
+		UINT32 numSignificantDigits = 0;
+
+		auto readDigits = [&](bool fraction)
+		{
+			while(cursor < end && *cursor >= '0' && *cursor <= '9')
+			{
+				if(numSignificantDigits < 19)
+				{
+					mantissa = mantissa * 10 + (UINT64)(*cursor - '0');
+					if(mantissa > 0)
+						numSignificantDigits++;
+
+					if(fraction)
+						exponent--;
+				}
+				else if(!fraction)
+					exponent++;
+
+				numDigits++;
+				cursor++;
+			}
+		};
+
+		readDigits(false);
+
+		if(cursor < end && *cursor == '.')
+		{
+			cursor++;
+			readDigits(true);
+		}
+
+		if(numDigits == 0)
+			return false;
+
+		if(cursor < end && (*cursor == 'e' || *cursor == 'E'))
+		{
+			const char* exponentStart = cursor++;
+
+			bool negativeExponent = false;
+			if(cursor < end && (*cursor == '+' || *cursor == '-'))
+			{
+				negativeExponent = *cursor == '-';
+				cursor++;
+			}
+
+			if(cursor < end && *cursor >= '0' && *cursor <= '9')
+			{
+				INT32 explicitExponent = 0;
+				while(cursor < end && *cursor >= '0' && *cursor <= '9')
+				{
+					explicitExponent = std::min(explicitExponent * 10 + (*cursor - '0'), 1000);
+					cursor++;
+				}
+
+				exponent += negativeExponent ? -explicitExponent : explicitExponent;
+			}
+			else // Not an exponent after all, leave the 'e' for the caller to reject
+				cursor = exponentStart;
+		}
+
+		static const FGAPowersOfTen powersOfTen;
+
+		double result = (double)mantissa;
+		if(mantissa != 0)
+		{
+			const UINT32 absExponent = (UINT32)std::abs(exponent);
+			const double scale = absExponent < FGAPowersOfTen::COUNT ? powersOfTen.values[absExponent] :
+				std::pow(10.0, (double)absExponent);
+
+			result = exponent < 0 ? result / scale : result * scale;
+		}
+
+		value = (float)(negative ? -result : result);
+		return true;
+	}
+
+	/** Maps a texel coordinate to the two texels to interpolate between, and the interpolation factor. */
+	void getSampleTexels(float coord, UINT32 count, bool tile, UINT32& texel0, UINT32& texel1, float& frac)
+	{
+		if(tile)
+		{
+			coord -= std::floor(coord / count) * count;
+
+			texel0 = std::min((UINT32)coord, count - 1);
+			texel1 = texel0 + 1 < count ? texel0 + 1 : 0;
+		}
+		else
+		{
+			coord = Math::clamp(coord, 0.0f, (float)(count - 1));
+
+			texel0 = (UINT32)coord;
+			texel1 = std::min(texel0 + 1, count - 1);
+		}
+
+		frac = coord - std::floor(coord);
+	}
+
+	SPtr<CpuVectorField> CpuVectorField::create(UINT32 countX, UINT32 countY, UINT32 countZ, const AABox& bounds,
+		const Vector<Vector3>& values)
+	{
+		const UINT32 numValues = countX * countY * countZ;
+		if(numValues == 0 || values.size() < numValues)
+		{
+			LOGERR("Invalid vector field size.");
+			return nullptr;
+		}
+
+		SPtr<CpuVectorField> output = bs_shared_ptr_new<CpuVectorField>();
+		output->mCountX = countX;
+		output->mCountY = countY;
+		output->mCountZ = countZ;
+		output->mBounds = bounds;
+
+		output->mValuesX.resize(numValues);
+		output->mValuesY.resize(numValues);
+		output->mValuesZ.resize(numValues);
+
+		for(UINT32 i = 0; i < numValues; i++)
+		{
+			output->mValuesX[i] = values[i].x;
+			output->mValuesY[i] = values[i].y;
+			output->mValuesZ[i] = values[i].z;
+		}
+
+		return output;
+	}
+
+	SPtr<CpuVectorField> CpuVectorField::loadFGA(const Path& path)
+	{
+		if(!FileSystem::isFile(path))
+		{
+			LOGERR("Cannot find the vector field: " + path.toString());
+			return nullptr;
+		}
+
+		SPtr<DataStream> stream = FileSystem::openFile(path);
+		Vector<char> contents(stream->size());
+
+		if(!contents.empty())
+			stream->read(contents.data(), contents.size());
+
+		stream->close();
+
+		const char* const fileStart = contents.data();
+		const char* const fileEnd = fileStart + contents.size();
+
+		// The file is a comma separated list of numbers: the value counts, the bounds minimum, the bounds maximum and
+		// then the values themselves
+		float header[9];
+		const char* cursor = fileStart;
+		for(auto& entry : header)
+		{
+			if(!parseFGANumber(cursor, fileEnd, entry))
+			{
+				LOGERR("Invalid vector field: " + path.toString());
+				return nullptr;
+			}
+		}
+
+		const UINT32 countX = (UINT32)header[0];
+		const UINT32 countY = (UINT32)header[1];
+		const UINT32 countZ = (UINT32)header[2];
+		const AABox bounds(Vector3(header[3], header[4], header[5]), Vector3(header[6], header[7], header[8]));
+
+		const UINT32 numValues = countX * countY * countZ;
+		if(numValues == 0)
+		{
+			LOGERR("Invalid vector field: " + path.toString());
+			return nullptr;
+		}
+
+		// Split the values into chunks, ending each chunk at a separator so no number is split in two
+		Vector<const char*> chunkStarts = { cursor };
+		while(true)
+		{
+			const char* chunkEnd = chunkStarts.back() + FGA_CHUNK_SIZE;
+			if(chunkEnd >= fileEnd)
+				break;
+
+			while(chunkEnd < fileEnd && !isFGASeparator(*chunkEnd))
+				chunkEnd++;
+
+			if(chunkEnd >= fileEnd)
+				break;
+
+			chunkStarts.push_back(chunkEnd);
+		}
+
+		chunkStarts.push_back(fileEnd);
+
+		// Parse the chunks in parallel. Each chunk is parsed into its own list, and the lists are then merged in order.
+		const UINT32 numChunks = (UINT32)chunkStarts.size() - 1;
+		Vector<Vector<float>> chunkNumbers(numChunks);
+		Vector<UINT8> chunkValid(numChunks, 1);
+
+		parallelFor(numChunks, 1, [&](UINT32 start, UINT32 end)
+		{
+			for(UINT32 i = start; i < end; i++)
+			{
+				const char* chunkCursor = chunkStarts[i];
+				const char* chunkEnd = chunkStarts[i + 1];
+
+				// Roughly estimate the number count to avoid most reallocations
+				Vector<float>& numbers = chunkNumbers[i];
+				numbers.reserve((chunkEnd - chunkCursor) / 8);
+
+				float value;
+				while(parseFGANumber(chunkCursor, chunkEnd, value))
+					numbers.push_back(value);
+
+				// Parsing stops either at the end of the chunk, or at something that isn't a number
+				while(chunkCursor < chunkEnd && isFGASeparator(*chunkCursor))
+					chunkCursor++;
+
+				chunkValid[i] = chunkCursor == chunkEnd;
+			}
+		});
+
+		SPtr<CpuVectorField> output = bs_shared_ptr_new<CpuVectorField>();
+		output->mCountX = countX;
+		output->mCountY = countY;
+		output->mCountZ = countZ;
+		output->mBounds = bounds;
+
+		output->mValuesX.resize(numValues);
+		output->mValuesY.resize(numValues);
+		output->mValuesZ.resize(numValues);
+
+		float* components[3] = { output->mValuesX.data(), output->mValuesY.data(), output->mValuesZ.data() };
+
+		UINT32 numberIdx = 0;
+		for(UINT32 i = 0; i < numChunks; i++)
+		{
+			if(!chunkValid[i])
+			{
+				LOGERR("Invalid vector field: " + path.toString());
+				return nullptr;
+			}
+
+			for(auto& entry : chunkNumbers[i])
+			{
+				if(numberIdx >= numValues * 3)
+					break;
+
+				components[numberIdx % 3][numberIdx / 3] = entry;
+				numberIdx++;
+			}
+		}
+
+		if(numberIdx < numValues * 3)
+		{
+			LOGERR("Vector field is missing values: " + path.toString());
+			return nullptr;
+		}
+
+		return output;
+	}
+
+	SPtr<CpuVectorField> CpuVectorField::loadCache(const Path& path)
+	{
+		if(!FileSystem::isFile(path))
+			return nullptr;
+
+		SPtr<DataStream> stream = FileSystem::openFile(path);
+
+		VectorFieldCacheHeader header;
+		if(stream->read(&header, sizeof(header)) != sizeof(header) || header.magic != CACHE_MAGIC ||
+			header.version != CACHE_VERSION)
+		{
+			stream->close();
+			return nullptr;
+		}
+
+		const UINT32 numValues = header.countX * header.countY * header.countZ;
+		const UINT32 componentSize = header.halfPrecision ? sizeof(UINT16) : sizeof(float);
+
+		if(numValues == 0 || stream->size() != sizeof(header) + (size_t)numValues * componentSize * 3)
+		{
+			stream->close();
+			return nullptr;
+		}
+
+		SPtr<CpuVectorField> output = bs_shared_ptr_new<CpuVectorField>();
+		output->mCountX = header.countX;
+		output->mCountY = header.countY;
+		output->mCountZ = header.countZ;
+		output->mBounds = AABox(
+			Vector3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]),
+			Vector3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]));
+
+		Vector<UINT16> halfValues;
+		for(auto* entry : { &output->mValuesX, &output->mValuesY, &output->mValuesZ })
+		{
+			entry->resize(numValues);
+
+			if(header.halfPrecision)
+			{
+				halfValues.resize(numValues);
+				stream->read(halfValues.data(), numValues * sizeof(UINT16));
+
+				for(UINT32 i = 0; i < numValues; i++)
+					(*entry)[i] = Bitwise::halfToFloat(halfValues[i]);
+			}
+			else
+				stream->read(entry->data(), numValues * sizeof(float));
+		}
+
+		stream->close();
+		return output;
+	}
+
+	SPtr<CpuVectorField> CpuVectorField::load(const Path& path, bool halfPrecision, bool* fromCache)
+	{
+		Path cachePath = path;
+		cachePath.setExtension(path.getExtension() + ".cache");
+
+		if(fromCache)
+			*fromCache = false;
+
+		// Use the cache unless the source file changed since it was written
+		bool cacheValid = FileSystem::isFile(cachePath);
+		if(cacheValid && FileSystem::isFile(path))
+			cacheValid = FileSystem::getLastModifiedTime(cachePath) >= FileSystem::getLastModifiedTime(path);
+
+		if(cacheValid)
+		{
+			SPtr<CpuVectorField> output = loadCache(cachePath);
+			if(output)
+			{
+				if(fromCache)
+					*fromCache = true;
+
+				return output;
+			}
+		}
+
+		SPtr<CpuVectorField> output = loadFGA(path);
+		if(output)
+			output->saveCache(cachePath, halfPrecision);
+
+		return output;
+	}
+
+	bool CpuVectorField::saveCache(const Path& path, bool halfPrecision) const
+	{
+		SPtr<DataStream> stream = FileSystem::createAndOpenFile(path);
+		if(!stream)
+		{
+			LOGWRN("Unable to save the vector field cache: " + path.toString());
+			return false;
+		}
+
+		VectorFieldCacheHeader header;
+		header.countX = mCountX;
+		header.countY = mCountY;
+		header.countZ = mCountZ;
+		header.halfPrecision = halfPrecision ? 1 : 0;
+
+		for(UINT32 i = 0; i < 3; i++)
+		{
+			header.boundsMin[i] = mBounds.getMin()[i];
+			header.boundsMax[i] = mBounds.getMax()[i];
+		}
+
+		stream->write(&header, sizeof(header));
+
+		Vector<UINT16> halfValues;
+		for(auto* entry : { &mValuesX, &mValuesY, &mValuesZ })
+		{
+			if(halfPrecision)
+			{
+				halfValues.resize(entry->size());
+				for(UINT32 i = 0; i < (UINT32)entry->size(); i++)
+					halfValues[i] = Bitwise::floatToHalf((*entry)[i]);
+
+				stream->write(halfValues.data(), halfValues.size() * sizeof(UINT16));
+			}
+			else
+				stream->write(entry->data(), entry->size() * sizeof(float));
+		}
+
+		stream->close();
+		return true;
+	}
+
+	HVectorField CpuVectorField::createResource() const
+	{
+		VECTOR_FIELD_DESC desc;
+		desc.countX = mCountX;
+		desc.countY = mCountY;
+		desc.countZ = mCountZ;
+		desc.bounds = mBounds;
+
+		const UINT32 numValues = (UINT32)mValuesX.size();
+		Vector<Vector3> values(numValues);
+
+		for(UINT32 i = 0; i < numValues; i++)
+			values[i] = Vector3(mValuesX[i], mValuesY[i], mValuesZ[i]);
+
+		return VectorField::create(desc, values);
+	}
+
+	Vector3 CpuVectorField::sample(const Vector3& position, bool tileX, bool tileY, bool tileZ) const
+	{
+		const Vector3 size = mBounds.getSize();
+		const Vector3 uvw = (position - mBounds.getMin()) / size;
+
+		// Values are placed at the cell centers, same as texels
+		UINT32 x0, x1, y0, y1, z0, z1;
+		float fx, fy, fz;
+		getSampleTexels(uvw.x * mCountX - 0.5f, mCountX, tileX, x0, x1, fx);
+		getSampleTexels(uvw.y * mCountY - 0.5f, mCountY, tileY, y0, y1, fy);
+		getSampleTexels(uvw.z * mCountZ - 0.5f, mCountZ, tileZ, z0, z1, fz);
+
+		const UINT32 sliceSize = mCountX * mCountY;
+		auto value = [&](UINT32 x, UINT32 y, UINT32 z)
+		{
+			const UINT32 idx = x + y * mCountX + z * sliceSize;
+			return Vector3(mValuesX[idx], mValuesY[idx], mValuesZ[idx]);
+		};
+
+		const Vector3 y0z0 = Math::lerp(fx, value(x0, y0, z0), value(x1, y0, z0));
+		const Vector3 y1z0 = Math::lerp(fx, value(x0, y1, z0), value(x1, y1, z0));
+		const Vector3 y0z1 = Math::lerp(fx, value(x0, y0, z1), value(x1, y0, z1));
+		const Vector3 y1z1 = Math::lerp(fx, value(x0, y1, z1), value(x1, y1, z1));
+
+		const Vector3 z0v = Math::lerp(fy, y0z0, y1z0);
+		const Vector3 z1v = Math::lerp(fy, y0z1, y1z1);
+
+		return Math::lerp(fz, z0v, z1v);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "Math/BsAABox.h"
+
+namespace bs
+{
+	/**
+	 * CPU copy of a vector field, as used by the VectorField resource for GPU particle simulation. The VectorField resource
+	 * only keeps its values in a GPU texture, so this keeps them in memory instead, allowing particles to be simulated
+	 * using the vector field on the CPU.
+	 *
+	 * Values are stored in separate arrays per component, ordered by X, then Y, then Z. Sampling matches the GPU
+	 * simulation, which reads the values from a 3D texture: values are placed at the centers of the grid cells spanning
+	 * the bounds, and are interpolated trilinearly.
+	 */
+	class CpuVectorField
+	{
+	public:
+		/**
+		 * Creates a new vector field with the provided number of values along each axis, spanning the provided bounds.
+		 * The values are expected in the same order as they are stored in, see the class description.
+		 */
+		static SPtr<CpuVectorField> create(UINT32 countX, UINT32 countY, UINT32 countZ, const AABox& bounds,
+			const Vector<Vector3>& values);
+
+		/**
+		 * Loads a vector field from a file in the FGA format, as used by the VectorField importer. Large files are split
+		 * into chunks parsed in parallel by the task scheduler workers.
+		 */
+		static SPtr<CpuVectorField> loadFGA(const Path& path);
+
+		/**
+		 * Loads a vector field from a cache file saved by saveCache(). Returns null if the file doesn't exist or is not a
+		 * valid cache file.
+		 */
+		static SPtr<CpuVectorField> loadCache(const Path& path);
+
+		/**
+		 * Loads a vector field from a file in the FGA format, using a binary cache next to it if possible. If the cache
+		 * is missing or older than the FGA file, the FGA file is parsed and the cache is re-created.
+		 *
+		 * @param[in]	path			Path to the FGA file.
+		 * @param[in]	halfPrecision	If true the cache stores the values as 16-bit floats, halving its size.
+		 * @param[out]	fromCache		Optional output set to true if the vector field was loaded from the cache.
+		 */
+		static SPtr<CpuVectorField> load(const Path& path, bool halfPrecision = false, bool* fromCache = nullptr);
+
+		/** Saves the vector field into a binary cache file, which can be loaded using loadCache(). */
+		bool saveCache(const Path& path, bool halfPrecision = false) const;
+
+		/** Creates a VectorField resource holding the same values, for use by the GPU particle simulation. */
+		HVectorField createResource() const;
+
+		/** Returns the number of values along the X axis. */
+		UINT32 getCountX() const { return mCountX; }
+
+		/** Returns the number of values along the Y axis. */
+		UINT32 getCountY() const { return mCountY; }
+
+		/** Returns the number of values along the Z axis. */
+		UINT32 getCountZ() const { return mCountZ; }
+
+		/** Returns the area the vector field spans, in the vector field's local space. */
+		const AABox& getBounds() const { return mBounds; }
+
+		/** Returns the X components of all the values. */
+		const Vector<float>& getValuesX() const { return mValuesX; }
+
+		/** Returns the Y components of all the values. */
+		const Vector<float>& getValuesY() const { return mValuesY; }
+
+		/** Returns the Z components of all the values. */
+		const Vector<float>& getValuesZ() const { return mValuesZ; }
+
+		/**
+		 * Samples the vector field at the provided position, in the vector field's local space. Positions outside the bounds
+		 * either repeat the vector field if tiling is enabled for that axis, or use the value at the edge otherwise.
+		 */
+		Vector3 sample(const Vector3& position, bool tileX = false, bool tileY = false, bool tileZ = false) const;
+
+	private:
+		UINT32 mCountX = 0;
+		UINT32 mCountY = 0;
+		UINT32 mCountZ = 0;
+		AABox mBounds;
+
+		Vector<float> mValuesX;
+		Vector<float> mValuesY;
+		Vector<float> mValuesZ;
+	};
+}
\ No newline at end of file
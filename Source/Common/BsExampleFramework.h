@@ -5,6 +5,9 @@
 #include "Resources/BsResources.h"
 #include "Resources/BsResourceManifest.h"
 #include "Mesh/BsMesh.h"
+#include "Mesh/BsMeshData.h"
+#include "RenderAPI/BsVertexDataDesc.h"
+#include "Physics/BsPhysicsMesh.h"
 #include "Importer/BsImporter.h"
 #include "Importer/BsMeshImportOptions.h"
 #include "Importer/BsTextureImportOptions.h"
@@ -22,6 +25,22 @@ namespace bs
 		Cerberus
 	};
 
+	/** Types of physics meshes that can be generated for the example mesh assets. */
+	enum class ExampleCollisionMesh
+	{
+		/** No physics mesh is generated. */
+		None,
+		/** A single convex hull enclosing the entire mesh. Can be used with dynamic rigidbodies. */
+		ConvexHull,
+		/** 
+		 * A separate convex hull for every sub-mesh, approximating concave meshes better than a single hull. Can be used
+		 * with dynamic rigidbodies, by attaching a mesh collider per hull. 
+		 */
+		ConvexDecomposition,
+		/** The mesh triangles used as-is. Can only be used for static or kinematic objects. */
+		TriangleMesh
+	};
+
 	/** A list of texture assets provided with the example projects. */
 	enum class ExampleTexture
 	{
@@ -135,8 +154,14 @@ namespace bs
 		 * 
 		 * Use the 'scale' parameter to control the size of the mesh. Note this option is only relevant when a mesh is
 		 * being imported (i.e. when the asset file is missing).
+		 *
+		 * Optionally a physics mesh can be generated for the mesh, as specified by 'collisionType', and returned in
+		 * 'collisionMeshes'. Physics meshes are cooked when first generated and saved next to the mesh asset, so following
+		 * runs only need to load them. Same as the mesh, the physics meshes are only re-generated if their asset files are
+		 * missing.
 		 */
-		static HMesh loadMesh(ExampleMesh type, float scale = 1.0f)
+		static HMesh loadMesh(ExampleMesh type, float scale = 1.0f, 
+			ExampleCollisionMesh collisionType = ExampleCollisionMesh::None, Vector<HPhysicsMesh>* collisionMeshes = nullptr)
 		{
 			// Map from the enum to the actual file path
 			static Path assetPaths[] =
@@ -177,6 +202,9 @@ namespace bs
 					manifest->registerResource(model.getUUID(), assetPath);
 			}
 
+			if(collisionType != ExampleCollisionMesh::None && collisionMeshes != nullptr)
+				*collisionMeshes = loadCollisionMesh(srcAssetPath, collisionType, scale);
+
 			return model;
 		}
 
@@ -416,6 +444,131 @@ namespace bs
 
 
 	private:
+		/** 
+		 * Loads previously cooked physics meshes for the mesh at the provided source path. If they don't exist, the mesh
+		 * is re-imported and the physics meshes are cooked and saved. @see loadMesh.
+		 */
+		static Vector<HPhysicsMesh> loadCollisionMesh(const Path& srcAssetPath, ExampleCollisionMesh type, float scale)
+		{
+			static const char* suffixes[] = { "", ".convex", ".convexparts", ".trimesh" };
+
+			// Returns the path of the asset in which to store the physics mesh with the provided index
+			auto getAssetPath = [&srcAssetPath, type](UINT32 idx)
+			{
+				String extension = srcAssetPath.getExtension() + suffixes[(UINT32)type];
+				if(type == ExampleCollisionMesh::ConvexDecomposition)
+					extension += toString(idx);
+
+				Path assetPath = srcAssetPath;
+				assetPath.setExtension(extension + ".asset");
+
+				return assetPath;
+			};
+
+			// Attempt to load the previously cooked meshes
+			Vector<HPhysicsMesh> output;
+			while(true)
+			{
+				const Path assetPath = getAssetPath((UINT32)output.size());
+				if(!FileSystem::exists(assetPath))
+					break;
+
+				HPhysicsMesh physicsMesh = gResources().load<PhysicsMesh>(assetPath);
+				if(physicsMesh == nullptr)
+					break;
+
+				output.push_back(physicsMesh);
+
+				// Only the decomposition has more than one part
+				if(type != ExampleCollisionMesh::ConvexDecomposition)
+					break;
+			}
+
+			if(!output.empty())
+				return output;
+
+			// Cooked meshes don't exist, re-import the mesh keeping a copy of its data on the CPU, using the same scale as
+			// the mesh itself
+			SPtr<ImportOptions> meshImportOptions = Importer::instance().createImportOptions(srcAssetPath);
+			if (rtti_is_of_type<MeshImportOptions>(meshImportOptions))
+			{
+				MeshImportOptions* importOptions = static_cast<MeshImportOptions*>(meshImportOptions.get());
+
+				importOptions->setImportScale(scale);
+				importOptions->setCPUCached(true);
+			}
+
+			HMesh mesh = gImporter().import<Mesh>(srcAssetPath, meshImportOptions);
+			if(mesh == nullptr)
+				return output;
+
+			SPtr<MeshData> meshData = mesh->getCachedData();
+			const MeshProperties& meshProps = mesh->getProperties();
+
+			switch(type)
+			{
+			case ExampleCollisionMesh::ConvexHull:
+				output.push_back(PhysicsMesh::create(meshData, PhysicsMeshType::Convex));
+				break;
+			case ExampleCollisionMesh::TriangleMesh:
+				output.push_back(PhysicsMesh::create(meshData, PhysicsMeshType::Triangle));
+				break;
+			case ExampleCollisionMesh::ConvexDecomposition:
+			{
+				// Hull every sub-mesh separately. Only the positions of the vertices referenced by a sub-mesh are needed.
+				SPtr<VertexDataDesc> vertexDesc = VertexDataDesc::create();
+				vertexDesc->addVertElem(VET_FLOAT3, VES_POSITION);
+
+				VertexElemIter<Vector3> srcPositions = meshData->getVec3DataIter(VES_POSITION);
+				const bool is32bit = meshData->getIndexType() == IT_32BIT;
+
+				for(UINT32 i = 0; i < meshProps.getNumSubMeshes(); i++)
+				{
+					const SubMesh& subMesh = meshProps.getSubMesh(i);
+					if(subMesh.indexCount == 0)
+						continue;
+
+					Vector<Vector3> positions;
+					positions.reserve(subMesh.indexCount);
+
+					for(UINT32 j = 0; j < subMesh.indexCount; j++)
+					{
+						const UINT32 idx = subMesh.indexOffset + j;
+						const UINT32 vertIdx = is32bit ? meshData->getIndices32()[idx] : meshData->getIndices16()[idx];
+
+						positions.push_back(srcPositions.getAt(vertIdx));
+					}
+
+					// Hulls don't need the triangles, so simply use every referenced vertex as a separate triangle corner
+					SPtr<MeshData> partData = MeshData::create((UINT32)positions.size(), (UINT32)positions.size(), 
+						vertexDesc);
+					partData->setVertexData(VES_POSITION, positions.data(), (UINT32)(positions.size() * sizeof(Vector3)));
+
+					UINT32* indices = partData->getIndices32();
+					for(UINT32 j = 0; j < (UINT32)positions.size(); j++)
+						indices[j] = j;
+
+					output.push_back(PhysicsMesh::create(partData, PhysicsMeshType::Convex));
+				}
+			}
+				break;
+			default:
+				break;
+			}
+
+			// Save the cooked meshes so following runs only need to load them
+			for(UINT32 i = 0; i < (UINT32)output.size(); i++)
+			{
+				const Path assetPath = getAssetPath(i);
+				gResources().save(output[i], assetPath, true);
+
+				if(manifest)
+					manifest->registerResource(output[i].getUUID(), assetPath);
+			}
+
+			return output;
+		}
+
 		static SPtr<ResourceManifest> manifest;
 	};
 
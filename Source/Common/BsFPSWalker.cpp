@@ -39,14 +39,60 @@ namespace bs
 		mFastMove = VirtualButton("FastMove");
 	}
 
+	void FPSWalker::setStepper(const HPhysicsStepper& stepper)
+	{
+		mStepConn.disconnect();
+		mUseStepper = false;
+
+		if(stepper)
+		{
+			mStepConn = stepper->onPreStep.connect([this](UINT32 stepIdx, float stepSize) { move(stepSize); });
+			mUseStepper = true;
+		}
+	}
+
 	void FPSWalker::fixedUpdate()
+	{
+		// Movement is triggered by the stepper instead, if one is used
+		if(mUseStepper)
+			return;
+
+		move(gTime().getFixedFrameDelta());
+	}
+
+	void FPSWalker::onDestroyed()
+	{
+		mStepConn.disconnect();
+	}
+
+	FPSWalkerInputFlags FPSWalker::readInput() const
+	{
+		FPSWalkerInputFlags input;
+		if (gVirtualInput().isButtonHeld(mMoveForward)) input |= FPSWalkerInput::Forward;
+		if (gVirtualInput().isButtonHeld(mMoveBack)) input |= FPSWalkerInput::Back;
+		if (gVirtualInput().isButtonHeld(mMoveLeft)) input |= FPSWalkerInput::Left;
+		if (gVirtualInput().isButtonHeld(mMoveRight)) input |= FPSWalkerInput::Right;
+		if (gVirtualInput().isButtonHeld(mFastMove)) input |= FPSWalkerInput::FastMove;
+
+		return input;
+	}
+
+	void FPSWalker::setInputOverride(bool enable, FPSWalkerInputFlags input)
+	{
+		mUseInputOverride = enable;
+		mInputOverride = input;
+	}
+
+	void FPSWalker::move(float frameDelta)
 	{
 		// Check if any movement keys are being held
-		bool goingForward = gVirtualInput().isButtonHeld(mMoveForward);
-		bool goingBack = gVirtualInput().isButtonHeld(mMoveBack);
-		bool goingLeft = gVirtualInput().isButtonHeld(mMoveLeft);
-		bool goingRight = gVirtualInput().isButtonHeld(mMoveRight);
-		bool fastMove = gVirtualInput().isButtonHeld(mFastMove);
+		const FPSWalkerInputFlags input = mUseInputOverride ? mInputOverride : readInput();
+
+		bool goingForward = input.isSet(FPSWalkerInput::Forward);
+		bool goingBack = input.isSet(FPSWalkerInput::Back);
+		bool goingLeft = input.isSet(FPSWalkerInput::Left);
+		bool goingRight = input.isSet(FPSWalkerInput::Right);
+		bool fastMove = input.isSet(FPSWalkerInput::FastMove);
 
 		const Transform& tfrm = SO()->getTransform();
 
@@ -61,8 +107,6 @@ namespace bs
 		direction.y = 0.0f;
 		direction.normalize();
 
-		const float frameDelta = gTime().getFixedFrameDelta();
-
 		// If a direction is chosen, normalize it to determine final direction.
 		if (direction.squaredLength() != 0)
 		{
@@ -3,9 +3,23 @@
 #include "BsPrerequisites.h"
 #include "Scene/BsComponent.h"
 #include "Input/BsVirtualInput.h"
+#include "BsPhysicsStepper.h"
 
 namespace bs
 {
+	/** Movement buttons that can be held while controlling an FPSWalker. */
+	enum class FPSWalkerInput
+	{
+		Forward = 1 << 0,
+		Back = 1 << 1,
+		Left = 1 << 2,
+		Right = 1 << 3,
+		FastMove = 1 << 4
+	};
+
+	typedef Flags<FPSWalkerInput> FPSWalkerInputFlags;
+	BS_FLAGS_OPERATORS(FPSWalkerInput)
+
 	/** 
 	 * Component that controls movement through a character controller, used for first-person movement. The 
 	 * CharacterController component must be attached to the same SceneObject this component is on.
@@ -15,11 +29,36 @@ namespace bs
 	public:
 		FPSWalker(const HSceneObject& parent);
 
+		/**
+		 * Makes the walker move in sync with the provided physics stepper, using its step size, instead of on the engine's
+		 * fixed update.
+		 */
+		void setStepper(const HPhysicsStepper& stepper);
+
+		/** Returns the movement buttons currently held by the user. */
+		FPSWalkerInputFlags readInput() const;
+
+		/** 
+		 * Makes the walker use the provided input instead of reading it from the user, until disabled. Used for replaying
+		 * recorded input.
+		 */
+		void setInputOverride(bool enable, FPSWalkerInputFlags input = FPSWalkerInputFlags());
+
 		/** Triggered once per frame. Allows the component to handle input and move. */
 		void fixedUpdate() override;
 
+		/** @copydoc Component::onDestroyed */
+		void onDestroyed() override;
+
 	private:
+		/** Handles input and moves the character controller over the provided time step. */
+		void move(float frameDelta);
+
 		HCharacterController mController;
+		HEvent mStepConn; /**< Connection to the physics stepper, if one is used. */
+		bool mUseStepper = false; /**< True if movement is driven by a physics stepper instead of fixed update. */
+		bool mUseInputOverride = false; /**< True if mInputOverride should be used instead of user input. */
+		FPSWalkerInputFlags mInputOverride; /**< Input to use instead of user input, if enabled. */
 
 		float mCurrentSpeed = 0.0f; /**< Current speed of the camera. */
 
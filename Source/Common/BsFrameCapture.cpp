@@ -0,0 +1,387 @@
+#include "BsFrameCapture.h"
+#include "Image/BsTexture.h"
+#include "Image/BsPixelUtil.h"
+#include "RenderAPI/BsRenderAPI.h"
+#include "FileSystem/BsFileSystem.h"
+#include "FileSystem/BsDataStream.h"
+
+namespace bs { namespace ct
+{
+	/** Maximum number of bytes in a single stored (uncompressed) deflate block. */
+	constexpr UINT32 MAX_STORED_BLOCK_SIZE = 65535;
+
+	/** Modulus of the Adler-32 checksum sums. */
+	constexpr UINT32 ADLER_MODULUS = 65521;
+
+	/**
+	 * Largest number of bytes that can be added to the Adler-32 sums before they need to be reduced, without the second
+	 * sum overflowing 32 bits.
+	 */
+	constexpr UINT32 ADLER_MAX_UNREDUCED = 5552;
+
+	/** Table used for calculating the CRC-32 checksums of PNG chunks. */
+	struct PNGCRCTable
+	{
+		PNGCRCTable()
+		{
+			for(UINT32 i = 0; i < 256; i++)
+			{
+				UINT32 value = i;
+				for(UINT32 j = 0; j < 8; j++)
+					value = (value & 1) ? (0xEDB88320U ^ (value >> 1)) : (value >> 1);
+
+				values[i] = value;
+			}
+		}
+
+		UINT32 values[256];
+	};
+
+	/** Appends a 32-bit value to the output, in big endian order as PNG expects. */
+	void writePNGUInt32(Vector<UINT8>& output, UINT32 value)
+	{
+		output.push_back((UINT8)(value >> 24));
+		output.push_back((UINT8)(value >> 16));
+		output.push_back((UINT8)(value >> 8));
+		output.push_back((UINT8)value);
+	}
+
+	/** Appends a PNG chunk with the provided type and data to the output, followed by its checksum. */
+	void writePNGChunk(Vector<UINT8>& output, const char* type, const UINT8* data, UINT32 size)
+	{
+		writePNGUInt32(output, size);
+
+		const size_t start = output.size();
+		output.insert(output.end(), type, type + 4);
+		output.insert(output.end(), data, data + size);
+
+		static const PNGCRCTable crcTable;
+
+		UINT32 crc = 0xFFFFFFFFU;
+		for(size_t i = start; i < output.size(); i++)
+			crc = crcTable.values[(crc ^ output[i]) & 0xFF] ^ (crc >> 8);
+
+		writePNGUInt32(output, crc ^ 0xFFFFFFFFU);
+	}
+
+	/**
+	 * Encodes tightly packed RGBA8 pixels as a PNG image. The image data is stored using uncompressed deflate blocks, so
+	 * encoding costs little more than a copy, trading file size for keeping up with the frame rate.
+	 */
+	void encodeUncompressedPNG(const UINT8* pixels, UINT32 width, UINT32 height, Vector<UINT8>& output,
+		Vector<UINT8>& scratch)
+	{
+		static const UINT8 SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+		output.clear();
+		output.insert(output.end(), SIGNATURE, SIGNATURE + sizeof(SIGNATURE));
+
+		// Header: resolution, 8 bits per channel, RGBA, default compression & filtering, no interlacing
+		UINT8 header[13];
+		header[0] = (UINT8)(width >> 24); header[1] = (UINT8)(width >> 16);
+		header[2] = (UINT8)(width >> 8); header[3] = (UINT8)width;
+		header[4] = (UINT8)(height >> 24); header[5] = (UINT8)(height >> 16);
+		header[6] = (UINT8)(height >> 8); header[7] = (UINT8)height;
+		header[8] = 8;
+		header[9] = 6;
+		header[10] = 0;
+		header[11] = 0;
+		header[12] = 0;
+
+		writePNGChunk(output, "IHDR", header, sizeof(header));
+
+		// Image data, where every row starts with a filter type byte. No filtering is used.
+		const UINT32 rowSize = width * 4;
+		const UINT64 rawSize = (UINT64)(rowSize + 1) * height;
+		const UINT64 numBlocks = std::max((rawSize + MAX_STORED_BLOCK_SIZE - 1) / MAX_STORED_BLOCK_SIZE, (UINT64)1);
+
+		scratch.clear();
+		scratch.reserve((size_t)(2 + rawSize + numBlocks * 5 + 4));
+
+		// zlib header, with no preset dictionary and the fastest compression level
+		scratch.push_back(0x78);
+		scratch.push_back(0x01);
+
+		UINT32 adlerA = 1;
+		UINT32 adlerB = 0;
+		UINT32 blockRemaining = 0;
+		UINT64 rawRemaining = rawSize;
+
+		// Appends the bytes to the deflate stream, starting a new stored block whenever the current one is full
+		auto writeBytes = [&](const UINT8* data, UINT32 size)
+		{
+			while(size > 0)
+			{
+				if(blockRemaining == 0)
+				{
+					const UINT32 blockSize = (UINT32)std::min(rawRemaining, (UINT64)MAX_STORED_BLOCK_SIZE);
+					const bool isFinal = blockSize == rawRemaining;
+
+					scratch.push_back(isFinal ? 1 : 0);
+					scratch.push_back((UINT8)blockSize);
+					scratch.push_back((UINT8)(blockSize >> 8));
+					scratch.push_back((UINT8)~blockSize);
+					scratch.push_back((UINT8)(~blockSize >> 8));
+
+					blockRemaining = blockSize;
+				}
+
+				const UINT32 count = std::min(size, blockRemaining);
+				scratch.insert(scratch.end(), data, data + count);
+
+				// Only reduce the sums once every few thousand bytes, rather than after every byte
+				for(UINT32 start = 0; start < count; start += ADLER_MAX_UNREDUCED)
+				{
+					const UINT32 end = std::min(start + ADLER_MAX_UNREDUCED, count);
+					for(UINT32 i = start; i < end; i++)
+					{
+						adlerA += data[i];
+						adlerB += adlerA;
+					}
+
+					adlerA %= ADLER_MODULUS;
+					adlerB %= ADLER_MODULUS;
+				}
+
+				data += count;
+				size -= count;
+				blockRemaining -= count;
+				rawRemaining -= count;
+			}
+		};
+
+		const UINT8 filterType = 0;
+		for(UINT32 y = 0; y < height; y++)
+		{
+			writeBytes(&filterType, 1);
+			writeBytes(pixels + (size_t)y * rowSize, rowSize);
+		}
+
+		writePNGUInt32(scratch, (adlerB << 16) | adlerA);
+
+		writePNGChunk(output, "IDAT", scratch.data(), (UINT32)scratch.size());
+		writePNGChunk(output, "IEND", nullptr, 0);
+	}
+
+	FrameCapture::FrameCapture(const Path& folder, FrameCaptureFormat format, UINT32 numStagingTextures,
+		UINT32 maxQueuedWrites)
+		:mFolder(folder), mFormat(format), mMaxQueuedWrites(std::max(maxQueuedWrites, 1U))
+		, mStaging(std::max(numStagingTextures, 1U))
+	{
+		if(!FileSystem::exists(mFolder))
+			FileSystem::createDir(mFolder);
+
+		mWriterThread = Thread(std::bind(&FrameCapture::writerMain, this));
+	}
+
+	FrameCapture::~FrameCapture()
+	{
+		// Don't lose the frames still in flight. Reading them back waits on the GPU, and they are queued past the write
+		// limit since the writer thread only has to catch up once, both of which are fine at this point.
+		for(auto& entry : mStaging)
+		{
+			if(entry.inFlight)
+				readBack(entry, true);
+		}
+
+		{
+			Lock lock(mMutex);
+			mShutdown = true;
+		}
+
+		mSignal.notify_one();
+		mWriterThread.join();
+	}
+
+	void FrameCapture::capture(const SPtr<Texture>& texture, UINT64 frameIdx)
+	{
+		update();
+
+		// Staging textures are used in order, so if the next one is still in flight all of them are
+		StagingEntry& entry = mStaging[mNextStagingIdx];
+		if(entry.inFlight)
+		{
+			Lock lock(mMutex);
+			mStats.numFramesDropped++;
+
+			return;
+		}
+
+		const TextureProperties& props = texture->getProperties();
+
+		// (Re)create the staging texture if the captured texture changed size or format
+		bool createTexture = entry.texture == nullptr;
+		if(!createTexture)
+		{
+			const TextureProperties& stagingProps = entry.texture->getProperties();
+			createTexture = stagingProps.getWidth() != props.getWidth() ||
+				stagingProps.getHeight() != props.getHeight() || stagingProps.getFormat() != props.getFormat();
+		}
+
+		if(createTexture)
+		{
+			TEXTURE_DESC stagingDesc;
+			stagingDesc.type = TEX_TYPE_2D;
+			stagingDesc.width = props.getWidth();
+			stagingDesc.height = props.getHeight();
+			stagingDesc.format = props.getFormat();
+			stagingDesc.usage = TU_CPUREADABLE;
+
+			entry.texture = Texture::create(stagingDesc);
+		}
+
+		// Copy on a command buffer of our own, so we can tell when the copy finishes
+		mCommandBuffers.beginFrame();
+		entry.fence = mCommandBuffers.acquire();
+
+		texture->copy(entry.texture, TEXTURE_COPY_DESC::DEFAULT, entry.fence);
+		RenderAPI::instance().submitCommandBuffer(entry.fence);
+
+		entry.frameIdx = frameIdx;
+		entry.inFlight = true;
+
+		mNextStagingIdx = (mNextStagingIdx + 1) % (UINT32)mStaging.size();
+
+		Lock lock(mMutex);
+		mStats.numFramesCaptured++;
+	}
+
+	void FrameCapture::update()
+	{
+		// Read back in the order the captures were made, starting from the oldest one
+		for(UINT32 i = 0; i < (UINT32)mStaging.size(); i++)
+		{
+			StagingEntry& entry = mStaging[(mNextStagingIdx + i) % (UINT32)mStaging.size()];
+			if(entry.inFlight && entry.fence->getState() != CommandBufferState::Executing)
+				readBack(entry);
+		}
+	}
+
+	FrameCaptureStats FrameCapture::getStats() const
+	{
+		Lock lock(mMutex);
+		return mStats;
+	}
+
+	void FrameCapture::readBack(StagingEntry& entry, bool force)
+	{
+		entry.inFlight = false;
+		entry.fence = nullptr;
+
+		const TextureProperties& props = entry.texture->getProperties();
+
+		WriteJob job;
+		job.width = props.getWidth();
+		job.height = props.getHeight();
+		job.frameIdx = entry.frameIdx;
+
+		{
+			Lock lock(mMutex);
+			mStats.numFramesRead++;
+
+			if(!force && (UINT32)mQueuedWrites.size() >= mMaxQueuedWrites)
+			{
+				mStats.numWritesDropped++;
+				return;
+			}
+
+			// Reuse the memory of frames that were already saved
+			if(!mFreeBuffers.empty())
+			{
+				job.pixels = std::move(mFreeBuffers.back());
+				mFreeBuffers.pop_back();
+			}
+		}
+
+		job.pixels.resize((size_t)job.width * job.height * 4);
+
+		// Converts to RGBA8 and removes any row padding the staging texture has
+		PixelData dest(job.width, job.height, 1, PF_RGBA8);
+		dest.setExternalBuffer(job.pixels.data());
+
+		PixelData source = entry.texture->lock(GBL_READ_ONLY);
+		PixelUtil::bulkPixelConversion(source, dest);
+		entry.texture->unlock();
+
+		{
+			Lock lock(mMutex);
+			mQueuedWrites.push(std::move(job));
+		}
+
+		mSignal.notify_one();
+	}
+
+	void FrameCapture::writerMain()
+	{
+		Vector<UINT8> encoded;
+		Vector<UINT8> scratch;
+
+		while(true)
+		{
+			WriteJob job;
+
+			{
+				Lock lock(mMutex);
+				while(mQueuedWrites.empty() && !mShutdown)
+					mSignal.wait(lock);
+
+				// Finish saving the queued frames before shutting down
+				if(mQueuedWrites.empty())
+					break;
+
+				job = std::move(mQueuedWrites.front());
+				mQueuedWrites.pop();
+			}
+
+			const UINT8* data = job.pixels.data();
+			size_t size = job.pixels.size();
+
+			if(mFormat == FrameCaptureFormat::PNG)
+			{
+				encodeUncompressedPNG(job.pixels.data(), job.width, job.height, encoded, scratch);
+
+				data = encoded.data();
+				size = encoded.size();
+			}
+
+			const Path path = getFramePath(job.frameIdx, job.width, job.height);
+
+			SPtr<DataStream> stream = FileSystem::createAndOpenFile(path);
+			bool written = false;
+			if(stream)
+			{
+				written = stream->write(data, size) == size;
+				stream->close();
+			}
+
+			if(!written)
+				LOGWRN("Unable to save the captured frame: " + path.toString());
+
+			Lock lock(mMutex);
+			if(written)
+			{
+				mStats.numFramesWritten++;
+				mStats.numBytesWritten += size;
+			}
+
+			mFreeBuffers.push_back(std::move(job.pixels));
+		}
+	}
+
+	Path FrameCapture::getFramePath(UINT64 frameIdx, UINT32 width, UINT32 height) const
+	{
+		char name[64];
+		if(mFormat == FrameCaptureFormat::PNG)
+			snprintf(name, sizeof(name), "frame_%06llu.png", (unsigned long long)frameIdx);
+		else
+		{
+			snprintf(name, sizeof(name), "frame_%06llu_%ux%u.rgba", (unsigned long long)frameIdx, (unsigned)width,
+				(unsigned)height);
+		}
+
+		Path path = mFolder;
+		path.append(name);
+
+		return path;
+	}
+}}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "BsCommandBufferPool.h"
+
+namespace bs { namespace ct
+{
+	/** Formats the frames captured by FrameCapture can be saved in. */
+	enum class FrameCaptureFormat
+	{
+		/** Uncompressed 8-bit RGBA PNG. Readable by any image viewer, but the files are as large as raw ones. */
+		PNG,
+		/**
+		 * Tightly packed 8-bit RGBA pixels with no header, with the resolution in the file name. Fastest to write, and
+		 * can be fed to video encoders directly.
+		 */
+		Raw
+	};
+
+	/** Statistics about the frames handled by a FrameCapture. */
+	struct FrameCaptureStats
+	{
+		UINT32 numFramesCaptured = 0; /**< Number of frames copied to a staging texture. */
+		UINT32 numFramesRead = 0; /**< Number of frames read back to the CPU once their copy finished on the GPU. */
+		UINT32 numFramesWritten = 0; /**< Number of frames saved to the disk. */
+		UINT32 numFramesDropped = 0; /**< Number of frames not captured because all staging textures were in flight. */
+		UINT32 numWritesDropped = 0; /**< Number of frames read back but not saved because the writer fell behind. */
+		UINT64 numBytesWritten = 0; /**< Total size of the saved files, in bytes. */
+	};
+
+	/**
+	 * Captures the contents of a texture every frame and saves them to the disk, without stalling the GPU or the core
+	 * thread.
+	 *
+	 * Every capture copies the texture into one of a fixed number of CPU readable staging textures, on a command buffer
+	 * of its own. The command buffer acts as a fence: the staging texture is only read once it is done executing, which
+	 * is checked on every following capture, so the copy has a few frames to complete. The pixels read back are handed
+	 * to a background thread, which encodes and saves them. If all the staging textures are still in flight, or the
+	 * writer thread falls too far behind, frames are dropped rather than waited on, and counted in the statistics.
+	 *
+	 * Must only be used from the core thread.
+	 */
+	class FrameCapture
+	{
+	public:
+		/**
+		 * Creates a new capture and starts its writer thread.
+		 *
+		 * @param[in]	folder				Folder to save the frames to. Created if it doesn't exist.
+		 * @param[in]	format				Format to save the frames in.
+		 * @param[in]	numStagingTextures	Number of captures that can be in flight on the GPU at once.
+		 * @param[in]	maxQueuedWrites		Maximum number of frames read back but not yet saved, before new ones are
+		 *									dropped.
+		 */
+		FrameCapture(const Path& folder, FrameCaptureFormat format, UINT32 numStagingTextures = 3,
+			UINT32 maxQueuedWrites = 8);
+
+		/**
+		 * Reads back the frames still in flight, waits until all of them are saved and stops the writer thread. Frames
+		 * in flight are queued even if the writer queue is full, so none of them are dropped.
+		 */
+		~FrameCapture();
+
+		/**
+		 * Queues a copy of the texture's first mip level, which will be saved under the provided frame index. Any
+		 * commands that render to the texture must already be submitted. Also reads back any earlier captures that
+		 * have finished in the meantime.
+		 */
+		void capture(const SPtr<Texture>& texture, UINT64 frameIdx);
+
+		/** Reads back the earlier captures that have finished on the GPU, without starting a new one. */
+		void update();
+
+		/** Returns statistics about the captured frames. */
+		FrameCaptureStats getStats() const;
+
+	private:
+		/** Staging texture, along with the capture that's using it. */
+		struct StagingEntry
+		{
+			SPtr<Texture> texture;
+			SPtr<CommandBuffer> fence;
+			UINT64 frameIdx = 0;
+			bool inFlight = false;
+		};
+
+		/** Pixels read back from a staging texture, waiting to be saved. */
+		struct WriteJob
+		{
+			Vector<UINT8> pixels;
+			UINT32 width = 0;
+			UINT32 height = 0;
+			UINT64 frameIdx = 0;
+		};
+
+		/**
+		 * Copies the staging texture's contents to the writer queue, as tightly packed RGBA8. Waits on the GPU if the
+		 * copy into the staging texture hasn't finished yet. The frame is dropped if the writer queue is full, unless
+		 * @p force is true, in which case it is queued regardless.
+		 */
+		void readBack(StagingEntry& entry, bool force = false);
+
+		/** Encodes and saves the queued frames until the capture is destroyed. Runs on the writer thread. */
+		void writerMain();
+
+		/** Returns the path to save the frame with the provided index and resolution to. */
+		Path getFramePath(UINT64 frameIdx, UINT32 width, UINT32 height) const;
+
+		Path mFolder;
+		FrameCaptureFormat mFormat;
+		UINT32 mMaxQueuedWrites;
+
+		Vector<StagingEntry> mStaging;
+		UINT32 mNextStagingIdx = 0;
+		CommandBufferPool mCommandBuffers;
+
+		// Shared with the writer thread
+		mutable Mutex mMutex;
+		Signal mSignal;
+		Queue<WriteJob> mQueuedWrites;
+		Vector<Vector<UINT8>> mFreeBuffers;
+		FrameCaptureStats mStats;
+		bool mShutdown = false;
+
+		Thread mWriterThread;
+	};
+}}
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "BsGeometryStreamer.h"
+#include "RenderAPI/BsCommandBuffer.h"
+
+namespace bs { namespace ct
+{
+	GeometryStreamer::GeometryStreamer(UINT32 vertexSize, UINT32 numVertices, UINT32 numIndices, IndexType indexType)
+		:mIndexType(indexType)
+	{
+		mVertices.elementSize = vertexSize;
+		mIndices.elementSize = indexType == IT_16BIT ? sizeof(UINT16) : sizeof(UINT32);
+
+		createBuffer(mVertices, std::max(numVertices, 1U));
+		createBuffer(mIndices, std::max(numIndices, 1U));
+
+		// Allocations made before the first beginFrame() call belong to this frame
+		mFrames.push_back(Frame());
+	}
+
+	void GeometryStreamer::beginFrame()
+	{
+		mStats.numFrameVertices = 0;
+		mStats.numFrameIndices = 0;
+
+		Frame frame;
+		frame.vertexStart = mVertices.head;
+		frame.indexStart = mIndices.head;
+
+		mFrames.push_back(frame);
+		releaseFinishedFrames();
+	}
+
+	StreamedGeometry GeometryStreamer::lock(UINT32 numVertices, UINT32 numIndices)
+	{
+		assert(!mVerticesLocked && !mIndicesLocked);
+
+		StreamedGeometry output;
+		output.numVertices = numVertices;
+		output.numIndices = numIndices;
+
+		Frame& frame = mFrames.back();
+
+		// Allocations must fit in the buffers as a whole. Drawing the geometry already in the old buffers still works,
+		// as the frame keeps them alive until it finishes executing.
+		if(numVertices > mVertices.capacity)
+		{
+			frame.oldVertexBuffers.push_back(mVertices.vertexBuffer);
+			createBuffer(mVertices, std::max(numVertices, mVertices.capacity * 2));
+
+			mStats.numResizes++;
+		}
+
+		if(numIndices > mIndices.capacity)
+		{
+			frame.oldIndexBuffers.push_back(mIndices.indexBuffer);
+			createBuffer(mIndices, std::max(numIndices, mIndices.capacity * 2));
+
+			mStats.numResizes++;
+		}
+
+		// Try to fit in the space the GPU is done with, checking for frames that finished since the frame started if
+		// the allocation doesn't fit right away
+		const UINT64 oldVertexHead = mVertices.head;
+
+		bool vertexFits = tryAllocate(mVertices, numVertices, output.firstVertex);
+		bool indexFits = tryAllocate(mIndices, numIndices, output.firstIndex);
+
+		if(!vertexFits || !indexFits)
+		{
+			releaseFinishedFrames();
+
+			if(!vertexFits)
+				vertexFits = tryAllocate(mVertices, numVertices, output.firstVertex);
+
+			if(!indexFits)
+				indexFits = tryAllocate(mIndices, numIndices, output.firstIndex);
+		}
+
+		// If the GPU is still using the space, discard the buffer instead of waiting. The driver hands out fresh memory,
+		// while the draws already recorded keep using the old one. All of the buffer's space is free after that.
+		auto discard = [](Ring& ring, UINT32 count, UINT32& offset)
+		{
+			const UINT32 position = (UINT32)(ring.head % ring.capacity);
+			if(position > 0)
+				ring.head += ring.capacity - position;
+
+			ring.tail = ring.head;
+			ring.head += count;
+
+			offset = 0;
+		};
+
+		if(!vertexFits)
+			discard(mVertices, numVertices, output.firstVertex);
+
+		if(!indexFits)
+			discard(mIndices, numIndices, output.firstIndex);
+
+		if(!vertexFits || !indexFits)
+			mStats.numDiscards++;
+
+		if(output.firstVertex == 0 && oldVertexHead > 0 && numVertices > 0)
+			mStats.numWraps++;
+
+		if(numVertices > 0)
+		{
+			output.vertices = mVertices.vertexBuffer->lock(output.firstVertex * mVertices.elementSize,
+				numVertices * mVertices.elementSize,
+				vertexFits ? GBL_WRITE_ONLY_NO_OVERWRITE : GBL_WRITE_ONLY_DISCARD);
+		}
+
+		if(numIndices > 0)
+		{
+			output.indices = mIndices.indexBuffer->lock(output.firstIndex * mIndices.elementSize,
+				numIndices * mIndices.elementSize,
+				indexFits ? GBL_WRITE_ONLY_NO_OVERWRITE : GBL_WRITE_ONLY_DISCARD);
+		}
+
+		mStats.numVerticesStreamed += numVertices;
+		mStats.numIndicesStreamed += numIndices;
+		mStats.numFrameVertices += numVertices;
+		mStats.numFrameIndices += numIndices;
+
+		mVerticesLocked = numVertices > 0;
+		mIndicesLocked = numIndices > 0;
+
+		return output;
+	}
+
+	void GeometryStreamer::unlock()
+	{
+		if(mVerticesLocked)
+			mVertices.vertexBuffer->unlock();
+
+		if(mIndicesLocked)
+			mIndices.indexBuffer->unlock();
+
+		mVerticesLocked = false;
+		mIndicesLocked = false;
+	}
+
+	void GeometryStreamer::addFence(const SPtr<CommandBuffer>& commandBuffer)
+	{
+		Vector<SPtr<CommandBuffer>>& fences = mFrames.back().fences;
+		if(std::find(fences.begin(), fences.end(), commandBuffer) == fences.end())
+			fences.push_back(commandBuffer);
+	}
+
+	void GeometryStreamer::releaseFinishedFrames()
+	{
+		// The last frame is the current one, which may still get new allocations
+		while(mFrames.size() > 1 && !isInFlight(mFrames.front()))
+			mFrames.pop_front();
+
+		// A discard or a resize may have already freed more space than the oldest frame's start
+		const Frame& oldest = mFrames.front();
+		mVertices.tail = std::max(mVertices.tail, oldest.vertexStart);
+		mIndices.tail = std::max(mIndices.tail, oldest.indexStart);
+	}
+
+	bool GeometryStreamer::tryAllocate(Ring& ring, UINT32 count, UINT32& offset)
+	{
+		// Allocations are never split, so skip to the start of the buffer if there isn't enough space left at its end
+		UINT64 start = ring.head;
+
+		const UINT32 position = (UINT32)(start % ring.capacity);
+		if(position + count > ring.capacity)
+			start += ring.capacity - position;
+
+		if(start + count - ring.tail > ring.capacity)
+			return false;
+
+		offset = (UINT32)(start % ring.capacity);
+		ring.head = start + count;
+
+		return true;
+	}
+
+	void GeometryStreamer::createBuffer(Ring& ring, UINT32 capacity)
+	{
+		if(&ring == &mVertices)
+		{
+			VERTEX_BUFFER_DESC desc;
+			desc.vertexSize = ring.elementSize;
+			desc.numVerts = capacity;
+			desc.usage = GBU_DYNAMIC;
+
+			ring.vertexBuffer = VertexBuffer::create(desc);
+		}
+		else
+		{
+			INDEX_BUFFER_DESC desc;
+			desc.indexType = mIndexType;
+			desc.numIndices = capacity;
+			desc.usage = GBU_DYNAMIC;
+
+			ring.indexBuffer = IndexBuffer::create(desc);
+		}
+
+		// The new buffer is empty. Positions keep increasing, so the starts of older frames stay behind the tail.
+		ring.capacity = capacity;
+		ring.tail = ring.head;
+	}
+
+	bool GeometryStreamer::isInFlight(const Frame& frame)
+	{
+		for(auto& entry : frame.fences)
+		{
+			if(entry->getState() == CommandBufferState::Executing)
+				return true;
+		}
+
+		return false;
+	}
+}}
\ No newline at end of file
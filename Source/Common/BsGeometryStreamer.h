@@ -0,0 +1,138 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "RenderAPI/BsVertexBuffer.h"
+#include "RenderAPI/BsIndexBuffer.h"
+
+namespace bs { namespace ct
+{
+	/** Statistics about the geometry written through a GeometryStreamer. */
+	struct GeometryStreamerStats
+	{
+		UINT64 numVerticesStreamed = 0; /**< Total number of vertices written. */
+		UINT64 numIndicesStreamed = 0; /**< Total number of indices written. */
+		UINT32 numFrameVertices = 0; /**< Number of vertices written during the current frame. */
+		UINT32 numFrameIndices = 0; /**< Number of indices written during the current frame. */
+		UINT32 numWraps = 0; /**< Number of times writing wrapped around to the start of the buffers. */
+		UINT32 numDiscards = 0; /**< Number of wraps that had to discard the buffers, as the GPU was still using them. */
+		UINT32 numResizes = 0; /**< Number of times the buffers were recreated to fit a larger allocation. */
+	};
+
+	/** Location of geometry allocated from a GeometryStreamer, along with the memory to write it to. */
+	struct StreamedGeometry
+	{
+		void* vertices = nullptr; /**< Mapped memory to write the vertices to. Valid until unlock(). */
+		void* indices = nullptr; /**< Mapped memory to write the indices to, relative to the first vertex. */
+		UINT32 firstVertex = 0; /**< Offset to the first vertex, to provide as the vertex offset when drawing. */
+		UINT32 firstIndex = 0; /**< Offset to the first index, to provide as the start index when drawing. */
+		UINT32 numVertices = 0;
+		UINT32 numIndices = 0;
+	};
+
+	/**
+	 * Streams geometry that changes every frame, such as debug lines, trails or UI, through a single pair of dynamic
+	 * vertex & index buffers, without creating new buffers or having the driver rename them on every update.
+	 *
+	 * The buffers are used as rings. Every allocation is placed right after the previous one and locked with no-overwrite
+	 * semantics, promising the driver that the data the GPU may be reading is left alone. Every frame records where its
+	 * allocations start, along with the command buffers that draw them, which act as its fence. When an allocation
+	 * doesn't fit at the end of the buffers it wraps around to their start, which is only allowed once the frames that
+	 * used that space have finished executing. If they haven't, the buffers are locked with discard semantics instead,
+	 * letting the driver hand out fresh memory rather than waiting on the GPU.
+	 *
+	 * Must only be used from the core thread.
+	 */
+	class GeometryStreamer
+	{
+	public:
+		/**
+		 * Creates a new streamer.
+		 *
+		 * @param[in]	vertexSize		Size of a single vertex, in bytes.
+		 * @param[in]	numVertices		Number of vertices the vertex buffer can hold. Should fit a few frames worth of
+		 *								geometry, so the GPU can finish with a frame before its space is reused.
+		 * @param[in]	numIndices		Number of indices the index buffer can hold.
+		 * @param[in]	indexType		Type of the indices.
+		 */
+		GeometryStreamer(UINT32 vertexSize, UINT32 numVertices, UINT32 numIndices, IndexType indexType = IT_32BIT);
+
+		/** Starts a new frame, releasing the space used by the frames that have finished executing on the GPU. */
+		void beginFrame();
+
+		/**
+		 * Allocates space for the provided number of vertices & indices, and maps it for writing. Must be followed by a
+		 * call to unlock() before the geometry is drawn or another allocation is made.
+		 */
+		StreamedGeometry lock(UINT32 numVertices, UINT32 numIndices);
+
+		/** Unmaps the memory returned by the last lock() call. */
+		void unlock();
+
+		/**
+		 * Registers a command buffer that draws geometry allocated during the current frame. The space isn't reused until
+		 * the command buffer finishes executing. Should be called for every command buffer that references the geometry.
+		 */
+		void addFence(const SPtr<CommandBuffer>& commandBuffer);
+
+		/** Returns the vertex buffer the geometry is written to. Can change when an allocation requires a resize. */
+		const SPtr<VertexBuffer>& getVertexBuffer() const { return mVertices.vertexBuffer; }
+
+		/** Returns the index buffer the geometry is written to. Can change when an allocation requires a resize. */
+		const SPtr<IndexBuffer>& getIndexBuffer() const { return mIndices.indexBuffer; }
+
+		/** Returns statistics about the streamed geometry. */
+		const GeometryStreamerStats& getStats() const { return mStats; }
+
+	private:
+		/**
+		 * Write position in one of the buffers. Positions count elements written since the buffer was created, without
+		 * wrapping, so the distance between any two of them is the amount of data written in between.
+		 */
+		struct Ring
+		{
+			SPtr<VertexBuffer> vertexBuffer;
+			SPtr<IndexBuffer> indexBuffer;
+			UINT32 elementSize = 0;
+			UINT32 capacity = 0;
+			UINT64 head = 0; /**< Position the next allocation is made at. */
+			UINT64 tail = 0; /**< Start of the oldest allocation the GPU may still be using. */
+		};
+
+		/** Allocations made during a single frame, along with the command buffers that reference them. */
+		struct Frame
+		{
+			UINT64 vertexStart = 0;
+			UINT64 indexStart = 0;
+			Vector<SPtr<CommandBuffer>> fences;
+
+			/** Buffers replaced by a resize during the frame, kept alive until the frame finishes executing. */
+			Vector<SPtr<VertexBuffer>> oldVertexBuffers;
+			Vector<SPtr<IndexBuffer>> oldIndexBuffers;
+		};
+
+		/** Removes the frames that have finished executing, and moves the ring tails to the oldest remaining one. */
+		void releaseFinishedFrames();
+
+		/**
+		 * Finds the place for an allocation of the provided number of elements in the ring. Returns false if it
+		 * doesn't fit in the space the GPU is done with.
+		 */
+		static bool tryAllocate(Ring& ring, UINT32 count, UINT32& offset);
+
+		/** Creates the buffer of the ring, large enough for the provided number of elements. */
+		void createBuffer(Ring& ring, UINT32 capacity);
+
+		/** Checks is any command buffer referencing the frame's allocations still executing. */
+		static bool isInFlight(const Frame& frame);
+
+		Ring mVertices;
+		Ring mIndices;
+		IndexType mIndexType;
+
+		Deque<Frame> mFrames;
+		bool mVerticesLocked = false;
+		bool mIndicesLocked = false;
+
+		GeometryStreamerStats mStats;
+	};
+}}
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "BsGpuPipelineCache.h"
+#include "BsHash.h"
+#include "RenderAPI/BsGpuPipelineState.h"
+#include "FileSystem/BsFileSystem.h"
+#include "Serialization/BsFileSerializer.h"
+
+namespace bs { namespace ct
+{
+	/** Extension of the files the program bytecode is stored in. */
+	constexpr const char* BYTECODE_EXTENSION = ".bytecode";
+
+	GpuPipelineCache::GpuPipelineCache(const Path& cacheFolder)
+		:mCacheFolder(cacheFolder)
+	{
+		if(!mCacheFolder.isEmpty() && !FileSystem::exists(mCacheFolder))
+			FileSystem::createDir(mCacheFolder);
+	}
+
+	SPtr<GpuProgram> GpuPipelineCache::getProgram(const GPU_PROGRAM_DESC& desc)
+	{
+		const UINT64 hash = getProgramHash(desc);
+
+		Vector<ProgramEntry>& entries = mPrograms[hash];
+		for(auto& entry : entries)
+		{
+			if(isEqual(entry.desc, desc))
+			{
+				mStats.numProgramsReused++;
+				return entry.program;
+			}
+		}
+
+		GPU_PROGRAM_DESC programDesc = desc;
+		const Path bytecodePath = getBytecodePath(hash, desc.language);
+
+		// Use the bytecode saved by a previous run, if any. The render API falls back to compiling the source if the
+		// bytecode was produced by a different compiler.
+		if(!bytecodePath.isEmpty())
+			programDesc.bytecode = loadBytecode(bytecodePath);
+
+		if(programDesc.bytecode)
+			mStats.numProgramsLoaded++;
+		else
+		{
+			programDesc.bytecode = GpuProgram::compileBytecode(programDesc);
+			mStats.numProgramsCompiled++;
+
+			// Only save bytecode that compiled without errors, so a fixed source gets compiled again
+			if(programDesc.bytecode && programDesc.bytecode->instructions.data != nullptr && !bytecodePath.isEmpty())
+			{
+				FileEncoder encoder(bytecodePath);
+				encoder.encode(programDesc.bytecode.get());
+			}
+		}
+
+		ProgramEntry entry;
+		entry.desc = desc;
+		entry.program = GpuProgram::create(programDesc);
+
+		entries.push_back(entry);
+		return entry.program;
+	}
+
+	SPtr<GraphicsPipelineState> GpuPipelineCache::getGraphicsPipeline(const GRAPHICS_PIPELINE_DESC& desc)
+	{
+		UINT64 hash = 0;
+		bs_hash_combine(hash, BlendState::generateHash(desc.blendState));
+		bs_hash_combine(hash, DepthStencilState::generateHash(desc.depthStencilState));
+		bs_hash_combine(hash, RasterizerState::generateHash(desc.rasterizerState));
+		bs_hash_combine(hash, getProgramHash(desc.vertexProgram));
+		bs_hash_combine(hash, getProgramHash(desc.fragmentProgram));
+
+		Vector<PipelineEntry>& entries = mPipelines[hash];
+		for(auto& entry : entries)
+		{
+			if(isEqual(entry.desc, desc))
+			{
+				mStats.numPipelinesReused++;
+				return entry.pipeline;
+			}
+		}
+
+		// Render states are already shared by the render state manager, but the pipeline states that reference them
+		// are not, which is what this cache is for
+		PIPELINE_STATE_DESC pipelineDesc;
+		pipelineDesc.blendState = BlendState::create(desc.blendState);
+		pipelineDesc.depthStencilState = DepthStencilState::create(desc.depthStencilState);
+		pipelineDesc.rasterizerState = RasterizerState::create(desc.rasterizerState);
+		pipelineDesc.vertexProgram = getProgram(desc.vertexProgram);
+		pipelineDesc.fragmentProgram = getProgram(desc.fragmentProgram);
+
+		PipelineEntry entry;
+		entry.desc = desc;
+		entry.pipeline = GraphicsPipelineState::create(pipelineDesc);
+
+		mStats.numPipelinesCreated++;
+
+		entries.push_back(entry);
+		return entry.pipeline;
+	}
+
+	UINT64 GpuPipelineCache::getProgramHash(const GPU_PROGRAM_DESC& desc)
+	{
+		const UINT32 type = (UINT32)desc.type;
+		const UINT32 requiresAdjacency = desc.requiresAdjacency ? 1 : 0;
+
+		UINT64 hash = FNV_OFFSET_BASIS;
+		hash = hashFNV1a(hash, desc.source);
+		hash = hashFNV1a(hash, desc.entryPoint);
+		hash = hashFNV1a(hash, desc.language);
+		hash = hashFNV1a(hash, &type, sizeof(type));
+		hash = hashFNV1a(hash, &requiresAdjacency, sizeof(requiresAdjacency));
+
+		return hash;
+	}
+
+	Path GpuPipelineCache::getBytecodePath(UINT64 hash, const String& language) const
+	{
+		if(mCacheFolder.isEmpty())
+			return Path::BLANK;
+
+		char hashString[17];
+		snprintf(hashString, sizeof(hashString), "%016llx", (unsigned long long)hash);
+
+		Path path = mCacheFolder;
+		path.append(String(hashString) + "." + language + BYTECODE_EXTENSION);
+
+		return path;
+	}
+
+	SPtr<GpuProgramBytecode> GpuPipelineCache::loadBytecode(const Path& path) const
+	{
+		if(!FileSystem::isFile(path))
+			return nullptr;
+
+		FileDecoder decoder(path);
+		SPtr<IReflectable> object = decoder.decode();
+
+		if(object == nullptr || !rtti_is_of_type<GpuProgramBytecode>(object))
+		{
+			LOGWRN("Ignoring invalid program bytecode cache file: " + path.toString());
+			return nullptr;
+		}
+
+		return std::static_pointer_cast<GpuProgramBytecode>(object);
+	}
+
+	bool GpuPipelineCache::isEqual(const GPU_PROGRAM_DESC& a, const GPU_PROGRAM_DESC& b)
+	{
+		return a.type == b.type && a.requiresAdjacency == b.requiresAdjacency && a.language == b.language &&
+			a.entryPoint == b.entryPoint && a.source == b.source;
+	}
+
+	bool GpuPipelineCache::isEqual(const GRAPHICS_PIPELINE_DESC& a, const GRAPHICS_PIPELINE_DESC& b)
+	{
+		return a.blendState == b.blendState && a.depthStencilState == b.depthStencilState &&
+			a.rasterizerState == b.rasterizerState && isEqual(a.vertexProgram, b.vertexProgram) &&
+			isEqual(a.fragmentProgram, b.fragmentProgram);
+	}
+}}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "RenderAPI/BsGpuProgram.h"
+#include "RenderAPI/BsBlendState.h"
+#include "RenderAPI/BsDepthStencilState.h"
+#include "RenderAPI/BsRasterizerState.h"
+
+namespace bs { namespace ct
+{
+	/** Describes a graphics pipeline in terms of state descriptors and program sources, rather than objects. */
+	struct GRAPHICS_PIPELINE_DESC
+	{
+		BLEND_STATE_DESC blendState;
+		DEPTH_STENCIL_STATE_DESC depthStencilState;
+		RASTERIZER_STATE_DESC rasterizerState;
+		GPU_PROGRAM_DESC vertexProgram;
+		GPU_PROGRAM_DESC fragmentProgram;
+	};
+
+	/** Statistics about the objects requested from a GpuPipelineCache. */
+	struct GpuPipelineCacheStats
+	{
+		UINT32 numProgramsCompiled = 0; /**< Number of programs compiled from source. */
+		UINT32 numProgramsLoaded = 0; /**< Number of programs created from bytecode loaded from the disk cache. */
+		UINT32 numProgramsReused = 0; /**< Number of program requests that returned an already created program. */
+		UINT32 numPipelinesCreated = 0; /**< Number of pipeline states created. */
+		UINT32 numPipelinesReused = 0; /**< Number of pipeline requests that returned an already created pipeline. */
+	};
+
+	/**
+	 * Creates GPU programs and graphics pipeline states, reusing the ones that were already created for the same
+	 * descriptors.
+	 *
+	 * Programs are identified by a hash of their source, entry point, type and language. Their compiled bytecode is
+	 * saved in a cache folder on disk, with the hash and the language in the file name, so following runs create them
+	 * from the bytecode instead of compiling the source again. Pipeline states are identified by a hash of their state
+	 * descriptors and their programs, so identical descriptors always result in the same pipeline state object.
+	 */
+	class GpuPipelineCache
+	{
+	public:
+		/**
+		 * Creates a new cache.
+		 *
+		 * @param[in]	cacheFolder		Folder in which to save the compiled program bytecode. If empty, bytecode is not
+		 *								saved nor loaded, and programs are only reused while the cache exists.
+		 */
+		GpuPipelineCache(const Path& cacheFolder = Path::BLANK);
+
+		/** Returns a program created from the provided descriptor, compiling it only if it is not cached. */
+		SPtr<GpuProgram> getProgram(const GPU_PROGRAM_DESC& desc);
+
+		/** Returns a pipeline state created from the provided descriptor, creating it only if it is not cached. */
+		SPtr<GraphicsPipelineState> getGraphicsPipeline(const GRAPHICS_PIPELINE_DESC& desc);
+
+		/** Returns statistics about the objects requested from the cache. */
+		const GpuPipelineCacheStats& getStats() const { return mStats; }
+
+		/**
+		 * Calculates a hash of the program descriptor, from its source, entry point, type and language. The hash is the
+		 * same on every run and platform, so it can be used to identify the program on disk.
+		 */
+		static UINT64 getProgramHash(const GPU_PROGRAM_DESC& desc);
+
+	private:
+		/** Program created by the cache, along with the descriptor it was created from. */
+		struct ProgramEntry
+		{
+			GPU_PROGRAM_DESC desc;
+			SPtr<GpuProgram> program;
+		};
+
+		/** Pipeline created by the cache, along with the descriptor it was created from. */
+		struct PipelineEntry
+		{
+			GRAPHICS_PIPELINE_DESC desc;
+			SPtr<GraphicsPipelineState> pipeline;
+		};
+
+		/** Returns the path of the file the bytecode of the program with the provided hash & language is stored in. */
+		Path getBytecodePath(UINT64 hash, const String& language) const;
+
+		/** Loads previously saved program bytecode from the disk. Returns null if not found. */
+		SPtr<GpuProgramBytecode> loadBytecode(const Path& path) const;
+
+		/** Checks do the two program descriptors describe the same program. */
+		static bool isEqual(const GPU_PROGRAM_DESC& a, const GPU_PROGRAM_DESC& b);
+
+		/** Checks do the two pipeline descriptors describe the same pipeline. */
+		static bool isEqual(const GRAPHICS_PIPELINE_DESC& a, const GRAPHICS_PIPELINE_DESC& b);
+
+		Path mCacheFolder;
+
+		UnorderedMap<UINT64, Vector<ProgramEntry>> mPrograms;
+		UnorderedMap<UINT64, Vector<PipelineEntry>> mPipelines;
+
+		GpuPipelineCacheStats mStats;
+	};
+}}
\ No newline at end of file
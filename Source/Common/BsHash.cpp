@@ -0,0 +1,21 @@
+#include "BsHash.h"
+
+namespace bs
+{
+	UINT64 hashFNV1a(UINT64 hash, const void* data, UINT32 size)
+	{
+		const UINT8* bytes = (const UINT8*)data;
+		for(UINT32 i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= FNV_PRIME;
+		}
+
+		return hash;
+	}
+
+	UINT64 hashFNV1a(UINT64 hash, const String& value)
+	{
+		return hashFNV1a(hash, value.c_str(), (UINT32)value.size() + 1);
+	}
+}
\ No newline at end of file
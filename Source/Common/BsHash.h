@@ -0,0 +1,22 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+
+namespace bs
+{
+	/** Offset basis of the 64-bit FNV-1a hash. Used as the initial value of the hash. */
+	constexpr UINT64 FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+
+	/** Prime of the 64-bit FNV-1a hash. */
+	constexpr UINT64 FNV_PRIME = 0x100000001b3ULL;
+
+	/**
+	 * Continues calculating a 64-bit FNV-1a hash over the provided data, and returns the new hash. Start with
+	 * FNV_OFFSET_BASIS. Unlike std::hash, the result doesn't depend on the standard library implementation, so it can be
+	 * saved and compared between runs.
+	 */
+	UINT64 hashFNV1a(UINT64 hash, const void* data, UINT32 size);
+
+	/** Continues calculating a 64-bit FNV-1a hash over the provided string, including its terminator. */
+	UINT64 hashFNV1a(UINT64 hash, const String& value);
+}
\ No newline at end of file
@@ -0,0 +1,707 @@
+#include "BsInstancedParticleRenderer.h"
+#include "BsBenchmarkLog.h"
+#include "BsParticleSimulator.h"
+#include "Scene/BsSceneObject.h"
+#include "Components/BsCCamera.h"
+#include "CoreThread/BsCoreThread.h"
+#include "Renderer/BsCamera.h"
+#include "RenderAPI/BsRenderAPI.h"
+#include "RenderAPI/BsGpuProgram.h"
+#include "RenderAPI/BsGpuParams.h"
+#include "RenderAPI/BsGpuPipelineState.h"
+#include "RenderAPI/BsDepthStencilState.h"
+#include "RenderAPI/BsGpuParamBlockBuffer.h"
+#include "RenderAPI/BsVertexBuffer.h"
+#include "RenderAPI/BsIndexBuffer.h"
+#include "RenderAPI/BsVertexDataDesc.h"
+#include "Utility/BsTimer.h"
+#include "Utility/BsTime.h"
+#include "BsEngineConfig.h"
+
+namespace bs
+{
+	/** Number of floats stored per particle in the instance buffers: position and size, followed by the color. */
+	constexpr UINT32 FLOATS_PER_INSTANCE = 8;
+
+	InstancedParticleRenderer::InstancedParticleRenderer(const HSceneObject& parent,
+		const INSTANCED_PARTICLE_RENDERER_DESC& desc)
+		:Component(parent), mDesc(desc)
+	{
+		// Set a name for the component, so we can find it later if needed
+		setName("InstancedParticleRenderer");
+	}
+
+	void InstancedParticleRenderer::onInitialized()
+	{
+		mExtension = RendererExtension::create<ct::InstancedParticleRendererExtension>(mDesc);
+	}
+
+	void InstancedParticleRenderer::update()
+	{
+		if(!mSimulator || !mCamera || !mExtension)
+			return;
+
+		const Vector3 cameraPos = mCamera->SO()->getTransform().getPosition();
+
+		// Advance the simulation first, so the particles packed below are the ones from this frame, regardless of the
+		// order the components are updated in
+		if(mDesc.simulate)
+		{
+			Timer simulateTimer;
+			mSimulator->simulate(gTime().getFrameDelta(), cameraPos);
+
+			mStats.simulateTime = simulateTimer.getMicroseconds() / 1000.0f;
+		}
+
+		Timer timer;
+
+		const float impostorDistance2 = mDesc.impostorDistance * mDesc.impostorDistance;
+
+		SPtr<InstancedParticleData> meshData = mMeshData->acquire();
+		SPtr<InstancedParticleData> impostorData = mImpostorData->acquire();
+
+		// Any particle can end up in either buffer, so both need to be able to hold all of them. The buffers only ever
+		// grow, so they stop allocating once they reach the peak particle count.
+		UINT32 numParticles = 0;
+		for(UINT32 i = 0; i < mSimulator->getNumSystems(); i++)
+			numParticles += mSimulator->getSystem(i).particles.getCount();
+
+		for(auto* data : { meshData.get(), impostorData.get() })
+		{
+			if(data->instances.size() < numParticles * FLOATS_PER_INSTANCE)
+				data->instances.resize(numParticles * FLOATS_PER_INSTANCE);
+		}
+
+		// Pack the particles of all the systems, picking the representation based on their distance to the camera
+		float* meshInstances = meshData->instances.data();
+		float* impostorInstances = impostorData->instances.data();
+
+		UINT32 numMesh = 0;
+		UINT32 numImpostor = 0;
+		for(UINT32 i = 0; i < mSimulator->getNumSystems(); i++)
+		{
+			const SimdParticles& particles = mSimulator->getSystem(i).particles;
+			for(UINT32 j = 0; j < particles.getCount(); j++)
+			{
+				const Vector3 position(particles.positionX[j], particles.positionY[j], particles.positionZ[j]);
+
+				float* dst;
+				if(position.squaredDistance(cameraPos) > impostorDistance2)
+					dst = impostorInstances + (numImpostor++) * FLOATS_PER_INSTANCE;
+				else
+					dst = meshInstances + (numMesh++) * FLOATS_PER_INSTANCE;
+
+				dst[0] = position.x;
+				dst[1] = position.y;
+				dst[2] = position.z;
+				dst[3] = particles.size[j];
+				dst[4] = particles.colorR[j];
+				dst[5] = particles.colorG[j];
+				dst[6] = particles.colorB[j];
+				dst[7] = particles.colorA[j];
+			}
+		}
+
+		meshData->numInstances = numMesh;
+		impostorData->numInstances = numImpostor;
+
+		// Hand the data back once it has been uploaded. The pools are kept alive by the command, in case the component
+		// is destroyed before it executes.
+		ct::InstancedParticleRendererExtension* extension = mExtension.get();
+		SPtr<InstancedParticleDataPool> meshPool = mMeshData;
+		SPtr<InstancedParticleDataPool> impostorPool = mImpostorData;
+
+		gCoreThread().queueCommand([extension, meshPool, impostorPool, meshData, impostorData]()
+		{
+			extension->setInstances(meshData, impostorData);
+
+			meshPool->release(meshData);
+			impostorPool->release(impostorData);
+		});
+
+		mStats.numMeshInstances = numMesh;
+		mStats.numImpostorInstances = numImpostor;
+		mStats.numDrawCalls = (numMesh > 0 ? 1 : 0) + (numImpostor > 0 ? 1 : 0);
+		mStats.packTime = timer.getMicroseconds() / 1000.0f;
+
+		if(mLog)
+		{
+			mLog->record("meshInstances", mStats.numMeshInstances);
+			mLog->record("impostorInstances", mStats.numImpostorInstances);
+			mLog->record("drawCalls", mStats.numDrawCalls);
+			mLog->record("packMs", mStats.packTime);
+
+			if(mDesc.simulate)
+				mLog->record("simulateMs", mStats.simulateTime);
+		}
+	}
+
+	void InstancedParticleRenderer::onDestroyed()
+	{
+		mExtension = nullptr;
+	}
+
+	SPtr<InstancedParticleData> InstancedParticleDataPool::acquire()
+	{
+		{
+			Lock lock(mMutex);
+			if(!mFree.empty())
+			{
+				SPtr<InstancedParticleData> data = mFree.back();
+				mFree.pop_back();
+
+				return data;
+			}
+		}
+
+		return bs_shared_ptr_new<InstancedParticleData>();
+	}
+
+	void InstancedParticleDataPool::release(const SPtr<InstancedParticleData>& data)
+	{
+		Lock lock(mMutex);
+		mFree.push_back(data);
+	}
+
+	namespace ct
+	{
+		/** Uniform block used by the instanced particle GPU programs. */
+		struct InstancedParticleParamBlock
+		{
+			Matrix4 gMatViewProj;
+			Vector4 gCameraRight;
+			Vector4 gCameraUp;
+			Vector4 gCameraBack; /**< Direction from the scene towards the camera. */
+			Vector4 gLightDir;
+			Color gLightColor;
+			Color gAmbientColor;
+			Vector4 gImpostor; /**< X is one when drawing impostors, and zero when drawing the sphere mesh. */
+		};
+
+		const char* getInstancedParticleVertexSource(bool hlsl, bool vksl);
+		const char* getInstancedParticleFragmentSource(bool hlsl, bool vksl);
+
+		InstancedParticleRendererExtension::InstancedParticleRendererExtension()
+			:RendererExtension(RenderLocation::PostLightPass, 0)
+		{ }
+
+		void InstancedParticleRendererExtension::initialize(const Any& data)
+		{
+			mDesc = any_cast<INSTANCED_PARTICLE_RENDERER_DESC>(data);
+
+			// Determine which shading language to use (depending on the RenderAPI chosen during build)
+			mUseHLSL = strcmp(BS_RENDER_API_MODULE, "bsfD3D11RenderAPI") == 0;
+			const bool useVKSL = strcmp(BS_RENDER_API_MODULE, "bsfVulkanRenderAPI") == 0;
+			const char* language = mUseHLSL ? "hlsl" : useVKSL ? "vksl" : "glsl4_1";
+
+			// Create the GPU programs and the pipeline state. Particles are opaque, so they are depth tested and written
+			// like any other opaque geometry.
+			GPU_PROGRAM_DESC vertProgDesc;
+			vertProgDesc.type = GPT_VERTEX_PROGRAM;
+			vertProgDesc.entryPoint = "main";
+			vertProgDesc.language = language;
+			vertProgDesc.source = getInstancedParticleVertexSource(mUseHLSL, useVKSL);
+
+			GPU_PROGRAM_DESC fragProgDesc;
+			fragProgDesc.type = GPT_FRAGMENT_PROGRAM;
+			fragProgDesc.entryPoint = "main";
+			fragProgDesc.language = language;
+			fragProgDesc.source = getInstancedParticleFragmentSource(mUseHLSL, useVKSL);
+
+			DEPTH_STENCIL_STATE_DESC depthStencilDesc;
+			depthStencilDesc.depthReadEnable = true;
+			depthStencilDesc.depthWriteEnable = true;
+
+			PIPELINE_STATE_DESC pipelineDesc;
+			pipelineDesc.depthStencilState = DepthStencilState::create(depthStencilDesc);
+			pipelineDesc.vertexProgram = GpuProgram::create(vertProgDesc);
+			pipelineDesc.fragmentProgram = GpuProgram::create(fragProgDesc);
+
+			mPipelineState = GraphicsPipelineState::create(pipelineDesc);
+
+			// The mesh vertices are read from the first stream, and the per-particle data from the second one, advancing
+			// once per instance
+			SPtr<VertexDataDesc> vertexDesc = VertexDataDesc::create();
+			vertexDesc->addVertElem(VET_FLOAT3, VES_POSITION, 0, 0);
+			vertexDesc->addVertElem(VET_FLOAT4, VES_TEXCOORD, 0, 1, 1);
+			vertexDesc->addVertElem(VET_FLOAT4, VES_COLOR, 0, 1, 1);
+
+			mVertexDecl = VertexDeclaration::create(vertexDesc);
+			mInstanceStride = vertexDesc->getVertexStride(1);
+
+			// Create a unit sphere. Its positions double as the normals.
+			const UINT32 numSegments = std::max(mDesc.sphereSegments, 4U);
+			const UINT32 numRings = numSegments / 2;
+
+			mNumSphereVertices = (numRings + 1) * (numSegments + 1);
+			mNumSphereIndices = numRings * numSegments * 6;
+
+			VERTEX_BUFFER_DESC sphereVBDesc;
+			sphereVBDesc.numVerts = mNumSphereVertices;
+			sphereVBDesc.vertexSize = vertexDesc->getVertexStride(0);
+
+			mSphereVertices = VertexBuffer::create(sphereVBDesc);
+
+			Vector3* sphereVertices = (Vector3*)mSphereVertices->lock(0, mNumSphereVertices * sizeof(Vector3),
+				GBL_WRITE_ONLY_DISCARD);
+
+			for(UINT32 ring = 0; ring <= numRings; ring++)
+			{
+				const Radian theta(Math::PI * ring / numRings);
+				for(UINT32 segment = 0; segment <= numSegments; segment++)
+				{
+					const Radian phi(Math::TWO_PI * segment / numSegments);
+
+					*sphereVertices++ = Vector3(Math::sin(theta) * Math::cos(phi), Math::cos(theta),
+						Math::sin(theta) * Math::sin(phi));
+				}
+			}
+
+			mSphereVertices->unlock();
+
+			// Fall back to 32-bit indices once the vertices can no longer be addressed using 16 bits
+			const bool use32BitIndices = mNumSphereVertices > std::numeric_limits<UINT16>::max();
+			const UINT32 indexSize = use32BitIndices ? sizeof(UINT32) : sizeof(UINT16);
+
+			INDEX_BUFFER_DESC sphereIBDesc;
+			sphereIBDesc.numIndices = mNumSphereIndices;
+			sphereIBDesc.indexType = use32BitIndices ? IT_32BIT : IT_16BIT;
+
+			mSphereIndices = IndexBuffer::create(sphereIBDesc);
+
+			UINT8* sphereIndices = (UINT8*)mSphereIndices->lock(0, mNumSphereIndices * indexSize,
+				GBL_WRITE_ONLY_DISCARD);
+			auto writeIndex = [&sphereIndices, use32BitIndices, indexSize](UINT32 index)
+			{
+				if(use32BitIndices)
+					*(UINT32*)sphereIndices = index;
+				else
+					*(UINT16*)sphereIndices = (UINT16)index;
+
+				sphereIndices += indexSize;
+			};
+
+			for(UINT32 ring = 0; ring < numRings; ring++)
+			{
+				for(UINT32 segment = 0; segment < numSegments; segment++)
+				{
+					const UINT32 a = ring * (numSegments + 1) + segment;
+					const UINT32 b = a + 1;
+					const UINT32 c = a + numSegments + 1;
+					const UINT32 d = c + 1;
+
+					// Clockwise when viewed from the outside
+					writeIndex(a);
+					writeIndex(c);
+					writeIndex(b);
+					writeIndex(b);
+					writeIndex(c);
+					writeIndex(d);
+				}
+			}
+
+			mSphereIndices->unlock();
+
+			// Create a quad for the impostors. It is oriented towards the camera in the vertex program.
+			VERTEX_BUFFER_DESC quadVBDesc;
+			quadVBDesc.numVerts = 4;
+			quadVBDesc.vertexSize = vertexDesc->getVertexStride(0);
+
+			mQuadVertices = VertexBuffer::create(quadVBDesc);
+
+			const Vector3 quadVertices[] =
+			{
+				Vector3(-1.0f, -1.0f, 0.0f), Vector3(1.0f, -1.0f, 0.0f), Vector3(1.0f, 1.0f, 0.0f), Vector3(-1.0f, 1.0f, 0.0f)
+			};
+
+			mQuadVertices->writeData(0, sizeof(quadVertices), quadVertices, BWT_DISCARD);
+
+			INDEX_BUFFER_DESC quadIBDesc;
+			quadIBDesc.numIndices = 6;
+			quadIBDesc.indexType = IT_16BIT;
+
+			mQuadIndices = IndexBuffer::create(quadIBDesc);
+
+			const UINT16 quadIndices[] = { 2, 1, 0, 0, 3, 2 };
+			mQuadIndices->writeData(0, sizeof(quadIndices), quadIndices, BWT_DISCARD);
+
+			// Both draws use the same programs, with a flag in the uniform block telling them apart
+			mMeshParamBuffer = GpuParamBlockBuffer::create(sizeof(InstancedParticleParamBlock));
+			mImpostorParamBuffer = GpuParamBlockBuffer::create(sizeof(InstancedParticleParamBlock));
+
+			mMeshParams = GpuParams::create(mPipelineState);
+			mMeshParams->setParamBlockBuffer(GPT_VERTEX_PROGRAM, "Params", mMeshParamBuffer);
+			mMeshParams->setParamBlockBuffer(GPT_FRAGMENT_PROGRAM, "Params", mMeshParamBuffer);
+
+			mImpostorParams = GpuParams::create(mPipelineState);
+			mImpostorParams->setParamBlockBuffer(GPT_VERTEX_PROGRAM, "Params", mImpostorParamBuffer);
+			mImpostorParams->setParamBlockBuffer(GPT_FRAGMENT_PROGRAM, "Params", mImpostorParamBuffer);
+		}
+
+		void InstancedParticleRendererExtension::destroy()
+		{
+			mPipelineState = nullptr;
+			mVertexDecl = nullptr;
+			mSphereVertices = nullptr;
+			mSphereIndices = nullptr;
+			mQuadVertices = nullptr;
+			mQuadIndices = nullptr;
+			mMeshParamBuffer = nullptr;
+			mImpostorParamBuffer = nullptr;
+			mMeshParams = nullptr;
+			mImpostorParams = nullptr;
+			mMeshInstances = InstanceBuffer();
+			mImpostorInstances = InstanceBuffer();
+		}
+
+		RendererExtensionRequest InstancedParticleRendererExtension::check(const Camera& camera)
+		{
+			if(mMeshInstances.numInstances == 0 && mImpostorInstances.numInstances == 0)
+				return RendererExtensionRequest::DontRender;
+
+			return RendererExtensionRequest::RenderIfTargetValid;
+		}
+
+		void InstancedParticleRendererExtension::render(const Camera& camera, const RendererViewContext& viewContext)
+		{
+			Matrix4 viewProj = camera.getProjectionMatrixRS() * camera.getViewMatrix();
+
+			// GLSL uses column major matrices, so transpose
+			if(!mUseHLSL)
+				viewProj = viewProj.transpose();
+
+			const Quaternion& rotation = camera.getTransform().getRotation();
+			const Vector3 right = rotation.rotate(Vector3::UNIT_X);
+			const Vector3 up = rotation.rotate(Vector3::UNIT_Y);
+			const Vector3 back = rotation.rotate(Vector3::UNIT_Z);
+			const Vector3 lightDir = Vector3::normalize(mDesc.lightDirection);
+
+			InstancedParticleParamBlock block;
+			block.gMatViewProj = viewProj;
+			block.gCameraRight = Vector4(right.x, right.y, right.z, 0.0f);
+			block.gCameraUp = Vector4(up.x, up.y, up.z, 0.0f);
+			block.gCameraBack = Vector4(back.x, back.y, back.z, 0.0f);
+			block.gLightDir = Vector4(lightDir.x, lightDir.y, lightDir.z, 0.0f);
+			block.gLightColor = mDesc.lightColor;
+			block.gAmbientColor = mDesc.ambientColor;
+			block.gImpostor = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
+
+			mMeshParamBuffer->write(0, &block, sizeof(block));
+
+			block.gImpostor.x = 1.0f;
+			mImpostorParamBuffer->write(0, &block, sizeof(block));
+
+			// A single draw per representation, covering all the particles of all the systems
+			draw(mMeshInstances, mSphereVertices, mSphereIndices, mNumSphereVertices, mNumSphereIndices, mMeshParams);
+			draw(mImpostorInstances, mQuadVertices, mQuadIndices, 4, 6, mImpostorParams);
+		}
+
+		void InstancedParticleRendererExtension::setInstances(const SPtr<InstancedParticleData>& meshData,
+			const SPtr<InstancedParticleData>& impostorData)
+		{
+			upload(mMeshInstances, *meshData);
+			upload(mImpostorInstances, *impostorData);
+		}
+
+		void InstancedParticleRendererExtension::upload(InstanceBuffer& buffer, const InstancedParticleData& data)
+		{
+			buffer.numInstances = data.numInstances;
+			if(data.numInstances == 0)
+				return;
+
+			// Grow the buffer in large steps, so it doesn't need to be re-created as the particle count slowly rises
+			if(data.numInstances > buffer.capacity)
+			{
+				buffer.capacity = std::max(data.numInstances, buffer.capacity * 2);
+
+				VERTEX_BUFFER_DESC desc;
+				desc.numVerts = buffer.capacity;
+				desc.vertexSize = mInstanceStride;
+				desc.usage = GBU_DYNAMIC;
+
+				buffer.buffer = VertexBuffer::create(desc);
+			}
+
+			buffer.buffer->writeData(0, data.numInstances * mInstanceStride, data.instances.data(), BWT_DISCARD);
+		}
+
+		void InstancedParticleRendererExtension::draw(const InstanceBuffer& instances, const SPtr<VertexBuffer>& vertices,
+			const SPtr<IndexBuffer>& indices, UINT32 numVertices, UINT32 numIndices, const SPtr<GpuParams>& params)
+		{
+			if(instances.numInstances == 0)
+				return;
+
+			RenderAPI& rapi = RenderAPI::instance();
+			rapi.setGraphicsPipeline(mPipelineState);
+
+			SPtr<VertexBuffer> vertexBuffers[] = { vertices, instances.buffer };
+			rapi.setVertexBuffers(0, vertexBuffers, 2);
+			rapi.setIndexBuffer(indices);
+			rapi.setVertexDeclaration(mVertexDecl);
+			rapi.setDrawOperation(DOT_TRIANGLE_LIST);
+			rapi.setGpuParams(params);
+
+			rapi.drawIndexed(0, numIndices, 0, numVertices, instances.numInstances);
+		}
+
+		const char* getInstancedParticleVertexSource(bool hlsl, bool vksl)
+		{
+			if(hlsl)
+			{
+				static const char* src = R"(
+cbuffer Params
+{
+	float4x4 gMatViewProj;
+	float4 gCameraRight;
+	float4 gCameraUp;
+	float4 gCameraBack;
+	float4 gLightDir;
+	float4 gLightColor;
+	float4 gAmbientColor;
+	float4 gImpostor;
+}
+
+void main(
+	in float3 inPos : POSITION,
+	in float4 inInstance : TEXCOORD0,
+	in float4 inColor : COLOR0,
+	out float4 oPosition : SV_Position,
+	out float3 oLocalPos : TEXCOORD0,
+	out float4 oColor : COLOR0)
+{
+	float3 offset;
+	if(gImpostor.x > 0.5f)
+		offset = gCameraRight.xyz * inPos.x + gCameraUp.xyz * inPos.y;
+	else
+		offset = inPos;
+
+	float3 worldPos = inInstance.xyz + offset * inInstance.w;
+
+	oPosition = mul(gMatViewProj, float4(worldPos, 1));
+	oLocalPos = inPos;
+	oColor = inColor;
+}
+)";
+
+				return src;
+			}
+			else if(vksl)
+			{
+				static const char* src = R"(
+layout (binding = 0, std140) uniform Params
+{
+	mat4 gMatViewProj;
+	vec4 gCameraRight;
+	vec4 gCameraUp;
+	vec4 gCameraBack;
+	vec4 gLightDir;
+	vec4 gLightColor;
+	vec4 gAmbientColor;
+	vec4 gImpostor;
+};
+
+layout (location = 0) in vec3 bs_position;
+layout (location = 1) in vec4 bs_texcoord0;
+layout (location = 2) in vec4 bs_color0;
+
+layout (location = 0) out vec3 localPos;
+layout (location = 1) out vec4 color;
+
+out gl_PerVertex
+{
+	vec4 gl_Position;
+};
+
+void main()
+{
+	vec3 offset;
+	if(gImpostor.x > 0.5f)
+		offset = gCameraRight.xyz * bs_position.x + gCameraUp.xyz * bs_position.y;
+	else
+		offset = bs_position;
+
+	vec3 worldPos = bs_texcoord0.xyz + offset * bs_texcoord0.w;
+
+	gl_Position = gMatViewProj * vec4(worldPos, 1);
+	localPos = bs_position;
+	color = bs_color0;
+}
+)";
+
+				return src;
+			}
+			else
+			{
+				static const char* src = R"(
+layout (std140) uniform Params
+{
+	mat4 gMatViewProj;
+	vec4 gCameraRight;
+	vec4 gCameraUp;
+	vec4 gCameraBack;
+	vec4 gLightDir;
+	vec4 gLightColor;
+	vec4 gAmbientColor;
+	vec4 gImpostor;
+};
+
+in vec3 bs_position;
+in vec4 bs_texcoord0;
+in vec4 bs_color0;
+
+out vec3 localPos;
+out vec4 color;
+
+out gl_PerVertex
+{
+	vec4 gl_Position;
+};
+
+void main()
+{
+	vec3 offset;
+	if(gImpostor.x > 0.5f)
+		offset = gCameraRight.xyz * bs_position.x + gCameraUp.xyz * bs_position.y;
+	else
+		offset = bs_position;
+
+	vec3 worldPos = bs_texcoord0.xyz + offset * bs_texcoord0.w;
+
+	gl_Position = gMatViewProj * vec4(worldPos, 1);
+	localPos = bs_position;
+	color = bs_color0;
+}
+)";
+
+				return src;
+			}
+		}
+
+		const char* getInstancedParticleFragmentSource(bool hlsl, bool vksl)
+		{
+			// Impostors reconstruct the normal of the sphere they stand in for, facing the camera, and discard the pixels
+			// outside of it
+			if(hlsl)
+			{
+				static const char* src = R"(
+cbuffer Params
+{
+	float4x4 gMatViewProj;
+	float4 gCameraRight;
+	float4 gCameraUp;
+	float4 gCameraBack;
+	float4 gLightDir;
+	float4 gLightColor;
+	float4 gAmbientColor;
+	float4 gImpostor;
+}
+
+float4 main(in float4 inPos : SV_Position, in float3 localPos : TEXCOORD0, in float4 color : COLOR0) : SV_Target
+{
+	float3 normal;
+	if(gImpostor.x > 0.5f)
+	{
+		float radiusSqrd = dot(localPos.xy, localPos.xy);
+		if(radiusSqrd > 1.0f)
+			discard;
+
+		normal = gCameraRight.xyz * localPos.x + gCameraUp.xyz * localPos.y +
+			gCameraBack.xyz * sqrt(1.0f - radiusSqrd);
+	}
+	else
+		normal = normalize(localPos);
+
+	float NoL = saturate(dot(normal, -gLightDir.xyz));
+	return float4(color.rgb * (gAmbientColor.rgb + gLightColor.rgb * NoL), 1.0f);
+}
+)";
+
+				return src;
+			}
+			else if(vksl)
+			{
+				static const char* src = R"(
+layout (binding = 0, std140) uniform Params
+{
+	mat4 gMatViewProj;
+	vec4 gCameraRight;
+	vec4 gCameraUp;
+	vec4 gCameraBack;
+	vec4 gLightDir;
+	vec4 gLightColor;
+	vec4 gAmbientColor;
+	vec4 gImpostor;
+};
+
+layout (location = 0) in vec3 localPos;
+layout (location = 1) in vec4 color;
+
+layout (location = 0) out vec4 fragColor;
+
+void main()
+{
+	vec3 normal;
+	if(gImpostor.x > 0.5f)
+	{
+		float radiusSqrd = dot(localPos.xy, localPos.xy);
+		if(radiusSqrd > 1.0f)
+			discard;
+
+		normal = gCameraRight.xyz * localPos.x + gCameraUp.xyz * localPos.y +
+			gCameraBack.xyz * sqrt(1.0f - radiusSqrd);
+	}
+	else
+		normal = normalize(localPos);
+
+	float NoL = clamp(dot(normal, -gLightDir.xyz), 0.0f, 1.0f);
+	fragColor = vec4(color.rgb * (gAmbientColor.rgb + gLightColor.rgb * NoL), 1.0f);
+}
+)";
+
+				return src;
+			}
+			else
+			{
+				static const char* src = R"(
+layout (std140) uniform Params
+{
+	mat4 gMatViewProj;
+	vec4 gCameraRight;
+	vec4 gCameraUp;
+	vec4 gCameraBack;
+	vec4 gLightDir;
+	vec4 gLightColor;
+	vec4 gAmbientColor;
+	vec4 gImpostor;
+};
+
+in vec3 localPos;
+in vec4 color;
+
+out vec4 fragColor;
+
+void main()
+{
+	vec3 normal;
+	if(gImpostor.x > 0.5f)
+	{
+		float radiusSqrd = dot(localPos.xy, localPos.xy);
+		if(radiusSqrd > 1.0f)
+			discard;
+
+		normal = gCameraRight.xyz * localPos.x + gCameraUp.xyz * localPos.y +
+			gCameraBack.xyz * sqrt(1.0f - radiusSqrd);
+	}
+	else
+		normal = normalize(localPos);
+
+	float NoL = clamp(dot(normal, -gLightDir.xyz), 0.0f, 1.0f);
+	fragColor = vec4(color.rgb * (gAmbientColor.rgb + gLightColor.rgb * NoL), 1.0f);
+}
+)";
+
+				return src;
+			}
+		}
+	}
+}
\ No newline at end of file
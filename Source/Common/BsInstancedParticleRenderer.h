@@ -0,0 +1,208 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "Scene/BsComponent.h"
+#include "Renderer/BsRendererExtension.h"
+#include "Image/BsColor.h"
+
+namespace bs
+{
+	class BenchmarkLog;
+	class ParticleSimulator;
+
+	namespace ct { class InstancedParticleRendererExtension; }
+
+	/** Information used for initializing an InstancedParticleRenderer component. */
+	struct INSTANCED_PARTICLE_RENDERER_DESC
+	{
+		/**
+		 * Particles further than this distance from the camera are rendered as camera-facing impostors, instead of sphere
+		 * meshes.
+		 */
+		float impostorDistance = 10.0f;
+
+		/**
+		 * Number of segments around the sphere mesh. The mesh has half as many rings. Meshes with more than 65535
+		 * vertices, about 360 segments or more, use 32-bit indices.
+		 */
+		UINT32 sphereSegments = 16;
+
+		/** Direction the light shading the particles travels in, in world space. */
+		Vector3 lightDirection = Vector3(-0.3f, -1.0f, 0.4f);
+
+		/** Color and intensity of the light shading the particles. */
+		Color lightColor = Color::White;
+
+		/** Light applied to all sides of the particles. */
+		Color ambientColor = Color(0.2f, 0.2f, 0.25f);
+
+		/**
+		 * True if the component should advance the simulator by the frame delta every frame, right before packing its
+		 * particles. Otherwise the simulator must be advanced by something that is guaranteed to run before the
+		 * component's update, or the rendered particles lag a frame behind.
+		 */
+		bool simulate = true;
+	};
+
+	/** Statistics about the last frame rendered by an InstancedParticleRenderer component. */
+	struct InstancedParticleStats
+	{
+		UINT32 numMeshInstances = 0; /**< Number of particles rendered using the sphere mesh. */
+		UINT32 numImpostorInstances = 0; /**< Number of particles rendered as impostors. */
+		UINT32 numDrawCalls = 0; /**< Number of draw calls issued per camera. */
+		float simulateTime = 0.0f; /**< Time it took to advance the simulator, in milliseconds. */
+		float packTime = 0.0f; /**< Time it took to pack the particles into the instance data, in milliseconds. */
+	};
+
+	/** Per-particle data rendered by a single instanced draw call. */
+	struct InstancedParticleData
+	{
+		/** Position (xyz) and size (w) of every particle, followed by its color (rgba). */
+		Vector<float> instances;
+		UINT32 numInstances = 0;
+	};
+
+	/**
+	 * Instance data not used by the core thread. Data is taken from the pool on the main thread, and handed back by the
+	 * core thread once it has been uploaded, so it can be filled again.
+	 */
+	class InstancedParticleDataPool
+	{
+	public:
+		/** Returns instance data that is no longer used by the core thread, creating new data if there is none. */
+		SPtr<InstancedParticleData> acquire();
+
+		/** Returns the data to the pool once the core thread is done with it. Can be called from any thread. */
+		void release(const SPtr<InstancedParticleData>& data);
+
+	private:
+		Mutex mMutex;
+		Vector<SPtr<InstancedParticleData>> mFree;
+	};
+
+	/**
+	 * Renders the particles simulated by a ParticleSimulator as lit 3D spheres, the same way ParticleRenderMode::Mesh
+	 * renders the 3D particle effect, but using instancing.
+	 *
+	 * Instead of drawing the mesh once per particle, the position, size and color of all the particles are packed into a
+	 * single instance buffer, and all the particles are drawn using a single draw call. Particles further than
+	 * INSTANCED_PARTICLE_RENDERER_DESC::impostorDistance from the camera use a second instance buffer, and are drawn as
+	 * camera-facing quads shaded as spheres, which are much cheaper than the full sphere mesh while looking the same at a
+	 * distance. A frame therefore needs at most two draw calls, regardless of the number of particles and systems.
+	 *
+	 * The instance data is packed on the main thread, and rendered on the core thread by a renderer extension, after the
+	 * lighting pass. By default the component also advances the simulation right before packing, so the packed
+	 * particles are always the ones simulated during the same frame, see INSTANCED_PARTICLE_RENDERER_DESC::simulate.
+	 */
+	class InstancedParticleRenderer : public Component
+	{
+	public:
+		InstancedParticleRenderer(const HSceneObject& parent,
+			const INSTANCED_PARTICLE_RENDERER_DESC& desc = INSTANCED_PARTICLE_RENDERER_DESC());
+
+		/** Sets the simulator whose particle systems to render. */
+		void setSimulator(const SPtr<ParticleSimulator>& simulator) { mSimulator = simulator; }
+
+		/** Sets the camera whose position determines which particles are rendered as impostors. */
+		void setCamera(const HCamera& camera) { mCamera = camera; }
+
+		/** Changes the log the statistics are recorded in every frame. Set to null to stop recording. */
+		void setLog(const SPtr<BenchmarkLog>& log) { mLog = log; }
+
+		/** Returns statistics about the last frame. */
+		const InstancedParticleStats& getStats() const { return mStats; }
+
+		/** @copydoc Component::onInitialized */
+		void onInitialized() override;
+
+		/** @copydoc Component::update */
+		void update() override;
+
+		/** @copydoc Component::onDestroyed */
+		void onDestroyed() override;
+
+	private:
+		INSTANCED_PARTICLE_RENDERER_DESC mDesc;
+		SPtr<ParticleSimulator> mSimulator;
+		HCamera mCamera;
+		SPtr<BenchmarkLog> mLog;
+
+		SPtr<ct::InstancedParticleRendererExtension> mExtension;
+
+		/**
+		 * Instance data for the sphere mesh and the impostors. Filled on the main thread and handed over to the core
+		 * thread. Every buffer is reused once the core thread hands it back.
+		 */
+		SPtr<InstancedParticleDataPool> mMeshData = bs_shared_ptr_new<InstancedParticleDataPool>();
+		SPtr<InstancedParticleDataPool> mImpostorData = bs_shared_ptr_new<InstancedParticleDataPool>();
+
+		InstancedParticleStats mStats;
+	};
+
+	using HInstancedParticleRenderer = GameObjectHandle<InstancedParticleRenderer>;
+
+	namespace ct
+	{
+		/** Renders the particles packed by the InstancedParticleRenderer component, on the core thread. */
+		class InstancedParticleRendererExtension : public RendererExtension
+		{
+		public:
+			InstancedParticleRendererExtension();
+
+			/** @copydoc RendererExtension::initialize */
+			void initialize(const Any& data) override;
+
+			/** @copydoc RendererExtension::destroy */
+			void destroy() override;
+
+			/** @copydoc RendererExtension::check */
+			RendererExtensionRequest check(const Camera& camera) override;
+
+			/** @copydoc RendererExtension::render */
+			void render(const Camera& camera, const RendererViewContext& viewContext) override;
+
+			/** Uploads the particles to render from now on, for the sphere mesh and the impostors. */
+			void setInstances(const SPtr<InstancedParticleData>& meshData, const SPtr<InstancedParticleData>& impostorData);
+
+		private:
+			/** Instance buffer along with the number of particles it holds. */
+			struct InstanceBuffer
+			{
+				SPtr<VertexBuffer> buffer;
+				UINT32 capacity = 0;
+				UINT32 numInstances = 0;
+			};
+
+			/** Writes the instance data into the buffer, growing it if needed. */
+			void upload(InstanceBuffer& buffer, const InstancedParticleData& data);
+
+			/** Draws all the instances in the buffer using the provided mesh. */
+			void draw(const InstanceBuffer& instances, const SPtr<VertexBuffer>& vertices, const SPtr<IndexBuffer>& indices,
+				UINT32 numVertices, UINT32 numIndices, const SPtr<GpuParams>& params);
+
+			INSTANCED_PARTICLE_RENDERER_DESC mDesc;
+
+			SPtr<GraphicsPipelineState> mPipelineState;
+			SPtr<VertexDeclaration> mVertexDecl;
+			UINT32 mInstanceStride = 0;
+
+			SPtr<VertexBuffer> mSphereVertices;
+			SPtr<IndexBuffer> mSphereIndices;
+			UINT32 mNumSphereVertices = 0;
+			UINT32 mNumSphereIndices = 0;
+
+			SPtr<VertexBuffer> mQuadVertices;
+			SPtr<IndexBuffer> mQuadIndices;
+
+			SPtr<GpuParamBlockBuffer> mMeshParamBuffer;
+			SPtr<GpuParamBlockBuffer> mImpostorParamBuffer;
+			SPtr<GpuParams> mMeshParams;
+			SPtr<GpuParams> mImpostorParams;
+
+			InstanceBuffer mMeshInstances;
+			InstanceBuffer mImpostorInstances;
+
+			bool mUseHLSL = true;
+		};
+	}
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "BsParallelFor.h"
+#include "Threading/BsTaskScheduler.h"
+#include "Math/BsMath.h"
+
+namespace bs
+{
+	/** Number of task scheduler workers before the first call to setNumTaskWorkers(). Zero if not yet queried. */
+	UINT32 gDefaultNumTaskWorkers = 0;
+
+	void parallelFor(UINT32 count, UINT32 itemsPerTask, const std::function<void(UINT32, UINT32)>& worker)
+	{
+		if(count == 0)
+			return;
+
+		itemsPerTask = std::max(itemsPerTask, 1U);
+		const UINT32 numChunks = Math::divideAndRoundUp(count, itemsPerTask);
+
+		// Hand all but the last chunk to the workers. The last chunk is executed on this thread, while it would otherwise
+		// just be waiting.
+		Vector<SPtr<Task>> tasks;
+		tasks.reserve(numChunks - 1);
+
+		TaskScheduler& taskScheduler = TaskScheduler::instance();
+		for(UINT32 i = 0; i < numChunks - 1; i++)
+		{
+			const UINT32 start = i * itemsPerTask;
+			const UINT32 end = start + itemsPerTask;
+
+			SPtr<Task> task = Task::create("ParallelFor", [&worker, start, end]() { worker(start, end); });
+			taskScheduler.addTask(task);
+
+			tasks.push_back(task);
+		}
+
+		worker((numChunks - 1) * itemsPerTask, count);
+
+		for(auto& entry : tasks)
+			entry->wait();
+	}}
+
+	void setNumTaskWorkers(UINT32 numWorkers)
+	{
+		// Make sure we remember the original worker count before changing it, so it can be restored
+		getDefaultNumTaskWorkers();
+
+		TaskScheduler& taskScheduler = TaskScheduler::instance();
+		while(taskScheduler.getNumWorkers() < numWorkers)
+			taskScheduler.addWorker();
+
+		while(taskScheduler.getNumWorkers() > numWorkers && taskScheduler.getNumWorkers() > 1)
+			taskScheduler.removeWorker();
+	}
+
+	void restoreNumTaskWorkers()
+	{
+		// Nothing to restore if the worker count was never changed
+		if(gDefaultNumTaskWorkers == 0)
+			return;
+
+		setNumTaskWorkers(gDefaultNumTaskWorkers);
+	}
+
+	UINT32 getDefaultNumTaskWorkers()
+	{
+		if(gDefaultNumTaskWorkers == 0)
+			gDefaultNumTaskWorkers = TaskScheduler::instance().getNumWorkers();
+
+		return gDefaultNumTaskWorkers;
+	}
+}
\ No newline at end of file
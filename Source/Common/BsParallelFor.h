@@ -0,0 +1,32 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+
+namespace bs
+{
+	/**
+	 * Splits the [0, count) range into chunks of @p itemsPerTask items and executes @p worker on each chunk, using the
+	 * task scheduler workers. The last chunk is executed on the calling thread, and the method returns once all the chunks
+	 * have been processed. Each call receives the start (inclusive) and the end (exclusive) of its chunk. Chunks are
+	 * always the same for the same count, so results written per-item don't depend on the number of workers.
+	 *
+	 * Every chunk but the last is queued as its own task, so each call makes a few heap allocations per chunk.
+	 */
+	void parallelFor(UINT32 count, UINT32 itemsPerTask, const std::function<void(UINT32, UINT32)>& worker);
+
+	/**
+	 * Adds or removes task scheduler workers until there are the provided number of them. At least one worker is always
+	 * kept. The number of workers the scheduler had before the first call is remembered, so it can be restored by
+	 * restoreNumTaskWorkers().
+	 */
+	void setNumTaskWorkers(UINT32 numWorkers);
+
+	/** Restores the number of task scheduler workers to what it was before the first call to setNumTaskWorkers(). */
+	void restoreNumTaskWorkers();
+
+	/**
+	 * Returns the number of workers the task scheduler had before the first call to setNumTaskWorkers(), or the
+	 * current number if it was never called.
+	 */
+	UINT32 getDefaultNumTaskWorkers();
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "BsParticleLOD.h"
+#include "BsBenchmarkLog.h"
+#include "Scene/BsSceneObject.h"
+#include "Components/BsCCamera.h"
+#include "Components/BsCParticleSystem.h"
+#include "Particles/BsParticleEmitter.h"
+#include "Math/BsConvexVolume.h"
+#include "Math/BsSphere.h"
+#include "Utility/BsTime.h"
+
+namespace bs
+{
+	/** Minimum change in the emission scale before it is applied to the emitters. */
+	constexpr float EMISSION_SCALE_EPSILON = 0.01f;
+
+	ParticleLOD::ParticleLOD(const HSceneObject& parent, const PARTICLE_LOD_DESC& desc)
+		:Component(parent), mDesc(desc)
+	{
+		// Set a name for the component, so we can find it later if needed
+		setName("ParticleLOD");
+	}
+
+	void ParticleLOD::track(const HParticleSystem& system, const PARTICLE_LOD_SYSTEM_DESC& desc)
+	{
+		System entry;
+		entry.system = system;
+		entry.desc = desc;
+
+		// Full rates are the ones the emitters are set up with, unless provided
+		if(entry.desc.emissionRates.empty())
+		{
+			for(auto& emitter : system->getEmitters())
+				entry.desc.emissionRates.push_back(emitter->getEmissionRate());
+		}
+
+		mSystems.push_back(entry);
+		mStats.numSystems = (UINT32)mSystems.size();
+	}
+
+	void ParticleLOD::clear()
+	{
+		for(auto& entry : mSystems)
+		{
+			if(entry.system.isDestroyed())
+				continue;
+
+			applyEmissionScale(entry, 1.0f);
+
+			if(entry.paused)
+				entry.system->play();
+		}
+
+		mSystems.clear();
+		mStats = ParticleLODStats();
+	}
+
+	void ParticleLOD::update()
+	{
+		if(!mCamera)
+			return;
+
+		const float frameDelta = gTime().getFrameDelta();
+		const Vector3 cameraPos = mCamera->SO()->getTransform().getPosition();
+		const ConvexVolume frustum = mCamera->getWorldFrustum();
+
+		const float rateRange = std::max(mDesc.pauseDistance - mDesc.fullRateDistance, 0.001f);
+		const float maxScaleChange = mDesc.emissionBlendTime > 0.0f ? frameDelta / mDesc.emissionBlendTime : 1.0f;
+
+		mStats.numSimulated = 0;
+		mStats.numPaused = 0;
+		mStats.numVisible = 0;
+		mStats.numSimulatedParticles = 0;
+		mStats.numVisibleParticles = 0;
+
+		for(auto& entry : mSystems)
+		{
+			if(entry.system.isDestroyed())
+				continue;
+
+			const Vector3 position = entry.system->SO()->getTransform().getPosition();
+			const float distance = std::max(position.distance(cameraPos) - entry.desc.radius, 0.0f);
+
+			const bool visible = frustum.intersects(Sphere(position, entry.desc.radius + mDesc.frustumMargin));
+
+			// Paused systems need to come a bit closer before they resume
+			const float pauseDistance = entry.paused ? mDesc.pauseDistance - mDesc.hysteresis : mDesc.pauseDistance;
+			const bool wantPause = distance > pauseDistance || (mDesc.pauseInvisible && !visible);
+
+			if(wantPause)
+				entry.pauseTimer += frameDelta;
+			else
+				entry.pauseTimer = 0.0f;
+
+			if(!entry.paused && wantPause && entry.pauseTimer >= mDesc.pauseDelay)
+			{
+				entry.system->pause();
+				entry.paused = true;
+			}
+			else if(entry.paused && !wantPause)
+			{
+				// Resuming continues with the particles the system had when paused, so nothing pops in or out
+				entry.system->play();
+				entry.paused = false;
+			}
+
+			// Move the emission rate gradually towards the rate for the current distance
+			const float distanceFactor = Math::clamp01((distance - mDesc.fullRateDistance) / rateRange);
+			entry.targetEmissionScale = Math::lerp(distanceFactor, 1.0f, mDesc.minEmissionScale);
+
+			const float scaleDelta = Math::clamp(entry.targetEmissionScale - entry.emissionScale, -maxScaleChange,
+				maxScaleChange);
+			const float emissionScale = entry.emissionScale + scaleDelta;
+
+			if(std::abs(emissionScale - entry.emissionScale) >= EMISSION_SCALE_EPSILON ||
+				(emissionScale == entry.targetEmissionScale && emissionScale != entry.emissionScale))
+			{
+				applyEmissionScale(entry, emissionScale);
+			}
+
+			// Estimate the number of particles, once the system reaches a steady state
+			float emissionRate = 0.0f;
+			for(auto& rate : entry.desc.emissionRates)
+				emissionRate += rate;
+
+			const UINT32 numParticles = (UINT32)(emissionRate * entry.emissionScale * entry.desc.particleLifetime);
+
+			if(entry.paused)
+				mStats.numPaused++;
+			else
+			{
+				mStats.numSimulated++;
+				mStats.numSimulatedParticles += numParticles;
+			}
+
+			if(visible)
+			{
+				mStats.numVisible++;
+				mStats.numVisibleParticles += numParticles;
+			}
+		}
+
+		if(mLog)
+		{
+			mLog->record("lodSimulatedSystems", mStats.numSimulated);
+			mLog->record("lodPausedSystems", mStats.numPaused);
+			mLog->record("lodSimulatedParticles", mStats.numSimulatedParticles);
+			mLog->record("lodVisibleParticles", mStats.numVisibleParticles);
+		}
+	}
+
+	void ParticleLOD::onDestroyed()
+	{
+		clear();
+	}
+
+	void ParticleLOD::applyEmissionScale(System& system, float scale)
+	{
+		system.emissionScale = scale;
+
+		const Vector<SPtr<ParticleEmitter>>& emitters = system.system->getEmitters();
+		const UINT32 numRates = std::min((UINT32)emitters.size(), (UINT32)system.desc.emissionRates.size());
+
+		for(UINT32 i = 0; i < numRates; i++)
+			emitters[i]->setEmissionRate(system.desc.emissionRates[i] * scale);
+	}
+}
\ No newline at end of file
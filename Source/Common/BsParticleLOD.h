@@ -0,0 +1,147 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "Scene/BsComponent.h"
+
+namespace bs
+{
+	class BenchmarkLog;
+
+	/** Information used for initializing a ParticleLOD component. */
+	struct PARTICLE_LOD_DESC
+	{
+		/** Particle systems closer than this distance to the camera emit at their full rate. */
+		float fullRateDistance = 15.0f;
+
+		/**
+		 * Particle systems further than this distance from the camera are paused. Between this distance and the full rate
+		 * distance the emission rate is scaled down linearly, towards the minimum emission scale.
+		 */
+		float pauseDistance = 50.0f;
+
+		/** Fraction of the full emission rate used by systems right before the pause distance. */
+		float minEmissionScale = 0.25f;
+
+		/**
+		 * Distance a paused system must come closer than the pause distance before it resumes. Prevents systems near the
+		 * pause distance from constantly switching.
+		 */
+		float hysteresis = 2.0f;
+
+		/** True if systems outside of the camera frustum should be paused. */
+		bool pauseInvisible = true;
+
+		/** Extra distance added to the radius of every system when testing it against the camera frustum. */
+		float frustumMargin = 1.0f;
+
+		/**
+		 * Time in seconds a system must be outside of the frustum or beyond the pause distance before it is paused. Quickly
+		 * looking away and back doesn't stop the systems.
+		 */
+		float pauseDelay = 0.5f;
+
+		/** Time in seconds it takes the emission rate to change from the full rate to the minimum rate, or vice versa. */
+		float emissionBlendTime = 0.5f;
+	};
+
+	/** Information about a particle system managed by a ParticleLOD component. */
+	struct PARTICLE_LOD_SYSTEM_DESC
+	{
+		/** Radius of a sphere centered on the particle system's scene object, roughly enclosing its particles. */
+		float radius = 1.0f;
+
+		/**
+		 * Full emission rate of every emitter of the system, in the order returned by CParticleSystem::getEmitters(), in
+		 * particles per second. Emitters without an entry keep their emission rate. When empty, the rates the emitters
+		 * have when the system starts being tracked are used.
+		 */
+		Vector<float> emissionRates;
+
+		/** Lifetime of the particles, in seconds. Used for estimating the number of particles. */
+		float particleLifetime = 5.0f;
+	};
+
+	/** Statistics about the particle systems managed by a ParticleLOD component. */
+	struct ParticleLODStats
+	{
+		UINT32 numSystems = 0; /**< Number of particle systems managed by the component. */
+		UINT32 numSimulated = 0; /**< Number of systems currently simulated. */
+		UINT32 numPaused = 0; /**< Number of systems currently paused. */
+		UINT32 numVisible = 0; /**< Number of systems within the camera frustum. */
+
+		/**
+		 * Estimated number of particles simulated, across all the simulated systems. Estimated from the current emission
+		 * rates and the particle lifetime, as the number of particles once the systems reach a steady state.
+		 */
+		UINT32 numSimulatedParticles = 0;
+
+		/** Estimated number of particles within the camera frustum, in the same way as numSimulatedParticles. */
+		UINT32 numVisibleParticles = 0;
+	};
+
+	/**
+	 * Component that throttles the simulation of particle systems based on their distance to a camera and its frustum,
+	 * as specified by PARTICLE_LOD_DESC. Systems further away emit fewer particles, and systems that are out of view or
+	 * too far away are paused.
+	 *
+	 * Changes are applied so they aren't noticeable when the systems come back into view: the emission rate changes
+	 * gradually, and paused systems keep their particles and continue from the same state once they are resumed.
+	 */
+	class ParticleLOD : public Component
+	{
+	public:
+		ParticleLOD(const HSceneObject& parent, const PARTICLE_LOD_DESC& desc = PARTICLE_LOD_DESC());
+
+		/** Changes the settings that determine how are the systems throttled. Applied on the next update. */
+		void setDesc(const PARTICLE_LOD_DESC& desc) { mDesc = desc; }
+
+		/** Sets the camera whose position and frustum determine how are the systems throttled. */
+		void setCamera(const HCamera& camera) { mCamera = camera; }
+
+		/** Changes the log the statistics are recorded in every frame. Set to null to stop recording. */
+		void setLog(const SPtr<BenchmarkLog>& log) { mLog = log; }
+
+		/**
+		 * Registers a particle system to manage. Unless the full emission rates are provided, they are read from the
+		 * emitters, so the system should be tracked once its emitters are set up.
+		 */
+		void track(const HParticleSystem& system, const PARTICLE_LOD_SYSTEM_DESC& desc);
+
+		/** Stops managing all the particle systems, and restores them to their full emission rate. */
+		void clear();
+
+		/** Returns statistics about the managed systems. */
+		const ParticleLODStats& getStats() const { return mStats; }
+
+		/** @copydoc Component::update */
+		void update() override;
+
+		/** @copydoc Component::onDestroyed */
+		void onDestroyed() override;
+
+	private:
+		/** State of a single managed particle system. */
+		struct System
+		{
+			HParticleSystem system;
+			PARTICLE_LOD_SYSTEM_DESC desc;
+
+			bool paused = false;
+			float pauseTimer = 0.0f; /**< Time the system spent wanting to be paused. */
+			float emissionScale = 1.0f; /**< Emission scale currently applied to the emitters. */
+			float targetEmissionScale = 1.0f; /**< Emission scale the current one is moving towards. */
+		};
+
+		/** Applies the emission scale to the emitters of a system. */
+		void applyEmissionScale(System& system, float scale);
+
+		PARTICLE_LOD_DESC mDesc;
+		HCamera mCamera;
+		SPtr<BenchmarkLog> mLog;
+
+		Vector<System> mSystems;
+		ParticleLODStats mStats;
+	};
+
+	using HParticleLOD = GameObjectHandle<ParticleLOD>;
+}
\ No newline at end of file
@@ -0,0 +1,346 @@
+#include "BsParticleSimulator.h"
+#include "BsParallelFor.h"
+#include "BsHash.h"
+#include "Math/BsMath.h"
+
+namespace bs
+{
+	/** Advances a xorshift random number generator and returns a number in [0, 1] range. */
+	float nextParticleRandom(UINT32& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+
+		return (state & 0xFFFFFF) / (float)0xFFFFFF;
+	}
+
+	/**
+	 * Extra space reserved by ParticleSimulator::prewarm() on top of the estimated number of particles, as a fraction of
+	 * the estimate.
+	 */
+	constexpr float PREWARM_HEADROOM = 0.1f;
+
+	ParticleSimulator::ParticleSimulator(UINT32 particlesPerTask, UINT32 systemsPerTask)
+		: mParticlesPerTask(Math::divideAndRoundUp(std::max(particlesPerTask, 1U), SimdParticleEvolver::getSimdWidth())
+			* SimdParticleEvolver::getSimdWidth())
+		, mSystemsPerTask(std::max(systemsPerTask, 1U))
+	{ }
+
+	UINT32 ParticleSimulator::addSystem(const SIMD_PARTICLE_SYSTEM_DESC& desc)
+	{
+		const UINT32 idx = (UINT32)mSystems.size();
+
+		SimdParticleSystem system;
+		system.desc = desc;
+
+		// Xorshift state must never be zero
+		const UINT32 seed = desc.seed != 0 ? desc.seed : idx + 1;
+		system.randomState = (seed * 0x9E3779B9) | 1;
+
+		mSystems.push_back(system);
+		mStats.numSystems = (UINT32)mSystems.size();
+
+		return idx;
+	}
+
+	void ParticleSimulator::clear()
+	{
+		mSystems.clear();
+		mRanges.clear();
+		mTaskRanges.clear();
+		mArena = Vector<float>();
+		mNumStorageAllocations = 0;
+		mStats = ParticleSimulatorStats();
+	}
+
+	void ParticleSimulator::prewarm(float time, float timeStep, const Vector3& viewPoint)
+	{
+		const UINT32 numSystems = (UINT32)mSystems.size();
+
+		// Size the storage of every system for its steady state
+		Vector<UINT32> capacities(numSystems);
+
+		UINT64 arenaSize = 0;
+		UINT32 numRanges = 0;
+		for(UINT32 i = 0; i < numSystems; i++)
+		{
+			capacities[i] = estimateCapacity(mSystems[i], timeStep);
+			arenaSize += SimdParticles::getStorageSize(capacities[i]);
+			numRanges += Math::divideAndRoundUp(capacities[i], mParticlesPerTask);
+		}
+
+		// Place the particles of all the systems in a single allocation. Existing particles are copied into it, before
+		// the previous arena is released.
+		Vector<float> arena((size_t)arenaSize);
+
+		float* storage = arena.data();
+		for(UINT32 i = 0; i < numSystems; i++)
+		{
+			SimdParticleSystem& system = mSystems[i];
+
+			system.particles.reserve(capacities[i], storage);
+			storage += SimdParticles::getStorageSize(capacities[i]);
+
+			if(system.desc.sort)
+			{
+				system.sortDistances.reserve(capacities[i]);
+				system.sorter.reserve(capacities[i]);
+			}
+		}
+
+		mArena = std::move(arena);
+
+		mRanges.reserve(numRanges);
+		mTaskRanges.reserve(numRanges + 1);
+		mNumEmitted.reserve(numSystems);
+		mNumRemoved.reserve(numSystems);
+
+		// Fast-forward, so the systems start in their steady state
+		if(time > 0.0f && timeStep > 0.0f)
+		{
+			const UINT32 numSteps = (UINT32)std::round(time / timeStep);
+			for(UINT32 i = 0; i < numSteps; i++)
+				simulate(timeStep, viewPoint);
+		}
+	}
+
+	void ParticleSimulator::simulate(float timeStep, const Vector3& viewPoint)
+	{
+		const UINT32 numSystems = (UINT32)mSystems.size();
+
+		// Buffers never shrink during a step, so any change in their size means they had to allocate
+		const UINT64 bufferSize = getBufferSize();
+
+		// Evolve the existing particles
+		buildRanges();
+
+		const UINT32 numTasks = (UINT32)mTaskRanges.size() - 1;
+		parallelFor(numTasks, 1, [this, timeStep](UINT32 start, UINT32 end)
+		{
+			for(UINT32 i = start; i < end; i++)
+			{
+				for(UINT32 j = mTaskRanges[i]; j < mTaskRanges[i + 1]; j++)
+				{
+					const ParticleRange& range = mRanges[j];
+					SimdParticleSystem& system = mSystems[range.system];
+
+					if(system.desc.evolver)
+					{
+						system.desc.evolver->simulate(system.particles, timeStep, range.start, range.end,
+							system.desc.position);
+					}
+				}
+			}
+		});
+
+		// Remove the dead particles, emit new ones and sort. Counts are written per system and summed up afterwards, so
+		// the tasks don't need to synchronize.
+		mNumEmitted.assign(numSystems, 0);
+		mNumRemoved.assign(numSystems, 0);
+
+		parallelFor(numSystems, mSystemsPerTask, [this, timeStep, &viewPoint](UINT32 start, UINT32 end)
+		{
+			for(UINT32 i = start; i < end; i++)
+			{
+				SimdParticleSystem& system = mSystems[i];
+
+				mNumRemoved[i] = system.particles.removeDead();
+				mNumEmitted[i] = emit(system, timeStep);
+
+				if(system.desc.sort)
+					sort(system, viewPoint);
+			}
+		});
+
+		mStats.numSystems = numSystems;
+		mStats.numParticles = 0;
+		mStats.numEmitted = 0;
+		mStats.numRemoved = 0;
+		mStats.numTasks = numTasks;
+
+		UINT64 numStorageAllocations = 0;
+		for(UINT32 i = 0; i < numSystems; i++)
+		{
+			mStats.numParticles += mSystems[i].particles.getCount();
+			mStats.numEmitted += mNumEmitted[i];
+			mStats.numRemoved += mNumRemoved[i];
+
+			numStorageAllocations += mSystems[i].particles.getNumAllocations();
+		}
+
+		mStats.numStorageAllocations = (UINT32)(numStorageAllocations - mNumStorageAllocations);
+		mNumStorageAllocations = numStorageAllocations;
+
+		mStats.bufferGrowth = getBufferSize() - bufferSize;
+	}
+
+	UINT64 ParticleSimulator::calculateChecksum() const
+	{
+		UINT64 hash = FNV_OFFSET_BASIS;
+		for(auto& entry : mSystems)
+		{
+			const SimdParticles& particles = entry.particles;
+			const UINT32 count = particles.getCount();
+
+			for(auto* values : { particles.positionX, particles.positionY, particles.positionZ, particles.velocityX,
+				particles.velocityY, particles.velocityZ, particles.lifetime })
+			{
+				hash = hashFNV1a(hash, values, count * sizeof(float));
+			}
+		}
+
+		return hash;
+	}
+
+	void ParticleSimulator::buildRanges()
+	{
+		const UINT32 simdWidth = SimdParticleEvolver::getSimdWidth();
+
+		// Split large systems into multiple ranges, aligned to the SIMD width
+		mRanges.clear();
+		for(UINT32 i = 0; i < (UINT32)mSystems.size(); i++)
+		{
+			const UINT32 count = mSystems[i].particles.getCount();
+			for(UINT32 start = 0; start < count; start += mParticlesPerTask)
+			{
+				ParticleRange range;
+				range.system = i;
+				range.start = start;
+				range.end = std::min(start + mParticlesPerTask, count);
+
+				mRanges.push_back(range);
+			}
+		}
+
+		// Group consecutive ranges into tasks of roughly the same number of particles, so many small systems don't each
+		// end up in their own task
+		mTaskRanges.clear();
+
+		UINT32 numTaskParticles = 0;
+		for(UINT32 i = 0; i < (UINT32)mRanges.size(); i++)
+		{
+			if(i == 0 || numTaskParticles >= mParticlesPerTask)
+			{
+				mTaskRanges.push_back(i);
+				numTaskParticles = 0;
+			}
+
+			const ParticleRange& range = mRanges[i];
+			numTaskParticles += Math::divideAndRoundUp(range.end - range.start, simdWidth) * simdWidth;
+		}
+
+		mTaskRanges.push_back((UINT32)mRanges.size());
+	}
+
+	UINT32 ParticleSimulator::emit(SimdParticleSystem& system, float timeStep)
+	{
+		const SIMD_PARTICLE_EMITTER_DESC& emitter = system.desc.emitter;
+
+		const float numToEmit = system.emissionRemainder + emitter.emissionRate * timeStep;
+		UINT32 numEmitted = (UINT32)numToEmit;
+		system.emissionRemainder = numToEmit - numEmitted;
+
+		SimdParticles& particles = system.particles;
+		const UINT32 start = particles.getCount();
+
+		if(system.desc.maxParticles > 0)
+			numEmitted = std::min(numEmitted, system.desc.maxParticles - std::min(start, system.desc.maxParticles));
+
+		if(numEmitted == 0)
+			return 0;
+
+		particles.resize(start + numEmitted);
+
+		const float coneRadius = Math::tan(emitter.coneAngle);
+		const float invLifetime = 1.0f / emitter.initialLifetime;
+
+		for(UINT32 i = start; i < start + numEmitted; i++)
+		{
+			Vector3 position = system.desc.position;
+			Vector3 direction;
+
+			if(emitter.shape == SimdParticleEmitterShape::Cone)
+			{
+				// Pick a random direction within the cone, in local space
+				const float radius = coneRadius * Math::sqrt(nextParticleRandom(system.randomState));
+				const float angle = nextParticleRandom(system.randomState) * Math::TWO_PI;
+
+				direction = Vector3(radius * std::cos(angle), radius * std::sin(angle), 1.0f);
+				direction.normalize();
+
+				direction = system.desc.rotation.rotate(direction);
+			}
+			else
+			{
+				// Pick a random point on the sphere surface, and move away from the center
+				const float z = nextParticleRandom(system.randomState) * 2.0f - 1.0f;
+				const float angle = nextParticleRandom(system.randomState) * Math::TWO_PI;
+				const float radius = Math::sqrt(std::max(1.0f - z * z, 0.0f));
+
+				direction = Vector3(radius * std::cos(angle), radius * std::sin(angle), z);
+				position += direction * emitter.sphereRadius;
+			}
+
+			const Vector3 velocity = direction * emitter.initialSpeed;
+
+			particles.positionX[i] = position.x;
+			particles.positionY[i] = position.y;
+			particles.positionZ[i] = position.z;
+			particles.velocityX[i] = velocity.x;
+			particles.velocityY[i] = velocity.y;
+			particles.velocityZ[i] = velocity.z;
+			particles.size[i] = emitter.initialSize;
+			particles.colorR[i] = emitter.initialColor.r;
+			particles.colorG[i] = emitter.initialColor.g;
+			particles.colorB[i] = emitter.initialColor.b;
+			particles.colorA[i] = emitter.initialColor.a;
+			particles.frame[i] = 0.0f;
+			particles.lifetime[i] = emitter.initialLifetime;
+			particles.invInitialLifetime[i] = invLifetime;
+		}
+
+		return numEmitted;
+	}
+
+	void ParticleSimulator::sort(SimdParticleSystem& system, const Vector3& viewPoint)
+	{
+		const SimdParticles& particles = system.particles;
+		const UINT32 count = particles.getCount();
+
+		system.sortDistances.resize(count);
+		for(UINT32 i = 0; i < count; i++)
+		{
+			const Vector3 position(particles.positionX[i], particles.positionY[i], particles.positionZ[i]);
+			system.sortDistances[i] = position.squaredDistance(viewPoint);
+		}
+
+		// Already running within a task, so the sort itself runs on this thread
+		system.sorter.sort(system.sortDistances.data(), count);
+	}
+
+	UINT64 ParticleSimulator::getBufferSize() const
+	{
+		UINT64 size = mRanges.capacity() * sizeof(ParticleRange);
+		size += (mTaskRanges.capacity() + mNumEmitted.capacity() + mNumRemoved.capacity()) * sizeof(UINT32);
+
+		for(auto& entry : mSystems)
+			size += entry.sortDistances.capacity() * sizeof(float) + entry.sorter.getAllocatedSize();
+
+		return size;
+	}
+
+	UINT32 ParticleSimulator::estimateCapacity(const SimdParticleSystem& system, float timeStep) const
+	{
+		const SIMD_PARTICLE_EMITTER_DESC& emitter = system.desc.emitter;
+
+		// Particles spawned during a step are added before the dead ones are removed on the next step
+		const float numParticles = emitter.emissionRate * (emitter.initialLifetime + timeStep);
+		UINT32 capacity = (UINT32)std::ceil(numParticles * (1.0f + PREWARM_HEADROOM)) + 1;
+
+		if(system.desc.maxParticles > 0)
+			capacity = std::min(capacity, system.desc.maxParticles);
+
+		return std::max(capacity, system.particles.getCount());
+	}
+}
\ No newline at end of file
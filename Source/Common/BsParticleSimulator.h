@@ -0,0 +1,232 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "Image/BsColor.h"
+#include "Math/BsQuaternion.h"
+#include "BsSimdParticles.h"
+#include "BsParticleSort.h"
+
+namespace bs
+{
+	/** Shapes new particles can be spawned from by a particle system simulated by ParticleSimulator. */
+	enum class SimdParticleEmitterShape
+	{
+		/**
+		 * Particles spawn at the base of a cone, traveling in a random direction within the cone. Same as
+		 * ParticleEmitterConeShape using ParticleEmitterConeType::Base.
+		 */
+		Cone,
+		/** Particles spawn on the surface of a sphere, traveling away from its center. Same as ParticleEmitterSphereShape. */
+		Sphere
+	};
+
+	/**
+	 * Determines how are new particles spawned by a particle system simulated by ParticleSimulator. Mirrors a
+	 * ParticleEmitter using one of the shapes in SimdParticleEmitterShape.
+	 */
+	struct SIMD_PARTICLE_EMITTER_DESC
+	{
+		/** Shape the particles are spawned from. */
+		SimdParticleEmitterShape shape = SimdParticleEmitterShape::Cone;
+
+		/** Number of particles to spawn per second. */
+		float emissionRate = 20.0f;
+
+		/** Speed of newly spawned particles, in meters per second. */
+		float initialSpeed = 1.0f;
+
+		/** Lifetime of newly spawned particles, in seconds. */
+		float initialLifetime = 5.0f;
+
+		/** Size of newly spawned particles. */
+		float initialSize = 1.0f;
+
+		/** Color of newly spawned particles. */
+		Color initialColor = Color::White;
+
+		/** Angle of the cone the particles travel in, around the local Z axis of the particle system. */
+		Degree coneAngle = Degree(10.0f);
+
+		/** Radius of the sphere the particles are spawned on. */
+		float sphereRadius = 1.0f;
+	};
+
+	/** Information used for adding a particle system to a ParticleSimulator. */
+	struct SIMD_PARTICLE_SYSTEM_DESC
+	{
+		/** World position the particles are spawned at. */
+		Vector3 position = Vector3::ZERO;
+
+		/** World rotation of the particle system, orienting the emission cone. */
+		Quaternion rotation = Quaternion::IDENTITY;
+
+		/** Determines how are new particles spawned. */
+		SIMD_PARTICLE_EMITTER_DESC emitter;
+
+		/**
+		 * Evolvers applied to the particles. Can be shared between many particle systems. The evolver must be created with
+		 * SIMD_PARTICLE_EVOLVERS_DESC::respawn disabled, as the particles are spawned by the emitter instead.
+		 */
+		SPtr<SimdParticleEvolver> evolver;
+
+		/** True if the particles should be sorted back to front, relative to the view point. */
+		bool sort = true;
+
+		/**
+		 * Maximum number of live particles. The emitter stops spawning particles while the system is at the limit. Zero
+		 * means there is no limit.
+		 */
+		UINT32 maxParticles = 0;
+
+		/** Seed for the random emission directions. Zero picks a seed based on the particle system index. */
+		UINT32 seed = 0;
+	};
+
+	/** Particle system simulated by a ParticleSimulator. */
+	struct SimdParticleSystem
+	{
+		SIMD_PARTICLE_SYSTEM_DESC desc;
+		SimdParticles particles;
+
+		/**
+		 * Sorts the particles relative to the view point. Once sorted, ParticleDistanceSorter::getOrder() returns the
+		 * indices of the particles ordered from the furthest to the nearest.
+		 */
+		ParticleDistanceSorter sorter = ParticleDistanceSorter(24, false);
+
+		/** Fraction of a particle left to emit, carried over from the previous step. */
+		float emissionRemainder = 0.0f;
+
+		/** State of the xorshift random number generator used for emission. */
+		UINT32 randomState = 1;
+
+		/** Scratch buffer holding the squared distances of the particles to the view point. */
+		Vector<float> sortDistances;
+	};
+
+	/** Statistics about the last step executed by a ParticleSimulator. */
+	struct ParticleSimulatorStats
+	{
+		UINT32 numSystems = 0; /**< Number of particle systems in the simulator. */
+		UINT32 numParticles = 0; /**< Number of live particles, across all the systems. */
+		UINT32 numEmitted = 0; /**< Number of particles spawned during the last step. */
+		UINT32 numRemoved = 0; /**< Number of particles that died during the last step. */
+		UINT32 numTasks = 0; /**< Number of tasks the particles were evolved in. */
+
+		/**
+		 * Number of times a particle system had to allocate new particle storage during the last step, because it
+		 * outgrew its current storage. Zero once the systems were pre-warmed and reached their steady state.
+		 */
+		UINT32 numStorageAllocations = 0;
+
+		/**
+		 * Number of bytes the sorting buffers, and the buffers used for splitting the work into tasks, grew by during
+		 * the last step. Zero once the systems were pre-warmed and reached their steady state.
+		 */
+		UINT64 bufferGrowth = 0;
+	};
+
+	/**
+	 * Simulates a large number of CPU particle systems, splitting the work between the task scheduler workers. Instead
+	 * of updating each particle system as a whole, the particles of all the systems are split into ranges of roughly the
+	 * same size, so both many small systems and a few large ones keep all the workers busy.
+	 *
+	 * Each step is executed in two parallel phases:
+	 *  - The particle ranges are evolved. Ranges never share particles, and are always aligned to the SIMD width.
+	 *  - Every particle system removes its dead particles, emits new ones and sorts its particles. Each system only
+	 *    touches its own data and uses its own random number generator, and particles are always appended and sorted in
+	 *    the same order.
+	 *
+	 * The result of a step therefore doesn't depend on the number of workers, or the order the tasks were executed in.
+	 */
+	class ParticleSimulator
+	{
+	public:
+		/**
+		 * Creates a new simulator. @p particlesPerTask determines the number of particles a single task evolves, and
+		 * @p systemsPerTask the number of particle systems emitted and sorted by a single task. The number of particles
+		 * is rounded up to a multiple of the SIMD width, so the ranges split from a system never share a SIMD lane.
+		 */
+		ParticleSimulator(UINT32 particlesPerTask = 8192, UINT32 systemsPerTask = 16);
+
+		/** Adds a new particle system and returns its index. */
+		UINT32 addSystem(const SIMD_PARTICLE_SYSTEM_DESC& desc);
+
+		/** Removes all the particle systems. */
+		void clear();
+
+		/**
+		 * Allocates the particle storage of all the particle systems up front, and optionally fast-forwards the simulation
+		 * so the systems start in their steady state.
+		 *
+		 * The storage of all the systems is placed in a single arena allocation, sized for the number of particles every
+		 * system has once it reaches the steady state: the emission rate times the particle lifetime, limited by
+		 * SIMD_PARTICLE_SYSTEM_DESC::maxParticles. The sorting buffers and the buffers used for splitting the work into
+		 * tasks are reserved as well, so later steps don't allocate any particle or sorting memory. Systems added after
+		 * the call, or ones that outgrow their storage, allocate their own storage as before.
+		 *
+		 * @param[in]	time		Time to fast-forward the simulation by, in seconds. Zero only allocates the storage.
+		 * @param[in]	timeStep	Time step to use for fast-forwarding, and for estimating the number of particles
+		 *							spawned during a single step.
+		 * @param[in]	viewPoint	View point the particles are sorted relative to while fast-forwarding.
+		 */
+		void prewarm(float time = 0.0f, float timeStep = 1.0f / 60.0f, const Vector3& viewPoint = Vector3::ZERO);
+
+		/** Advances all the particle systems by the provided time step, sorting them relative to the view point. */
+		void simulate(float timeStep, const Vector3& viewPoint);
+
+		/** Returns the particle system with the provided index. */
+		const SimdParticleSystem& getSystem(UINT32 idx) const { return mSystems[idx]; }
+
+		/** Returns the number of particle systems. */
+		UINT32 getNumSystems() const { return (UINT32)mSystems.size(); }
+
+		/** Returns statistics about the last step. */
+		const ParticleSimulatorStats& getStats() const { return mStats; }
+
+		/**
+		 * Calculates a hash of the state of all the particles, in particle system order. The same sequence of steps
+		 * always produces the same hash, regardless of the number of workers.
+		 */
+		UINT64 calculateChecksum() const;
+
+	private:
+		/** Range of particles of a single particle system. */
+		struct ParticleRange
+		{
+			UINT32 system;
+			UINT32 start;
+			UINT32 end;
+		};
+
+		/** Splits the particles of all the systems into ranges, and groups the ranges into tasks. */
+		void buildRanges();
+
+		/** Removes the dead particles from a particle system and emits new ones. Returns the number of emitted particles. */
+		UINT32 emit(SimdParticleSystem& system, float timeStep);
+
+		/** Sorts the particles of a particle system back to front. */
+		void sort(SimdParticleSystem& system, const Vector3& viewPoint);
+
+		/** Returns the size of the sorting buffers and the buffers used for splitting the work into tasks, in bytes. */
+		UINT64 getBufferSize() const;
+
+		/** Estimates the maximum number of particles a system will have, once it reaches the steady state. */
+		UINT32 estimateCapacity(const SimdParticleSystem& system, float timeStep) const;
+
+		UINT32 mParticlesPerTask;
+		UINT32 mSystemsPerTask;
+
+		Vector<SimdParticleSystem> mSystems;
+		Vector<ParticleRange> mRanges;
+		Vector<UINT32> mTaskRanges; /**< Index of the first range of every task, followed by the total number of ranges. */
+
+		Vector<UINT32> mNumEmitted; /**< Number of particles emitted by every system during the last step. */
+		Vector<UINT32> mNumRemoved; /**< Number of particles removed from every system during the last step. */
+
+		Vector<float> mArena; /**< Particle storage of all the systems that existed during the last prewarm(). */
+		UINT64 mNumStorageAllocations = 0; /**< Number of particle storage allocations made by all the systems. */
+
+		ParticleSimulatorStats mStats;
+	};
+}
\ No newline at end of file
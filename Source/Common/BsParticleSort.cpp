@@ -0,0 +1,209 @@
+#include "BsParticleSort.h"
+#include "BsParallelFor.h"
+#include "Math/BsMath.h"
+
+namespace bs
+{
+	/** Number of bits sorted by a single radix pass. */
+	constexpr UINT32 RADIX_BITS = 8;
+
+	/** Number of possible digit values in a single radix pass. */
+	constexpr UINT32 RADIX_SIZE = 1 << RADIX_BITS;
+
+	/**
+	 * Maximum number of element moves the insertion sort may make per particle, before giving up and running the radix
+	 * sort instead.
+	 */
+	constexpr UINT32 MAX_INSERTION_MOVES_PER_PARTICLE = 4;
+
+	/** Converts a float into a key whose unsigned integer order matches the float order. */
+	UINT32 floatToSortKey(float value)
+	{
+		UINT32 bits;
+		memcpy(&bits, &value, sizeof(bits));
+
+		// Flip all the bits of negative numbers, and only the sign bit of positive ones
+		return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+	}
+
+	ParticleDistanceSorter::ParticleDistanceSorter(UINT32 keyBits, bool parallel)
+		:mKeyBits(Math::clamp(keyBits, RADIX_BITS, 32U)), mParallel(parallel)
+	{ }
+
+	void ParticleDistanceSorter::sort(const float* distances, UINT32 count)
+	{
+		// Start from the previous order if it still refers to the same particles, otherwise from the identity order
+		mOrderReused = false;
+		if(mOrder.size() != count || count == 0)
+		{
+			mOrder.resize(count);
+			for(UINT32 i = 0; i < count; i++)
+				mOrder[i] = i;
+		}
+		else
+			mOrderReused = true;
+
+		calculateKeys(distances, count);
+
+		if(mOrderReused && sortIncremental())
+			return;
+
+		mOrderReused = false;
+		sortRadix();
+	}
+
+	void ParticleDistanceSorter::reset()
+	{
+		mOrder.clear();
+		mOrderReused = false;
+	}
+
+	void ParticleDistanceSorter::reserve(UINT32 count)
+	{
+		const UINT32 particlesPerTask = mParallel ? PARTICLES_PER_TASK : std::max(count, 1U);
+		const UINT32 numTasks = std::max(Math::divideAndRoundUp(count, particlesPerTask), 1U);
+
+		mKeys.reserve(count);
+		mOrder.reserve(count);
+		mTempKeys.reserve(count);
+		mTempOrder.reserve(count);
+		mHistograms.reserve(numTasks * RADIX_SIZE);
+	}
+
+	UINT64 ParticleDistanceSorter::getAllocatedSize() const
+	{
+		const UINT64 capacity = mKeys.capacity() + mOrder.capacity() + mTempKeys.capacity() + mTempOrder.capacity() +
+			mHistograms.capacity();
+
+		return capacity * sizeof(UINT32);
+	}
+
+	void ParticleDistanceSorter::calculateKeys(const float* distances, UINT32 count)
+	{
+		const UINT32 shift = 32 - mKeyBits;
+
+		// Keys are inverted so that sorting them in ascending order puts the furthest particles first
+		mKeys.resize(count);
+		for(UINT32 i = 0; i < count; i++)
+			mKeys[i] = (~floatToSortKey(distances[mOrder[i]])) >> shift;
+	}
+
+	bool ParticleDistanceSorter::sortIncremental()
+	{
+		const UINT32 count = (UINT32)mKeys.size();
+		const UINT64 maxMoves = (UINT64)count * MAX_INSERTION_MOVES_PER_PARTICLE;
+
+		UINT64 numMoves = 0;
+		for(UINT32 i = 1; i < count; i++)
+		{
+			const UINT32 key = mKeys[i];
+			if(mKeys[i - 1] <= key)
+				continue;
+
+			const UINT32 index = mOrder[i];
+
+			UINT32 j = i;
+			while(j > 0 && mKeys[j - 1] > key)
+			{
+				mKeys[j] = mKeys[j - 1];
+				mOrder[j] = mOrder[j - 1];
+				j--;
+			}
+
+			mKeys[j] = key;
+			mOrder[j] = index;
+
+			// Keys and indices are always moved together, so the partially sorted state is still valid for the radix
+			// sort if we give up
+			numMoves += i - j;
+			if(numMoves > maxMoves)
+				return false;
+		}
+
+		return true;
+	}
+
+	void ParticleDistanceSorter::sortRadix()
+	{
+		const UINT32 count = (UINT32)mKeys.size();
+		if(count < 2)
+			return;
+
+		const UINT32 particlesPerTask = mParallel ? PARTICLES_PER_TASK : count;
+		const UINT32 numTasks = Math::divideAndRoundUp(count, particlesPerTask);
+
+		mTempKeys.resize(count);
+		mTempOrder.resize(count);
+		mHistograms.resize(numTasks * RADIX_SIZE);
+
+		const UINT32 numPasses = Math::divideAndRoundUp(mKeyBits, RADIX_BITS);
+		for(UINT32 pass = 0; pass < numPasses; pass++)
+		{
+			const UINT32 shift = pass * RADIX_BITS;
+
+			// Count the digits of every task's range
+			parallelFor(count, particlesPerTask, [this, shift, particlesPerTask](UINT32 start, UINT32 end)
+			{
+				UINT32* histogram = &mHistograms[(start / particlesPerTask) * RADIX_SIZE];
+				memset(histogram, 0, RADIX_SIZE * sizeof(UINT32));
+
+				for(UINT32 i = start; i < end; i++)
+					histogram[(mKeys[i] >> shift) & (RADIX_SIZE - 1)]++;
+			});
+
+			// Skip the pass if all the keys have the same digit, as it wouldn't change the order. Common for the highest
+			// digits, as particle distances tend to be within a narrow range.
+			bool singleDigit = false;
+			for(UINT32 digit = 0; digit < RADIX_SIZE; digit++)
+			{
+				UINT32 total = 0;
+				for(UINT32 task = 0; task < numTasks; task++)
+					total += mHistograms[task * RADIX_SIZE + digit];
+
+				if(total == count)
+				{
+					singleDigit = true;
+					break;
+				}
+
+				if(total > 0)
+					break;
+			}
+
+			if(singleDigit)
+				continue;
+
+			// Turn the counts into offsets. Elements with a lower digit go first, and elements with the same digit keep
+			// the order of the tasks, which keeps the sort stable.
+			UINT32 offset = 0;
+			for(UINT32 digit = 0; digit < RADIX_SIZE; digit++)
+			{
+				for(UINT32 task = 0; task < numTasks; task++)
+				{
+					UINT32& entry = mHistograms[task * RADIX_SIZE + digit];
+
+					const UINT32 taskCount = entry;
+					entry = offset;
+					offset += taskCount;
+				}
+			}
+
+			// Move the elements to their sorted positions. Every task writes to its own set of positions.
+			parallelFor(count, particlesPerTask, [this, shift, particlesPerTask](UINT32 start, UINT32 end)
+			{
+				UINT32* offsets = &mHistograms[(start / particlesPerTask) * RADIX_SIZE];
+
+				for(UINT32 i = start; i < end; i++)
+				{
+					const UINT32 dst = offsets[(mKeys[i] >> shift) & (RADIX_SIZE - 1)]++;
+
+					mTempKeys[dst] = mKeys[i];
+					mTempOrder[dst] = mOrder[i];
+				}
+			});
+
+			std::swap(mKeys, mTempKeys);
+			std::swap(mOrder, mTempOrder);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+
+namespace bs
+{
+	/**
+	 * Sorts particles back to front by their distance to the viewer, the same order ParticleSortMode::Distance uses.
+	 * Distances are quantized into integer keys and sorted using a least-significant-digit radix sort, so the cost grows
+	 * linearly with the number of particles instead of N log N.
+	 *
+	 * The order from the previous sort is kept, and if the number of particles didn't change it is used as the starting
+	 * point: particles usually move only a little between frames, so the previous order is often already sorted or close
+	 * to it, in which case it is fixed up with a bounded number of insertion sort moves instead of a full sort.
+	 *
+	 * Particles with the same key keep their relative order, so the result is always the same for the same input.
+	 *
+	 * Only used by the CPU particles simulated through ParticleSimulator (and the SIMD benchmark). Particle systems
+	 * simulated by the engine itself are still sorted by the engine when using ParticleSortMode::Distance, which this
+	 * doesn't replace.
+	 */
+	class ParticleDistanceSorter
+	{
+	public:
+		/**
+		 * Creates a new sorter.
+		 *
+		 * @param[in]	keyBits		Number of most significant bits of the distance keys to sort by, in [8, 32] range. Each
+		 *							8 bits require one radix pass. The default keeps enough precision to order particles a
+		 *							few millimeters apart at a hundred meters.
+		 * @param[in]	parallel	If true the radix passes of large particle sets are split between the task scheduler
+		 *							workers. Disable when sorting from within a task.
+		 */
+		ParticleDistanceSorter(UINT32 keyBits = 24, bool parallel = true);
+
+		/**
+		 * Sorts the particles by the provided distances (or squared distances), from the furthest to the nearest. The result
+		 * can be retrieved through getOrder().
+		 */
+		void sort(const float* distances, UINT32 count);
+
+		/** Returns the indices of the particles from the last sort, ordered from the furthest to the nearest. */
+		const Vector<UINT32>& getOrder() const { return mOrder; }
+
+		/** Returns true if the last sort only needed to fix up the previous order, instead of sorting from scratch. */
+		bool wasOrderReused() const { return mOrderReused; }
+
+		/** Forgets the previous order, so the next sort starts from scratch. */
+		void reset();
+
+		/** Allocates the internal buffers up front, so sorting up to @p count particles doesn't need to allocate. */
+		void reserve(UINT32 count);
+
+		/** Returns the size of the memory allocated by the internal buffers, in bytes. */
+		UINT64 getAllocatedSize() const;
+
+		/** Number of particles processed by a single task during the parallel radix passes. */
+		static constexpr UINT32 PARTICLES_PER_TASK = 16384;
+
+	private:
+		/** Calculates the key of every particle, in the order of the indices in mOrder. */
+		void calculateKeys(const float* distances, UINT32 count);
+
+		/**
+		 * Attempts to sort the keys using insertion sort, giving up once too many particles had to be moved. Returns true
+		 * if the keys are now sorted.
+		 */
+		bool sortIncremental();
+
+		/** Sorts the keys using the radix sort. */
+		void sortRadix();
+
+		UINT32 mKeyBits;
+		bool mParallel;
+		bool mOrderReused = false;
+
+		Vector<UINT32> mKeys;
+		Vector<UINT32> mOrder;
+		Vector<UINT32> mTempKeys;
+		Vector<UINT32> mTempOrder;
+		Vector<UINT32> mHistograms; /**< Digit counts, 256 per task. Turned into scatter offsets after counting. */
+	};
+}
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "BsPhysicsLOD.h"
+#include "BsBenchmarkLog.h"
+#include "Scene/BsSceneObject.h"
+#include "Components/BsCRigidbody.h"
+
+namespace bs
+{
+	PhysicsLOD::PhysicsLOD(const HSceneObject& parent, const PHYSICS_LOD_DESC& desc)
+		:Component(parent), mDesc(desc)
+	{
+		// Set a name for the component, so we can find it later if needed
+		setName("PhysicsLOD");
+	}
+
+	void PhysicsLOD::setStepper(const HPhysicsStepper& stepper)
+	{
+		mStepConn.disconnect();
+		mUseStepper = false;
+
+		if(stepper)
+		{
+			mStepConn = stepper->onPreStep.connect([this](UINT32 stepIdx, float stepSize) { evaluate(); });
+			mUseStepper = true;
+		}
+	}
+
+	void PhysicsLOD::track(const Vector<HRigidbody>& bodies)
+	{
+		for(auto& entry : bodies)
+		{
+			Body body;
+			body.rigidbody = entry;
+
+			mBodies.push_back(body);
+		}
+
+		mStats.numBodies = (UINT32)mBodies.size();
+	}
+
+	void PhysicsLOD::clear()
+	{
+		for(auto& entry : mBodies)
+			setSimulated(entry, true);
+
+		mBodies.clear();
+		mStats = PhysicsLODStats();
+	}
+
+	void PhysicsLOD::fixedUpdate()
+	{
+		// Bodies are evaluated before the stepper's steps instead, if one is used
+		if(mUseStepper)
+			return;
+
+		evaluate();
+	}
+
+	void PhysicsLOD::update()
+	{
+		if(!mLog)
+			return;
+
+		mLog->record("lodSimulatedBodies", mStats.numSimulated);
+		mLog->record("lodFrozenBodies", mStats.numFrozen);
+		mLog->record("lodCappedBodies", mStats.numCapped);
+	}
+
+	void PhysicsLOD::onDestroyed()
+	{
+		mStepConn.disconnect();
+		clear();
+	}
+
+	void PhysicsLOD::evaluate()
+	{
+		if(!mTarget)
+			return;
+
+		const Vector3 targetPos = mTarget->getTransform().getPosition();
+		const float wakeRadiusSqrd = mDesc.radius * mDesc.radius;
+		const float stopRadius = mDesc.radius + mDesc.hysteresis;
+		const float stopRadiusSqrd = stopRadius * stopRadius;
+
+		const UINT32 numBodies = (UINT32)mBodies.size();
+		mWanted.assign(numBodies, 0);
+		mCandidates.clear();
+
+		// Find the bodies that should be simulated, ignoring the limit for now. Bodies already simulated keep being
+		// simulated until they leave the larger radius.
+		for(UINT32 i = 0; i < numBodies; i++)
+		{
+			const Body& body = mBodies[i];
+			if(body.rigidbody.isDestroyed())
+				continue;
+
+			const float distanceSqrd = body.rigidbody->SO()->getTransform().getPosition().squaredDistance(targetPos);
+			const bool wanted = distanceSqrd < (body.simulated ? stopRadiusSqrd : wakeRadiusSqrd);
+			if(wanted)
+			{
+				mWanted[i] = 1;
+				mCandidates.push_back(std::make_pair(distanceSqrd, i));
+			}
+		}
+
+		// Apply the limit by keeping only the closest bodies. Ties are resolved by the registration order, so the choice
+		// is always the same for the same positions.
+		mStats.numCapped = 0;
+		if(mDesc.maxSimulatedBodies > 0 && (UINT32)mCandidates.size() > mDesc.maxSimulatedBodies)
+		{
+			auto limit = mCandidates.begin() + mDesc.maxSimulatedBodies;
+			std::nth_element(mCandidates.begin(), limit, mCandidates.end());
+
+			for(auto iter = limit; iter != mCandidates.end(); ++iter)
+				mWanted[iter->second] = 0;
+
+			mStats.numCapped = (UINT32)(mCandidates.end() - limit);
+		}
+
+		// Switch the bodies whose state changed, in registration order
+		mStats.numWoken = 0;
+		mStats.numStopped = 0;
+		mStats.numSimulated = 0;
+
+		for(UINT32 i = 0; i < numBodies; i++)
+		{
+			Body& body = mBodies[i];
+			if(body.rigidbody.isDestroyed())
+				continue;
+
+			const bool wanted = mWanted[i] != 0;
+			if(wanted != body.simulated)
+			{
+				setSimulated(body, wanted);
+
+				if(wanted)
+					mStats.numWoken++;
+				else
+					mStats.numStopped++;
+			}
+
+			if(body.simulated)
+				mStats.numSimulated++;
+		}
+
+		mStats.numFrozen = numBodies - mStats.numSimulated;
+	}
+
+	void PhysicsLOD::setSimulated(Body& body, bool simulated)
+	{
+		if(body.simulated == simulated)
+			return;
+
+		body.simulated = simulated;
+		if(body.rigidbody.isDestroyed())
+			return;
+
+		const HRigidbody& rigidbody = body.rigidbody;
+		if(!simulated)
+		{
+			body.wasSleeping = rigidbody->isSleeping();
+			body.frozenMode = mDesc.mode;
+
+			if(mDesc.mode == PhysicsLODMode::Kinematic)
+			{
+				// Remember the velocities, so the body continues moving the same way once it is simulated again
+				body.velocity = rigidbody->getVelocity();
+				body.angularVelocity = rigidbody->getAngularVelocity();
+
+				rigidbody->setIsKinematic(true);
+			}
+			else
+				rigidbody->sleep();
+		}
+		else
+		{
+			// Undo whatever was done when the body was frozen, even if the mode has changed since
+			if(body.frozenMode == PhysicsLODMode::Kinematic)
+			{
+				rigidbody->setIsKinematic(false);
+				rigidbody->setVelocity(body.velocity);
+				rigidbody->setAngularVelocity(body.angularVelocity);
+			}
+
+			// Bodies that were already resting don't need to be woken up
+			if(body.wasSleeping)
+				rigidbody->sleep();
+			else
+				rigidbody->wakeUp();
+		}
+	}
+}
\ No newline at end of file
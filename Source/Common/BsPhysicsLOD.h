@@ -0,0 +1,133 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "Scene/BsComponent.h"
+#include "BsPhysicsStepper.h"
+
+namespace bs
+{
+	class BenchmarkLog;
+
+	/** Determines how does PhysicsLOD stop bodies from being simulated. */
+	enum class PhysicsLODMode
+	{
+		/**
+		 * Bodies are made kinematic, removing them from the simulation entirely. Their velocities are restored once they
+		 * are simulated again.
+		 */
+		Kinematic,
+		/** Bodies are put to sleep. Cheaper to switch, but sleeping bodies are woken up by anything touching them. */
+		Sleep
+	};
+
+	/** Information used for initializing a PhysicsLOD component. */
+	struct PHYSICS_LOD_DESC
+	{
+		/** Bodies closer than this distance to the target are simulated. */
+		float radius = 25.0f;
+
+		/**
+		 * Extra distance a simulated body must move away beyond the radius before it stops being simulated. Prevents bodies
+		 * near the edge from constantly switching.
+		 */
+		float hysteresis = 2.0f;
+
+		/** Maximum number of bodies to simulate. The bodies closest to the target are preferred. Zero means no limit. */
+		UINT32 maxSimulatedBodies = 0;
+
+		/** Determines how are the bodies stopped from being simulated. */
+		PhysicsLODMode mode = PhysicsLODMode::Kinematic;
+	};
+
+	/** Statistics about the bodies managed by a PhysicsLOD component. */
+	struct PhysicsLODStats
+	{
+		UINT32 numBodies = 0; /**< Number of bodies managed by the component. */
+		UINT32 numSimulated = 0; /**< Number of bodies currently simulated. */
+		UINT32 numFrozen = 0; /**< Number of bodies currently not simulated. */
+		UINT32 numCapped = 0; /**< Number of bodies within the radius that aren't simulated due to the body limit. */
+		UINT32 numWoken = 0; /**< Number of bodies that started being simulated during the last update. */
+		UINT32 numStopped = 0; /**< Number of bodies that stopped being simulated during the last update. */
+	};
+
+	/**
+	 * Component that only simulates the rigidbodies near a target object (e.g. the player character), and stops simulating
+	 * the bodies further away, as specified by PHYSICS_LOD_DESC. The number of simulated bodies can also be capped, in
+	 * which case the bodies closest to the target are preferred.
+	 *
+	 * Bodies are evaluated once before every physics step, in the order they were registered in, so the same sequence of
+	 * target positions always results in the same bodies being woken up and stopped at the same steps. If the simulation is
+	 * stepped by a PhysicsStepper, provide it through setStepper(). Otherwise the bodies are evaluated in this component's
+	 * fixedUpdate().
+	 */
+	class PhysicsLOD : public Component
+	{
+	public:
+		PhysicsLOD(const HSceneObject& parent, const PHYSICS_LOD_DESC& desc = PHYSICS_LOD_DESC());
+
+		/**
+		 * Changes the settings that determine which bodies are simulated. Applied on the next evaluation. Bodies that
+		 * are currently frozen are unfrozen the same way they were frozen, even if the mode changes.
+		 */
+		void setDesc(const PHYSICS_LOD_DESC& desc) { mDesc = desc; }
+
+		/** Sets the object whose position determines which bodies are simulated. */
+		void setTarget(const HSceneObject& target) { mTarget = target; }
+
+		/** Evaluates the bodies right before the steps executed by the provided stepper. */
+		void setStepper(const HPhysicsStepper& stepper);
+
+		/** Changes the log the statistics are recorded in every frame. Set to null to stop recording. */
+		void setLog(const SPtr<BenchmarkLog>& log) { mLog = log; }
+
+		/** Registers a set of rigidbodies to manage. All bodies start out simulated. */
+		void track(const Vector<HRigidbody>& bodies);
+
+		/** Stops managing all the rigidbodies, and makes them all simulated again. */
+		void clear();
+
+		/** Returns statistics about the managed bodies. */
+		const PhysicsLODStats& getStats() const { return mStats; }
+
+		/** @copydoc Component::fixedUpdate */
+		void fixedUpdate() override;
+
+		/** @copydoc Component::update */
+		void update() override;
+
+		/** @copydoc Component::onDestroyed */
+		void onDestroyed() override;
+
+	private:
+		/** State of a single managed body. */
+		struct Body
+		{
+			HRigidbody rigidbody;
+			bool simulated = true;
+			bool wasSleeping = false; /**< True if the body was asleep when it stopped being simulated. */
+			PhysicsLODMode frozenMode = PhysicsLODMode::Kinematic; /**< Mode the body was last stopped with. */
+			Vector3 velocity;
+			Vector3 angularVelocity;
+		};
+
+		/** Determines which bodies should be simulated and switches the ones that changed. */
+		void evaluate();
+
+		/** Starts or stops simulating a body. */
+		void setSimulated(Body& body, bool simulated);
+
+		PHYSICS_LOD_DESC mDesc;
+		HSceneObject mTarget;
+		SPtr<BenchmarkLog> mLog;
+
+		Vector<Body> mBodies;
+		Vector<std::pair<float, UINT32>> mCandidates; /**< Scratch buffer of bodies within the radius, with distances. */
+		Vector<UINT8> mWanted; /**< Scratch buffer holding the wanted state for every body. */
+
+		HEvent mStepConn;
+		bool mUseStepper = false;
+		PhysicsLODStats mStats;
+	};
+
+	using HPhysicsLOD = GameObjectHandle<PhysicsLOD>;
+}
\ No newline at end of file
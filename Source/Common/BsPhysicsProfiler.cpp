@@ -0,0 +1,222 @@
+#include "BsPhysicsProfiler.h"
+#include "BsBenchmarkLog.h"
+#include "Scene/BsSceneObject.h"
+#include "Components/BsCRigidbody.h"
+#include "Components/BsCCollider.h"
+#include "Physics/BsPhysicsCommon.h"
+#include "Utility/BsTime.h"
+
+namespace bs
+{
+	PhysicsProfiler::PhysicsProfiler(const HSceneObject& parent, const SPtr<BenchmarkLog>& log)
+		:Component(parent), mLog(log)
+	{
+		// Set a name for the component, so we can find it later if needed
+		setName("PhysicsProfiler");
+	}
+
+	void PhysicsProfiler::setStepper(const HPhysicsStepper& stepper)
+	{
+		mStepConn.disconnect();
+		mUseStepper = false;
+
+		if(stepper)
+		{
+			mStepConn = stepper->onPostStep.connect([this, stepper](UINT32 stepIdx, float stepSize)
+			{
+				mFrameStepTime += stepper->getLastStepTime();
+				mFrameNumSteps++;
+			});
+
+			mUseStepper = true;
+		}
+	}
+
+	void PhysicsProfiler::track(const Vector<HRigidbody>& bodies)
+	{
+		for(auto& body : bodies)
+		{
+			const UINT32 bodyIdx = (UINT32)mBodies.size();
+			mBodies.push_back(body);
+
+			if(!mTrackIslands)
+				continue;
+
+			// Listen to contacts on all the colliders of the body, so we can determine which bodies are touching
+			mBodyLookup[body->SO()->getInstanceId()] = bodyIdx;
+
+			Vector<HCollider> colliders = body->SO()->getComponents<CCollider>();
+			for(auto& collider : colliders)
+			{
+				collider->setCollisionReportMode(CollisionReportMode::Report);
+
+				mCollisionEvents.push_back(collider->onCollisionBegin.connect(
+					[this](const CollisionData& data) { updateContact(data, 1); }));
+				mCollisionEvents.push_back(collider->onCollisionEnd.connect(
+					[this](const CollisionData& data) { updateContact(data, -1); }));
+			}
+		}
+	}
+
+	void PhysicsProfiler::clear()
+	{
+		for(auto& entry : mCollisionEvents)
+			entry.disconnect();
+
+		mCollisionEvents.clear();
+		mBodies.clear();
+		mBodyLookup.clear();
+		mContacts.clear();
+	}
+
+	void PhysicsProfiler::fixedUpdate()
+	{
+		// Steps are measured by the stepper instead, if one is used
+		if(mUseStepper)
+			return;
+
+		// If multiple fixed steps run in a frame, this marks the end of the previous one
+		endStepMeasurement();
+
+		mStepStart = gTime().getTimePrecise();
+		mFrameNumSteps++;
+	}
+
+	void PhysicsProfiler::update()
+	{
+		endStepMeasurement();
+
+		PhysicsFrameStats stats;
+		stats.numSteps = mFrameNumSteps;
+		stats.stepTime = mFrameStepTime / 1000.0f;
+		stats.numBodies = (UINT32)mBodies.size();
+
+		for(auto& body : mBodies)
+		{
+			if(!body.isDestroyed() && body->isSleeping())
+				stats.numSleeping++;
+		}
+
+		stats.sleepingRatio = stats.numBodies > 0 ? stats.numSleeping / (float)stats.numBodies : 0.0f;
+
+		if(mTrackIslands)
+			stats.numActiveIslands = countActiveIslands();
+
+		if(mLog)
+		{
+			mLog->record("physicsStepMs", stats.stepTime);
+			mLog->record("physicsSteps", stats.numSteps);
+			mLog->record("awakeBodies", stats.numBodies - stats.numSleeping);
+			mLog->record("sleepingRatio", stats.sleepingRatio);
+
+			if(mTrackIslands)
+				mLog->record("activeIslands", stats.numActiveIslands);
+		}
+
+		mLastFrameStats = stats;
+		mFrameStepTime = 0;
+		mFrameNumSteps = 0;
+	}
+
+	void PhysicsProfiler::onDestroyed()
+	{
+		mStepConn.disconnect();
+		clear();
+	}
+
+	void PhysicsProfiler::endStepMeasurement()
+	{
+		if(mStepStart == 0)
+			return;
+
+		mFrameStepTime += gTime().getTimePrecise() - mStepStart;
+		mStepStart = 0;
+	}
+
+	UINT64 PhysicsProfiler::getPairKey(UINT32 a, UINT32 b)
+	{
+		if(a > b)
+			std::swap(a, b);
+
+		return ((UINT64)a << 32) | b;
+	}
+
+	void PhysicsProfiler::updateContact(const CollisionData& data, INT32 delta)
+	{
+		if(!data.collider[0] || !data.collider[1])
+			return;
+
+		// Ignore contacts with anything that's not tracked (e.g. the floor)
+		auto iterFindA = mBodyLookup.find(data.collider[0]->SO()->getInstanceId());
+		auto iterFindB = mBodyLookup.find(data.collider[1]->SO()->getInstanceId());
+
+		if(iterFindA == mBodyLookup.end() || iterFindB == mBodyLookup.end())
+			return;
+
+		// Both colliders in a pair report the same contact, so the count stays symmetrical
+		const UINT64 key = getPairKey(iterFindA->second, iterFindB->second);
+		if(delta > 0)
+			mContacts[key]++;
+		else
+		{
+			auto iterFind = mContacts.find(key);
+			if(iterFind != mContacts.end())
+			{
+				if(iterFind->second <= 1)
+					mContacts.erase(iterFind);
+				else
+					iterFind->second--;
+			}
+		}
+	}
+
+	UINT32 PhysicsProfiler::countActiveIslands()
+	{
+		// Union-find over all the awake bodies, using the contacts as edges
+		const UINT32 numBodies = (UINT32)mBodies.size();
+		mIslandParents.resize(numBodies);
+
+		for(UINT32 i = 0; i < numBodies; i++)
+			mIslandParents[i] = i;
+
+		auto findRoot = [this](UINT32 idx)
+		{
+			while(mIslandParents[idx] != idx)
+			{
+				mIslandParents[idx] = mIslandParents[mIslandParents[idx]];
+				idx = mIslandParents[idx];
+			}
+
+			return idx;
+		};
+
+		auto isAwake = [this](UINT32 idx)
+		{
+			return !mBodies[idx].isDestroyed() && !mBodies[idx]->isSleeping();
+		};
+
+		for(auto& entry : mContacts)
+		{
+			const UINT32 a = (UINT32)(entry.first >> 32);
+			const UINT32 b = (UINT32)(entry.first & 0xFFFFFFFF);
+
+			if(!isAwake(a) || !isAwake(b))
+				continue;
+
+			const UINT32 rootA = findRoot(a);
+			const UINT32 rootB = findRoot(b);
+
+			if(rootA != rootB)
+				mIslandParents[rootB] = rootA;
+		}
+
+		UINT32 numIslands = 0;
+		for(UINT32 i = 0; i < numBodies; i++)
+		{
+			if(isAwake(i) && findRoot(i) == i)
+				numIslands++;
+		}
+
+		return numIslands;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "Scene/BsComponent.h"
+#include "Utility/BsEvent.h"
+#include "BsPhysicsStepper.h"
+
+namespace bs
+{
+	class BenchmarkLog;
+	struct CollisionData;
+
+	/** Physics statistics gathered by PhysicsProfiler during a single frame. */
+	struct PhysicsFrameStats
+	{
+		UINT32 numSteps = 0; /**< Number of fixed physics steps executed this frame. */
+		float stepTime = 0.0f; /**< Total time spent in the physics steps this frame, in milliseconds. */
+		UINT32 numBodies = 0; /**< Number of tracked rigidbodies. */
+		UINT32 numSleeping = 0; /**< Number of tracked rigidbodies that are currently sleeping. */
+		float sleepingRatio = 0.0f; /**< Ratio of sleeping bodies to all tracked bodies, in [0, 1] range. */
+
+		/**
+		 * Number of groups of awake bodies that are in contact with each other. Only calculated if island tracking is
+		 * enabled, otherwise zero.
+		 */
+		UINT32 numActiveIslands = 0;
+	};
+
+	/**
+	 * Component that measures the cost of the physics simulation and gathers statistics about a set of tracked
+	 * rigidbodies. Statistics are available through getLastFrameStats(), and are optionally recorded into a benchmark
+	 * log every frame.
+	 *
+	 * If the simulation is stepped by a PhysicsStepper, provide it through setStepper() so the steps can be measured
+	 * exactly. Otherwise the physics step is measured from this component's fixedUpdate() up to the next time any of its
+	 * callbacks are triggered. In that case create this component after all the other components that implement
+	 * fixedUpdate(), so it runs last before the simulation step.
+	 */
+	class PhysicsProfiler : public Component
+	{
+	public:
+		PhysicsProfiler(const HSceneObject& parent, const SPtr<BenchmarkLog>& log = nullptr);
+
+		/**
+		 * Enables or disables island tracking. Island tracking requires collision reporting on all tracked colliders,
+		 * which has a measurable cost of its own, so it is disabled by default. Must be called before any bodies are
+		 * tracked.
+		 */
+		void setTrackIslands(bool enable) { mTrackIslands = enable; }
+
+		/** Returns true if island tracking is enabled. See setTrackIslands(). */
+		bool getTrackIslands() const { return mTrackIslands; }
+
+		/** Measures the steps executed by the provided stepper, instead of relying on the engine's fixed update. */
+		void setStepper(const HPhysicsStepper& stepper);
+
+		/** Changes the log the statistics are recorded in. Set to null to stop recording. */
+		void setLog(const SPtr<BenchmarkLog>& log) { mLog = log; }
+
+		/** Registers a set of rigidbodies whose state to include in the statistics. */
+		void track(const Vector<HRigidbody>& bodies);
+
+		/** Stops tracking all rigidbodies. */
+		void clear();
+
+		/** Returns the statistics gathered during the last frame. */
+		const PhysicsFrameStats& getLastFrameStats() const { return mLastFrameStats; }
+
+		/** @copydoc Component::fixedUpdate */
+		void fixedUpdate() override;
+
+		/** @copydoc Component::update */
+		void update() override;
+
+		/** @copydoc Component::onDestroyed */
+		void onDestroyed() override;
+
+	private:
+		/** Ends the physics step measurement started in fixedUpdate(), if any. */
+		void endStepMeasurement();
+
+		/** Returns a key uniquely identifying a pair of tracked bodies in contact. */
+		static UINT64 getPairKey(UINT32 a, UINT32 b);
+
+		/** Registers or unregisters a contact between two colliders. */
+		void updateContact(const CollisionData& data, INT32 delta);
+
+		/** Counts the groups of awake bodies in contact with each other. */
+		UINT32 countActiveIslands();
+
+		SPtr<BenchmarkLog> mLog;
+		bool mTrackIslands = false;
+
+		Vector<HRigidbody> mBodies;
+		UnorderedMap<UINT64, UINT32> mBodyLookup; /**< Maps scene object instance IDs to indices in mBodies. */
+		UnorderedMap<UINT64, UINT32> mContacts; /**< Number of active contacts for each pair of bodies in contact. */
+		Vector<UINT32> mIslandParents; /**< Scratch buffer used when counting islands. */
+		Vector<HEvent> mCollisionEvents;
+		HEvent mStepConn;
+		bool mUseStepper = false;
+
+		UINT64 mStepStart = 0;
+		UINT64 mFrameStepTime = 0;
+		UINT32 mFrameNumSteps = 0;
+		PhysicsFrameStats mLastFrameStats;
+	};
+
+	using HPhysicsProfiler = GameObjectHandle<PhysicsProfiler>;
+}
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "BsPhysicsQueryBatch.h"
+#include "BsParallelFor.h"
+#include "Physics/BsPhysics.h"
+#include "Math/BsSphere.h"
+#include "Math/BsAABox.h"
+#include "Math/BsCapsule.h"
+#include "Utility/BsTimer.h"
+
+namespace bs
+{
+	PhysicsQueryBatch::PhysicsQueryBatch(const HSceneObject& parent)
+		:Component(parent)
+	{
+		// Set a name for the component, so we can find it later if needed
+		setName("PhysicsQueryBatch");
+	}
+
+	void PhysicsQueryBatch::setStepper(const HPhysicsStepper& stepper)
+	{
+		mPostStepConn.disconnect();
+
+		mUseStepper = stepper != nullptr;
+		if(mUseStepper)
+			mPostStepConn = stepper->onPostStep.connect([this](UINT32, float) { execute(); });
+	}
+
+	UINT32 PhysicsQueryBatch::add(const PhysicsQuery& query)
+	{
+		mPending.push_back(query);
+		return (UINT32)mPending.size() - 1;
+	}
+
+	UINT32 PhysicsQueryBatch::addRayCast(const Vector3& origin, const Vector3& unitDir, float maxDistance,
+		UINT64 layer)
+	{
+		PhysicsQuery query;
+		query.shape = PhysicsQueryShape::Ray;
+		query.origin = origin;
+		query.direction = unitDir;
+		query.maxDistance = maxDistance;
+		query.layer = layer;
+
+		return add(query);
+	}
+
+	UINT32 PhysicsQueryBatch::addSphereCast(const Vector3& center, float radius, const Vector3& unitDir,
+		float maxDistance, UINT64 layer)
+	{
+		PhysicsQuery query;
+		query.shape = PhysicsQueryShape::Sphere;
+		query.origin = center;
+		query.direction = unitDir;
+		query.maxDistance = maxDistance;
+		query.layer = layer;
+		query.size = Vector3(radius, 0.0f, 0.0f);
+
+		return add(query);
+	}
+
+	UINT32 PhysicsQueryBatch::addBoxCast(const Vector3& center, const Vector3& halfExtents, const Quaternion& rotation,
+		const Vector3& unitDir, float maxDistance, UINT64 layer)
+	{
+		PhysicsQuery query;
+		query.shape = PhysicsQueryShape::Box;
+		query.origin = center;
+		query.direction = unitDir;
+		query.maxDistance = maxDistance;
+		query.layer = layer;
+		query.size = halfExtents;
+		query.rotation = rotation;
+
+		return add(query);
+	}
+
+	UINT32 PhysicsQueryBatch::addCapsuleCast(const Vector3& center, float radius, float halfHeight,
+		const Quaternion& rotation, const Vector3& unitDir, float maxDistance, UINT64 layer)
+	{
+		PhysicsQuery query;
+		query.shape = PhysicsQueryShape::Capsule;
+		query.origin = center;
+		query.direction = unitDir;
+		query.maxDistance = maxDistance;
+		query.layer = layer;
+		query.size = Vector3(radius, halfHeight, 0.0f);
+		query.rotation = rotation;
+
+		return add(query);
+	}
+
+	void PhysicsQueryBatch::execute()
+	{
+		// Keep the previous results around if nothing new was queued, e.g. when multiple steps run in a single frame
+		if(mPending.empty())
+			return;
+
+		// Swap the buffers so new queries can be added while the results of this batch are in use
+		std::swap(mPending, mExecuting);
+		mPending.clear();
+
+		const UINT32 numQueries = (UINT32)mExecuting.size();
+		mResults.resize(numQueries);
+
+		Timer timer;
+
+		// The scene is only read from, so the queries can safely run concurrently
+		parallelFor(numQueries, mQueriesPerTask, [this](UINT32 start, UINT32 end) { executeRange(start, end); });
+
+		mLastExecuteTime = timer.getMicroseconds();
+		mExecuting.clear();
+
+		onExecuted();
+	}
+
+	void PhysicsQueryBatch::executeRange(UINT32 start, UINT32 end)
+	{
+		const Physics& physics = gPhysics();
+		for(UINT32 i = start; i < end; i++)
+		{
+			const PhysicsQuery& query = mExecuting[i];
+			PhysicsQueryResult& result = mResults[i];
+
+			switch(query.shape)
+			{
+			case PhysicsQueryShape::Ray:
+				result.hit = physics.rayCast(query.origin, query.direction, result.info, query.layer,
+					query.maxDistance);
+				break;
+			case PhysicsQueryShape::Sphere:
+				result.hit = physics.sphereCast(Sphere(query.origin, query.size.x), query.direction, result.info,
+					query.layer, query.maxDistance);
+				break;
+			case PhysicsQueryShape::Box:
+				result.hit = physics.boxCast(AABox(query.origin - query.size, query.origin + query.size),
+					query.rotation, query.direction, result.info, query.layer, query.maxDistance);
+				break;
+			case PhysicsQueryShape::Capsule:
+			{
+				const Vector3 axis(0.0f, query.size.y, 0.0f);
+				const Capsule capsule(LineSegment3(query.origin - axis, query.origin + axis), query.size.x);
+
+				result.hit = physics.capsuleCast(capsule, query.rotation, query.direction, result.info, query.layer,
+					query.maxDistance);
+			}
+				break;
+			}
+
+			if(!result.hit)
+				result.info = PhysicsQueryHit();
+		}
+	}
+
+	void PhysicsQueryBatch::fixedUpdate()
+	{
+		if(!mUseStepper)
+			execute();
+	}
+
+	void PhysicsQueryBatch::onDestroyed()
+	{
+		mPostStepConn.disconnect();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "Scene/BsComponent.h"
+#include "Utility/BsEvent.h"
+#include "Physics/BsPhysicsCommon.h"
+#include "BsPhysicsStepper.h"
+
+namespace bs
+{
+	/** Shape that is cast by a batched physics query. */
+	enum class PhysicsQueryShape
+	{
+		Ray,
+		Sphere,
+		Box,
+		Capsule
+	};
+
+	/** Single query queued in a PhysicsQueryBatch. */
+	struct PhysicsQuery
+	{
+		PhysicsQueryShape shape = PhysicsQueryShape::Ray;
+		Vector3 origin = Vector3::ZERO; /**< Starting position of the ray, or the center of the swept shape. */
+		Vector3 direction = Vector3::UNIT_Z; /**< Unit direction in which to cast the ray or the shape. */
+		float maxDistance = FLT_MAX; /**< Maximum distance to search for hits. */
+		UINT64 layer = BS_ALL_LAYERS; /**< Layers to search in. */
+
+		/**
+		 * Size of the swept shape. Sphere radius is stored in x. Box half-extents are stored in all components. Capsule
+		 * radius is stored in x and its half-height (excluding the caps) in y.
+		 */
+		Vector3 size = Vector3::ZERO;
+
+		/** Orientation of a swept box or capsule. The capsule is aligned with the Y axis before rotation. */
+		Quaternion rotation = Quaternion::IDENTITY;
+	};
+
+	/** Result of a query executed by a PhysicsQueryBatch. */
+	struct PhysicsQueryResult
+	{
+		bool hit = false; /**< True if the query hit something, in which case the hit information is valid. */
+		PhysicsQueryHit info; /**< Information about the closest hit. */
+	};
+
+	/**
+	 * Component that collects ray and shape cast queries from many systems, and executes them all at once in parallel
+	 * against the physics scene. Queries are stored and executed in the order they were added, and their results are
+	 * written into a single contiguous array at the index returned when the query was added.
+	 *
+	 * Queries added during a frame are executed right after the next physics step, when the scene isn't being modified.
+	 * If the simulation is stepped by a PhysicsStepper, provide it through setStepper(). Otherwise the queries are
+	 * executed in this component's fixedUpdate(), so create it after all the other components that implement
+	 * fixedUpdate() and move physics objects. Results remain available until the next batch is executed. If no queries
+	 * were added since the last batch, the previous results are kept.
+	 */
+	class PhysicsQueryBatch : public Component
+	{
+	public:
+		PhysicsQueryBatch(const HSceneObject& parent);
+
+		/** Executes the queries right after the steps executed by the provided stepper. */
+		void setStepper(const HPhysicsStepper& stepper);
+
+		/**
+		 * Determines how many queries are executed by a single worker task. Smaller batches spread the work more evenly
+		 * but have more overhead.
+		 */
+		void setQueriesPerTask(UINT32 count) { mQueriesPerTask = std::max(count, 1U); }
+
+		/** Queues a query for execution and returns the index at which its result will be available. */
+		UINT32 add(const PhysicsQuery& query);
+
+		/** Queues a ray cast. @see add() */
+		UINT32 addRayCast(const Vector3& origin, const Vector3& unitDir, float maxDistance = FLT_MAX,
+			UINT64 layer = BS_ALL_LAYERS);
+
+		/** Queues a sphere sweep. @see add() */
+		UINT32 addSphereCast(const Vector3& center, float radius, const Vector3& unitDir, float maxDistance = FLT_MAX,
+			UINT64 layer = BS_ALL_LAYERS);
+
+		/** Queues a box sweep. @see add() */
+		UINT32 addBoxCast(const Vector3& center, const Vector3& halfExtents, const Quaternion& rotation,
+			const Vector3& unitDir, float maxDistance = FLT_MAX, UINT64 layer = BS_ALL_LAYERS);
+
+		/** Queues a capsule sweep. @see add() */
+		UINT32 addCapsuleCast(const Vector3& center, float radius, float halfHeight, const Quaternion& rotation,
+			const Vector3& unitDir, float maxDistance = FLT_MAX, UINT64 layer = BS_ALL_LAYERS);
+
+		/** Returns the number of queries waiting to be executed. */
+		UINT32 getNumPending() const { return (UINT32)mPending.size(); }
+
+		/** Returns the results of the last executed batch, in the same order the queries were added in. */
+		const Vector<PhysicsQueryResult>& getResults() const { return mResults; }
+
+		/** Returns the result of a query from the last executed batch, using the index returned when it was added. */
+		const PhysicsQueryResult& getResult(UINT32 idx) const { return mResults[idx]; }
+
+		/** Returns the time it took to execute the last batch, in microseconds. */
+		UINT64 getLastExecuteTime() const { return mLastExecuteTime; }
+
+		/** Executes all the queued queries immediately, and makes their results available. */
+		void execute();
+
+		/** @copydoc Component::fixedUpdate */
+		void fixedUpdate() override;
+
+		/** @copydoc Component::onDestroyed */
+		void onDestroyed() override;
+
+		/** Triggered after a batch was executed and its results are available. */
+		Event<void()> onExecuted;
+
+	private:
+		/** Executes the queries in the provided range of the executing batch. */
+		void executeRange(UINT32 start, UINT32 end);
+
+		Vector<PhysicsQuery> mPending;
+		Vector<PhysicsQuery> mExecuting;
+		Vector<PhysicsQueryResult> mResults;
+
+		HEvent mPostStepConn;
+		bool mUseStepper = false;
+		UINT32 mQueriesPerTask = 64;
+		UINT64 mLastExecuteTime = 0;
+	};
+
+	using HPhysicsQueryBatch = GameObjectHandle<PhysicsQueryBatch>;
+}
\ No newline at end of file
@@ -0,0 +1,313 @@
+#include "BsPhysicsRecorder.h"
+#include "BsHash.h"
+#include "Scene/BsSceneObject.h"
+#include "Components/BsCRigidbody.h"
+#include "FileSystem/BsFileSystem.h"
+#include "FileSystem/BsDataStream.h"
+#include "Debug/BsDebug.h"
+
+namespace bs
+{
+	/** Identifier at the start of every log file. */
+	constexpr UINT32 LOG_MAGIC = 0x52504253; // "BSPR"
+
+	/** Version of the log format. Logs with a different version are rejected. */
+	constexpr UINT32 LOG_VERSION = 2;
+
+	/**
+	 * Flags stored at the start of every step entry. The entry then holds the walker input & rotation, the spawns and
+	 * the checksum, in that order, if present.
+	 */
+	enum StepEntryFlags
+	{
+		/** Entry contains a checksum of the simulation state after the step. */
+		STEP_HAS_CHECKSUM = 1 << 0,
+		/** Entry contains the walker input & rotation to use for the step. */
+		STEP_HAS_ROTATION = 1 << 1,
+		/** Entry contains spawns to perform before the step. */
+		STEP_HAS_SPAWNS = 1 << 2
+	};
+
+	/** Precision at which are the positions and rotations quantized when calculating the checksum. */
+	constexpr float CHECKSUM_PRECISION = 1000.0f;
+
+	/** Log header, written once at the start of the file. */
+	struct LogHeader
+	{
+		UINT32 magic;
+		UINT32 version;
+		float fixedStepRate;
+		UINT32 numSubsteps;
+	};
+
+	/** Adds a vector to a FNV-1a hash, quantizing its components first. */
+	void hashCombine(UINT64& hash, const Vector3& value)
+	{
+		for(UINT32 i = 0; i < 3; i++)
+		{
+			const INT32 quantized = (INT32)Math::round(value[i] * CHECKSUM_PRECISION);
+			hash = hashFNV1a(hash, &quantized, sizeof(quantized));
+		}
+	}
+
+	PhysicsRecorder::PhysicsRecorder(const HSceneObject& parent, const HPhysicsStepper& stepper,
+		PhysicsRecorderMode mode, const Path& path)
+		:Component(parent), mStepper(stepper), mMode(mode), mPath(path)
+	{
+		// Set a name for the component, so we can find it later if needed
+		setName("PhysicsRecorder");
+	}
+
+	void PhysicsRecorder::setWalker(const HFPSWalker& walker)
+	{
+		mWalker = walker;
+
+		// Replayed input is applied before every step, but make sure the user can't move the walker in between. Only
+		// done once the log has loaded, otherwise the walker would stay frozen.
+		if(mWalker && mMode == PhysicsRecorderMode::Replay && !mStats.finished)
+			mWalker->setInputOverride(true);
+	}
+
+	void PhysicsRecorder::track(const Vector<HRigidbody>& bodies)
+	{
+		mBodies = bodies;
+	}
+
+	void PhysicsRecorder::queueSpawn(const Vector3& position, const Vector3& velocity)
+	{
+		if(mMode == PhysicsRecorderMode::Record)
+			mQueuedSpawns.push_back({ position, velocity });
+	}
+
+	void PhysicsRecorder::onInitialized()
+	{
+		PhysicsSettings settings = mStepper->getSettings();
+
+		if(mMode == PhysicsRecorderMode::Record)
+		{
+			LogHeader header = { LOG_MAGIC, LOG_VERSION, settings.fixedStepRate, settings.numSubsteps };
+			write(&header, sizeof(header));
+		}
+		else
+		{
+			mStats.finished = true;
+			if(!FileSystem::isFile(mPath))
+			{
+				LOGERR("Cannot find the physics log: " + mPath.toString());
+				return;
+			}
+
+			SPtr<DataStream> stream = FileSystem::openFile(mPath);
+			mData.resize(stream->size());
+
+			if(!mData.empty())
+				stream->read(mData.data(), mData.size());
+
+			stream->close();
+
+			LogHeader header;
+			if(!read(&header, sizeof(header)) || header.magic != LOG_MAGIC || header.version != LOG_VERSION)
+			{
+				LOGERR("Invalid physics log: " + mPath.toString());
+				return;
+			}
+
+			// Replay at the same fixed step the log was recorded with, otherwise the results cannot match
+			settings.fixedStepRate = header.fixedStepRate;
+			settings.numSubsteps = header.numSubsteps;
+			mStepper->setSettings(settings);
+
+			mStats.finished = false;
+
+			if(mWalker)
+				mWalker->setInputOverride(true);
+		}
+
+		mPrepareStepConn = mStepper->onPrepareStep.connect(std::bind(&PhysicsRecorder::prepareStep, this,
+			std::placeholders::_1, std::placeholders::_2));
+		mPostStepConn = mStepper->onPostStep.connect(std::bind(&PhysicsRecorder::postStep, this,
+			std::placeholders::_1, std::placeholders::_2));
+	}
+
+	void PhysicsRecorder::onDestroyed()
+	{
+		mPrepareStepConn.disconnect();
+		mPostStepConn.disconnect();
+
+		if(mWalker)
+			mWalker->setInputOverride(false);
+
+		if(mMode != PhysicsRecorderMode::Record)
+			return;
+
+		SPtr<DataStream> stream = FileSystem::createAndOpenFile(mPath);
+		stream->write(mData.data(), mData.size());
+		stream->close();
+	}
+
+	void PhysicsRecorder::prepareStep(UINT32 stepIdx, float step)
+	{
+		if(mStats.finished)
+			return;
+
+		if(mMode == PhysicsRecorderMode::Record)
+		{
+			const bool storeChecksum = mChecksumInterval > 0 && (mStats.numSteps % mChecksumInterval) == 0;
+
+			mStepFlags = 0;
+			if(storeChecksum) mStepFlags |= STEP_HAS_CHECKSUM;
+			if(mWalker) mStepFlags |= STEP_HAS_ROTATION;
+			if(!mQueuedSpawns.empty() && mProjectilePool) mStepFlags |= STEP_HAS_SPAWNS;
+
+			write(&mStepFlags, sizeof(mStepFlags));
+
+			// Capture the input & rotation the walker is about to move with, and make it use exactly what was recorded
+			if(mWalker)
+			{
+				const FPSWalkerInputFlags inputFlags = mWalker->readInput();
+				mWalker->setInputOverride(true, inputFlags);
+
+				UINT8 input = (UINT8)(UINT32)inputFlags;
+				Quaternion rotation = mWalker->SO()->getTransform().getRotation();
+
+				write(&input, sizeof(input));
+				write(&rotation, sizeof(rotation));
+			}
+
+			if(mStepFlags & STEP_HAS_SPAWNS)
+			{
+				UINT32 numSpawns = (UINT32)mQueuedSpawns.size();
+				write(&numSpawns, sizeof(numSpawns));
+
+				for(auto& entry : mQueuedSpawns)
+				{
+					write(&entry, sizeof(entry));
+					mProjectilePool->spawn(entry.position, entry.velocity);
+				}
+
+				mStats.numSpawns += numSpawns;
+			}
+
+			mQueuedSpawns.clear();
+		}
+		else
+		{
+			if(!read(&mStepFlags, sizeof(mStepFlags)))
+			{
+				// Reached the end of the log, give the control back to the user
+				if(mWalker)
+					mWalker->setInputOverride(false);
+
+				mStats.finished = true;
+				return;
+			}
+
+			if(mStepFlags & STEP_HAS_ROTATION)
+			{
+				UINT8 input = 0;
+				Quaternion rotation;
+				read(&input, sizeof(input));
+				read(&rotation, sizeof(rotation));
+
+				if(mWalker)
+				{
+					mWalker->setInputOverride(true, FPSWalkerInputFlags((FPSWalkerInput)input));
+					mWalker->SO()->setRotation(rotation);
+				}
+			}
+
+			if(mStepFlags & STEP_HAS_SPAWNS)
+			{
+				UINT32 numSpawns = 0;
+				read(&numSpawns, sizeof(numSpawns));
+
+				for(UINT32 i = 0; i < numSpawns; i++)
+				{
+					Spawn spawn;
+					if(!read(&spawn, sizeof(spawn)))
+						break;
+
+					if(mProjectilePool)
+						mProjectilePool->spawn(spawn.position, spawn.velocity);
+				}
+
+				mStats.numSpawns += numSpawns;
+			}
+		}
+	}
+
+	void PhysicsRecorder::postStep(UINT32 stepIdx, float step)
+	{
+		if(mStats.finished)
+			return;
+
+		if(mStepFlags & STEP_HAS_CHECKSUM)
+		{
+			if(mMode == PhysicsRecorderMode::Record)
+			{
+				UINT64 checksum = calculateChecksum();
+				write(&checksum, sizeof(checksum));
+			}
+			else
+			{
+				UINT64 checksum = 0;
+				read(&checksum, sizeof(checksum));
+
+				if(checksum != calculateChecksum())
+				{
+					if(mStats.numMismatches == 0)
+					{
+						mStats.firstMismatchStep = mStats.numSteps;
+						LOGWRN("Physics replay diverged from the recording at step " +
+							toString(mStats.numSteps) + ".");
+					}
+
+					mStats.numMismatches++;
+				}
+			}
+
+			mStats.numChecksums++;
+		}
+
+		mStats.numSteps++;
+	}
+
+	UINT64 PhysicsRecorder::calculateChecksum() const
+	{
+		UINT64 hash = FNV_OFFSET_BASIS;
+		for(auto& entry : mBodies)
+		{
+			if(entry.isDestroyed())
+				continue;
+
+			const Transform& tfrm = entry->SO()->getTransform();
+			hashCombine(hash, tfrm.getPosition());
+
+			// Hash the forward and up directions rather than the quaternion, since q and -q represent the same rotation
+			hashCombine(hash, tfrm.getForward());
+			hashCombine(hash, tfrm.getUp());
+		}
+
+		if(mWalker)
+			hashCombine(hash, mWalker->SO()->getTransform().getPosition());
+
+		return hash;
+	}
+
+	void PhysicsRecorder::write(const void* data, UINT32 size)
+	{
+		const UINT8* bytes = (const UINT8*)data;
+		mData.insert(mData.end(), bytes, bytes + size);
+	}
+
+	bool PhysicsRecorder::read(void* data, UINT32 size)
+	{
+		if(mReadPos + size > (UINT32)mData.size())
+			return false;
+
+		memcpy(data, mData.data() + mReadPos, size);
+		mReadPos += size;
+
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "Scene/BsComponent.h"
+#include "BsPhysicsStepper.h"
+#include "BsProjectilePool.h"
+#include "BsFPSWalker.h"
+
+namespace bs
+{
+	/** Determines what a PhysicsRecorder does with its log. */
+	enum class PhysicsRecorderMode
+	{
+		/** User input and projectile spawns are captured every fixed step and saved to the log when destroyed. */
+		Record,
+		/** Input and spawns are read from the log and applied at the same fixed steps they were recorded at. */
+		Replay
+	};
+
+	/** Information about the progress of a PhysicsRecorder. */
+	struct PhysicsRecorderStats
+	{
+		UINT32 numSteps = 0; /**< Number of fixed steps recorded or replayed so far. */
+		UINT32 numSpawns = 0; /**< Number of projectile spawns recorded or replayed so far. */
+		UINT32 numChecksums = 0; /**< Number of simulation checksums recorded or compared so far. */
+		UINT32 numMismatches = 0; /**< Number of replayed checksums that didn't match the recorded ones. */
+		UINT32 firstMismatchStep = (UINT32)-1; /**< Index of the first step whose checksum didn't match, if any. */
+		bool finished = false; /**< True once the replay has reached the end of the log. */
+	};
+
+	/**
+	 * Component that records the inputs that drive the physics simulation in the example scenes (character movement and
+	 * projectile spawns) at fixed step granularity, and replays them later. While recording a checksum of the tracked
+	 * rigidbody states is periodically stored with the inputs, and compared against during replay. This allows the
+	 * results of the simulation to be compared between runs, for example after changing the physics settings.
+	 *
+	 * Inputs for a step are captured and applied from the stepper's onPrepareStep event, right before the step, so they
+	 * are exactly what the step is simulated with, and are applied before the walker moves in onPreStep. The log is a
+	 * compact binary file holding the step rate and number of sub-steps, followed by a small entry per step.
+	 */
+	class PhysicsRecorder : public Component
+	{
+	public:
+		PhysicsRecorder(const HSceneObject& parent, const HPhysicsStepper& stepper, PhysicsRecorderMode mode,
+			const Path& path);
+
+		/** Sets the pool from which to spawn projectiles. Required for spawns to be recorded or replayed. */
+		void setProjectilePool(const HProjectilePool& pool) { mProjectilePool = pool; }
+
+		/**
+		 * Sets the walker whose input to record or replay. The walker's input is taken over by the recorder, and its
+		 * scene object's rotation is recorded along with the input. During replay the input is only taken over once the
+		 * log has been loaded, and given back once the end of the log is reached.
+		 */
+		void setWalker(const HFPSWalker& walker);
+
+		/**
+		 * Sets the rigidbodies whose state is used for calculating the checksums. Bodies must be provided in the same order
+		 * during recording and replay.
+		 */
+		void track(const Vector<HRigidbody>& bodies);
+
+		/** Determines how often, in fixed steps, is a checksum of the simulation state stored. Zero disables checksums. */
+		void setChecksumInterval(UINT32 interval) { mChecksumInterval = interval; }
+
+		/**
+		 * Queues a projectile spawn that will be performed and recorded before the next fixed step. Ignored during
+		 * replay.
+		 */
+		void queueSpawn(const Vector3& position, const Vector3& velocity);
+
+		/** Returns the mode the recorder is running in. */
+		PhysicsRecorderMode getMode() const { return mMode; }
+
+		/** Returns information about the progress of recording or replay. */
+		const PhysicsRecorderStats& getStats() const { return mStats; }
+
+		/** @copydoc Component::onInitialized */
+		void onInitialized() override;
+
+		/** @copydoc Component::onDestroyed */
+		void onDestroyed() override;
+
+	private:
+		/** Spawn to perform before a fixed step. */
+		struct Spawn
+		{
+			Vector3 position;
+			Vector3 velocity;
+		};
+
+		/** Records or replays the inputs of the step about to be executed. */
+		void prepareStep(UINT32 stepIdx, float step);
+
+		/** Records or compares the checksum of the step that just finished, if the step's entry has one. */
+		void postStep(UINT32 stepIdx, float step);
+
+		/** Calculates a checksum of the current state of the tracked rigidbodies and the walker. */
+		UINT64 calculateChecksum() const;
+
+		/** Appends raw data to the log being recorded. */
+		void write(const void* data, UINT32 size);
+
+		/** Reads raw data from the log being replayed. Returns false if the end of the log was reached. */
+		bool read(void* data, UINT32 size);
+
+		HPhysicsStepper mStepper;
+		HProjectilePool mProjectilePool;
+		HFPSWalker mWalker;
+		Vector<HRigidbody> mBodies;
+		HEvent mPrepareStepConn;
+		HEvent mPostStepConn;
+
+		PhysicsRecorderMode mMode;
+		Path mPath;
+		UINT32 mChecksumInterval = 60;
+
+		Vector<UINT8> mData;
+		UINT32 mReadPos = 0;
+		Vector<Spawn> mQueuedSpawns;
+		UINT8 mStepFlags = 0;
+		PhysicsRecorderStats mStats;
+	};
+
+	using HPhysicsRecorder = GameObjectHandle<PhysicsRecorder>;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "BsPhysicsSettings.h"
+#include "BsCommandLine.h"
+#include "BsParallelFor.h"
+#include "Math/BsMath.h"
+
+namespace bs
+{
+	/** Lowest fixed step rate allowed, in steps per second. */
+	constexpr float MIN_FIXED_STEP_RATE = 10.0f;
+
+	/** Highest fixed step rate allowed, in steps per second. */
+	constexpr float MAX_FIXED_STEP_RATE = 1000.0f;
+
+	/** Highest number of sub-steps allowed per fixed step. */
+	constexpr UINT32 MAX_SUBSTEPS = 16;
+
+	PhysicsSettings PhysicsSettings::fromCommandLine()
+	{
+		PhysicsSettings settings;
+		settings.numWorkerThreads = CommandLine::getUInt("physics-threads", settings.numWorkerThreads);
+		settings.numSubsteps = Math::clamp(CommandLine::getUInt("physics-substeps", settings.numSubsteps), 1U,
+			MAX_SUBSTEPS);
+		settings.fixedStepRate = Math::clamp(CommandLine::getFloat("physics-rate", settings.fixedStepRate),
+			MIN_FIXED_STEP_RATE, MAX_FIXED_STEP_RATE);
+		settings.lockstep = CommandLine::hasOption("physics-lockstep");
+
+		return settings;
+	}
+
+	void PhysicsSettings::applyWorkerThreads() const
+	{
+		setNumTaskWorkers(numWorkerThreads > 0 ? numWorkerThreads : getDefaultNumTaskWorkers());
+	}
+
+	void PhysicsSettings::restoreWorkerThreads()
+	{
+		restoreNumTaskWorkers();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+
+namespace bs
+{
+	/**
+	 * Settings that control how is the physics simulation stepped. Settings can be read from the command line:
+	 * --physics-threads=N - Number of worker threads used by the simulation. 0 keeps the default (one per CPU core).
+	 * --physics-substeps=N - Number of sub-steps each fixed step is split into.
+	 * --physics-rate=N - Number of fixed steps per second.
+	 * --physics-lockstep - Run exactly one fixed step per frame, regardless of how much time has passed.
+	 */
+	struct PhysicsSettings
+	{
+		/**
+		 * Number of worker threads available to the physics simulation. bsf runs the simulation tasks on its global task
+		 * scheduler, so this also limits the number of workers available to other tasks. Zero keeps the default.
+		 */
+		UINT32 numWorkerThreads = 0;
+
+		/** Number of sub-steps each fixed step is split into. Higher values improve stability at a higher cost. */
+		UINT32 numSubsteps = 1;
+
+		/** Number of fixed steps to run per second of simulated time. */
+		float fixedStepRate = 60.0f;
+
+		/**
+		 * If true exactly one fixed step is executed every frame, regardless of how much time has passed. This makes the
+		 * simulation independent of the frame rate, which is useful for benchmarking and replays.
+		 */
+		bool lockstep = false;
+
+		/** Returns the duration of a single fixed step, in seconds. */
+		float getFixedStep() const { return 1.0f / fixedStepRate; }
+
+		/** Returns the duration of a single sub-step, in seconds. */
+		float getSubstep() const { return getFixedStep() / numSubsteps; }
+
+		/** Reads the settings from the command line. Settings not present on the command line keep their defaults. */
+		static PhysicsSettings fromCommandLine();
+
+		/**
+		 * Applies the number of worker threads to the task scheduler. Other settings are applied by the PhysicsStepper
+		 * component.
+		 */
+		void applyWorkerThreads() const;
+
+		/** Restores the number of task scheduler workers to what it was before any settings were applied. */
+		static void restoreWorkerThreads();
+	};
+}
\ No newline at end of file
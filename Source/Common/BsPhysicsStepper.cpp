@@ -0,0 +1,93 @@
+#include "BsPhysicsStepper.h"
+#include "Physics/BsPhysics.h"
+#include "Utility/BsTime.h"
+#include "Utility/BsTimer.h"
+
+namespace bs
+{
+	/**
+	 * Maximum number of fixed steps to execute in a single frame. If the simulation falls further behind the remaining
+	 * time is dropped, so a slow frame doesn't cause even slower frames afterwards.
+	 */
+	constexpr UINT32 MAX_STEPS_PER_FRAME = 8;
+
+	PhysicsStepper::PhysicsStepper(const HSceneObject& parent, const PhysicsSettings& settings)
+		:Component(parent), mSettings(settings)
+	{
+		// Set a name for the component, so we can find it later if needed
+		setName("PhysicsStepper");
+	}
+
+	void PhysicsStepper::setSettings(const PhysicsSettings& settings)
+	{
+		mSettings = settings;
+		mSettings.applyWorkerThreads();
+
+		mAccumulator = 0.0f;
+	}
+
+	void PhysicsStepper::onInitialized()
+	{
+		mSettings.applyWorkerThreads();
+
+		// Stop the engine from stepping the simulation, we'll be doing it ourselves
+		gPhysics().setPaused(true);
+	}
+
+	void PhysicsStepper::onDestroyed()
+	{
+		gPhysics().setPaused(false);
+
+		// Hand the task scheduler back with the number of workers it had before
+		PhysicsSettings::restoreWorkerThreads();
+	}
+
+	void PhysicsStepper::update()
+	{
+		if(mSettings.lockstep)
+		{
+			step();
+			return;
+		}
+
+		const float fixedStep = mSettings.getFixedStep();
+		mAccumulator += gTime().getFrameDelta();
+
+		UINT32 numSteps = 0;
+		while(mAccumulator >= fixedStep && numSteps < MAX_STEPS_PER_FRAME)
+		{
+			step();
+
+			mAccumulator -= fixedStep;
+			numSteps++;
+		}
+
+		if(numSteps == MAX_STEPS_PER_FRAME)
+			mAccumulator = std::min(mAccumulator, fixedStep);
+	}
+
+	void PhysicsStepper::step()
+	{
+		const float fixedStep = mSettings.getFixedStep();
+		const float substep = mSettings.getSubstep();
+
+		onPrepareStep(mStepIdx, fixedStep);
+		onPreStep(mStepIdx, fixedStep);
+
+		Timer timer;
+
+		// The simulation only advances while unpaused, so unpause it just for the duration of our own steps
+		Physics& physics = gPhysics();
+		physics.setPaused(false);
+
+		for(UINT32 i = 0; i < mSettings.numSubsteps; i++)
+			physics.fixedUpdate(substep);
+
+		physics.setPaused(true);
+
+		mLastStepTime = timer.getMicroseconds();
+
+		onPostStep(mStepIdx, fixedStep);
+		mStepIdx++;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "Scene/BsComponent.h"
+#include "Utility/BsEvent.h"
+#include "BsPhysicsSettings.h"
+
+namespace bs
+{
+	/**
+	 * Component that takes over stepping of the physics simulation from the engine, so it can be run at a custom fixed
+	 * rate, split into sub-steps, or locked to one step per frame, as specified by PhysicsSettings. Only one stepper
+	 * should exist at a time. The engine's own stepping is paused while the component is alive.
+	 *
+	 * Other systems can hook into onPrepareStep, onPreStep and onPostStep to perform work in sync with the simulation.
+	 */
+	class PhysicsStepper : public Component
+	{
+	public:
+		PhysicsStepper(const HSceneObject& parent, const PhysicsSettings& settings);
+
+		/** Changes the settings used for stepping, and applies the requested number of worker threads. */
+		void setSettings(const PhysicsSettings& settings);
+
+		/** Returns the settings used for stepping. */
+		const PhysicsSettings& getSettings() const { return mSettings; }
+
+		/** Returns the index of the next fixed step that will be executed. */
+		UINT32 getStepIdx() const { return mStepIdx; }
+
+		/** Returns the time it took to execute the last fixed step, including all sub-steps, in microseconds. */
+		UINT64 getLastStepTime() const { return mLastStepTime; }
+
+		/** @copydoc Component::onInitialized */
+		void onInitialized() override;
+
+		/** @copydoc Component::onDestroyed */
+		void onDestroyed() override;
+
+		/** @copydoc Component::update */
+		void update() override;
+
+		/**
+		 * Triggered before onPreStep, for systems that provide the inputs a fixed step is simulated with, such as
+		 * recorded input. This way they run before the systems consuming the inputs in onPreStep, regardless of the order
+		 * the events were connected in. Provides the index and the duration of the step.
+		 */
+		Event<void(UINT32, float)> onPrepareStep;
+
+		/** Triggered right before a fixed step is executed. Provides the index and the duration of the step. */
+		Event<void(UINT32, float)> onPreStep;
+
+		/** Triggered right after a fixed step was executed. Provides the index and the duration of the step. */
+		Event<void(UINT32, float)> onPostStep;
+
+	private:
+		/** Executes a single fixed step, split into the requested number of sub-steps. */
+		void step();
+
+		PhysicsSettings mSettings;
+		float mAccumulator = 0.0f;
+		UINT32 mStepIdx = 0;
+		UINT64 mLastStepTime = 0;
+	};
+
+	using HPhysicsStepper = GameObjectHandle<PhysicsStepper>;
+}
\ No newline at end of file
@@ -0,0 +1,692 @@
+#include "BsProceduralGeometry.h"
+#include "BsParallelFor.h"
+#include "Math/BsMath.h"
+#include "RenderAPI/BsVertexDataDesc.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define BS_PROCEDURAL_GEOMETRY_SSE 1
+#endif
+
+namespace bs
+{
+	/** Number of vertices the attributes are calculated for at once. */
+	constexpr UINT32 LANE_WIDTH = 4;
+
+	/** Approximate number of grid vertices generated by a single task, when generating a grid in parallel. */
+	constexpr UINT32 GRID_VERTICES_PER_TASK = 16384;
+
+	// Thin wrappers over the instruction set, so the kernels below are only written once
+#if BS_PROCEDURAL_GEOMETRY_SSE
+	typedef __m128 LaneFloat;
+
+	LaneFloat laneLoad(const float* data) { return _mm_loadu_ps(data); }
+	void laneStore(float* data, LaneFloat value) { _mm_store_ps(data, value); }
+	LaneFloat laneSet(float value) { return _mm_set1_ps(value); }
+	LaneFloat laneRamp(float start, float step)
+	{
+		return _mm_add_ps(_mm_set1_ps(start), _mm_mul_ps(_mm_set1_ps(step), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f)));
+	}
+	LaneFloat laneAdd(LaneFloat a, LaneFloat b) { return _mm_add_ps(a, b); }
+	LaneFloat laneSub(LaneFloat a, LaneFloat b) { return _mm_sub_ps(a, b); }
+	LaneFloat laneMul(LaneFloat a, LaneFloat b) { return _mm_mul_ps(a, b); }
+	LaneFloat laneDiv(LaneFloat a, LaneFloat b) { return _mm_div_ps(a, b); }
+	LaneFloat laneSqrt(LaneFloat value) { return _mm_sqrt_ps(value); }
+#else
+	struct LaneFloat { float v[LANE_WIDTH]; };
+
+	LaneFloat laneLoad(const float* data) { LaneFloat o; for(UINT32 i = 0; i < LANE_WIDTH; i++) o.v[i] = data[i]; return o; }
+	void laneStore(float* data, LaneFloat value) { for(UINT32 i = 0; i < LANE_WIDTH; i++) data[i] = value.v[i]; }
+	LaneFloat laneSet(float value) { LaneFloat o; for(auto& entry : o.v) entry = value; return o; }
+	LaneFloat laneRamp(float start, float step)
+	{
+		LaneFloat o;
+		for(UINT32 i = 0; i < LANE_WIDTH; i++)
+			o.v[i] = start + step * i;
+
+		return o;
+	}
+	LaneFloat laneAdd(LaneFloat a, LaneFloat b) { for(UINT32 i = 0; i < LANE_WIDTH; i++) a.v[i] += b.v[i]; return a; }
+	LaneFloat laneSub(LaneFloat a, LaneFloat b) { for(UINT32 i = 0; i < LANE_WIDTH; i++) a.v[i] -= b.v[i]; return a; }
+	LaneFloat laneMul(LaneFloat a, LaneFloat b) { for(UINT32 i = 0; i < LANE_WIDTH; i++) a.v[i] *= b.v[i]; return a; }
+	LaneFloat laneDiv(LaneFloat a, LaneFloat b) { for(UINT32 i = 0; i < LANE_WIDTH; i++) a.v[i] /= b.v[i]; return a; }
+	LaneFloat laneSqrt(LaneFloat a) { for(UINT32 i = 0; i < LANE_WIDTH; i++) a.v[i] = std::sqrt(a.v[i]); return a; }
+#endif
+
+	/** Attributes of LANE_WIDTH consecutive vertices, one array per attribute component. */
+	struct alignas(16) VertexLanes
+	{
+		float px[LANE_WIDTH], py[LANE_WIDTH], pz[LANE_WIDTH];
+		float nx[LANE_WIDTH], ny[LANE_WIDTH], nz[LANE_WIDTH];
+		float tx[LANE_WIDTH], ty[LANE_WIDTH], tz[LANE_WIDTH], tw[LANE_WIDTH];
+		float u[LANE_WIDTH], v[LANE_WIDTH];
+	};
+
+#if BS_PROCEDURAL_GEOMETRY_SSE
+	/** Stores the first three components of the value, without touching the memory after them. */
+	void storeFloat3(UINT8* data, __m128 value)
+	{
+		_mm_storel_pi((__m64*)data, value);
+		_mm_store_ss((float*)(data + 8), _mm_movehl_ps(value, value));
+	}
+#endif
+
+	/**
+	 * Writes the attributes of the first @p count vertices in @p lanes to the output, starting at the vertex with the
+	 * provided index. Full sets of lanes are transposed into one register per vertex and written with a single store per
+	 * attribute.
+	 */
+	void writeVertexLanes(const ProceduralVertexOutput& output, UINT32 vertexIdx, const VertexLanes& lanes, UINT32 count)
+	{
+#if BS_PROCEDURAL_GEOMETRY_SSE
+		if(count == LANE_WIDTH)
+		{
+			if(output.positions)
+			{
+				__m128 r0 = _mm_load_ps(lanes.px), r1 = _mm_load_ps(lanes.py), r2 = _mm_load_ps(lanes.pz);
+				__m128 r3 = _mm_setzero_ps();
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+				UINT8* data = output.positions + (size_t)vertexIdx * output.positionStride;
+				storeFloat3(data, r0);
+				storeFloat3(data + output.positionStride, r1);
+				storeFloat3(data + output.positionStride * 2, r2);
+				storeFloat3(data + output.positionStride * 3, r3);
+			}
+
+			if(output.normals)
+			{
+				__m128 r0 = _mm_load_ps(lanes.nx), r1 = _mm_load_ps(lanes.ny), r2 = _mm_load_ps(lanes.nz);
+				__m128 r3 = _mm_setzero_ps();
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+				UINT8* data = output.normals + (size_t)vertexIdx * output.normalStride;
+				storeFloat3(data, r0);
+				storeFloat3(data + output.normalStride, r1);
+				storeFloat3(data + output.normalStride * 2, r2);
+				storeFloat3(data + output.normalStride * 3, r3);
+			}
+
+			if(output.tangents)
+			{
+				__m128 r0 = _mm_load_ps(lanes.tx), r1 = _mm_load_ps(lanes.ty), r2 = _mm_load_ps(lanes.tz);
+				__m128 r3 = _mm_load_ps(lanes.tw);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+				UINT8* data = output.tangents + (size_t)vertexIdx * output.tangentStride;
+				_mm_storeu_ps((float*)data, r0);
+				_mm_storeu_ps((float*)(data + output.tangentStride), r1);
+				_mm_storeu_ps((float*)(data + output.tangentStride * 2), r2);
+				_mm_storeu_ps((float*)(data + output.tangentStride * 3), r3);
+			}
+
+			if(output.uvs)
+			{
+				// Interleave the U & V lanes into pairs, two vertices per register
+				const __m128 u = _mm_load_ps(lanes.u), v = _mm_load_ps(lanes.v);
+				const __m128 low = _mm_unpacklo_ps(u, v);
+				const __m128 high = _mm_unpackhi_ps(u, v);
+
+				UINT8* data = output.uvs + (size_t)vertexIdx * output.uvStride;
+				_mm_storel_pi((__m64*)data, low);
+				_mm_storeh_pi((__m64*)(data + output.uvStride), low);
+				_mm_storel_pi((__m64*)(data + output.uvStride * 2), high);
+				_mm_storeh_pi((__m64*)(data + output.uvStride * 3), high);
+			}
+
+			return;
+		}
+#endif
+
+		for(UINT32 i = 0; i < count; i++)
+		{
+			const size_t idx = vertexIdx + i;
+
+			if(output.positions)
+			{
+				const float value[] = { lanes.px[i], lanes.py[i], lanes.pz[i] };
+				memcpy(output.positions + idx * output.positionStride, value, sizeof(value));
+			}
+
+			if(output.normals)
+			{
+				const float value[] = { lanes.nx[i], lanes.ny[i], lanes.nz[i] };
+				memcpy(output.normals + idx * output.normalStride, value, sizeof(value));
+			}
+
+			if(output.tangents)
+			{
+				const float value[] = { lanes.tx[i], lanes.ty[i], lanes.tz[i], lanes.tw[i] };
+				memcpy(output.tangents + idx * output.tangentStride, value, sizeof(value));
+			}
+
+			if(output.uvs)
+			{
+				const float value[] = { lanes.u[i], lanes.v[i] };
+				memcpy(output.uvs + idx * output.uvStride, value, sizeof(value));
+			}
+		}
+	}
+
+	/** Writes a single index of the provided type. */
+	void writeProceduralIndex(void* indices, IndexType type, UINT32 idx, UINT32 value)
+	{
+		if(type == IT_16BIT)
+			((UINT16*)indices)[idx] = (UINT16)value;
+		else
+			((UINT32*)indices)[idx] = value;
+	}
+
+	/** Writes the two triangles of a quad, as a fan around its corners, which must be in clockwise order. */
+	void writeProceduralQuad(void* indices, IndexType type, UINT32 idx, UINT32 a, UINT32 b, UINT32 c, UINT32 d)
+	{
+		writeProceduralIndex(indices, type, idx + 0, a);
+		writeProceduralIndex(indices, type, idx + 1, b);
+		writeProceduralIndex(indices, type, idx + 2, c);
+		writeProceduralIndex(indices, type, idx + 3, a);
+		writeProceduralIndex(indices, type, idx + 4, c);
+		writeProceduralIndex(indices, type, idx + 5, d);
+	}
+
+	/**
+	 * Returns the cosine & sine of the angle of every vertex around a ring of @p numSegments segments, including a copy
+	 * of the first vertex at the end. The tables are padded to a multiple of the lane width.
+	 */
+	void getRingTables(UINT32 numSegments, Vector<float>& cosines, Vector<float>& sines)
+	{
+		const UINT32 numVertices = numSegments + 1;
+		const UINT32 paddedCount = Math::divideAndRoundUp(numVertices, LANE_WIDTH) * LANE_WIDTH;
+
+		cosines.resize(paddedCount);
+		sines.resize(paddedCount);
+
+		for(UINT32 i = 0; i < paddedCount; i++)
+		{
+			// The last vertex repeats the first one exactly, so the seam doesn't leave a gap
+			const Radian angle((i % numSegments) * Math::TWO_PI / numSegments);
+			cosines[i] = Math::cos(angle);
+			sines[i] = Math::sin(angle);
+		}
+	}
+
+	/**
+	 * Writes a ring of vertices around the Y axis, where the vertex position is @p center plus the ring direction scaled by
+	 * @p radius, and the normal is the ring direction scaled by @p normalScale plus @p normalY. Tangents point along the
+	 * ring. Used for the sphere & the cylinder sides.
+	 */
+	void writeRingVertices(const ProceduralVertexOutput& output, UINT32 vertexIdx, UINT32 numSegments,
+		const Vector<float>& cosines, const Vector<float>& sines, const Vector3& center, float radius, float normalScale,
+		float normalY, float v)
+	{
+		const UINT32 numVertices = numSegments + 1;
+		const float uStep = 1.0f / numSegments;
+
+		VertexLanes lanes;
+		for(UINT32 i = 0; i < numVertices; i += LANE_WIDTH)
+		{
+			const LaneFloat cosine = laneLoad(&cosines[i]);
+			const LaneFloat sine = laneLoad(&sines[i]);
+
+			laneStore(lanes.px, laneAdd(laneSet(center.x), laneMul(cosine, laneSet(radius))));
+			laneStore(lanes.py, laneSet(center.y));
+			laneStore(lanes.pz, laneAdd(laneSet(center.z), laneMul(sine, laneSet(radius))));
+
+			laneStore(lanes.nx, laneMul(cosine, laneSet(normalScale)));
+			laneStore(lanes.ny, laneSet(normalY));
+			laneStore(lanes.nz, laneMul(sine, laneSet(normalScale)));
+
+			laneStore(lanes.tx, laneSub(laneSet(0.0f), sine));
+			laneStore(lanes.ty, laneSet(0.0f));
+			laneStore(lanes.tz, cosine);
+			laneStore(lanes.tw, laneSet(1.0f));
+
+			laneStore(lanes.u, laneRamp(i * uStep, uStep));
+			laneStore(lanes.v, laneSet(v));
+
+			writeVertexLanes(output, vertexIdx + i, lanes, std::min(numVertices - i, LANE_WIDTH));
+		}
+	}
+
+	/**
+	 * Writes the vertices of a flat disc facing up or down, used for the cylinder caps. The first vertex is the center,
+	 * followed by the ring around it.
+	 */
+	void writeDiscVertices(const ProceduralVertexOutput& output, UINT32 vertexIdx, UINT32 numSegments,
+		const Vector<float>& cosines, const Vector<float>& sines, const Vector3& center, float radius, bool up)
+	{
+		const float normalY = up ? 1.0f : -1.0f;
+
+		// The tangent follows the U coordinate along X. The bitangent follows V along Z, which is on the opposite side
+		// of the tangent when looking at the top face.
+		const float bitangentSign = up ? -1.0f : 1.0f;
+
+		VertexLanes lanes;
+		lanes.px[0] = center.x; lanes.py[0] = center.y; lanes.pz[0] = center.z;
+		lanes.nx[0] = 0.0f; lanes.ny[0] = normalY; lanes.nz[0] = 0.0f;
+		lanes.tx[0] = 1.0f; lanes.ty[0] = 0.0f; lanes.tz[0] = 0.0f; lanes.tw[0] = bitangentSign;
+		lanes.u[0] = 0.5f; lanes.v[0] = 0.5f;
+
+		writeVertexLanes(output, vertexIdx, lanes, 1);
+
+		const UINT32 numVertices = numSegments + 1;
+		for(UINT32 i = 0; i < numVertices; i += LANE_WIDTH)
+		{
+			const LaneFloat cosine = laneLoad(&cosines[i]);
+			const LaneFloat sine = laneLoad(&sines[i]);
+
+			laneStore(lanes.px, laneAdd(laneSet(center.x), laneMul(cosine, laneSet(radius))));
+			laneStore(lanes.py, laneSet(center.y));
+			laneStore(lanes.pz, laneAdd(laneSet(center.z), laneMul(sine, laneSet(radius))));
+
+			laneStore(lanes.nx, laneSet(0.0f));
+			laneStore(lanes.ny, laneSet(normalY));
+			laneStore(lanes.nz, laneSet(0.0f));
+
+			laneStore(lanes.tx, laneSet(1.0f));
+			laneStore(lanes.ty, laneSet(0.0f));
+			laneStore(lanes.tz, laneSet(0.0f));
+			laneStore(lanes.tw, laneSet(bitangentSign));
+
+			laneStore(lanes.u, laneAdd(laneSet(0.5f), laneMul(cosine, laneSet(0.5f))));
+			laneStore(lanes.v, laneAdd(laneSet(0.5f), laneMul(sine, laneSet(0.5f))));
+
+			writeVertexLanes(output, vertexIdx + 1 + i, lanes, std::min(numVertices - i, LANE_WIDTH));
+		}
+	}
+
+	/** Parameters of a plane or a height field grid. */
+	struct ProceduralGridDesc
+	{
+		Vector3 center;
+		Vector2 size;
+		UINT32 numCellsX;
+		UINT32 numCellsZ;
+		const std::function<float(float, float)>* height;
+		ProceduralVertexOutput vertices;
+		void* indices;
+		IndexType indexType;
+		UINT32 baseVertex;
+	};
+
+	/**
+	 * Writes the vertices of the grid rows in the [firstRow, lastRow) range, along with the indices of the cells below
+	 * them. Rows can be written in any order, by different threads.
+	 */
+	void writeGridRows(const ProceduralGridDesc& desc, UINT32 firstRow, UINT32 lastRow)
+	{
+		const UINT32 numColumns = desc.numCellsX + 1;
+		const float cellSizeX = desc.size.x / desc.numCellsX;
+		const float cellSizeZ = desc.size.y / desc.numCellsZ;
+		const float startX = -desc.size.x * 0.5f;
+		const float startZ = -desc.size.y * 0.5f;
+
+		// Heights of the rows, along with one extra row & column on every side for calculating the normals, padded so
+		// the lanes never read past the end of a row
+		const UINT32 numHeightRows = lastRow - firstRow + 2;
+		const UINT32 heightPitch = Math::divideAndRoundUp(numColumns + 2, LANE_WIDTH) * LANE_WIDTH + LANE_WIDTH;
+
+		Vector<float> heights(numHeightRows * heightPitch, 0.0f);
+		if(desc.height && *desc.height)
+		{
+			for(UINT32 row = 0; row < numHeightRows; row++)
+			{
+				const float z = startZ + ((INT32)(firstRow + row) - 1) * cellSizeZ;
+				float* rowHeights = &heights[row * heightPitch];
+
+				for(UINT32 column = 0; column < numColumns + 2; column++)
+				{
+					const float x = startX + ((INT32)column - 1) * cellSizeX;
+					rowHeights[column] = (*desc.height)(x, z);
+				}
+			}
+		}
+
+		const LaneFloat invTwoCellSizeX = laneSet(0.5f / cellSizeX);
+		const LaneFloat invTwoCellSizeZ = laneSet(0.5f / cellSizeZ);
+		const LaneFloat zero = laneSet(0.0f);
+		const LaneFloat one = laneSet(1.0f);
+		const float uStep = 1.0f / desc.numCellsX;
+
+		VertexLanes lanes;
+		for(UINT32 row = firstRow; row < lastRow; row++)
+		{
+			const float* above = &heights[(row - firstRow) * heightPitch];
+			const float* current = above + heightPitch;
+			const float* below = current + heightPitch;
+
+			const float z = startZ + row * cellSizeZ;
+			const UINT32 rowVertexIdx = row * numColumns;
+
+			for(UINT32 i = 0; i < numColumns; i += LANE_WIDTH)
+			{
+				// Height slopes from the central differences of the neighboring heights
+				const LaneFloat height = laneLoad(current + i + 1);
+				const LaneFloat slopeX = laneMul(laneSub(laneLoad(current + i + 2), laneLoad(current + i)),
+					invTwoCellSizeX);
+				const LaneFloat slopeZ = laneMul(laneSub(laneLoad(below + i + 1), laneLoad(above + i + 1)),
+					invTwoCellSizeZ);
+
+				laneStore(lanes.px, laneAdd(laneSet(desc.center.x), laneRamp(startX + i * cellSizeX, cellSizeX)));
+				laneStore(lanes.py, laneAdd(laneSet(desc.center.y), height));
+				laneStore(lanes.pz, laneSet(desc.center.z + z));
+
+				// The normal is perpendicular to both slopes: (-slopeX, 1, -slopeZ), normalized
+				const LaneFloat invNormalLength = laneDiv(one,
+					laneSqrt(laneAdd(laneAdd(laneMul(slopeX, slopeX), laneMul(slopeZ, slopeZ)), one)));
+
+				laneStore(lanes.nx, laneMul(laneSub(zero, slopeX), invNormalLength));
+				laneStore(lanes.ny, invNormalLength);
+				laneStore(lanes.nz, laneMul(laneSub(zero, slopeZ), invNormalLength));
+
+				// The tangent follows the slope along X: (1, slopeX, 0), normalized. V runs along +Z, which is on the
+				// opposite side of the tangent when looking at the grid from above.
+				const LaneFloat invTangentLength = laneDiv(one, laneSqrt(laneAdd(laneMul(slopeX, slopeX), one)));
+
+				laneStore(lanes.tx, invTangentLength);
+				laneStore(lanes.ty, laneMul(slopeX, invTangentLength));
+				laneStore(lanes.tz, zero);
+				laneStore(lanes.tw, laneSet(-1.0f));
+
+				laneStore(lanes.u, laneRamp(i * uStep, uStep));
+				laneStore(lanes.v, laneSet(row / (float)desc.numCellsZ));
+
+				writeVertexLanes(desc.vertices, rowVertexIdx + i, lanes, std::min(numColumns - i, LANE_WIDTH));
+			}
+
+			// Cells between this row & the next one
+			if(row < desc.numCellsZ)
+			{
+				UINT32 indexIdx = row * desc.numCellsX * 6;
+				for(UINT32 i = 0; i < desc.numCellsX; i++)
+				{
+					const UINT32 a = desc.baseVertex + rowVertexIdx + i;
+					const UINT32 c = a + numColumns;
+
+					writeProceduralQuad(desc.indices, desc.indexType, indexIdx, a, a + 1, c + 1, c);
+					indexIdx += 6;
+				}
+			}
+		}
+	}
+
+	ProceduralVertexOutput ProceduralVertexOutput::interleaved(UINT8* data, const VertexDataDesc& desc, UINT32 stream)
+	{
+		const UINT32 stride = desc.getVertexStride(stream);
+
+		ProceduralVertexOutput output;
+		if(desc.hasElement(VES_POSITION, 0, stream))
+		{
+			output.positions = data + desc.getElementOffsetFromStream(VES_POSITION, 0, stream);
+			output.positionStride = stride;
+		}
+
+		if(desc.hasElement(VES_NORMAL, 0, stream))
+		{
+			output.normals = data + desc.getElementOffsetFromStream(VES_NORMAL, 0, stream);
+			output.normalStride = stride;
+		}
+
+		if(desc.hasElement(VES_TANGENT, 0, stream))
+		{
+			output.tangents = data + desc.getElementOffsetFromStream(VES_TANGENT, 0, stream);
+			output.tangentStride = stride;
+		}
+
+		if(desc.hasElement(VES_TEXCOORD, 0, stream))
+		{
+			output.uvs = data + desc.getElementOffsetFromStream(VES_TEXCOORD, 0, stream);
+			output.uvStride = stride;
+		}
+
+		return output;
+	}
+
+	ProceduralVertexOutput ProceduralVertexOutput::planar(float* positions, float* normals, float* tangents, float* uvs)
+	{
+		ProceduralVertexOutput output;
+		output.positions = (UINT8*)positions;
+		output.normals = (UINT8*)normals;
+		output.tangents = (UINT8*)tangents;
+		output.uvs = (UINT8*)uvs;
+		output.positionStride = sizeof(float) * 3;
+		output.normalStride = sizeof(float) * 3;
+		output.tangentStride = sizeof(float) * 4;
+		output.uvStride = sizeof(float) * 2;
+
+		return output;
+	}
+
+	ProceduralVertexOutput ProceduralVertexOutput::offset(UINT32 vertexIdx) const
+	{
+		ProceduralVertexOutput output = *this;
+		if(output.positions) output.positions += (size_t)vertexIdx * positionStride;
+		if(output.normals) output.normals += (size_t)vertexIdx * normalStride;
+		if(output.tangents) output.tangents += (size_t)vertexIdx * tangentStride;
+		if(output.uvs) output.uvs += (size_t)vertexIdx * uvStride;
+
+		return output;
+	}
+
+	IndexType ProceduralGeometry::getIndexType(UINT32 numVertices)
+	{
+		return numVertices <= 65536 ? IT_16BIT : IT_32BIT;
+	}
+
+	UINT32 ProceduralGeometry::getIndexSize(IndexType type)
+	{
+		return type == IT_16BIT ? sizeof(UINT16) : sizeof(UINT32);
+	}
+
+	void ProceduralGeometry::getBoxCounts(UINT32& numVertices, UINT32& numIndices)
+	{
+		numVertices = 24;
+		numIndices = 36;
+	}
+
+	void ProceduralGeometry::writeBox(const AABox& box, const ProceduralVertexOutput& vertices, void* indices,
+		IndexType indexType, UINT32 baseVertex)
+	{
+		static const AABox::Corner FACE_CORNERS[6][4] =
+		{
+			{ AABox::NEAR_LEFT_BOTTOM,	AABox::NEAR_RIGHT_BOTTOM,	AABox::NEAR_RIGHT_TOP,		AABox::NEAR_LEFT_TOP },
+			{ AABox::FAR_RIGHT_BOTTOM,	AABox::FAR_LEFT_BOTTOM,		AABox::FAR_LEFT_TOP,		AABox::FAR_RIGHT_TOP },
+			{ AABox::FAR_LEFT_BOTTOM,	AABox::NEAR_LEFT_BOTTOM,	AABox::NEAR_LEFT_TOP,		AABox::FAR_LEFT_TOP },
+			{ AABox::NEAR_RIGHT_BOTTOM,	AABox::FAR_RIGHT_BOTTOM,	AABox::FAR_RIGHT_TOP,		AABox::NEAR_RIGHT_TOP },
+			{ AABox::FAR_LEFT_TOP,		AABox::NEAR_LEFT_TOP,		AABox::NEAR_RIGHT_TOP,		AABox::FAR_RIGHT_TOP },
+			{ AABox::FAR_LEFT_BOTTOM,	AABox::FAR_RIGHT_BOTTOM,	AABox::NEAR_RIGHT_BOTTOM,	AABox::NEAR_LEFT_BOTTOM }
+		};
+
+		static const float FACE_U[] = { 0.0f, 1.0f, 1.0f, 0.0f };
+		static const float FACE_V[] = { 1.0f, 1.0f, 0.0f, 0.0f };
+
+		// Every face is exactly one set of lanes
+		VertexLanes lanes;
+		for(UINT32 face = 0; face < 6; face++)
+		{
+			Vector3 corners[4];
+			for(UINT32 i = 0; i < 4; i++)
+				corners[i] = box.getCorner(FACE_CORNERS[face][i]);
+
+			// U runs from the first corner to the second, and V from the fourth to the first
+			const Vector3 tangent = Vector3::normalize(corners[1] - corners[0]);
+			const Vector3 bitangent = corners[0] - corners[3];
+			const Vector3 normal = Vector3::normalize(tangent.cross(corners[3] - corners[0]));
+			const float bitangentSign = normal.cross(tangent).dot(bitangent) < 0.0f ? -1.0f : 1.0f;
+
+			for(UINT32 i = 0; i < 4; i++)
+			{
+				lanes.px[i] = corners[i].x; lanes.py[i] = corners[i].y; lanes.pz[i] = corners[i].z;
+				lanes.nx[i] = normal.x; lanes.ny[i] = normal.y; lanes.nz[i] = normal.z;
+				lanes.tx[i] = tangent.x; lanes.ty[i] = tangent.y; lanes.tz[i] = tangent.z; lanes.tw[i] = bitangentSign;
+				lanes.u[i] = FACE_U[i]; lanes.v[i] = FACE_V[i];
+			}
+
+			writeVertexLanes(vertices, face * 4, lanes, 4);
+
+			const UINT32 faceVertex = baseVertex + face * 4;
+			writeProceduralIndex(indices, indexType, face * 6 + 0, faceVertex + 2);
+			writeProceduralIndex(indices, indexType, face * 6 + 1, faceVertex + 1);
+			writeProceduralIndex(indices, indexType, face * 6 + 2, faceVertex + 0);
+			writeProceduralIndex(indices, indexType, face * 6 + 3, faceVertex + 0);
+			writeProceduralIndex(indices, indexType, face * 6 + 4, faceVertex + 3);
+			writeProceduralIndex(indices, indexType, face * 6 + 5, faceVertex + 2);
+		}
+	}
+
+	void ProceduralGeometry::getSphereCounts(UINT32 numSegments, UINT32 numRings, UINT32& numVertices,
+		UINT32& numIndices)
+	{
+		numSegments = std::max(numSegments, 3U);
+		numRings = std::max(numRings, 2U);
+
+		numVertices = (numRings + 1) * (numSegments + 1);
+		numIndices = numRings * numSegments * 6;
+	}
+
+	void ProceduralGeometry::writeSphere(const Vector3& center, float radius, UINT32 numSegments, UINT32 numRings,
+		const ProceduralVertexOutput& vertices, void* indices, IndexType indexType, UINT32 baseVertex)
+	{
+		numSegments = std::max(numSegments, 3U);
+		numRings = std::max(numRings, 2U);
+
+		Vector<float> cosines;
+		Vector<float> sines;
+		getRingTables(numSegments, cosines, sines);
+
+		// Every ring is a circle around the Y axis, with the normal pointing away from the center. Rings at the poles
+		// collapse into a single point, but still have a full set of vertices so every one can have its own UV.
+		const UINT32 numRingVertices = numSegments + 1;
+		for(UINT32 ring = 0; ring <= numRings; ring++)
+		{
+			const Radian angle(ring * Math::PI / numRings);
+			const float sine = Math::sin(angle);
+			const float cosine = Math::cos(angle);
+
+			const Vector3 ringCenter = center + Vector3(0.0f, cosine * radius, 0.0f);
+			writeRingVertices(vertices, ring * numRingVertices, numSegments, cosines, sines, ringCenter, sine * radius,
+				sine, cosine, ring / (float)numRings);
+		}
+
+		UINT32 indexIdx = 0;
+		for(UINT32 ring = 0; ring < numRings; ring++)
+		{
+			for(UINT32 segment = 0; segment < numSegments; segment++)
+			{
+				const UINT32 a = baseVertex + ring * numRingVertices + segment;
+				const UINT32 c = a + numRingVertices;
+
+				writeProceduralQuad(indices, indexType, indexIdx, a, c, c + 1, a + 1);
+				indexIdx += 6;
+			}
+		}
+	}
+
+	void ProceduralGeometry::getCylinderCounts(UINT32 numSegments, UINT32& numVertices, UINT32& numIndices)
+	{
+		numSegments = std::max(numSegments, 3U);
+
+		// Two rings for the side, and a ring plus a center vertex for each cap
+		numVertices = (numSegments + 1) * 2 + (numSegments + 2) * 2;
+		numIndices = numSegments * 6 + numSegments * 3 * 2;
+	}
+
+	void ProceduralGeometry::writeCylinder(const Vector3& base, float radius, float height, UINT32 numSegments,
+		const ProceduralVertexOutput& vertices, void* indices, IndexType indexType, UINT32 baseVertex)
+	{
+		numSegments = std::max(numSegments, 3U);
+
+		Vector<float> cosines;
+		Vector<float> sines;
+		getRingTables(numSegments, cosines, sines);
+
+		const Vector3 top = base + Vector3(0.0f, height, 0.0f);
+		const UINT32 numRingVertices = numSegments + 1;
+
+		// Side, with its own rings so the normals point outwards instead of along the caps
+		writeRingVertices(vertices, 0, numSegments, cosines, sines, top, radius, 1.0f, 0.0f, 0.0f);
+		writeRingVertices(vertices, numRingVertices, numSegments, cosines, sines, base, radius, 1.0f, 0.0f, 1.0f);
+
+		UINT32 indexIdx = 0;
+		for(UINT32 segment = 0; segment < numSegments; segment++)
+		{
+			const UINT32 a = baseVertex + segment;
+			const UINT32 c = a + numRingVertices;
+
+			writeProceduralQuad(indices, indexType, indexIdx, a, c, c + 1, a + 1);
+			indexIdx += 6;
+		}
+
+		// Caps, as fans around their center vertex. The bottom one is seen from below, so its winding is reversed.
+		const UINT32 topCapVertex = numRingVertices * 2;
+		const UINT32 bottomCapVertex = topCapVertex + numRingVertices + 1;
+
+		writeDiscVertices(vertices, topCapVertex, numSegments, cosines, sines, top, radius, true);
+		writeDiscVertices(vertices, bottomCapVertex, numSegments, cosines, sines, base, radius, false);
+
+		for(UINT32 segment = 0; segment < numSegments; segment++)
+		{
+			const UINT32 topCenter = baseVertex + topCapVertex;
+			writeProceduralIndex(indices, indexType, indexIdx + 0, topCenter);
+			writeProceduralIndex(indices, indexType, indexIdx + 1, topCenter + 1 + segment);
+			writeProceduralIndex(indices, indexType, indexIdx + 2, topCenter + 2 + segment);
+
+			const UINT32 bottomCenter = baseVertex + bottomCapVertex;
+			writeProceduralIndex(indices, indexType, indexIdx + 3, bottomCenter);
+			writeProceduralIndex(indices, indexType, indexIdx + 4, bottomCenter + 2 + segment);
+			writeProceduralIndex(indices, indexType, indexIdx + 5, bottomCenter + 1 + segment);
+
+			indexIdx += 6;
+		}
+	}
+
+	void ProceduralGeometry::getGridCounts(UINT32 numCellsX, UINT32 numCellsZ, UINT32& numVertices, UINT32& numIndices)
+	{
+		numCellsX = std::max(numCellsX, 1U);
+		numCellsZ = std::max(numCellsZ, 1U);
+
+		numVertices = (numCellsX + 1) * (numCellsZ + 1);
+		numIndices = numCellsX * numCellsZ * 6;
+	}
+
+	void ProceduralGeometry::writePlane(const Vector3& center, const Vector2& size, UINT32 numCellsX, UINT32 numCellsZ,
+		const ProceduralVertexOutput& vertices, void* indices, IndexType indexType, UINT32 baseVertex)
+	{
+		ProceduralGridDesc desc;
+		desc.center = center;
+		desc.size = size;
+		desc.numCellsX = std::max(numCellsX, 1U);
+		desc.numCellsZ = std::max(numCellsZ, 1U);
+		desc.height = nullptr;
+		desc.vertices = vertices;
+		desc.indices = indices;
+		desc.indexType = indexType;
+		desc.baseVertex = baseVertex;
+
+		writeGridRows(desc, 0, desc.numCellsZ + 1);
+	}
+
+	void ProceduralGeometry::writeGrid(const Vector3& center, const Vector2& size, UINT32 numCellsX, UINT32 numCellsZ,
+		const std::function<float(float, float)>& height, const ProceduralVertexOutput& vertices, void* indices,
+		IndexType indexType, UINT32 baseVertex)
+	{
+		ProceduralGridDesc desc;
+		desc.center = center;
+		desc.size = size;
+		desc.numCellsX = std::max(numCellsX, 1U);
+		desc.numCellsZ = std::max(numCellsZ, 1U);
+		desc.height = &height;
+		desc.vertices = vertices;
+		desc.indices = indices;
+		desc.indexType = indexType;
+		desc.baseVertex = baseVertex;
+
+		// Every task writes a band of whole rows, so the tasks never write the same vertices or indices
+		const UINT32 numRows = desc.numCellsZ + 1;
+		const UINT32 rowsPerTask = std::max(GRID_VERTICES_PER_TASK / (desc.numCellsX + 1), 1U);
+
+		parallelFor(numRows, rowsPerTask, [&desc](UINT32 start, UINT32 end)
+		{
+			writeGridRows(desc, start, end);
+		});
+	}
+}
\ No newline at end of file
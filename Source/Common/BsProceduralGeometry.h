@@ -0,0 +1,116 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "Math/BsAABox.h"
+
+namespace bs
+{
+	/**
+	 * Locations to write the vertex attributes generated by ProceduralGeometry to. Every attribute has its own pointer and
+	 * stride, so the same description covers interleaved buffers, where all the attributes share one stride, and planar
+	 * buffers, where every attribute is a tightly packed array. Attributes with a null pointer are not written.
+	 */
+	struct ProceduralVertexOutput
+	{
+		UINT8* positions = nullptr; /**< Positions, as three floats. */
+		UINT8* normals = nullptr; /**< Normals, as three floats. */
+		UINT8* tangents = nullptr; /**< Tangents, as four floats with the sign of the bitangent in the last one. */
+		UINT8* uvs = nullptr; /**< Texture coordinates, as two floats. */
+
+		UINT32 positionStride = 0;
+		UINT32 normalStride = 0;
+		UINT32 tangentStride = 0;
+		UINT32 uvStride = 0;
+
+		/**
+		 * Creates an output writing to a buffer with the vertex layout of the provided stream. The attributes are found
+		 * by their semantics, and the ones the layout doesn't have are not written. Positions & normals must be FLOAT3,
+		 * tangents FLOAT4 and UVs FLOAT2.
+		 */
+		static ProceduralVertexOutput interleaved(UINT8* data, const VertexDataDesc& desc, UINT32 stream = 0);
+
+		/** Creates an output writing every attribute to its own tightly packed array. Any of them can be null. */
+		static ProceduralVertexOutput planar(float* positions, float* normals, float* tangents, float* uvs);
+
+		/** Returns an output that starts writing at the vertex with the provided index. */
+		ProceduralVertexOutput offset(UINT32 vertexIdx) const;
+	};
+
+	/**
+	 * Generates the vertices & indices of simple shapes directly into vertex & index buffers, along with their normals,
+	 * tangents & texture coordinates. Each shape has a method returning the number of vertices & indices it needs, so the
+	 * buffers can be allocated up front, and a method writing it.
+	 *
+	 * The attributes are calculated several vertices at once using SIMD, and written with one store per attribute. All
+	 * shapes face outwards with clockwise winding. Indices are written relative to @p baseVertex, so many shapes can be
+	 * written into the same buffers. Use getIndexType() to pick the smallest index type that fits the vertex count.
+	 */
+	class ProceduralGeometry
+	{
+	public:
+		/** Returns 16-bit indices if the provided number of vertices can be indexed with them, or 32-bit otherwise. */
+		static IndexType getIndexType(UINT32 numVertices);
+
+		/** Returns the size of a single index of the provided type, in bytes. */
+		static UINT32 getIndexSize(IndexType type);
+
+		/** Returns the number of vertices & indices of a box. */
+		static void getBoxCounts(UINT32& numVertices, UINT32& numIndices);
+
+		/** Writes an axis aligned box, with four vertices per face so every face has its own normal & texture. */
+		static void writeBox(const AABox& box, const ProceduralVertexOutput& vertices, void* indices,
+			IndexType indexType, UINT32 baseVertex = 0);
+
+		/** Returns the number of vertices & indices of a sphere with the provided tessellation. */
+		static void getSphereCounts(UINT32 numSegments, UINT32 numRings, UINT32& numVertices, UINT32& numIndices);
+
+		/**
+		 * Writes a sphere made out of rings of vertices, from the top pole to the bottom one.
+		 *
+		 * @param[in]	center			Center of the sphere.
+		 * @param[in]	radius			Radius of the sphere.
+		 * @param[in]	numSegments		Number of vertices around every ring, at least 3.
+		 * @param[in]	numRings		Number of rings between the poles, at least 2.
+		 * @param[in]	vertices		Output to write the vertices to.
+		 * @param[in]	indices			Output to write the indices to.
+		 * @param[in]	indexType		Type of the indices.
+		 * @param[in]	baseVertex		Value to add to every index.
+		 */
+		static void writeSphere(const Vector3& center, float radius, UINT32 numSegments, UINT32 numRings,
+			const ProceduralVertexOutput& vertices, void* indices, IndexType indexType, UINT32 baseVertex = 0);
+
+		/** Returns the number of vertices & indices of a cylinder with the provided tessellation. */
+		static void getCylinderCounts(UINT32 numSegments, UINT32& numVertices, UINT32& numIndices);
+
+		/** Writes a capped cylinder standing on @p base, along the Y axis, with @p numSegments (at least 3) sides. */
+		static void writeCylinder(const Vector3& base, float radius, float height, UINT32 numSegments,
+			const ProceduralVertexOutput& vertices, void* indices, IndexType indexType, UINT32 baseVertex = 0);
+
+		/** Returns the number of vertices & indices of a plane or a grid with the provided number of cells. */
+		static void getGridCounts(UINT32 numCellsX, UINT32 numCellsZ, UINT32& numVertices, UINT32& numIndices);
+
+		/** Writes a flat plane in the XZ plane, facing up, split into the provided number of cells along each axis. */
+		static void writePlane(const Vector3& center, const Vector2& size, UINT32 numCellsX, UINT32 numCellsZ,
+			const ProceduralVertexOutput& vertices, void* indices, IndexType indexType, UINT32 baseVertex = 0);
+
+		/**
+		 * Writes a height field grid in the XZ plane, such as a terrain. Normals & tangents are calculated from the
+		 * differences between neighboring heights. Rows of the grid are generated in parallel using the task scheduler
+		 * workers, so large grids are written several times faster.
+		 *
+		 * @param[in]	center			Center of the grid, at height zero.
+		 * @param[in]	size			Size of the grid along the X & Z axes.
+		 * @param[in]	numCellsX		Number of cells along the X axis.
+		 * @param[in]	numCellsZ		Number of cells along the Z axis.
+		 * @param[in]	height			Returns the height of the grid at the provided X & Z position, relative to the
+		 *								center. Called from multiple threads at once.
+		 * @param[in]	vertices		Output to write the vertices to.
+		 * @param[in]	indices			Output to write the indices to.
+		 * @param[in]	indexType		Type of the indices.
+		 * @param[in]	baseVertex		Value to add to every index.
+		 */
+		static void writeGrid(const Vector3& center, const Vector2& size, UINT32 numCellsX, UINT32 numCellsZ,
+			const std::function<float(float, float)>& height, const ProceduralVertexOutput& vertices, void* indices,
+			IndexType indexType, UINT32 baseVertex = 0);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "BsProjectilePool.h"
+#include "Scene/BsSceneObject.h"
+#include "Components/BsCRenderable.h"
+#include "Components/BsCSphereCollider.h"
+#include "Components/BsCRigidbody.h"
+#include "Utility/BsTimer.h"
+
+namespace bs
+{
+	/** Location below the floor at which unused projectiles are parked, before they are spawned for the first time. */
+	constexpr float PARKING_DEPTH = -1000.0f;
+
+	/** Distance between the parked projectiles, so they don't overlap while waiting to be used. */
+	constexpr float PARKING_SPACING = 2.0f;
+
+	ProjectilePool::ProjectilePool(const HSceneObject& parent, const PROJECTILE_POOL_DESC& desc)
+		:Component(parent), mDesc(desc)
+	{
+		// Set a name for the component, so we can find it later if needed
+		setName("ProjectilePool");
+	}
+
+	void ProjectilePool::onInitialized()
+	{
+		// Create all the projectiles up front, so no physics actors need to be created while the user is shooting
+		mProjectiles.resize(mDesc.capacity);
+		for(UINT32 i = 0; i < mDesc.capacity; i++)
+		{
+			Projectile& projectile = mProjectiles[i];
+
+			// Create the scene object and renderable geometry of the projectile
+			projectile.so = SceneObject::create("Projectile");
+
+			HRenderable renderable = projectile.so->addComponent<CRenderable>();
+			renderable->setMesh(mDesc.mesh);
+			renderable->setMaterial(mDesc.material);
+
+			// Create a spherical collider, represting physical geometry
+			HSphereCollider collider = projectile.so->addComponent<CSphereCollider>();
+			collider->setMaterial(mDesc.physicsMaterial);
+			collider->setMass(mDesc.mass);
+
+			// Add a rigidbody, but keep it kinematic while parked so it doesn't fall or collide with other parked
+			// projectiles
+			projectile.rigidbody = projectile.so->addComponent<CRigidbody>();
+			projectile.rigidbody->setIsKinematic(true);
+
+			projectile.so->setScale(Vector3::ONE * mDesc.scale);
+			projectile.so->setWorldPosition(Vector3(i * PARKING_SPACING, PARKING_DEPTH, 0.0f));
+		}
+	}
+
+	void ProjectilePool::onDestroyed()
+	{
+		for(auto& entry : mProjectiles)
+		{
+			if(!entry.so.isDestroyed())
+				entry.so->destroy();
+		}
+
+		mProjectiles.clear();
+	}
+
+	HSceneObject ProjectilePool::spawn(const Vector3& position, const Vector3& velocity)
+	{
+		if(mProjectiles.empty())
+			return HSceneObject();
+
+		Timer timer;
+
+		const UINT32 idx = findProjectileToSpawn();
+		Projectile& projectile = mProjectiles[idx];
+
+		// Reset the rigidbody state. Note we never disable the scene object or remove the components, as that would
+		// destroy the internal physics actor which would then need to be re-created on the next spawn.
+		projectile.rigidbody->setIsKinematic(false);
+		projectile.so->setWorldPosition(position);
+		projectile.so->setWorldRotation(Quaternion::IDENTITY);
+
+		projectile.rigidbody->setVelocity(velocity);
+		projectile.rigidbody->setAngularVelocity(Vector3::ZERO);
+		projectile.rigidbody->wakeUp();
+
+		projectile.spawnIdx = mNextSpawnIdx++;
+
+		// Update statistics
+		const UINT64 latency = timer.getMicroseconds();
+
+		mStats.numSpawned++;
+		mStats.lastSpawnLatency = latency;
+		mStats.maxSpawnLatency = std::max(mStats.maxSpawnLatency, latency);
+		mStats.totalSpawnLatency += latency;
+
+		return projectile.so;
+	}
+
+	Vector<HRigidbody> ProjectilePool::getRigidbodies() const
+	{
+		Vector<HRigidbody> output;
+		output.reserve(mProjectiles.size());
+
+		for(auto& entry : mProjectiles)
+			output.push_back(entry.rigidbody);
+
+		return output;
+	}
+
+	UINT32 ProjectilePool::findProjectileToSpawn()
+	{
+		// Prefer projectiles that were never used, then the oldest sleeping projectile, and finally the oldest projectile
+		UINT32 oldestIdx = 0;
+		UINT32 oldestSleepingIdx = (UINT32)-1;
+		for(UINT32 i = 0; i < (UINT32)mProjectiles.size(); i++)
+		{
+			const Projectile& projectile = mProjectiles[i];
+			if(projectile.spawnIdx == 0)
+				return i;
+
+			if(projectile.spawnIdx < mProjectiles[oldestIdx].spawnIdx)
+				oldestIdx = i;
+
+			if(projectile.rigidbody->isSleeping())
+			{
+				if(oldestSleepingIdx == (UINT32)-1 || projectile.spawnIdx < mProjectiles[oldestSleepingIdx].spawnIdx)
+					oldestSleepingIdx = i;
+			}
+		}
+
+		if(oldestSleepingIdx != (UINT32)-1)
+		{
+			mStats.numRecycledSleeping++;
+			return oldestSleepingIdx;
+		}
+
+		mStats.numRecycledOldest++;
+		return oldestIdx;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "Scene/BsComponent.h"
+
+namespace bs
+{
+	/** Information used for initializing a ProjectilePool. */
+	struct PROJECTILE_POOL_DESC
+	{
+		/** Number of projectiles to create up front. The pool never grows beyond this number. */
+		UINT32 capacity = 32;
+
+		/** Mesh used for rendering the projectiles. */
+		HMesh mesh;
+
+		/** Material used for rendering the projectiles. */
+		HMaterial material;
+
+		/** Physics material to apply to the projectile colliders. */
+		HPhysicsMaterial physicsMaterial;
+
+		/** Mass of a single projectile, in kilograms. */
+		float mass = 25.0f;
+
+		/** Uniform scale to apply to the projectile scene objects. */
+		float scale = 0.3f;
+	};
+
+	/** Statistics about projectiles spawned through a ProjectilePool. */
+	struct ProjectilePoolStats
+	{
+		UINT32 numSpawned = 0; /**< Total number of spawn() calls. */
+		UINT32 numRecycledSleeping = 0; /**< Number of spawns that reused a sleeping projectile. */
+		UINT32 numRecycledOldest = 0; /**< Number of spawns that had to reuse the oldest awake projectile. */
+		UINT64 lastSpawnLatency = 0; /**< Time it took to perform the last spawn, in microseconds. */
+		UINT64 maxSpawnLatency = 0; /**< Longest time a single spawn took, in microseconds. */
+		UINT64 totalSpawnLatency = 0; /**< Sum of all spawn times, in microseconds. */
+
+		/** Returns the average time a spawn took, in microseconds. */
+		float getAverageSpawnLatency() const
+		{
+			return numSpawned > 0 ? totalSpawnLatency / (float)numSpawned : 0.0f;
+		}
+	};
+
+	/**
+	 * Component that pre-creates a fixed number of spherical projectiles (renderable, sphere collider and rigidbody) and
+	 * hands them out on request. When all projectiles are in use the pool recycles a sleeping projectile if one exists,
+	 * or the oldest one otherwise. Recycled projectiles keep their physics actors, only their rigidbody state is reset.
+	 */
+	class ProjectilePool : public Component
+	{
+	public:
+		ProjectilePool(const HSceneObject& parent, const PROJECTILE_POOL_DESC& desc);
+
+		/**
+		 * Places a projectile at the provided world position and launches it with the provided velocity. Returns the
+		 * scene object of the projectile that was spawned.
+		 */
+		HSceneObject spawn(const Vector3& position, const Vector3& velocity);
+
+		/** Returns statistics about the spawns performed so far. */
+		const ProjectilePoolStats& getStats() const { return mStats; }
+
+		/** Returns the rigidbodies of all the projectiles in the pool, whether they were spawned or not. */
+		Vector<HRigidbody> getRigidbodies() const;
+
+		/** Returns the maximum number of projectiles the pool can have in the scene at once. */
+		UINT32 getCapacity() const { return (UINT32)mProjectiles.size(); }
+
+		/** @copydoc Component::onInitialized */
+		void onInitialized() override;
+
+		/** @copydoc Component::onDestroyed */
+		void onDestroyed() override;
+
+	private:
+		/** Single pooled projectile. */
+		struct Projectile
+		{
+			HSceneObject so;
+			HRigidbody rigidbody;
+			UINT64 spawnIdx = 0; /**< Sequential index of the spawn that last used this projectile. 0 if never used. */
+		};
+
+		/** Picks the projectile to use for the next spawn, according to the recycling rules. */
+		UINT32 findProjectileToSpawn();
+
+		PROJECTILE_POOL_DESC mDesc;
+		Vector<Projectile> mProjectiles;
+		UINT64 mNextSpawnIdx = 1;
+		ProjectilePoolStats mStats;
+	};
+
+	using HProjectilePool = GameObjectHandle<ProjectilePool>;
+}
\ No newline at end of file
@@ -0,0 +1,703 @@
+#include "BsSimdParticles.h"
+#include "BsCpuVectorField.h"
+#include "Image/BsColor.h"
+#include "Math/BsMath.h"
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define BS_SIMD_PARTICLES_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define BS_SIMD_PARTICLES_SSE 1
+#endif
+
+namespace bs
+{
+	// Thin wrappers over the instruction set the kernels are compiled for, so each kernel only needs to be written once
+#if BS_SIMD_PARTICLES_AVX2
+	typedef __m256 SimdFloat;
+	typedef __m256i SimdInt;
+	constexpr UINT32 SIMD_WIDTH = 8;
+
+	SimdFloat simdLoad(const float* data) { return _mm256_loadu_ps(data); }
+	void simdStore(float* data, SimdFloat value) { _mm256_storeu_ps(data, value); }
+	SimdFloat simdSet(float value) { return _mm256_set1_ps(value); }
+	SimdFloat simdAdd(SimdFloat a, SimdFloat b) { return _mm256_add_ps(a, b); }
+	SimdFloat simdSub(SimdFloat a, SimdFloat b) { return _mm256_sub_ps(a, b); }
+	SimdFloat simdMul(SimdFloat a, SimdFloat b) { return _mm256_mul_ps(a, b); }
+	SimdFloat simdDiv(SimdFloat a, SimdFloat b) { return _mm256_div_ps(a, b); }
+	SimdFloat simdMin(SimdFloat a, SimdFloat b) { return _mm256_min_ps(a, b); }
+	SimdFloat simdMax(SimdFloat a, SimdFloat b) { return _mm256_max_ps(a, b); }
+	SimdFloat simdLessEqual(SimdFloat a, SimdFloat b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+	SimdFloat simdLess(SimdFloat a, SimdFloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	SimdFloat simdAnd(SimdFloat a, SimdFloat b) { return _mm256_and_ps(a, b); }
+	SimdFloat simdSelect(SimdFloat mask, SimdFloat a, SimdFloat b) { return _mm256_blendv_ps(b, a, mask); }
+	SimdInt simdTruncate(SimdFloat value) { return _mm256_cvttps_epi32(value); }
+	SimdFloat simdToFloat(SimdInt value) { return _mm256_cvtepi32_ps(value); }
+	SimdFloat simdGather(const float* table, SimdInt indices) { return _mm256_i32gather_ps(table, indices, 4); }
+	SimdInt simdAddOne(SimdInt value) { return _mm256_add_epi32(value, _mm256_set1_epi32(1)); }
+#elif BS_SIMD_PARTICLES_SSE
+	typedef __m128 SimdFloat;
+	typedef __m128i SimdInt;
+	constexpr UINT32 SIMD_WIDTH = 4;
+
+	SimdFloat simdLoad(const float* data) { return _mm_loadu_ps(data); }
+	void simdStore(float* data, SimdFloat value) { _mm_storeu_ps(data, value); }
+	SimdFloat simdSet(float value) { return _mm_set1_ps(value); }
+	SimdFloat simdAdd(SimdFloat a, SimdFloat b) { return _mm_add_ps(a, b); }
+	SimdFloat simdSub(SimdFloat a, SimdFloat b) { return _mm_sub_ps(a, b); }
+	SimdFloat simdMul(SimdFloat a, SimdFloat b) { return _mm_mul_ps(a, b); }
+	SimdFloat simdDiv(SimdFloat a, SimdFloat b) { return _mm_div_ps(a, b); }
+	SimdFloat simdMin(SimdFloat a, SimdFloat b) { return _mm_min_ps(a, b); }
+	SimdFloat simdMax(SimdFloat a, SimdFloat b) { return _mm_max_ps(a, b); }
+	SimdFloat simdLessEqual(SimdFloat a, SimdFloat b) { return _mm_cmple_ps(a, b); }
+	SimdFloat simdLess(SimdFloat a, SimdFloat b) { return _mm_cmplt_ps(a, b); }
+	SimdFloat simdAnd(SimdFloat a, SimdFloat b) { return _mm_and_ps(a, b); }
+	SimdFloat simdSelect(SimdFloat mask, SimdFloat a, SimdFloat b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+	SimdInt simdTruncate(SimdFloat value) { return _mm_cvttps_epi32(value); }
+	SimdFloat simdToFloat(SimdInt value) { return _mm_cvtepi32_ps(value); }
+	SimdFloat simdGather(const float* table, SimdInt indices)
+	{
+		// SSE has no gather instruction, so the lookups are done one by one
+		alignas(16) INT32 idx[4];
+		_mm_store_si128((__m128i*)idx, indices);
+
+		return _mm_set_ps(table[idx[3]], table[idx[2]], table[idx[1]], table[idx[0]]);
+	}
+	SimdInt simdAddOne(SimdInt value) { return _mm_add_epi32(value, _mm_set1_epi32(1)); }
+#else
+	typedef float SimdFloat;
+	typedef INT32 SimdInt;
+	constexpr UINT32 SIMD_WIDTH = 1;
+
+	SimdFloat simdLoad(const float* data) { return *data; }
+	void simdStore(float* data, SimdFloat value) { *data = value; }
+	SimdFloat simdSet(float value) { return value; }
+	SimdFloat simdAdd(SimdFloat a, SimdFloat b) { return a + b; }
+	SimdFloat simdSub(SimdFloat a, SimdFloat b) { return a - b; }
+	SimdFloat simdMul(SimdFloat a, SimdFloat b) { return a * b; }
+	SimdFloat simdDiv(SimdFloat a, SimdFloat b) { return a / b; }
+	SimdFloat simdMin(SimdFloat a, SimdFloat b) { return std::min(a, b); }
+	SimdFloat simdMax(SimdFloat a, SimdFloat b) { return std::max(a, b); }
+	SimdFloat simdLessEqual(SimdFloat a, SimdFloat b) { return a <= b ? 1.0f : 0.0f; }
+	SimdFloat simdLess(SimdFloat a, SimdFloat b) { return a < b ? 1.0f : 0.0f; }
+	SimdFloat simdAnd(SimdFloat a, SimdFloat b) { return (a != 0.0f && b != 0.0f) ? 1.0f : 0.0f; }
+	SimdFloat simdSelect(SimdFloat mask, SimdFloat a, SimdFloat b) { return mask != 0.0f ? a : b; }
+	SimdInt simdTruncate(SimdFloat value) { return (INT32)value; }
+	SimdFloat simdToFloat(SimdInt value) { return (float)value; }
+	SimdFloat simdGather(const float* table, SimdInt indices) { return table[indices]; }
+	SimdInt simdAddOne(SimdInt value) { return value + 1; }
+#endif
+
+	/**
+	 * Number of particles processed by every evolver pass before moving on to the next pass. Keeps the attributes touched
+	 * by consecutive passes in the cache.
+	 */
+	constexpr UINT32 BLOCK_SIZE = 1024;
+
+	/** Samples a lookup table at the provided times, for SIMD_WIDTH particles at once. */
+	SimdFloat sampleCurve(const SimdParticleCurve& curve, SimdFloat t)
+	{
+		const float* samples = curve.samples.data();
+		const float maxIdx = (float)(curve.samples.size() - 2);
+
+		const SimdFloat x = simdMul(t, simdSet(maxIdx));
+		const SimdInt idx = simdTruncate(x);
+		const SimdFloat frac = simdSub(x, simdToFloat(idx));
+
+		const SimdFloat a = simdGather(samples, idx);
+		const SimdFloat b = simdGather(samples, simdAddOne(idx));
+
+		return simdAdd(a, simdMul(simdSub(b, a), frac));
+	}
+
+	/** Rounds the values down to the nearest integer. */
+	SimdFloat simdFloor(SimdFloat value)
+	{
+		const SimdFloat truncated = simdToFloat(simdTruncate(value));
+		return simdSelect(simdLess(value, truncated), simdSub(truncated, simdSet(1.0f)), truncated);
+	}
+
+	/** Linearly interpolates between two sets of values. */
+	SimdFloat simdLerp(SimdFloat a, SimdFloat b, SimdFloat t)
+	{
+		return simdAdd(a, simdMul(simdSub(b, a), t));
+	}
+
+	/**
+	 * Transformation from particle positions to vector field texel coordinates, and from vector field values to particle
+	 * forces, calculated once per simulate() call.
+	 */
+	struct VectorFieldTransform
+	{
+		const CpuVectorField* field = nullptr;
+		Vector3 origin; /**< Position of the vector field, in the same space as the particles. */
+		float toTexel[3][3]; /**< Rotation and scale from positions relative to the origin, to texel coordinates. */
+		float texelOffset[3]; /**< Offset applied after the rotation and scale. */
+		float counts[3]; /**< Number of texels along each axis. */
+		bool tiling[3];
+		float toWorld[3][3]; /**< Rotation and intensity applied to the sampled values. */
+	};
+
+	/** Calculates the texel coordinates to interpolate between along a single axis, matching GPU texture sampling. */
+	void getSimdSampleTexels(SimdFloat coord, float count, bool tile, SimdFloat& texel0, SimdFloat& texel1,
+		SimdFloat& frac)
+	{
+		const SimdFloat zero = simdSet(0.0f);
+		const SimdFloat one = simdSet(1.0f);
+		const SimdFloat countV = simdSet(count);
+		const SimdFloat last = simdSet(count - 1.0f);
+
+		if(tile)
+		{
+			coord = simdSub(coord, simdMul(simdFloor(simdDiv(coord, countV)), countV));
+
+			texel0 = simdMin(simdFloor(coord), last);
+			texel1 = simdAdd(texel0, one);
+			texel1 = simdSelect(simdLess(texel1, countV), texel1, zero);
+			frac = simdSub(coord, simdFloor(coord));
+		}
+		else
+		{
+			coord = simdMin(simdMax(coord, zero), last);
+
+			texel0 = simdFloor(coord);
+			texel1 = simdMin(simdAdd(texel0, one), last);
+			frac = simdSub(coord, texel0);
+		}
+	}
+
+	/** Samples the vector field at the provided positions, and returns the resulting forces. */
+	void sampleVectorField(const VectorFieldTransform& transform, SimdFloat posX, SimdFloat posY, SimdFloat posZ,
+		SimdFloat& forceX, SimdFloat& forceY, SimdFloat& forceZ)
+	{
+		const SimdFloat relX = simdSub(posX, simdSet(transform.origin.x));
+		const SimdFloat relY = simdSub(posY, simdSet(transform.origin.y));
+		const SimdFloat relZ = simdSub(posZ, simdSet(transform.origin.z));
+
+		SimdFloat texel0[3], texel1[3], frac[3];
+		for(UINT32 i = 0; i < 3; i++)
+		{
+			const SimdFloat coord = simdAdd(simdAdd(simdAdd(
+				simdMul(relX, simdSet(transform.toTexel[i][0])),
+				simdMul(relY, simdSet(transform.toTexel[i][1]))),
+				simdMul(relZ, simdSet(transform.toTexel[i][2]))),
+				simdSet(transform.texelOffset[i]));
+
+			getSimdSampleTexels(coord, transform.counts[i], transform.tiling[i], texel0[i], texel1[i], frac[i]);
+		}
+
+		// Indices of the 8 surrounding values. Texel counts are small enough that the indices are exact as floats.
+		const SimdFloat rowSize = simdSet(transform.counts[0]);
+		const SimdFloat sliceSize = simdSet(transform.counts[0] * transform.counts[1]);
+
+		const SimdFloat rows[2] = { simdMul(texel0[1], rowSize), simdMul(texel1[1], rowSize) };
+		const SimdFloat slices[2] = { simdMul(texel0[2], sliceSize), simdMul(texel1[2], sliceSize) };
+		const SimdFloat columns[2] = { texel0[0], texel1[0] };
+
+		const float* values[3] = { transform.field->getValuesX().data(), transform.field->getValuesY().data(),
+			transform.field->getValuesZ().data() };
+
+		SimdFloat sampled[3];
+		for(UINT32 i = 0; i < 3; i++)
+		{
+			SimdFloat corners[2][2][2];
+			for(UINT32 z = 0; z < 2; z++)
+			{
+				for(UINT32 y = 0; y < 2; y++)
+				{
+					for(UINT32 x = 0; x < 2; x++)
+					{
+						const SimdInt idx = simdTruncate(simdAdd(simdAdd(columns[x], rows[y]), slices[z]));
+						corners[z][y][x] = simdGather(values[i], idx);
+					}
+				}
+			}
+
+			const SimdFloat y0z0 = simdLerp(corners[0][0][0], corners[0][0][1], frac[0]);
+			const SimdFloat y1z0 = simdLerp(corners[0][1][0], corners[0][1][1], frac[0]);
+			const SimdFloat y0z1 = simdLerp(corners[1][0][0], corners[1][0][1], frac[0]);
+			const SimdFloat y1z1 = simdLerp(corners[1][1][0], corners[1][1][1], frac[0]);
+
+			sampled[i] = simdLerp(simdLerp(y0z0, y1z0, frac[1]), simdLerp(y0z1, y1z1, frac[1]), frac[2]);
+		}
+
+		SimdFloat* output[3] = { &forceX, &forceY, &forceZ };
+		for(UINT32 i = 0; i < 3; i++)
+		{
+			*output[i] = simdAdd(simdAdd(
+				simdMul(sampled[0], simdSet(transform.toWorld[i][0])),
+				simdMul(sampled[1], simdSet(transform.toWorld[i][1]))),
+				simdMul(sampled[2], simdSet(transform.toWorld[i][2])));
+		}
+	}
+
+	/** All the attribute arrays of SimdParticles, in the order they are placed in the storage. */
+	float* SimdParticles::* const PARTICLE_ARRAYS[] =
+	{
+		&SimdParticles::positionX, &SimdParticles::positionY, &SimdParticles::positionZ,
+		&SimdParticles::velocityX, &SimdParticles::velocityY, &SimdParticles::velocityZ,
+		&SimdParticles::size, &SimdParticles::colorR, &SimdParticles::colorG, &SimdParticles::colorB,
+		&SimdParticles::colorA, &SimdParticles::frame, &SimdParticles::lifetime, &SimdParticles::invInitialLifetime
+	};
+
+	constexpr UINT32 NUM_PARTICLE_ARRAYS = sizeof(PARTICLE_ARRAYS) / sizeof(PARTICLE_ARRAYS[0]);
+
+	SimdParticles::SimdParticles(const SimdParticles& other)
+	{
+		*this = other;
+	}
+
+	SimdParticles::SimdParticles(SimdParticles&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	SimdParticles& SimdParticles::operator=(const SimdParticles& other)
+	{
+		if(this == &other)
+			return *this;
+
+		// The particles are copied into the existing storage if it's large enough, which might be external storage such
+		// as an arena. Otherwise owned storage is allocated, as the storage of the other particles might belong to
+		// someone else.
+		mCount = 0;
+		mPaddedCount = 0;
+		reserve(other.mPaddedCount);
+
+		for(auto entry : PARTICLE_ARRAYS)
+		{
+			if(other.mPaddedCount > 0)
+				memcpy(this->*entry, other.*entry, other.mPaddedCount * sizeof(float));
+		}
+
+		mCount = other.mCount;
+		mPaddedCount = other.mPaddedCount;
+
+		return *this;
+	}
+
+	SimdParticles& SimdParticles::operator=(SimdParticles&& other) noexcept
+	{
+		if(this == &other)
+			return *this;
+
+		// Moving the owned storage keeps its memory, so the arrays remain valid
+		for(auto entry : PARTICLE_ARRAYS)
+		{
+			this->*entry = other.*entry;
+			other.*entry = nullptr;
+		}
+
+		mOwnedStorage = std::move(other.mOwnedStorage);
+		mCount = other.mCount;
+		mPaddedCount = other.mPaddedCount;
+		mCapacity = other.mCapacity;
+		mNumAllocations = other.mNumAllocations;
+
+		other.mOwnedStorage.clear();
+		other.mCount = 0;
+		other.mPaddedCount = 0;
+		other.mCapacity = 0;
+
+		return *this;
+	}
+
+	void SimdParticles::resize(UINT32 count)
+	{
+		const UINT32 paddedCount = Math::divideAndRoundUp(count, SIMD_WIDTH) * SIMD_WIDTH;
+		if(paddedCount > mCapacity)
+			reserve(std::max(paddedCount, mCapacity * 2));
+
+		// Initialize the newly added entries
+		for(UINT32 i = 0; i < NUM_PARTICLE_ARRAYS; i++)
+		{
+			float* entry = this->*PARTICLE_ARRAYS[i];
+			const float value = (entry == lifetime || entry == invInitialLifetime) ? 1.0f : 0.0f;
+
+			for(UINT32 j = mPaddedCount; j < paddedCount; j++)
+				entry[j] = value;
+		}
+
+		mCount = count;
+		mPaddedCount = paddedCount;
+
+		// Padding is simulated along with the real particles, so make sure it has a valid lifetime
+		for(UINT32 i = count; i < paddedCount; i++)
+		{
+			lifetime[i] = 1.0f;
+			invInitialLifetime[i] = 1.0f;
+		}
+	}
+
+	void SimdParticles::reserve(UINT32 capacity, float* storage)
+	{
+		const UINT32 paddedCapacity = Math::divideAndRoundUp(std::max(capacity, mPaddedCount), SIMD_WIDTH) * SIMD_WIDTH;
+		if(!storage && paddedCapacity <= mCapacity)
+			return;
+
+		Vector<float> ownedStorage;
+		if(!storage)
+		{
+			ownedStorage.resize(getStorageSize(paddedCapacity));
+			storage = ownedStorage.data();
+
+			mNumAllocations++;
+		}
+
+		// Move the existing particles over before the old storage is released
+		for(UINT32 i = 0; i < NUM_PARTICLE_ARRAYS; i++)
+		{
+			float*& entry = this->*PARTICLE_ARRAYS[i];
+			float* dst = storage + i * paddedCapacity;
+
+			if(mPaddedCount > 0)
+				memcpy(dst, entry, mPaddedCount * sizeof(float));
+
+			entry = dst;
+		}
+
+		mOwnedStorage = std::move(ownedStorage);
+		mCapacity = paddedCapacity;
+	}
+
+	UINT32 SimdParticles::removeDead()
+	{
+		UINT32 numAlive = 0;
+		for(UINT32 i = 0; i < mCount; i++)
+		{
+			if(lifetime[i] <= 0.0f)
+				continue;
+
+			if(numAlive != i)
+			{
+				for(auto entry : PARTICLE_ARRAYS)
+					(this->*entry)[numAlive] = (this->*entry)[i];
+			}
+
+			numAlive++;
+		}
+
+		const UINT32 numRemoved = mCount - numAlive;
+		if(numRemoved > 0)
+			resize(numAlive);
+
+		return numRemoved;
+	}
+
+	UINT32 SimdParticles::getStorageSize(UINT32 capacity)
+	{
+		return Math::divideAndRoundUp(capacity, SIMD_WIDTH) * SIMD_WIDTH * NUM_PARTICLE_ARRAYS;
+	}
+
+	SimdParticleCurve SimdParticleCurve::bake(const TAnimationCurve<float>& curve, UINT32 numSamples)
+	{
+		SimdParticleCurve output;
+		output.samples.resize(numSamples + 1);
+
+		for(UINT32 i = 0; i < numSamples; i++)
+			output.samples[i] = curve.evaluate(i / (float)(numSamples - 1), false);
+
+		output.samples[numSamples] = output.samples[numSamples - 1];
+		return output;
+	}
+
+	SimdParticleCurve SimdParticleCurve::bake(const TAnimationCurve<Vector3>& curve, UINT32 component, UINT32 numSamples)
+	{
+		SimdParticleCurve output;
+		output.samples.resize(numSamples + 1);
+
+		for(UINT32 i = 0; i < numSamples; i++)
+			output.samples[i] = curve.evaluate(i / (float)(numSamples - 1), false)[component];
+
+		output.samples[numSamples] = output.samples[numSamples - 1];
+		return output;
+	}
+
+	SimdParticleCurve SimdParticleCurve::bake(const ColorGradient& gradient, UINT32 channel, UINT32 numSamples)
+	{
+		SimdParticleCurve output;
+		output.samples.resize(numSamples + 1);
+
+		for(UINT32 i = 0; i < numSamples; i++)
+		{
+			const Color color = Color::fromRGBA(gradient.evaluate(i / (float)(numSamples - 1)));
+			output.samples[i] = color[channel];
+		}
+
+		output.samples[numSamples] = output.samples[numSamples - 1];
+		return output;
+	}
+
+	float SimdParticleCurve::evaluate(float t) const
+	{
+		const float x = Math::clamp01(t) * (samples.size() - 2);
+		const UINT32 idx = (UINT32)x;
+		const float frac = x - idx;
+
+		return samples[idx] + (samples[idx + 1] - samples[idx]) * frac;
+	}
+
+	SimdParticleEvolver::SimdParticleEvolver(const SIMD_PARTICLE_EVOLVERS_DESC& desc)
+		:mDesc(desc)
+	{
+		if(mDesc.useSize)
+			mSize = SimdParticleCurve::bake(mDesc.size);
+
+		if(mDesc.useColor)
+		{
+			for(UINT32 i = 0; i < 4; i++)
+				mColor[i] = SimdParticleCurve::bake(mDesc.color, i);
+		}
+
+		if(mDesc.useForce)
+		{
+			for(UINT32 i = 0; i < 3; i++)
+				mForce[i] = SimdParticleCurve::bake(mDesc.force, i);
+		}
+	}
+
+	void SimdParticleEvolver::simulate(SimdParticles& particles, float timeStep, UINT32 start, UINT32 end,
+		const Vector3& origin) const
+	{
+		start = (start / SIMD_WIDTH) * SIMD_WIDTH;
+		if(end != (UINT32)-1)
+			end = Math::divideAndRoundUp(end, SIMD_WIDTH) * SIMD_WIDTH;
+
+		end = std::min(end, particles.getPaddedCount());
+
+		// Set up the transformation between the particles and the vector field
+		const SIMD_PARTICLE_VECTOR_FIELD_DESC& fieldDesc = mDesc.vectorField;
+
+		VectorFieldTransform fieldTransform;
+		if(fieldDesc.vectorField)
+		{
+			const CpuVectorField& field = *fieldDesc.vectorField;
+			const Vector3 boundsMin = field.getBounds().getMin();
+			const Vector3 boundsSize = field.getBounds().getSize();
+			const UINT32 counts[3] = { field.getCountX(), field.getCountY(), field.getCountZ() };
+
+			const Quaternion invRotation = fieldDesc.rotation.inverse();
+			const Vector3 axes[3] = { Vector3::UNIT_X, Vector3::UNIT_Y, Vector3::UNIT_Z };
+
+			fieldTransform.field = &field;
+			fieldTransform.origin = origin + fieldDesc.offset;
+
+			for(UINT32 i = 0; i < 3; i++)
+			{
+				// Texel centers are at half a texel from the edges
+				const float texelsPerUnit = counts[i] / boundsSize[i];
+				fieldTransform.texelOffset[i] = -boundsMin[i] * texelsPerUnit - 0.5f;
+				fieldTransform.counts[i] = (float)counts[i];
+
+				for(UINT32 j = 0; j < 3; j++)
+				{
+					fieldTransform.toTexel[i][j] = invRotation.rotate(axes[j])[i] / fieldDesc.scale[i] * texelsPerUnit;
+					fieldTransform.toWorld[i][j] = fieldDesc.rotation.rotate(axes[j])[i] * fieldDesc.intensity;
+				}
+			}
+
+			fieldTransform.tiling[0] = fieldDesc.tilingX;
+			fieldTransform.tiling[1] = fieldDesc.tilingY;
+			fieldTransform.tiling[2] = fieldDesc.tilingZ;
+		}
+
+		const SimdFloat tightness = simdSet(fieldDesc.tightness);
+		const SimdFloat looseness = simdSet(1.0f - fieldDesc.tightness);
+
+		// Normalized lifetime of the particles in the current block, shared by all the passes
+		alignas(32) float normalizedTimes[BLOCK_SIZE];
+
+		const SimdFloat zero = simdSet(0.0f);
+		const SimdFloat one = simdSet(1.0f);
+		const SimdFloat dt = simdSet(timeStep);
+
+		for(UINT32 blockStart = start; blockStart < end; blockStart += BLOCK_SIZE)
+		{
+			const UINT32 blockEnd = std::min(blockStart + BLOCK_SIZE, end);
+
+			// Age the particles, respawn the dead ones at rest at the origin, and calculate the normalized lifetime
+			for(UINT32 i = blockStart; i < blockEnd; i += SIMD_WIDTH)
+			{
+				const SimdFloat invInitial = simdLoad(&particles.invInitialLifetime[i]);
+				SimdFloat lifetime = simdSub(simdLoad(&particles.lifetime[i]), dt);
+
+				if(!mDesc.respawn)
+				{
+					simdStore(&particles.lifetime[i], lifetime);
+
+					const SimdFloat t = simdMin(simdMax(simdSub(one, simdMul(lifetime, invInitial)), zero), one);
+					simdStore(&normalizedTimes[i - blockStart], t);
+					continue;
+				}
+
+				const SimdFloat dead = simdLessEqual(lifetime, zero);
+				lifetime = simdSelect(dead, simdAdd(lifetime, simdDiv(one, invInitial)), lifetime);
+				simdStore(&particles.lifetime[i], lifetime);
+
+				simdStore(&particles.positionX[i], simdSelect(dead, zero, simdLoad(&particles.positionX[i])));
+				simdStore(&particles.positionY[i], simdSelect(dead, zero, simdLoad(&particles.positionY[i])));
+				simdStore(&particles.positionZ[i], simdSelect(dead, zero, simdLoad(&particles.positionZ[i])));
+
+				// Otherwise recycled particles would keep the velocity accumulated during their previous lives
+				simdStore(&particles.velocityX[i], simdSelect(dead, zero, simdLoad(&particles.velocityX[i])));
+				simdStore(&particles.velocityY[i], simdSelect(dead, zero, simdLoad(&particles.velocityY[i])));
+				simdStore(&particles.velocityZ[i], simdSelect(dead, zero, simdLoad(&particles.velocityZ[i])));
+
+				const SimdFloat t = simdMin(simdMax(simdSub(one, simdMul(lifetime, invInitial)), zero), one);
+				simdStore(&normalizedTimes[i - blockStart], t);
+			}
+
+			// ParticleTextureAnimation
+			if(mDesc.numFrames > 0)
+			{
+				const SimdFloat numCycles = simdSet((float)mDesc.numCycles);
+				const SimdFloat numFrames = simdSet((float)mDesc.numFrames);
+				const SimdFloat lastFrame = simdSet((float)(mDesc.numFrames - 1));
+
+				for(UINT32 i = blockStart; i < blockEnd; i += SIMD_WIDTH)
+				{
+					const SimdFloat cycle = simdMul(simdLoad(&normalizedTimes[i - blockStart]), numCycles);
+					const SimdFloat cycleFrac = simdSub(cycle, simdToFloat(simdTruncate(cycle)));
+					const SimdFloat frame = simdToFloat(simdTruncate(simdMul(cycleFrac, numFrames)));
+
+					simdStore(&particles.frame[i], simdMin(frame, lastFrame));
+				}
+			}
+
+			// ParticleSize
+			if(mSize.isValid())
+			{
+				for(UINT32 i = blockStart; i < blockEnd; i += SIMD_WIDTH)
+				{
+					const SimdFloat t = simdLoad(&normalizedTimes[i - blockStart]);
+					simdStore(&particles.size[i], sampleCurve(mSize, t));
+				}
+			}
+
+			// ParticleColor
+			if(mColor[0].isValid())
+			{
+				float* channels[] = { particles.colorR, particles.colorG, particles.colorB, particles.colorA };
+
+				for(UINT32 i = blockStart; i < blockEnd; i += SIMD_WIDTH)
+				{
+					const SimdFloat t = simdLoad(&normalizedTimes[i - blockStart]);
+					for(UINT32 j = 0; j < 4; j++)
+						simdStore(&channels[j][i], sampleCurve(mColor[j], t));
+				}
+			}
+
+			// ParticleForce, ParticleGravity and the vector field
+			const SimdFloat gravityX = simdSet(mDesc.gravity.x * timeStep);
+			const SimdFloat gravityY = simdSet(mDesc.gravity.y * timeStep);
+			const SimdFloat gravityZ = simdSet(mDesc.gravity.z * timeStep);
+
+			for(UINT32 i = blockStart; i < blockEnd; i += SIMD_WIDTH)
+			{
+				SimdFloat velX = simdAdd(simdLoad(&particles.velocityX[i]), gravityX);
+				SimdFloat velY = simdAdd(simdLoad(&particles.velocityY[i]), gravityY);
+				SimdFloat velZ = simdAdd(simdLoad(&particles.velocityZ[i]), gravityZ);
+
+				if(mForce[0].isValid())
+				{
+					const SimdFloat t = simdLoad(&normalizedTimes[i - blockStart]);
+					velX = simdAdd(velX, simdMul(sampleCurve(mForce[0], t), dt));
+					velY = simdAdd(velY, simdMul(sampleCurve(mForce[1], t), dt));
+					velZ = simdAdd(velZ, simdMul(sampleCurve(mForce[2], t), dt));
+				}
+
+				if(fieldTransform.field)
+				{
+					SimdFloat fieldX, fieldY, fieldZ;
+					sampleVectorField(fieldTransform, simdLoad(&particles.positionX[i]), simdLoad(&particles.positionY[i]),
+						simdLoad(&particles.positionZ[i]), fieldX, fieldY, fieldZ);
+
+					// Apply the vectors as a force, and blend towards using them as the velocity based on the tightness
+					velX = simdAdd(simdMul(simdAdd(velX, simdMul(fieldX, dt)), looseness), simdMul(fieldX, tightness));
+					velY = simdAdd(simdMul(simdAdd(velY, simdMul(fieldY, dt)), looseness), simdMul(fieldY, tightness));
+					velZ = simdAdd(simdMul(simdAdd(velZ, simdMul(fieldZ, dt)), looseness), simdMul(fieldZ, tightness));
+				}
+
+				simdStore(&particles.velocityX[i], velX);
+				simdStore(&particles.velocityY[i], velY);
+				simdStore(&particles.velocityZ[i], velZ);
+
+				// Integrate the position
+				simdStore(&particles.positionX[i], simdAdd(simdLoad(&particles.positionX[i]), simdMul(velX, dt)));
+				simdStore(&particles.positionY[i], simdAdd(simdLoad(&particles.positionY[i]), simdMul(velY, dt)));
+				simdStore(&particles.positionZ[i], simdAdd(simdLoad(&particles.positionZ[i]), simdMul(velZ, dt)));
+			}
+
+			// ParticleCollisions, using planes
+			const SimdFloat radius = simdSet(mDesc.collisionRadius);
+			const SimdFloat restitution = simdSet(mDesc.restitution);
+			const SimdFloat tangentScale = simdSet(1.0f - mDesc.dampening);
+
+			for(auto& plane : mDesc.collisionPlanes)
+			{
+				const SimdFloat nx = simdSet(plane.normal.x);
+				const SimdFloat ny = simdSet(plane.normal.y);
+				const SimdFloat nz = simdSet(plane.normal.z);
+				const SimdFloat planeD = simdSet(plane.d);
+
+				for(UINT32 i = blockStart; i < blockEnd; i += SIMD_WIDTH)
+				{
+					SimdFloat posX = simdLoad(&particles.positionX[i]);
+					SimdFloat posY = simdLoad(&particles.positionY[i]);
+					SimdFloat posZ = simdLoad(&particles.positionZ[i]);
+
+					const SimdFloat distance = simdSub(
+						simdAdd(simdAdd(simdMul(nx, posX), simdMul(ny, posY)), simdMul(nz, posZ)), planeD);
+					const SimdFloat colliding = simdLess(distance, radius);
+
+					// Push the particle out of the plane
+					const SimdFloat push = simdSelect(colliding, simdSub(radius, distance), zero);
+					simdStore(&particles.positionX[i], simdAdd(posX, simdMul(nx, push)));
+					simdStore(&particles.positionY[i], simdAdd(posY, simdMul(ny, push)));
+					simdStore(&particles.positionZ[i], simdAdd(posZ, simdMul(nz, push)));
+
+					// Bounce the particles moving into the plane
+					const SimdFloat velX = simdLoad(&particles.velocityX[i]);
+					const SimdFloat velY = simdLoad(&particles.velocityY[i]);
+					const SimdFloat velZ = simdLoad(&particles.velocityZ[i]);
+
+					const SimdFloat normalVel = simdAdd(simdAdd(simdMul(nx, velX), simdMul(ny, velY)), simdMul(nz, velZ));
+					const SimdFloat bounce = simdAnd(colliding, simdLess(normalVel, zero));
+
+					// v' = (v - n * vn) * (1 - dampening) - n * vn * restitution
+					const SimdFloat reflected = simdMul(normalVel, restitution);
+					const SimdFloat newVelX = simdSub(simdMul(simdSub(velX, simdMul(nx, normalVel)), tangentScale),
+						simdMul(nx, reflected));
+					const SimdFloat newVelY = simdSub(simdMul(simdSub(velY, simdMul(ny, normalVel)), tangentScale),
+						simdMul(ny, reflected));
+					const SimdFloat newVelZ = simdSub(simdMul(simdSub(velZ, simdMul(nz, normalVel)), tangentScale),
+						simdMul(nz, reflected));
+
+					simdStore(&particles.velocityX[i], simdSelect(bounce, newVelX, velX));
+					simdStore(&particles.velocityY[i], simdSelect(bounce, newVelY, velY));
+					simdStore(&particles.velocityZ[i], simdSelect(bounce, newVelZ, velZ));
+				}
+			}
+		}
+	}
+
+	UINT32 SimdParticleEvolver::getSimdWidth()
+	{
+		return SIMD_WIDTH;
+	}
+
+	const char* SimdParticleEvolver::getInstructionSet()
+	{
+#if BS_SIMD_PARTICLES_AVX2
+		return "AVX2";
+#elif BS_SIMD_PARTICLES_SSE
+		return "SSE2";
+#else
+		return "Scalar";
+#endif
+	}
+}
\ No newline at end of file
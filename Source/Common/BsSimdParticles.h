@@ -0,0 +1,250 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "Animation/BsAnimationCurve.h"
+#include "Image/BsColorGradient.h"
+#include "Math/BsPlane.h"
+#include "Math/BsQuaternion.h"
+
+namespace bs
+{
+	class CpuVectorField;
+
+	/**
+	 * Particle attributes stored as a structure of arrays, one array per attribute component. Arrays are padded to a
+	 * multiple of the SIMD width, so kernels never need to handle a partial batch of particles.
+	 *
+	 * All the arrays are placed in a single block of memory. The block can be provided by the caller, so the particles of
+	 * many particle systems can be placed in a single arena allocation, see ParticleSimulator::prewarm().
+	 */
+	struct SimdParticles
+	{
+		SimdParticles() = default;
+		SimdParticles(const SimdParticles& other);
+		SimdParticles(SimdParticles&& other) noexcept;
+
+		SimdParticles& operator=(const SimdParticles& other);
+		SimdParticles& operator=(SimdParticles&& other) noexcept;
+
+		/**
+		 * Changes the number of particles. New particles are zero-initialized, except for the lifetime which is set to one
+		 * second. Growing beyond the capacity re-allocates the attribute arrays, doubling the capacity.
+		 */
+		void resize(UINT32 count);
+
+		/**
+		 * Makes sure the attribute arrays can hold at least @p capacity particles without allocating. Existing particles
+		 * are kept.
+		 *
+		 * @param[in]	capacity	Minimum number of particles to reserve the space for.
+		 * @param[in]	storage		Optional memory to place the attribute arrays in, instead of allocating it. Must hold at
+		 *							least getStorageSize(capacity) floats and must outlive the particles, or until they
+		 *							move to a different storage. When provided, the arrays are always moved into it.
+		 */
+		void reserve(UINT32 capacity, float* storage = nullptr);
+
+		/**
+		 * Removes the particles whose lifetime ran out, moving the remaining particles to the front of the arrays. The
+		 * remaining particles keep their relative order. Returns the number of removed particles.
+		 */
+		UINT32 removeDead();
+
+		/** Returns the number of particles. */
+		UINT32 getCount() const { return mCount; }
+
+		/** Returns the size of the attribute arrays, which is the particle count rounded up to the SIMD width. */
+		UINT32 getPaddedCount() const { return mPaddedCount; }
+
+		/** Returns the number of particles the attribute arrays can hold without allocating. */
+		UINT32 getCapacity() const { return mCapacity; }
+
+		/** Returns the number of times the attribute arrays were allocated, either by reserve() or by resize(). */
+		UINT32 getNumAllocations() const { return mNumAllocations; }
+
+		/** Returns the number of floats required to store the attribute arrays for the provided number of particles. */
+		static UINT32 getStorageSize(UINT32 capacity);
+
+		float* positionX = nullptr;
+		float* positionY = nullptr;
+		float* positionZ = nullptr;
+		float* velocityX = nullptr;
+		float* velocityY = nullptr;
+		float* velocityZ = nullptr;
+		float* size = nullptr;
+		float* colorR = nullptr;
+		float* colorG = nullptr;
+		float* colorB = nullptr;
+		float* colorA = nullptr;
+		float* frame = nullptr; /**< Index of the sprite sheet frame to render. */
+		float* lifetime = nullptr; /**< Remaining time until the particle dies, in seconds. */
+		float* invInitialLifetime = nullptr; /**< One divided by the total lifetime of the particle. */
+
+	private:
+		UINT32 mCount = 0;
+		UINT32 mPaddedCount = 0;
+		UINT32 mCapacity = 0;
+		UINT32 mNumAllocations = 0;
+
+		/** Memory the attribute arrays are placed in, unless they were placed in external storage. */
+		Vector<float> mOwnedStorage;
+	};
+
+	/**
+	 * Animation curve evaluated by sampling a pre-baked lookup table with linear interpolation. Lookup tables have a fixed
+	 * cost regardless of the number of keyframes, and can be sampled for many particles at once. Curves are sampled in
+	 * the [0, 1] range, i.e. over the normalized particle lifetime.
+	 */
+	struct SimdParticleCurve
+	{
+		/** Samples the provided curve into a lookup table with the provided number of entries. */
+		static SimdParticleCurve bake(const TAnimationCurve<float>& curve, UINT32 numSamples = 128);
+
+		/** Samples one component of the provided vector curve into a lookup table with the provided number of entries. */
+		static SimdParticleCurve bake(const TAnimationCurve<Vector3>& curve, UINT32 component, UINT32 numSamples = 128);
+
+		/** Samples one channel of the provided gradient into a lookup table with the provided number of entries. */
+		static SimdParticleCurve bake(const ColorGradient& gradient, UINT32 channel, UINT32 numSamples = 128);
+
+		/** Evaluates the lookup table at the provided time in [0, 1] range. */
+		float evaluate(float t) const;
+
+		/** Returns true if the lookup table holds any samples. */
+		bool isValid() const { return !samples.empty(); }
+
+		/**
+		 * Lookup table samples. Contains one extra sample at the end, duplicating the last one, so interpolation never
+		 * needs to clamp the second index.
+		 */
+		Vector<float> samples;
+	};
+
+	/**
+	 * Settings for the vector field evolver of the SIMD particle simulation. Mirrors ParticleVectorFieldSettings, as used
+	 * by the GPU particle simulation.
+	 */
+	struct SIMD_PARTICLE_VECTOR_FIELD_DESC
+	{
+		/** Vector field to sample. Null disables the vector field evolver. */
+		SPtr<CpuVectorField> vectorField;
+
+		/** Scale of the vectors in the field. Applies to both the forces and the velocities. */
+		float intensity = 1.0f;
+
+		/**
+		 * Determines how closely do the particle velocities follow the vectors in the field. At zero the vectors are
+		 * applied as forces, and at one the particle velocities are set to the vectors directly.
+		 */
+		float tightness = 0.0f;
+
+		/** Scale of the vector field bounds. */
+		Vector3 scale = Vector3::ONE;
+
+		/** Position of the vector field, relative to the particle system. */
+		Vector3 offset = Vector3::ZERO;
+
+		/** Orientation of the vector field, relative to the particle system. */
+		Quaternion rotation = Quaternion::IDENTITY;
+
+		/** Determines should the field repeat along the X axis outside of its bounds, or use the values at the edge. */
+		bool tilingX = false;
+
+		/** Determines should the field repeat along the Y axis outside of its bounds, or use the values at the edge. */
+		bool tilingY = false;
+
+		/** Determines should the field repeat along the Z axis outside of its bounds, or use the values at the edge. */
+		bool tilingZ = false;
+	};
+
+	/**
+	 * Describes the evolvers to apply to particles using the SIMD particle simulation. Mirrors the settings of the
+	 * ParticleTextureAnimation, ParticleSize, ParticleColor, ParticleForce, ParticleGravity and ParticleCollisions
+	 * evolvers, as well as the vector field applied by the GPU particle simulation.
+	 */
+	struct SIMD_PARTICLE_EVOLVERS_DESC
+	{
+		/** Number of frames in the sprite sheet to animate over. Zero disables texture animation. */
+		UINT32 numFrames = 0;
+
+		/** Number of times to play the sprite sheet animation during the particle lifetime. */
+		UINT32 numCycles = 1;
+
+		/** True if the particle size should be set from the size curve. */
+		bool useSize = false;
+
+		/** Particle size over the normalized particle lifetime. */
+		TAnimationCurve<float> size;
+
+		/** True if the particle color should be set from the color gradient. */
+		bool useColor = false;
+
+		/** Particle color over the normalized particle lifetime. */
+		ColorGradient color;
+
+		/** True if the force curve should be applied to the particle velocity. */
+		bool useForce = false;
+
+		/** Force (acceleration) over the normalized particle lifetime, in world space. */
+		TAnimationCurve<Vector3> force;
+
+		/** Vector field applied to the particle velocities. */
+		SIMD_PARTICLE_VECTOR_FIELD_DESC vectorField;
+
+		/** Gravity to apply, already scaled as needed. */
+		Vector3 gravity = Vector3::ZERO;
+
+		/** Planes the particles collide with. */
+		Vector<Plane> collisionPlanes;
+
+		/** Radius of the particles used for collisions. */
+		float collisionRadius = 0.0f;
+
+		/** Fraction of the velocity along the plane normal kept after a collision. */
+		float restitution = 1.0f;
+
+		/** Fraction of the velocity along the plane removed after a collision. */
+		float dampening = 0.5f;
+
+		/**
+		 * If true dead particles are respawned at rest at the origin, with their original lifetime. Otherwise they are
+		 * left with a non-positive lifetime, and it is up to the caller to remove them (e.g. using
+		 * SimdParticles::removeDead()).
+		 */
+		bool respawn = true;
+	};
+
+	/**
+	 * Evolves particles stored in SimdParticles. Each evolver is executed as a separate pass over the particle arrays,
+	 * processing 8 particles at once using AVX2, or 4 using SSE, depending on the instruction set the code is compiled
+	 * for. AVX2 is only used when the BS_EXAMPLES_AVX2 CMake option is enabled. Curves and gradients are baked into
+	 * lookup tables when the evolver is created.
+	 *
+	 * By default dead particles are respawned at rest at the origin with their original lifetime, keeping the particle
+	 * count constant. See SIMD_PARTICLE_EVOLVERS_DESC::respawn.
+	 */
+	class SimdParticleEvolver
+	{
+	public:
+		SimdParticleEvolver(const SIMD_PARTICLE_EVOLVERS_DESC& desc);
+
+		/**
+		 * Advances the particles in the [start, end) range by the provided time step. The range is rounded to the SIMD
+		 * width. Different ranges of the same particle set can be simulated concurrently. @p origin is the position of the
+		 * particle system, which the vector field is positioned relative to.
+		 */
+		void simulate(SimdParticles& particles, float timeStep, UINT32 start = 0, UINT32 end = (UINT32)-1,
+			const Vector3& origin = Vector3::ZERO) const;
+
+		/** Returns the number of particles processed at once by the kernels. */
+		static UINT32 getSimdWidth();
+
+		/** Returns the name of the instruction set used by the kernels. */
+		static const char* getInstructionSet();
+
+	private:
+		SIMD_PARTICLE_EVOLVERS_DESC mDesc;
+
+		SimdParticleCurve mSize;
+		SimdParticleCurve mColor[4];
+		SimdParticleCurve mForce[3];
+	};
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "BsUniformRingBuffer.h"
+#include "RenderAPI/BsGpuParamBlockBuffer.h"
+#include "RenderAPI/BsCommandBuffer.h"
+
+namespace bs { namespace ct
+{
+	UniformRingBuffer::UniformRingBuffer(UINT32 blockSize, UINT32 numFrames)
+		:mBlockSize(blockSize), mFrames(std::max(numFrames, 1U))
+	{
+		// Start at the last frame, so the first beginFrame() call moves on to the first one
+		mFrameIdx = (UINT32)mFrames.size() - 1;
+	}
+
+	void UniformRingBuffer::beginFrame()
+	{
+		mStats.numFrameBuffersCreated = 0;
+		mStats.numFrameAllocations = 0;
+
+		UINT32 nextFrameIdx = (mFrameIdx + 1) % (UINT32)mFrames.size();
+
+		// Never wait on the GPU. If it hasn't finished with the next frame yet, insert a fresh one before it.
+		if(isInFlight(mFrames[nextFrameIdx]))
+		{
+			nextFrameIdx = mFrameIdx + 1;
+			mFrames.insert(mFrames.begin() + nextFrameIdx, Frame());
+
+			mStats.numFramesAdded++;
+		}
+
+		mFrameIdx = nextFrameIdx;
+
+		Frame& frame = mFrames[mFrameIdx];
+		frame.fences.clear();
+		frame.numUsed = 0;
+	}
+
+	SPtr<GpuParamBlockBuffer> UniformRingBuffer::allocate()
+	{
+		Frame& frame = mFrames[mFrameIdx];
+		if(frame.numUsed == (UINT32)frame.buffers.size())
+		{
+			frame.buffers.push_back(GpuParamBlockBuffer::create(mBlockSize, GBU_DYNAMIC));
+
+			mStats.numBuffersCreated++;
+			mStats.numFrameBuffersCreated++;
+		}
+
+		mStats.numFrameAllocations++;
+		return frame.buffers[frame.numUsed++];
+	}
+
+	SPtr<GpuParamBlockBuffer> UniformRingBuffer::allocate(const void* data, UINT32 size)
+	{
+		SPtr<GpuParamBlockBuffer> buffer = allocate();
+		buffer->write(0, data, std::min(size, mBlockSize));
+
+		return buffer;
+	}
+
+	void UniformRingBuffer::addFence(const SPtr<CommandBuffer>& commandBuffer)
+	{
+		Vector<SPtr<CommandBuffer>>& fences = mFrames[mFrameIdx].fences;
+		if(std::find(fences.begin(), fences.end(), commandBuffer) == fences.end())
+			fences.push_back(commandBuffer);
+	}
+
+	bool UniformRingBuffer::isInFlight(const Frame& frame)
+	{
+		for(auto& entry : frame.fences)
+		{
+			if(entry->getState() == CommandBufferState::Executing)
+				return true;
+		}
+
+		return false;
+	}
+}}
\ No newline at end of file
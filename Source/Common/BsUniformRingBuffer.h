@@ -0,0 +1,86 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+
+namespace bs { namespace ct
+{
+	/** Statistics about the uniform buffers handed out by a UniformRingBuffer. */
+	struct UniformRingBufferStats
+	{
+		UINT32 numBuffersCreated = 0; /**< Total number of uniform buffers created since the ring was created. */
+		UINT32 numFrameBuffersCreated = 0; /**< Number of uniform buffers created during the current frame. */
+		UINT32 numFrameAllocations = 0; /**< Number of uniform buffers handed out during the current frame. */
+		UINT32 numFramesAdded = 0; /**< Number of times the ring grew because all of its frames were still in flight. */
+	};
+
+	/**
+	 * Hands out uniform buffers for data that changes every frame, without creating new GPU objects on the hot path.
+	 *
+	 * The ring holds the buffers of a fixed number of frames. Every frame uses the buffers of the next frame in the ring,
+	 * and each allocate() call hands out the next buffer of that frame, so the buffers are suballocated in the same order
+	 * every frame. The command buffers that reference the buffers of a frame act as its fence: the frame is only reused
+	 * once none of them are executing any more. This ensures the buffers are never written while the GPU still reads
+	 * them, which the render API would otherwise handle by renaming (i.e. re-allocating) the GPU memory behind them.
+	 *
+	 * The buffers keep a persistent CPU copy of their contents, and are created with dynamic usage, so writing them only
+	 * updates the mapped memory. New buffers are only created while the ring warms up, when a frame needs more buffers
+	 * than it ever has before, or when all the frames are still in flight.
+	 */
+	class UniformRingBuffer
+	{
+	public:
+		/**
+		 * Creates a new ring.
+		 *
+		 * @param[in]	blockSize		Size of every uniform buffer handed out by the ring, in bytes.
+		 * @param[in]	numFrames		Number of frames in the ring, i.e. the number of frames the CPU can get ahead of
+		 *								the GPU before the ring has to grow.
+		 */
+		UniformRingBuffer(UINT32 blockSize, UINT32 numFrames = 3);
+
+		/**
+		 * Starts a new frame, moving on to the next frame in the ring. If the GPU is still using that frame, a new frame
+		 * is inserted into the ring instead.
+		 */
+		void beginFrame();
+
+		/** Returns a uniform buffer that's free to be written during the current frame. */
+		SPtr<GpuParamBlockBuffer> allocate();
+
+		/** Returns a uniform buffer that's free to be written during the current frame, and fills it with the data. */
+		SPtr<GpuParamBlockBuffer> allocate(const void* data, UINT32 size);
+
+		/**
+		 * Registers a command buffer that uses the buffers of the current frame. The frame isn't reused until the
+		 * command buffer finishes executing. Should be called for every command buffer that references the buffers.
+		 */
+		void addFence(const SPtr<CommandBuffer>& commandBuffer);
+
+		/** Returns the index of the current frame in the ring. */
+		UINT32 getFrameIdx() const { return mFrameIdx; }
+
+		/** Returns the number of frames in the ring. Can grow if the GPU falls behind. */
+		UINT32 getNumFrames() const { return (UINT32)mFrames.size(); }
+
+		/** Returns statistics about the buffers handed out by the ring. */
+		const UniformRingBufferStats& getStats() const { return mStats; }
+
+	private:
+		/** Uniform buffers used by a single frame, along with the command buffers that reference them. */
+		struct Frame
+		{
+			Vector<SPtr<GpuParamBlockBuffer>> buffers;
+			Vector<SPtr<CommandBuffer>> fences;
+			UINT32 numUsed = 0;
+		};
+
+		/** Checks is any command buffer referencing the buffers of the frame still executing. */
+		static bool isInFlight(const Frame& frame);
+
+		UINT32 mBlockSize;
+		Vector<Frame> mFrames;
+		UINT32 mFrameIdx;
+
+		UniformRingBufferStats mStats;
+	};
+}}
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "BsWalkerSystem.h"
+#include "BsParallelFor.h"
+#include "Components/BsCCharacterController.h"
+#include "Physics/BsPhysics.h"
+#include "Math/BsMath.h"
+#include "Utility/BsTime.h"
+#include "Utility/BsTimer.h"
+
+namespace bs
+{
+	/** Advances a xorshift random number generator and returns a number in [0, 1] range. */
+	float nextRandom(UINT32& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+
+		return (state & 0xFFFFFF) / (float)0xFFFFFF;
+	}
+
+	WalkerSystem::WalkerSystem(const HSceneObject& parent, const WALKER_SYSTEM_DESC& desc)
+		:Component(parent), mDesc(desc)
+	{
+		// Set a name for the component, so we can find it later if needed
+		setName("WalkerSystem");
+	}
+
+	void WalkerSystem::setStepper(const HPhysicsStepper& stepper)
+	{
+		mStepConn.disconnect();
+		mUseStepper = false;
+
+		if(stepper)
+		{
+			mStepConn = stepper->onPreStep.connect([this](UINT32 stepIdx, float stepSize) { step(stepSize); });
+			mUseStepper = true;
+		}
+	}
+
+	UINT32 WalkerSystem::add(const HCharacterController& controller)
+	{
+		const UINT32 idx = (UINT32)mControllers.size();
+		const Vector3 position = controller->getPosition();
+
+		mControllers.push_back(controller);
+		mPositionX.push_back(position.x);
+		mPositionZ.push_back(position.z);
+		mVelocityX.push_back(0.0f);
+		mVelocityY.push_back(0.0f);
+		mVelocityZ.push_back(0.0f);
+		mTargetX.push_back(position.x);
+		mTargetZ.push_back(position.z);
+		mSpeed.push_back(mDesc.minSpeed);
+		mGrounded.push_back(0);
+		mBlocked.push_back(0);
+
+		// Xorshift state must never be zero
+		mRandomState.push_back(((mDesc.seed * 0x9E3779B9) ^ ((idx + 1) * 0x85EBCA6B)) | 1);
+
+		pickTarget(idx);
+		return idx;
+	}
+
+	void WalkerSystem::setTarget(UINT32 idx, const Vector3& target)
+	{
+		mTargetX[idx] = target.x;
+		mTargetZ[idx] = target.z;
+	}
+
+	void WalkerSystem::fixedUpdate()
+	{
+		// Movement is triggered by the stepper instead, if one is used
+		if(mUseStepper)
+			return;
+
+		step(gTime().getFixedFrameDelta());
+	}
+
+	void WalkerSystem::onDestroyed()
+	{
+		mStepConn.disconnect();
+	}
+
+	void WalkerSystem::step(float stepSize)
+	{
+		const UINT32 numWalkers = (UINT32)mControllers.size();
+		mStats.numWalkers = numWalkers;
+
+		// Read the shared state once for all the walkers
+		mGravity = gPhysics().getGravity();
+
+		// Calculate the new velocities. Only the walker arrays are touched, so this can be spread over the workers.
+		Timer timer;
+		parallelFor(numWalkers, mDesc.walkersPerTask, [this, stepSize](UINT32 start, UINT32 end)
+		{
+			think(start, end, stepSize);
+		});
+
+		mStats.thinkTime = timer.getMicroseconds() / 1000.0f;
+
+		// Move the controllers. The character controller manager cannot be used from multiple threads at once.
+		timer.reset();
+
+		UINT32 numGrounded = 0;
+		for(UINT32 i = 0; i < numWalkers; i++)
+		{
+			const HCharacterController& controller = mControllers[i];
+			if(controller.isDestroyed())
+				continue;
+
+			const Vector3 displacement(mVelocityX[i], mVelocityY[i], mVelocityZ[i]);
+			const CharacterCollisionFlags flags = controller->move(displacement * stepSize);
+
+			mGrounded[i] = flags.isSet(CharacterCollisionFlag::Down) ? 1 : 0;
+			mBlocked[i] = flags.isSet(CharacterCollisionFlag::Sides) ? 1 : 0;
+			numGrounded += mGrounded[i];
+
+			const Vector3 position = controller->getPosition();
+			mPositionX[i] = position.x;
+			mPositionZ[i] = position.z;
+		}
+
+		mStats.moveTime = timer.getMicroseconds() / 1000.0f;
+		mStats.numGrounded = numGrounded;
+	}
+
+	void WalkerSystem::think(UINT32 start, UINT32 end, float stepSize)
+	{
+		const float arriveDistanceSqrd = mDesc.arriveDistance * mDesc.arriveDistance;
+		const float maxDeltaV = mDesc.acceleration * stepSize;
+
+		for(UINT32 i = start; i < end; i++)
+		{
+			float toTargetX = mTargetX[i] - mPositionX[i];
+			float toTargetZ = mTargetZ[i] - mPositionZ[i];
+			float distanceSqrd = toTargetX * toTargetX + toTargetZ * toTargetZ;
+
+			// Pick a new target once the old one is reached, or if something is in the way
+			if(distanceSqrd < arriveDistanceSqrd || mBlocked[i])
+			{
+				pickTarget(i);
+
+				toTargetX = mTargetX[i] - mPositionX[i];
+				toTargetZ = mTargetZ[i] - mPositionZ[i];
+				distanceSqrd = toTargetX * toTargetX + toTargetZ * toTargetZ;
+			}
+
+			// Steer towards the target, limiting how quickly the velocity can change
+			float desiredX = 0.0f;
+			float desiredZ = 0.0f;
+			if(distanceSqrd > 0.0f)
+			{
+				const float scale = mSpeed[i] / std::sqrt(distanceSqrd);
+				desiredX = toTargetX * scale;
+				desiredZ = toTargetZ * scale;
+			}
+
+			float deltaX = desiredX - mVelocityX[i];
+			float deltaZ = desiredZ - mVelocityZ[i];
+			const float deltaSqrd = deltaX * deltaX + deltaZ * deltaZ;
+			if(deltaSqrd > maxDeltaV * maxDeltaV)
+			{
+				const float scale = maxDeltaV / std::sqrt(deltaSqrd);
+				deltaX *= scale;
+				deltaZ *= scale;
+			}
+
+			mVelocityX[i] += deltaX;
+			mVelocityZ[i] += deltaZ;
+
+			// Keep grounded walkers pressed against the ground, and let the others fall
+			if(mGrounded[i])
+				mVelocityY[i] = mGravity.y * stepSize;
+			else
+				mVelocityY[i] += mGravity.y * stepSize;
+		}
+	}
+
+	void WalkerSystem::pickTarget(UINT32 idx)
+	{
+		UINT32& state = mRandomState[idx];
+
+		mTargetX[idx] = mDesc.areaCenter.x + (nextRandom(state) * 2.0f - 1.0f) * mDesc.areaExtents.x;
+		mTargetZ[idx] = mDesc.areaCenter.z + (nextRandom(state) * 2.0f - 1.0f) * mDesc.areaExtents.y;
+		mSpeed[idx] = Math::lerp(nextRandom(state), mDesc.minSpeed, mDesc.maxSpeed);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "Scene/BsComponent.h"
+#include "BsPhysicsStepper.h"
+
+namespace bs
+{
+	/** Information used for initializing a WalkerSystem. */
+	struct WALKER_SYSTEM_DESC
+	{
+		/** Center of the area the walkers wander around in. Only the X and Z coordinates are used. */
+		Vector3 areaCenter = Vector3::ZERO;
+
+		/** Half-size of the area the walkers wander around in, along the X and Z axes. */
+		Vector2 areaExtents = Vector2(20.0f, 20.0f);
+
+		/** Lowest speed a walker can be assigned, in meters per second. */
+		float minSpeed = 1.5f;
+
+		/** Highest speed a walker can be assigned, in meters per second. */
+		float maxSpeed = 4.0f;
+
+		/** Maximum change in horizontal velocity per second, in meters per second squared. */
+		float acceleration = 6.0f;
+
+		/** Distance from the target at which a walker picks a new target. */
+		float arriveDistance = 0.5f;
+
+		/** Seed for the random targets and speeds. Walkers with the same seed and index always make the same choices. */
+		UINT32 seed = 0;
+
+		/** Number of walkers processed by a single worker task. */
+		UINT32 walkersPerTask = 256;
+	};
+
+	/** Statistics about the last step executed by a WalkerSystem. */
+	struct WalkerSystemStats
+	{
+		UINT32 numWalkers = 0; /**< Number of walkers in the system. */
+		UINT32 numGrounded = 0; /**< Number of walkers that were standing on the ground after the step. */
+		float thinkTime = 0.0f; /**< Time spent calculating the new velocities, in milliseconds. */
+		float moveTime = 0.0f; /**< Time spent moving the character controllers, in milliseconds. */
+	};
+
+	/**
+	 * Component that moves a large number of AI controlled character controllers in a single pass. Unlike FPSWalker, which
+	 * drives one controller per component, the walker state is kept in flat per-attribute arrays and all the walkers are
+	 * updated together once per physics step.
+	 *
+	 * Each walker wanders towards a target point, picking a new random one within the area once it arrives or gets
+	 * blocked. The new velocities are calculated in parallel on the task scheduler workers. The character controllers
+	 * are then moved sequentially, as the physics backend doesn't allow them to be moved concurrently. Gravity is read
+	 * once per step, and no user input is read at all.
+	 */
+	class WalkerSystem : public Component
+	{
+	public:
+		WalkerSystem(const HSceneObject& parent, const WALKER_SYSTEM_DESC& desc = WALKER_SYSTEM_DESC());
+
+		/**
+		 * Makes the walkers move in sync with the provided physics stepper, using its step size, instead of on the engine's
+		 * fixed update.
+		 */
+		void setStepper(const HPhysicsStepper& stepper);
+
+		/** Registers a character controller to be driven by the system. Returns the index of the new walker. */
+		UINT32 add(const HCharacterController& controller);
+
+		/** Changes the point the walker with the provided index is walking towards. */
+		void setTarget(UINT32 idx, const Vector3& target);
+
+		/** Returns the number of walkers driven by the system. */
+		UINT32 getNumWalkers() const { return (UINT32)mControllers.size(); }
+
+		/** Returns statistics about the last executed step. */
+		const WalkerSystemStats& getStats() const { return mStats; }
+
+		/** @copydoc Component::fixedUpdate */
+		void fixedUpdate() override;
+
+		/** @copydoc Component::onDestroyed */
+		void onDestroyed() override;
+
+	private:
+		/** Updates the velocities of all the walkers and moves them over the provided time step. */
+		void step(float stepSize);
+
+		/** Calculates new velocities for the walkers in the provided range. */
+		void think(UINT32 start, UINT32 end, float stepSize);
+
+		/** Picks a new random target and speed for the walker with the provided index. */
+		void pickTarget(UINT32 idx);
+
+		WALKER_SYSTEM_DESC mDesc;
+		Vector<HCharacterController> mControllers;
+
+		// Per-walker state, stored one attribute per array
+		Vector<float> mPositionX;
+		Vector<float> mPositionZ;
+		Vector<float> mVelocityX;
+		Vector<float> mVelocityY;
+		Vector<float> mVelocityZ;
+		Vector<float> mTargetX;
+		Vector<float> mTargetZ;
+		Vector<float> mSpeed;
+		Vector<UINT32> mRandomState;
+		Vector<UINT8> mGrounded;
+		Vector<UINT8> mBlocked;
+
+		Vector3 mGravity = Vector3::ZERO;
+		HEvent mStepConn;
+		bool mUseStepper = false;
+		WalkerSystemStats mStats;
+	};
+
+	using HWalkerSystem = GameObjectHandle<WalkerSystem>;
+}
\ No newline at end of file
@@ -4,6 +4,32 @@ set(BS_COMMON_INC_NOFILTER
 	"BsObjectRotator.h"
 	"BsFPSWalker.h"
 	"BsFPSCamera.h"
+	"BsProjectilePool.h"
+	"BsCommandLine.h"
+	"BsBenchmarkLog.h"
+	"BsBoxStackBuilder.h"
+	"BsPhysicsProfiler.h"
+	"BsPhysicsSettings.h"
+	"BsPhysicsStepper.h"
+	"BsPhysicsRecorder.h"
+	"BsPhysicsQueryBatch.h"
+	"BsParallelFor.h"
+	"BsWalkerSystem.h"
+	"BsPhysicsLOD.h"
+	"BsSimdParticles.h"
+	"BsParticleSimulator.h"
+	"BsParticleSort.h"
+	"BsParticleLOD.h"
+	"BsCpuVectorField.h"
+	"BsInstancedParticleRenderer.h"
+	"BsUniformRingBuffer.h"
+	"BsCommandBufferPool.h"
+	"BsGpuPipelineCache.h"
+	"BsFrameCapture.h"
+	"BsGeometryStreamer.h"
+	"BsProceduralGeometry.h"
+	"BsCoreThreadProfiler.h"
+	"BsHash.h"
 )
 
 set(BS_COMMON_SRC_NOFILTER
@@ -11,6 +37,32 @@ set(BS_COMMON_SRC_NOFILTER
 	"BsObjectRotator.cpp"
 	"BsFPSWalker.cpp"
 	"BsFPSCamera.cpp"
+	"BsProjectilePool.cpp"
+	"BsCommandLine.cpp"
+	"BsBenchmarkLog.cpp"
+	"BsBoxStackBuilder.cpp"
+	"BsPhysicsProfiler.cpp"
+	"BsPhysicsSettings.cpp"
+	"BsPhysicsStepper.cpp"
+	"BsPhysicsRecorder.cpp"
+	"BsPhysicsQueryBatch.cpp"
+	"BsParallelFor.cpp"
+	"BsWalkerSystem.cpp"
+	"BsPhysicsLOD.cpp"
+	"BsSimdParticles.cpp"
+	"BsParticleSimulator.cpp"
+	"BsParticleSort.cpp"
+	"BsParticleLOD.cpp"
+	"BsCpuVectorField.cpp"
+	"BsInstancedParticleRenderer.cpp"
+	"BsUniformRingBuffer.cpp"
+	"BsCommandBufferPool.cpp"
+	"BsGpuPipelineCache.cpp"
+	"BsFrameCapture.cpp"
+	"BsGeometryStreamer.cpp"
+	"BsProceduralGeometry.cpp"
+	"BsCoreThreadProfiler.cpp"
+	"BsHash.cpp"
 )
 
 set(BS_COMMON_SRC
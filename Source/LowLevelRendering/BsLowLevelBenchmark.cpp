@@ -0,0 +1,182 @@
+#include "BsLowLevelBenchmark.h"
+#include "BsApplication.h"
+#include "CoreThread/BsCoreThread.h"
+#include "RenderAPI/BsRenderAPI.h"
+#include "BsCommandLine.h"
+#include "BsParallelFor.h"
+#include "BsBenchmarkLog.h"
+#include "BsEngineConfig.h"
+
+namespace bs
+{
+	LowLevelBenchmark::LowLevelBenchmark(UINT32 numFrames, UINT32 windowWidth, UINT32 windowHeight)
+		:mNumFrames(numFrames), mWindowWidth(windowWidth), mWindowHeight(windowHeight)
+	{
+		mNumWarmupFrames = CommandLine::getUInt("benchmark-warmup", 10);
+		mOutputPath = CommandLine::getString("benchmark-output", "LowLevelRendering.json");
+		mLog = bs_shared_ptr_new<BenchmarkLog>("LowLevelRendering");
+
+		// When sweeping, record a separate run for every power of two thread count up to the requested one
+		const UINT32 numRecordThreads = std::max(CommandLine::getUInt("record-threads", 1), 1U);
+		if(CommandLine::hasOption("record-thread-sweep"))
+		{
+			for(UINT32 i = 1; i < numRecordThreads; i *= 2)
+				mRecordThreadCounts.push_back(i);
+		}
+
+		mRecordThreadCounts.push_back(numRecordThreads);
+
+#if !BS_PROFILING_ENABLED
+		LOGWRN("The engine was built without profiling, so heap allocations can't be counted and won't be "
+			"recorded.");
+#endif
+
+		startRun();
+	}
+
+	LowLevelBenchmark::~LowLevelBenchmark()
+	{
+		restoreNumTaskWorkers();
+	}
+
+	void LowLevelBenchmark::startRun()
+	{
+		const UINT32 numRecordThreads = mRecordThreadCounts[mRunIdx];
+
+		mLog->beginRun(toString(numRecordThreads) + " record threads");
+		mLog->setRunProperty("allocation", CommandLine::hasOption("per-frame-allocation") ? "perFrame" : "ring");
+		mLog->setRunProperty("objects", toString(CommandLine::getUInt("objects", 1)));
+		mLog->setRunProperty("drawMode", CommandLine::getString("draw-mode", "draw"));
+		mLog->setRunProperty("recordThreads", toString(numRecordThreads));
+		mLog->setRunProperty("hardwareThreads", toString((UINT32)BS_THREAD_HARDWARE_CONCURRENCY));
+		mLog->setRunProperty("renderAPI", BS_RENDER_API_MODULE);
+		mLog->setRunProperty("device", bs::RenderAPI::getCapabilities(0).deviceName);
+
+		// Estimate the memory traffic of the offscreen target & the blit. Rendering directly to the window needs
+		// neither. The offscreen target has 4 bytes of color & 4 bytes of depth per pixel. The blit reads the color
+		// and writes 4 bytes per window pixel.
+		const bool direct = CommandLine::hasOption("direct");
+		UINT32 renderWidth, renderHeight;
+		getRenderResolution(renderWidth, renderHeight);
+
+		const UINT64 numRenderPixels = (UINT64)renderWidth * renderHeight;
+		const UINT64 numWindowPixels = (UINT64)mWindowWidth * mWindowHeight;
+
+		mLog->setRunProperty("present", direct ? "direct" : "blit");
+		mLog->setRunProperty("renderWidth", toString(renderWidth));
+		mLog->setRunProperty("renderHeight", toString(renderHeight));
+		mLog->setRunProperty("offscreenTargetBytes", toString(direct ? 0 : numRenderPixels * 8));
+		mLog->setRunProperty("streamRate", toString(CommandLine::getUInt("stream-rate", 0)));
+		mLog->setRunProperty("blitBytesPerFrame", toString(direct ? 0 : numRenderPixels * 4 + numWindowPixels * 4));
+
+#if !BS_PROFILING_ENABLED
+		mLog->setRunProperty("heapAllocs", "unmeasured");
+#endif
+
+		// Make sure there are enough task scheduler workers for all the recording threads. The core thread records
+		// one of the slices itself.
+		setNumTaskWorkers(std::max(getDefaultNumTaskWorkers(), numRecordThreads - 1));
+
+		gCoreThread().queueCommand(std::bind(&ct::setRecordThreads, numRecordThreads));
+		mNumRunFrames = 0;
+	}
+
+	void LowLevelBenchmark::recordFrameStats(CoreThreadProfiler& queueProfiler)
+	{
+		ct::takeFrameStats(mFrameStats);
+		mPendingFrameStats.insert(mPendingFrameStats.end(), mFrameStats.begin(), mFrameStats.end());
+
+		queueProfiler.takeFrameStats(mQueueFrameStats);
+		for(auto& entry : mQueueFrameStats)
+			mPendingQueueStats[entry.frameIdx] = entry;
+
+		while(!mPendingFrameStats.empty())
+		{
+			// The profiler finishes timing the render command right after the frame's statistics are handed over,
+			// so they might only show up during the next call
+			const ct::FrameStats entry = mPendingFrameStats.front();
+			auto findQueueStats = mPendingQueueStats.find(entry.queueFrameIdx);
+			if(findQueueStats == mPendingQueueStats.end())
+				return;
+
+			const CoreThreadFrameStats queueStats = findQueueStats->second;
+			mPendingQueueStats.erase(findQueueStats);
+			mPendingFrameStats.pop_front();
+
+			// Done with all the configurations, waiting for the application to quit
+			if(mRunIdx >= (UINT32)mRecordThreadCounts.size())
+				continue;
+
+			// Frame rendered before the core thread picked up the current configuration
+			if(entry.numRecordThreads != mRecordThreadCounts[mRunIdx])
+				continue;
+
+			mNumRunFrames++;
+			if(mNumRunFrames <= mNumWarmupFrames)
+				continue;
+
+			// Frames are rendered on the core thread, so record them under their own index rather than the current
+			// main thread frame
+			mLog->record("cpuMs", entry.cpuTime, entry.frameIdx);
+#if BS_PROFILING_ENABLED
+			mLog->record("heapAllocs", entry.numHeapAllocs, entry.frameIdx);
+#endif
+			mLog->record("gpuObjectsCreated", entry.numGpuObjectsCreated, entry.frameIdx);
+			mLog->record("drawCalls", entry.numDrawCalls, entry.frameIdx);
+			mLog->record("presentCpuMs", entry.presentCpuTime, entry.frameIdx);
+
+			if(CommandLine::hasOption("capture"))
+				mLog->record("captureDrops", entry.numCaptureDrops, entry.frameIdx);
+
+			if(CommandLine::hasOption("stream-rate"))
+			{
+				mLog->record("streamVertices", entry.numStreamedVertices, entry.frameIdx);
+				mLog->record("streamDiscards", entry.numStreamDiscards, entry.frameIdx);
+				mLog->record("streamMs", entry.streamTime, entry.frameIdx);
+			}
+
+			// GPU times become available a few frames later, so they belong to an earlier frame than the one they
+			// are recorded with
+			if(entry.gpuSceneTime >= 0.0f)
+				mLog->record("gpuSceneMs", entry.gpuSceneTime, entry.frameIdx);
+
+			if(entry.gpuBlitTime >= 0.0f)
+				mLog->record("gpuBlitMs", entry.gpuBlitTime, entry.frameIdx);
+
+			// Timings of the commands queued during the main thread frame that queued this frame
+			mLog->record("queueDepth", queueStats.maxQueueDepth, entry.frameIdx);
+			mLog->record("queueWaitMs", queueStats.avgWaitTime, entry.frameIdx);
+			mLog->record("queueWaitMaxMs", queueStats.maxWaitTime, entry.frameIdx);
+			mLog->record("coreExecuteMs", queueStats.executeTime, entry.frameIdx);
+			mLog->record("mainIdleRatio", queueStats.mainIdleRatio, entry.frameIdx);
+			mLog->record("coreIdleRatio", queueStats.coreIdleRatio, entry.frameIdx);
+
+			if(mNumRunFrames == mNumWarmupFrames + mNumFrames)
+			{
+				// Setup has finished by the time frames are rendered
+				ct::SetupStats setupStats;
+				if(ct::getSetupStats(setupStats))
+				{
+					mLog->setRunProperty("setupMs", toString(setupStats.setupTime));
+					mLog->setRunProperty("programsCompiled", toString(setupStats.numProgramsCompiled));
+					mLog->setRunProperty("programsLoaded", toString(setupStats.numProgramsLoaded));
+					mLog->setRunProperty("programsReused", toString(setupStats.numProgramsReused));
+					mLog->setRunProperty("pipelinesCreated", toString(setupStats.numPipelinesCreated));
+					mLog->setRunProperty("pipelinesReused", toString(setupStats.numPipelinesReused));
+				}
+
+				mLog->endRun();
+
+				mRunIdx++;
+				if(mRunIdx < (UINT32)mRecordThreadCounts.size())
+					startRun();
+				else
+				{
+					restoreNumTaskWorkers();
+					mLog->save(mOutputPath);
+					gApplication().quitRequested();
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
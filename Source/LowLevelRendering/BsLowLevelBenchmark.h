@@ -0,0 +1,98 @@
+#pragma once
+
+#include "BsPrerequisites.h"
+#include "BsCoreThreadProfiler.h"
+
+namespace bs
+{
+	class BenchmarkLog;
+
+	// Returns the resolution the objects are rendered at. Defined in Main.cpp.
+	void getRenderResolution(UINT32& width, UINT32& height);
+
+	// Statistics the core thread rendering in Main.cpp hands over to the benchmark
+	namespace ct
+	{
+		// CPU-side statistics about a single frame rendered on the core thread
+		struct FrameStats
+		{
+			UINT64 frameIdx; // Sequential index of the frame, counting from the first rendered frame
+			float cpuTime; // Time it took to prepare & submit the frame's commands, in milliseconds
+			UINT32 numHeapAllocs; // Number of heap allocations made while preparing the frame
+			UINT32 numGpuObjectsCreated; // Number of GPU objects (buffers, command buffers, parameters) created
+			UINT32 numDrawCalls; // Number of draw calls issued
+			UINT32 numRecordThreads; // Number of threads the draw calls were recorded on
+			float presentCpuTime; // Time it took to capture the frame, blit it to the window & present it, in milliseconds
+			float gpuSceneTime; // GPU time spent rendering the objects in a recent frame, or negative if not available
+			float gpuBlitTime; // GPU time spent blitting the image to the window in a recent frame, or negative if
+			                   // not available
+			UINT32 numCaptureDrops; // Number of frames the frame capture dropped during this frame
+			UINT32 numStreamedVertices; // Number of ribbon vertices streamed to the GPU
+			UINT32 numStreamDiscards; // Number of times the streamed geometry had to discard its buffers
+			float streamTime; // Time it took to generate & write the streamed geometry, in milliseconds
+			UINT64 queueFrameIdx; // Index of the main thread frame the frame was queued during
+		};
+
+		// Statistics about the resources created by setup()
+		struct SetupStats
+		{
+			float setupTime; // Time it took to create all the resources, in milliseconds
+			UINT32 numProgramsCompiled; // Number of GPU programs compiled from source
+			UINT32 numProgramsLoaded; // Number of GPU programs created from bytecode cached by a previous run
+			UINT32 numProgramsReused; // Number of GPU program requests that returned an existing program
+			UINT32 numPipelinesCreated; // Number of pipeline states created
+			UINT32 numPipelinesReused; // Number of pipeline state requests that returned an existing pipeline
+		};
+
+		// Hands the statistics of the frames rendered since the last call over to the main thread
+		void takeFrameStats(Vector<FrameStats>& output);
+
+		// Changes the number of threads the per-object draw calls are recorded on
+		void setRecordThreads(UINT32 numThreads);
+
+		// Returns statistics about the resources created by setup(), if it has finished
+		bool getSetupStats(SetupStats& output);
+	}
+
+	// Benchmark harness of the LowLevelRendering example, enabled by --benchmark-frames. Records the statistics of the
+	// frames rendered on the core thread, along with the timings of the commands that queued them, in a separate run
+	// for every record thread count. Once every run has been recorded, the statistics are saved and the application
+	// quits. Must be used from the main thread.
+	class LowLevelBenchmark
+	{
+	public:
+		// Reads the benchmark options from the command line, and starts the first run. Every run records the provided
+		// number of frames, after the warmup frames.
+		LowLevelBenchmark(UINT32 numFrames, UINT32 windowWidth, UINT32 windowHeight);
+
+		// Restores the number of task scheduler workers changed for the recording threads, if the runs haven't finished
+		// yet. Must be destroyed before the task scheduler is shut down.
+		~LowLevelBenchmark();
+
+		// Records the statistics of the frames rendered on the core thread since the last call, joined with the queue
+		// timings from the provided profiler. Once enough frames have been recorded for every configuration, the
+		// statistics are saved and the application quits.
+		void recordFrameStats(CoreThreadProfiler& queueProfiler);
+
+	private:
+		// Starts recording the statistics of the current benchmark configuration, and applies the configuration on the
+		// core thread
+		void startRun();
+
+		SPtr<BenchmarkLog> mLog;
+		UINT32 mNumFrames = 0;
+		UINT32 mNumWarmupFrames = 0;
+		UINT32 mWindowWidth = 0;
+		UINT32 mWindowHeight = 0;
+		Path mOutputPath;
+
+		Vector<ct::FrameStats> mFrameStats;
+		Deque<ct::FrameStats> mPendingFrameStats;
+		Vector<CoreThreadFrameStats> mQueueFrameStats;
+		UnorderedMap<UINT64, CoreThreadFrameStats> mPendingQueueStats;
+
+		Vector<UINT32> mRecordThreadCounts;
+		UINT32 mRunIdx = 0;
+		UINT32 mNumRunFrames = 0;
+	};
+}
\ No newline at end of file
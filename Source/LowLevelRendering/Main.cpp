@@ -11,12 +11,26 @@
 #include "RenderAPI/BsGpuParamBlockBuffer.h"
 #include "RenderAPI/BsIndexBuffer.h"
 #include "RenderAPI/BsVertexDataDesc.h"
+#include "RenderAPI/BsTimerQuery.h"
 #include "Mesh/BsMeshData.h"
 #include "Math/BsQuaternion.h"
 #include "Utility/BsTime.h"
+#include "Utility/BsTimer.h"
 #include "Renderer/BsRendererUtility.h"
 #include "BsEngineConfig.h"
 
+// Example includes
+#include "BsCommandLine.h"
+#include "BsUniformRingBuffer.h"
+#include "BsCommandBufferPool.h"
+#include "BsParallelFor.h"
+#include "BsGpuPipelineCache.h"
+#include "BsFrameCapture.h"
+#include "BsGeometryStreamer.h"
+#include "BsProceduralGeometry.h"
+#include "BsCoreThreadProfiler.h"
+#include "BsLowLevelBenchmark.h"
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This example uses the low-level rendering API to render a textured cube mesh. This is opposed to using scene objects
 // and components, in which case objects are rendered automatically based on their transform and other properties.
@@ -32,19 +46,84 @@
 // The example first sets up necessary resources, like GPU programs, pipeline state, vertex & index buffers. Then every
 // frame it binds the necessary rendering resources and executes the draw call.
 //
+// On top of that, the example demonstrates the following, most of which are enabled by the options listed below:
+// 1. Resource reuse - GPU programs and pipeline states are created through a cache, which reuses the ones created for
+//    identical descriptors and saves the compiled programs to disk. The uniform buffers and command buffers are taken
+//    from a ring and a pool, which only hand them out again once the GPU has finished the frame that used them, so
+//    frames don't create any GPU objects once the ring warms up.
+// 2. Many objects - Many copies of the cube, drawn with one draw call per object, one instanced draw call, or merged
+//    into batches of 131072 objects. bsf has no multi-draw or indirect draw calls, so batches are the nearest
+//    alternative to submitting all the objects at once.
+// 3. Multi-threaded recording - The per-object draw calls are recorded on multiple threads, into command buffers that
+//    are submitted in a fixed order.
+// 4. Presenting - The objects are rendered to an offscreen render target and blitted to the window. The target can be
+//    smaller than the window, which the blit upscales, or skipped by rendering directly to the window.
+// 5. Frame capture - Every frame is copied to a CPU readable texture, read back a few frames later once the copy is
+//    done, and saved by a background thread, so capturing never waits on the GPU or the disk.
+// 6. Streamed geometry - Animated ribbons are generated on the CPU every frame, and written to large dynamic vertex &
+//    index buffers used as rings, only reusing the space the GPU is done with.
+// 7. Queue profiling - The commands queued for the core thread are timestamped when queued, started and finished,
+//    showing how long they wait and how much of every frame the main & core threads spend idle. The timings are
+//    recorded when benchmarking, and can be drawn as an on-screen graph.
+//
+// The following options are supported:
+// --shader-cache=path - Folder in which to save the compiled GPU programs, so following runs can skip compiling them.
+//    Defaults to ShaderCache.
+// --no-shader-cache - Always compile the GPU programs, without saving them.
+// --per-frame-allocation - Create new uniform buffers and a new command buffer every frame instead, for comparison.
+// --objects=N - Number of cubes to render, from 1 to 1000000. Defaults to 1.
+// --draw-mode=draw|instanced|batched - Way to draw the cubes. Defaults to draw, i.e. one draw call per object. The
+//    per-object mode needs a uniform buffer per object in every frame of the uniform ring, and the batched mode needs
+//    about 650 bytes of GPU memory per object.
+// --record-threads=N - Record the per-object draw calls on N threads, each recording a slice of the objects into its own
+//    command buffer. The command buffers are submitted in order, so the objects are drawn in the same order regardless
+//    of the number of threads. Only used in the per-object draw mode, and not together with --per-frame-allocation.
+// --record-thread-sweep - When benchmarking, record a separate run for 1, 2, 4, ... threads, up to --record-threads.
+// --direct - Render the objects directly to the window, instead of to an offscreen render target blitted to the window.
+// --render-scale=N - Render the objects to an offscreen render target N times the size of the window, from 0.1 to 1,
+//    which the blit upscales to the window. Defaults to 1. Not used together with --direct.
+// --capture=path - Save every rendered frame to the provided folder. Not supported together with --direct.
+// --capture-format=png|raw - Format to save the captured frames in. Defaults to png, using uncompressed PNG files. Raw
+//    frames are saved as tightly packed RGBA8 pixels, with the resolution in the file name.
+// --capture-staging=N - Number of frames that can be in flight between the GPU copy and the read back. Frames are
+//    dropped if the GPU falls further behind. Defaults to 3.
+// --stream-rate=N - Stream N vertices of animated ribbons per second, e.g. 10000000. The number of vertices streamed
+//    every frame depends on the time since the previous frame, so the rate holds regardless of the frame rate.
+// --queue-overlay - Draw a graph of the recent frames in the bottom left corner. Every frame is a gray bar of its frame
+//    time, with the average time the frame's commands waited in the core thread queue in red, the time the core thread
+//    spent executing them in green, and the most commands waiting in the queue at once in yellow. The full height of
+//    the graph is 33 milliseconds, or 8 commands.
+// --benchmark-frames=N - Record the CPU submission time, the number of draw calls and the number of allocations made by
+//    N frames, save them and quit. The core thread queue depth, wait time and thread idle ratios are recorded as well.
+// --benchmark-warmup=N - Number of frames to render before recording starts. Defaults to 10.
+// --benchmark-output=path - Path to the JSON file in which to save the statistics. Defaults to LowLevelRendering.json.
+//
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 namespace bs
 {
 	UINT32 windowResWidth = 1280;
 	UINT32 windowResHeight = 720;
 
+	// Returns the resolution the objects are rendered at. When rendering at a scale, the objects are rendered to a
+	// smaller target, which is upscaled to the window by the blit. When rendering directly to the window, the scale
+	// doesn't apply.
+	void getRenderResolution(UINT32& width, UINT32& height)
+	{
+		const float renderScale = CommandLine::hasOption("direct") ? 1.0f :
+			Math::clamp(CommandLine::getFloat("render-scale", 1.0f), 0.1f, 1.0f);
+
+		width = std::max((UINT32)Math::round(windowResWidth * renderScale), 1U);
+		height = std::max((UINT32)Math::round(windowResHeight * renderScale), 1U);
+	}
+
 	// Declare the methods we'll use to do work on the core thread. Note the "ct" namespace, which we use because we render
 	// on the core thread (ct = core thread). Every object usable on the core thread lives in this namespace.
 	namespace ct
 	{
 		void setup(const SPtr<RenderWindow>& renderWindow);
-		void render();
+		void render(UINT64 queueFrameIdx);
 		void shutdown();
+		void setQueueOverlay(const Vector<CoreThreadFrameStats>& history);
 	}
 
 	// Override the default Application so we can get notified when engine starts-up, shuts-down and when it executes
@@ -74,11 +153,22 @@ namespace bs
 			// Initialize all the resources we need for rendering. Since we do rendering on a separate thread (the "core
 			// thread"), we don't call the method directly, but rather queue it for execution using the CoreThread class.
 			gCoreThread().queueCommand(std::bind(&ct::setup, renderWindowCore));
+
+			// Optionally record the statistics of the rendered frames. The benchmark harness lives in
+			// BsLowLevelBenchmark.cpp, and isn't needed for rendering.
+			const UINT32 numBenchmarkFrames = CommandLine::getUInt("benchmark-frames", 0);
+			if(numBenchmarkFrames > 0)
+				mBenchmark = bs_shared_ptr_new<LowLevelBenchmark>(numBenchmarkFrames, windowResWidth, windowResHeight);
+
+			mShowQueueOverlay = CommandLine::hasOption("queue-overlay");
 		}
 
 		// Called when the engine is about to be shut down
 		void onShutDown() override
 		{
+			// Stop recording, in case the application is closed before the benchmark finishes
+			mBenchmark = nullptr;
+
 			// Queue the method for execution on the core thread
 			gCoreThread().queueCommand(&ct::shutdown);
 
@@ -86,15 +176,50 @@ namespace bs
 			Application::onShutDown();
 		}
 
-		// Called every frame, before any other engine system (optionally use postUpdate())
+		// Called every frame, before any other engine system
 		void preUpdate() override
 		{
-			// Queue the method for execution on the core thread
-			gCoreThread().queueCommand(&ct::render);
+			// Commands queued from now on belong to this frame
+			mQueueProfiler.beginFrame();
+
+			// Hand the timings of the recent frames to the core thread, to draw on top of this frame
+			if(mShowQueueOverlay)
+			{
+				const Deque<CoreThreadFrameStats>& history = mQueueProfiler.getHistory();
+				mQueueProfiler.queueCommand(std::bind(&ct::setQueueOverlay,
+					Vector<CoreThreadFrameStats>(history.begin(), history.end())));
+			}
+
+			// Queue the method for execution on the core thread. The profiler timestamps it when it's queued, started and
+			// finished.
+			mQueueProfiler.queueCommand(std::bind(&ct::render, gTime().getFrameIdx()));
+
+			// Record the statistics of the frames the core thread has finished since the last call. When not
+			// benchmarking only the profiler's history is used, so its per-frame statistics are thrown away.
+			if(mBenchmark)
+				mBenchmark->recordFrameStats(mQueueProfiler);
+			else
+				mQueueProfiler.takeFrameStats(mQueueFrameStats);
 
 			// Call the default version of this method to handle normal functionality
 			Application::preUpdate();
 		}
+
+		// Called every frame, after all the other engine systems have been updated
+		void postUpdate() override
+		{
+			Application::postUpdate();
+
+			// The main thread is done with the frame's work. From here on it submits the queued commands to the core
+			// thread, and waits for the core thread if it has fallen behind.
+			mQueueProfiler.endUpdate();
+		}
+
+		SPtr<LowLevelBenchmark> mBenchmark;
+
+		CoreThreadProfiler mQueueProfiler;
+		Vector<CoreThreadFrameStats> mQueueFrameStats;
+		bool mShowQueueOverlay = false;
 	};
 }
 
@@ -109,11 +234,18 @@ int CALLBACK WinMain(
 	_In_  int nCmdShow
 )
 #else
-int main()
+int main(int argc, char* argv[])
 #endif
 {
 	using namespace bs;
 
+	// Parse the options the example was started with
+#if BS_PLATFORM == BS_PLATFORM_WIN32
+	CommandLine::parse(__argc, __argv);
+#else
+	CommandLine::parse(argc, argv);
+#endif
+
 	// Define a video mode for the resolution of the primary rendering window.
 	VideoMode videoMode(windowResWidth, windowResHeight);
 
@@ -134,11 +266,27 @@ int main()
 namespace bs { namespace ct
 {
 	// Declarations for some helper methods we'll use during setup
-	void writeBoxVertices(const AABox& box, UINT8* positions, UINT8* uvs, UINT32 stride);
-	void writeBoxIndices(UINT32* indices);
 	const char* getVertexProgSource();
+	const char* getInstancedVertexProgSource();
 	const char* getFragmentProgSource();
-	Matrix4 createWorldViewProjectionMatrix();
+	GPU_PROGRAM_DESC createGpuProgramDesc(GpuProgramType type, const char* source);
+	GRAPHICS_PIPELINE_DESC createPipelineDesc(const char* vertexSource);
+	Matrix4 createViewProjectionMatrix();
+	void setupObjects(const SPtr<VertexDataDesc>& vertexDesc);
+	void bindGpuParams(const SPtr<GpuParams>& params, const SPtr<GpuParamBlockBuffer>& uniformBuffer);
+
+	struct UniformBlock;
+	void recordObjectsMultithreaded(const SPtr<CommandBuffer>& cmds, const Matrix4& viewProj,
+		UINT32& numGpuObjectsCreated);
+	void recordObjects(const SPtr<CommandBuffer>& cmds, const Matrix4& viewProj, UINT32 firstObject, UINT32 lastObject,
+		bool bindRenderTarget);
+	SPtr<GpuParams> getRingGpuParams(const SPtr<GraphicsPipelineState>& pipelineState,
+		const SPtr<GpuParamBlockBuffer>& uniformBuffer, UINT32& numCreated);
+	SPtr<GpuParams> getUniformParams(const UniformBlock& uniformBlock, const SPtr<GraphicsPipelineState>& pipelineState,
+		const SPtr<GpuParams>& sharedParams, const SPtr<CommandBuffer>& cmds, UINT32& numCreated);
+	void streamRibbons(const SPtr<CommandBuffer>& cmds, const UniformBlock& uniformBlock, FrameStats& frameStats,
+		UINT32& numGpuObjectsCreated);
+	void drawQueueOverlay(const SPtr<CommandBuffer>& cmds, UINT32& numDrawCalls, UINT32& numGpuObjectsCreated);
 
 	// Fields where we'll store the resources required during calls to render(). These are initialized in setup()
 	// and cleaned up in shutDown()
@@ -157,6 +305,111 @@ namespace bs { namespace ct
 	const UINT32 NUM_VERTICES = 24;
 	const UINT32 NUM_INDICES = 36;
 
+	// Ways of drawing the objects, selectable using the --draw-mode option
+	enum class DrawMode
+	{
+		PerObject, // One draw call per object, each with its own uniform buffer
+		Instanced, // One instanced draw call, with the object transforms in a per-instance vertex stream
+		Batched // All the objects merged into large vertex & index buffers, drawn using one draw call per batch
+	};
+
+	// Maximum number of objects that can be rendered at once
+	const UINT32 MAX_OBJECTS = 1000000;
+
+	// Maximum number of objects merged into a single vertex & index buffer, in the batched draw mode
+	const UINT32 MAX_OBJECTS_PER_BATCH = 131072;
+
+	// Objects to render, and the resources used for rendering them in the instanced & batched draw modes
+	DrawMode gDrawMode = DrawMode::PerObject;
+	Vector<Matrix4> gObjectTransforms;
+
+	SPtr<GraphicsPipelineState> gInstancedPipelineState;
+	SPtr<GpuParams> gInstancedGpuParams;
+	SPtr<VertexDeclaration> gInstancedVertexDecl;
+	SPtr<VertexBuffer> gInstanceBuffer;
+
+	// Vertex & index buffers containing a batch of objects merged together
+	struct Batch
+	{
+		SPtr<VertexBuffer> vertexBuffer;
+		SPtr<IndexBuffer> indexBuffer;
+		UINT32 numObjects;
+	};
+
+	Vector<Batch> gBatches;
+
+	// Ring of uniform buffers & pool of command buffers used every frame, unless creating them every frame instead
+	bool gPerFrameAllocation = false;
+	SPtr<UniformRingBuffer> gUniformRing;
+	SPtr<CommandBufferPool> gCommandBufferPool;
+
+	// GPU program parameters for every uniform buffer handed out by the ring, for each of the pipelines. The buffer a
+	// GpuParams object references never changes, so the parameters don't need to be re-bound every frame.
+	UnorderedMap<GpuParamBlockBuffer*, SPtr<GpuParams>> gRingGpuParams;
+	UnorderedMap<GpuParamBlockBuffer*, SPtr<GpuParams>> gRingInstancedGpuParams;
+
+	// Number of threads recording the per-object draw calls, and the command buffers they record into, one per thread
+	UINT32 gNumRecordThreads = 1;
+	Vector<SPtr<CommandBuffer>> gRecordCommandBuffers;
+
+	// Uniform buffer & parameters of every object, handed out by the ring before recording on multiple threads
+	struct ObjectDraw
+	{
+		SPtr<GpuParamBlockBuffer> uniformBuffer;
+		SPtr<GpuParams> params;
+	};
+
+	Vector<ObjectDraw> gObjectDraws;
+
+	// Target the objects are rendered to. Either the offscreen render target, which is then blitted to the window, or
+	// the window itself when rendering directly.
+	bool gRenderDirect = false;
+	SPtr<RenderTarget> gFrameTarget;
+
+	// GPU timer queries measuring how long rendering the objects and the blit take, for the last few frames. The results
+	// only become available once the GPU finishes the frame.
+	struct FrameTimerQueries
+	{
+		SPtr<TimerQuery> scene;
+		SPtr<TimerQuery> blit;
+		bool pending = false;
+	};
+
+	const UINT32 NUM_FRAME_TIMER_QUERIES = 4;
+	FrameTimerQueries gFrameTimerQueries[NUM_FRAME_TIMER_QUERIES];
+
+	// Streams the geometry of the animated ribbons, if enabled. Every ribbon is a strip of quads, split into two
+	// triangles each.
+	const UINT32 RIBBON_SEGMENTS = 255;
+	const UINT32 RIBBON_VERTICES = (RIBBON_SEGMENTS + 1) * 2;
+	const UINT32 RIBBON_INDICES = RIBBON_SEGMENTS * 6;
+	const UINT32 RIBBONS_PER_DRAW = 64;
+
+	SPtr<GeometryStreamer> gGeometryStreamer;
+	UINT32 gStreamRate = 0;
+	Timer gStreamTimer;
+
+	// Saves the rendered frames to disk, if enabled
+	SPtr<FrameCapture> gFrameCapture;
+
+	// Timings of the recent frames drawn by the queue overlay, if enabled, and the geometry of its bars. The graph's
+	// full height is OVERLAY_MAX_TIME milliseconds, or OVERLAY_MAX_QUEUE_DEPTH commands.
+	const float OVERLAY_MAX_TIME = 33.3f;
+	const UINT32 OVERLAY_MAX_QUEUE_DEPTH = 8;
+
+	Vector<CoreThreadFrameStats> gQueueOverlayHistory;
+	SPtr<GeometryStreamer> gOverlayStreamer;
+
+	// Cache used for creating the GPU programs and pipeline states
+	SPtr<GpuPipelineCache> gPipelineCache;
+
+	// Statistics about the rendered frames, waiting to be picked up by the main thread, and about setup()
+	Mutex gFrameStatsMutex;
+	SetupStats gSetupStats;
+	bool gSetupDone = false;
+	Vector<FrameStats> gFrameStats;
+	UINT64 gFrameIdx = 0;
+
 	// Structure that will hold uniform block variables for the GPU programs
 	struct UniformBlock
 	{
@@ -174,47 +427,25 @@ namespace bs { namespace ct
 		// This will be the primary output for our rendering (created by the main thread on start-up)
 		gRenderWindow = renderWindow;
 
-		// Create a vertex GPU program
-		const char* vertProgSrc = getVertexProgSource();
-
-		GPU_PROGRAM_DESC vertProgDesc;
-		vertProgDesc.type = GPT_VERTEX_PROGRAM;
-		vertProgDesc.entryPoint = "main";
-		vertProgDesc.language = gUseHLSL ? "hlsl" : gUseVKSL ? "vksl" : "glsl4_1";
-		vertProgDesc.source = vertProgSrc;
-
-		SPtr<GpuProgram> vertProg = GpuProgram::create(vertProgDesc);
+		// Create the ring of uniform buffers and the pool of command buffers. Three frames are enough for the CPU to
+		// get two frames ahead of the GPU without waiting on it.
+		gPerFrameAllocation = CommandLine::hasOption("per-frame-allocation");
+		gUniformRing = bs_shared_ptr_new<UniformRingBuffer>((UINT32)sizeof(UniformBlock), 3);
+		gCommandBufferPool = bs_shared_ptr_new<CommandBufferPool>(GQT_GRAPHICS);
 
-		// Create a fragment GPU program
-		const char* fragProgSrc = getFragmentProgSource();
+		// Number of threads to record the per-object draw calls on
+		setRecordThreads(CommandLine::getUInt("record-threads", 1));
 
-		GPU_PROGRAM_DESC fragProgDesc;
-		fragProgDesc.type = GPT_FRAGMENT_PROGRAM;
-		fragProgDesc.entryPoint = "main";
-		fragProgDesc.language = gUseHLSL ? "hlsl" : gUseVKSL ? "vksl" : "glsl4_1";
-		fragProgDesc.source = fragProgSrc;
+		// Create the cache that GPU programs & pipeline states are created through. Compiled programs are saved to
+		// disk, so following runs don't need to compile them again.
+		Timer setupTimer;
+		const Path shaderCachePath = CommandLine::hasOption("no-shader-cache") ? Path::BLANK :
+			Path(CommandLine::getString("shader-cache", "ShaderCache"));
 
-		SPtr<GpuProgram> fragProg = GpuProgram::create(fragProgDesc);
+		gPipelineCache = bs_shared_ptr_new<GpuPipelineCache>(shaderCachePath);
 
-		// Create a graphics pipeline state
-		BLEND_STATE_DESC blendDesc;
-		blendDesc.renderTargetDesc[0].blendEnable = true;
-		blendDesc.renderTargetDesc[0].renderTargetWriteMask = 0b0111; // RGB, don't write to alpha
-		blendDesc.renderTargetDesc[0].blendOp = BO_ADD;
-		blendDesc.renderTargetDesc[0].srcBlend = BF_SOURCE_ALPHA;
-		blendDesc.renderTargetDesc[0].dstBlend = BF_INV_SOURCE_ALPHA;
-
-		DEPTH_STENCIL_STATE_DESC depthStencilDesc;
-		depthStencilDesc.depthWriteEnable = false;
-		depthStencilDesc.depthReadEnable = false;
-
-		PIPELINE_STATE_DESC pipelineDesc;
-		pipelineDesc.blendState = BlendState::create(blendDesc);
-		pipelineDesc.depthStencilState = DepthStencilState::create(depthStencilDesc);
-		pipelineDesc.vertexProgram = vertProg;
-		pipelineDesc.fragmentProgram = fragProg;
-
-		gPipelineState = GraphicsPipelineState::create(pipelineDesc);
+		// Create a graphics pipeline state, along with its vertex & fragment GPU programs
+		gPipelineState = gPipelineCache->getGraphicsPipeline(createPipelineDesc(getVertexProgSource()));
 
 		// Create an object containing GPU program parameters
 		gGpuParams = GpuParams::create(gPipelineState);
@@ -226,7 +457,8 @@ namespace bs { namespace ct
 
 		gVertexDecl = VertexDeclaration::create(vertexDesc);
 
-		// Create & fill the vertex buffer for a box mesh
+		// Create the vertex & index buffers for a box mesh. Objects are scaled & positioned by their transforms. The
+		// box has few enough vertices for 16-bit indices.
 		UINT32 vertexStride = vertexDesc->getVertexStride();
 
 		VERTEX_BUFFER_DESC vbDesc;
@@ -235,25 +467,24 @@ namespace bs { namespace ct
 
 		gVertexBuffer = VertexBuffer::create(vbDesc);
 
-		UINT8* vbData = (UINT8*)gVertexBuffer->lock(0, vertexStride * NUM_VERTICES, GBL_WRITE_ONLY_DISCARD);
-		UINT8* positions = vbData + vertexDesc->getElementOffsetFromStream(VES_POSITION);
-		UINT8* uvs = vbData + vertexDesc->getElementOffsetFromStream(VES_TEXCOORD);
-
-		AABox box(Vector3::ONE * -10.0f, Vector3::ONE * 10.0f);
-		writeBoxVertices(box, positions, uvs, vertexStride);
-
-		gVertexBuffer->unlock();
-
-		// Create & fill the index buffer for a box mesh
 		INDEX_BUFFER_DESC ibDesc;
 		ibDesc.numIndices = NUM_INDICES;
-		ibDesc.indexType = IT_32BIT;
+		ibDesc.indexType = ProceduralGeometry::getIndexType(NUM_VERTICES);
 
 		gIndexBuffer = IndexBuffer::create(ibDesc);
-		UINT32* ibData = (UINT32*)gIndexBuffer->lock(0, NUM_INDICES * sizeof(UINT32), GBL_WRITE_ONLY_DISCARD);
-		writeBoxIndices(ibData);
+
+		const UINT32 indexSize = ProceduralGeometry::getIndexSize(ibDesc.indexType);
+
+		// Fill the buffers, with the vertex attributes placed according to the vertex declaration
+		UINT8* vbData = (UINT8*)gVertexBuffer->lock(0, vertexStride * NUM_VERTICES, GBL_WRITE_ONLY_DISCARD);
+		void* ibData = gIndexBuffer->lock(0, NUM_INDICES * indexSize, GBL_WRITE_ONLY_DISCARD);
+
+		AABox box(-Vector3::ONE, Vector3::ONE);
+		ProceduralGeometry::writeBox(box, ProceduralVertexOutput::interleaved(vbData, *vertexDesc), ibData,
+			ibDesc.indexType);
 
 		gIndexBuffer->unlock();
+		gVertexBuffer->unlock();
 
 		// Create a simple 2x2 checkerboard texture to map to the object we're about to render
 		SPtr<PixelData> pixelData = PixelData::create(2, 2, 1, PF_RGBA8);
@@ -272,9 +503,12 @@ namespace bs { namespace ct
 		gSurfaceSampler = SamplerState::create(samplerDesc);
 
 		// Create a color attachment texture for the render surface
+		UINT32 renderWidth, renderHeight;
+		getRenderResolution(renderWidth, renderHeight);
+
 		TEXTURE_DESC colorAttDesc;
-		colorAttDesc.width = windowResWidth;
-		colorAttDesc.height = windowResHeight;
+		colorAttDesc.width = renderWidth;
+		colorAttDesc.height = renderHeight;
 		colorAttDesc.format = PF_RGBA8;
 		colorAttDesc.usage = TU_RENDERTARGET;
 
@@ -282,8 +516,8 @@ namespace bs { namespace ct
 
 		// Create a depth attachment texture for the render surface
 		TEXTURE_DESC depthAttDesc;
-		depthAttDesc.width = windowResWidth;
-		depthAttDesc.height = windowResHeight;
+		depthAttDesc.width = renderWidth;
+		depthAttDesc.height = renderHeight;
 		depthAttDesc.format = PF_D32;
 		depthAttDesc.usage = TU_DEPTHSTENCIL;
 
@@ -295,78 +529,458 @@ namespace bs { namespace ct
 		desc.depthStencilSurface.texture = depthAtt;
 
 		gRenderTarget = RenderTexture::create(desc);
+
+		// Optionally skip the offscreen target and render directly to the window, avoiding the blit
+		gRenderDirect = CommandLine::hasOption("direct");
+		if(gRenderDirect)
+		{
+			if(CommandLine::hasOption("render-scale"))
+				LOGWRN("--render-scale is ignored when rendering directly to the window.");
+
+			gFrameTarget = gRenderWindow;
+		}
+		else
+			gFrameTarget = gRenderTarget;
+
+		// Optionally stream animated geometry. The buffers hold about a tenth of a second worth of vertices, which is a
+		// few frames at any interactive frame rate.
+		gStreamRate = CommandLine::getUInt("stream-rate", 0);
+		if(gStreamRate > 0)
+		{
+			const UINT32 numStreamVertices = std::max(gStreamRate / 10, RIBBON_VERTICES * RIBBONS_PER_DRAW);
+			const UINT32 numStreamIndices = (UINT32)((UINT64)numStreamVertices * RIBBON_INDICES / RIBBON_VERTICES);
+
+			gGeometryStreamer = bs_shared_ptr_new<GeometryStreamer>(vertexStride, numStreamVertices, numStreamIndices);
+			gStreamTimer.reset();
+		}
+
+		// Optionally capture the rendered frames. The window's back buffer can't be copied, so this requires rendering to
+		// the offscreen render target.
+		if(CommandLine::hasOption("capture"))
+		{
+			if(gRenderDirect)
+				LOGWRN("--capture is not supported when rendering directly to the window.");
+			else
+			{
+				const FrameCaptureFormat captureFormat = CommandLine::getString("capture-format", "png") == "raw" ?
+					FrameCaptureFormat::Raw : FrameCaptureFormat::PNG;
+
+				gFrameCapture = bs_shared_ptr_new<FrameCapture>(Path(CommandLine::getString("capture")), captureFormat,
+					CommandLine::getUInt("capture-staging", 3));
+			}
+		}
+
+		// Optionally draw the queue timings on top of the frame. Every frame of the graph is four quads, and the buffers
+		// fit a few frames worth of them.
+		if(CommandLine::hasOption("queue-overlay"))
+			gOverlayStreamer = bs_shared_ptr_new<GeometryStreamer>(vertexStride, 128 * 4 * 4 * 3, 128 * 4 * 6 * 3);
+
+		// Create the queries for measuring GPU time
+		for(auto& entry : gFrameTimerQueries)
+		{
+			entry.scene = TimerQuery::create();
+			entry.blit = TimerQuery::create();
+		}
+
+		// Position the objects, and create the resources needed by the selected draw mode
+		setupObjects(vertexDesc);
+
+		// Remember how long the setup took, and how many of the programs had to be compiled
+		const GpuPipelineCacheStats& cacheStats = gPipelineCache->getStats();
+
+		Lock lock(gFrameStatsMutex);
+		gSetupStats.setupTime = setupTimer.getMicroseconds() / 1000.0f;
+		gSetupStats.numProgramsCompiled = cacheStats.numProgramsCompiled;
+		gSetupStats.numProgramsLoaded = cacheStats.numProgramsLoaded;
+		gSetupStats.numProgramsReused = cacheStats.numProgramsReused;
+		gSetupStats.numPipelinesCreated = cacheStats.numPipelinesCreated;
+		gSetupStats.numPipelinesReused = cacheStats.numPipelinesReused;
+		gSetupDone = true;
 	}
 
-	// Render the box, called every frame
-	void render()
+	// Positions the objects in a grid, and creates the resources needed for drawing them using the selected draw mode.
+	// The vertex description is the one used by the single object vertex buffer.
+	void setupObjects(const SPtr<VertexDataDesc>& vertexDesc)
 	{
-		// Fill out the uniform block variables
-		UniformBlock uniformBlock;
-		uniformBlock.gMatWVP = createWorldViewProjectionMatrix();
-		uniformBlock.gTint = Color(1.0f, 1.0f, 1.0f, 0.5f);
+		const String drawMode = CommandLine::getString("draw-mode", "draw");
+		if(drawMode == "instanced")
+			gDrawMode = DrawMode::Instanced;
+		else if(drawMode == "batched")
+			gDrawMode = DrawMode::Batched;
+		else
+			gDrawMode = DrawMode::PerObject;
 
-		// Create a uniform block buffer for holding the uniform variables
-		SPtr<GpuParamBlockBuffer> uniformBuffer = GpuParamBlockBuffer::create(sizeof(UniformBlock));
-		uniformBuffer->write(0, &uniformBlock, sizeof(uniformBlock));
+		const UINT32 numObjects = Math::clamp(CommandLine::getUInt("objects", 1), 1U, MAX_OBJECTS);
 
-		// Assign the uniform buffer & texture
-		gGpuParams->setParamBlockBuffer(GPT_FRAGMENT_PROGRAM, "Params", uniformBuffer);
-		gGpuParams->setParamBlockBuffer(GPT_VERTEX_PROGRAM, "Params", uniformBuffer);
+		// Place the objects in a cubic grid, filling the same space as a single object would. A single object fills its
+		// whole cell, while multiple ones leave gaps between them so they can be told apart.
+		UINT32 gridSize = 1;
+		while(gridSize * gridSize * gridSize < numObjects)
+			gridSize++;
 
-		gGpuParams->setTexture(GPT_FRAGMENT_PROGRAM, "gMainTexture", gSurfaceTex);
+		const float cellSize = 20.0f / gridSize;
+		const float objectScale = cellSize * (numObjects == 1 ? 0.5f : 0.3f);
+		const Vector3 gridOrigin = Vector3::ONE * (-10.0f + cellSize * 0.5f);
 
-		// HLSL uses separate sampler states, so we need to use a different name for the sampler
-		if(gUseHLSL)
-			gGpuParams->setSamplerState(GPT_FRAGMENT_PROGRAM, "gMainTexSamp", gSurfaceSampler);
+		gObjectTransforms.resize(numObjects);
+		for(UINT32 i = 0; i < numObjects; i++)
+		{
+			const UINT32 x = i % gridSize;
+			const UINT32 y = (i / gridSize) % gridSize;
+			const UINT32 z = i / (gridSize * gridSize);
+
+			Vector3 position = gridOrigin + Vector3((float)x, (float)y, (float)z) * cellSize;
+			gObjectTransforms[i] = Matrix4::TRS(position, Quaternion::IDENTITY, Vector3::ONE * objectScale);
+		}
+
+		if(gDrawMode == DrawMode::Instanced)
+		{
+			// Create a separate pipeline whose vertex program reads the object transforms from the per-instance stream.
+			// It uses the same fragment program and states as the regular pipeline, which the cache returns instead of
+			// creating them again.
+			gInstancedPipelineState = gPipelineCache->getGraphicsPipeline(
+				createPipelineDesc(getInstancedVertexProgSource()));
+			gInstancedGpuParams = GpuParams::create(gInstancedPipelineState);
+
+			// Per-vertex data comes from the first stream, and the first three rows of the object transform come from
+			// the second stream, advancing once per instance
+			SPtr<VertexDataDesc> instancedVertexDesc = VertexDataDesc::create();
+			instancedVertexDesc->addVertElem(VET_FLOAT3, VES_POSITION);
+			instancedVertexDesc->addVertElem(VET_FLOAT2, VES_TEXCOORD);
+			instancedVertexDesc->addVertElem(VET_FLOAT4, VES_TEXCOORD, 1, 1, 1);
+			instancedVertexDesc->addVertElem(VET_FLOAT4, VES_TEXCOORD, 2, 1, 1);
+			instancedVertexDesc->addVertElem(VET_FLOAT4, VES_TEXCOORD, 3, 1, 1);
+
+			gInstancedVertexDecl = VertexDeclaration::create(instancedVertexDesc);
+
+			// Fill the instance buffer. The transforms don't change, so this only needs to be done once.
+			const UINT32 instanceStride = instancedVertexDesc->getVertexStride(1);
+
+			VERTEX_BUFFER_DESC vbDesc;
+			vbDesc.numVerts = numObjects;
+			vbDesc.vertexSize = instanceStride;
+			vbDesc.usage = GBU_STATIC;
+
+			gInstanceBuffer = VertexBuffer::create(vbDesc);
+
+			float* instanceData = (float*)gInstanceBuffer->lock(0, instanceStride * numObjects, GBL_WRITE_ONLY_DISCARD);
+			for(UINT32 i = 0; i < numObjects; i++)
+			{
+				const Matrix4& transform = gObjectTransforms[i];
+				for(UINT32 row = 0; row < 3; row++)
+				{
+					for(UINT32 column = 0; column < 4; column++)
+						*instanceData++ = transform[row][column];
+				}
+			}
+
+			gInstanceBuffer->unlock();
+		}
+		else if(gDrawMode == DrawMode::Batched)
+		{
+			// Merge the objects into batches of vertex & index buffers, with the object transforms baked into the
+			// vertices. The same pipeline as for a single object can then render all of them, using one draw call per
+			// batch. The objects are only scaled & translated, so every one of them is still an axis aligned box.
+			const UINT32 vertexStride = vertexDesc->getVertexStride();
+			const AABox box(-Vector3::ONE, Vector3::ONE);
+
+			for(UINT32 firstObject = 0; firstObject < numObjects; firstObject += MAX_OBJECTS_PER_BATCH)
+			{
+				Batch batch;
+				batch.numObjects = std::min(numObjects - firstObject, MAX_OBJECTS_PER_BATCH);
+
+				VERTEX_BUFFER_DESC vbDesc;
+				vbDesc.numVerts = batch.numObjects * NUM_VERTICES;
+				vbDesc.vertexSize = vertexStride;
+				vbDesc.usage = GBU_STATIC;
+
+				batch.vertexBuffer = VertexBuffer::create(vbDesc);
+
+				INDEX_BUFFER_DESC ibDesc;
+				ibDesc.numIndices = batch.numObjects * NUM_INDICES;
+				ibDesc.indexType = ProceduralGeometry::getIndexType(vbDesc.numVerts);
+				ibDesc.usage = GBU_STATIC;
+
+				batch.indexBuffer = IndexBuffer::create(ibDesc);
+
+				const UINT32 indexSize = ProceduralGeometry::getIndexSize(ibDesc.indexType);
+
+				UINT8* vbData = (UINT8*)batch.vertexBuffer->lock(0, vbDesc.numVerts * vertexStride,
+					GBL_WRITE_ONLY_DISCARD);
+				UINT8* ibData = (UINT8*)batch.indexBuffer->lock(0, ibDesc.numIndices * indexSize,
+					GBL_WRITE_ONLY_DISCARD);
+
+				const ProceduralVertexOutput vertexOutput = ProceduralVertexOutput::interleaved(vbData, *vertexDesc);
+				for(UINT32 i = 0; i < batch.numObjects; i++)
+				{
+					AABox objectBox = box;
+					objectBox.transformAffine(gObjectTransforms[firstObject + i]);
+
+					ProceduralGeometry::writeBox(objectBox, vertexOutput.offset(i * NUM_VERTICES),
+						ibData + i * NUM_INDICES * indexSize, ibDesc.indexType, i * NUM_VERTICES);
+				}
+
+				batch.indexBuffer->unlock();
+				batch.vertexBuffer->unlock();
+
+				gBatches.push_back(batch);
+			}
+		}
+	}
+
+	// Render the objects, called every frame
+	void render(UINT64 queueFrameIdx)
+	{
+		// Measure how long it takes to prepare the frame, and how many allocations it makes
+		const UINT64 numAllocs = MemoryCounter::getNumAllocs();
+		Timer timer;
+
+		SPtr<CommandBuffer> cmds;
+		UINT32 numGpuObjectsCreated = 0;
+		UINT32 numDrawCalls = 0;
+
+		FrameStats frameStats;
+		frameStats.frameIdx = gFrameIdx++;
+		frameStats.queueFrameIdx = queueFrameIdx;
+		frameStats.gpuSceneTime = -1.0f;
+		frameStats.gpuBlitTime = -1.0f;
+
+		// Read the GPU times of the frame that last used this frame's timer queries. If the GPU isn't done with it yet,
+		// skip measuring this frame.
+		FrameTimerQueries& timerQueries = gFrameTimerQueries[frameStats.frameIdx % NUM_FRAME_TIMER_QUERIES];
+		if(timerQueries.pending && timerQueries.scene->isReady() && (gRenderDirect || timerQueries.blit->isReady()))
+		{
+			frameStats.gpuSceneTime = timerQueries.scene->getTimeMs();
+			frameStats.gpuBlitTime = gRenderDirect ? 0.0f : timerQueries.blit->getTimeMs();
+
+			timerQueries.pending = false;
+		}
+
+		const bool measureGpu = !timerQueries.pending;
+
+		if(gPerFrameAllocation)
+		{
+			// Create a command buffer
+			cmds = CommandBuffer::create(GQT_GRAPHICS);
+			numGpuObjectsCreated++;
+		}
 		else
-			gGpuParams->setSamplerState(GPT_FRAGMENT_PROGRAM, "gMainTexture", gSurfaceSampler);
+		{
+			// Move on to the next frame in the ring. Buffers handed out from now on are no longer used by the GPU.
+			gUniformRing->beginFrame();
+			gCommandBufferPool->beginFrame();
 
-		// Create a command buffer
-		SPtr<CommandBuffer> cmds = CommandBuffer::create(GQT_GRAPHICS);
+			// Grab a command buffer that's no longer executing
+			cmds = gCommandBufferPool->acquire();
+		}
 
 		// Get the primary render API access point
 		RenderAPI& rapi = RenderAPI::instance();
 
+		if(measureGpu)
+			timerQueries.scene->begin(cmds);
+
 		// Bind render surface & clear it
-		rapi.setRenderTarget(gRenderTarget, 0, RT_NONE, cmds);
+		rapi.setRenderTarget(gFrameTarget, 0, RT_NONE, cmds);
 		rapi.clearRenderTarget(FBT_COLOR | FBT_DEPTH, Color::Blue, 1, 0, 0xFF, cmds);
 
-		// Bind the pipeline state
-		rapi.setGraphicsPipeline(gPipelineState, cmds);
-
-		// Set the vertex & index buffers, as well as vertex declaration and draw type
-		rapi.setVertexBuffers(0, &gVertexBuffer, 1, cmds);
-		rapi.setIndexBuffer(gIndexBuffer, cmds);
-		rapi.setVertexDeclaration(gVertexDecl, cmds);
+		// Set the draw type, and the index buffer shared by the single object draw modes
 		rapi.setDrawOperation(DOT_TRIANGLE_LIST, cmds);
+		rapi.setIndexBuffer(gIndexBuffer, cmds);
 
-		// Bind the GPU program parameters (i.e. resource descriptors)
-		rapi.setGpuParams(gGpuParams, cmds);
+		// Fill out the uniform block variables shared by all objects. The world transform is applied separately for
+		// every object, or is already baked into the vertices.
+		const Matrix4 viewProj = createViewProjectionMatrix();
 
-		// Draw
-		rapi.drawIndexed(0, NUM_INDICES, 0, NUM_VERTICES, 1, cmds);
+		UniformBlock uniformBlock;
+		uniformBlock.gMatWVP = gUseHLSL ? viewProj : viewProj.transpose(); // GLSL uses column major matrices
+		uniformBlock.gTint = Color(1.0f, 1.0f, 1.0f, 0.5f);
 
-		// Submit the command buffer
+		switch(gDrawMode)
+		{
+		case DrawMode::PerObject:
+		{
+			// Bind the pipeline state, the vertex buffer & vertex declaration
+			rapi.setGraphicsPipeline(gPipelineState, cmds);
+			rapi.setVertexBuffers(0, &gVertexBuffer, 1, cmds);
+			rapi.setVertexDeclaration(gVertexDecl, cmds);
+
+			// Record the objects on multiple threads, if requested
+			if(gNumRecordThreads > 1 && !gPerFrameAllocation)
+			{
+				recordObjectsMultithreaded(cmds, viewProj, numGpuObjectsCreated);
+				numDrawCalls += (UINT32)gObjectTransforms.size();
+
+				break;
+			}
+
+			// Every object gets its own uniform buffer, with its own world view projection matrix
+			for(auto& entry : gObjectTransforms)
+			{
+				const Matrix4 worldViewProj = viewProj * entry;
+				uniformBlock.gMatWVP = gUseHLSL ? worldViewProj : worldViewProj.transpose();
+
+				SPtr<GpuParams> gpuParams = getUniformParams(uniformBlock, gPipelineState, gGpuParams, cmds,
+					numGpuObjectsCreated);
+
+				// Bind the GPU program parameters (i.e. resource descriptors) & draw
+				rapi.setGpuParams(gpuParams, cmds);
+				rapi.drawIndexed(0, NUM_INDICES, 0, NUM_VERTICES, 1, cmds);
+				numDrawCalls++;
+			}
+		}
+			break;
+		case DrawMode::Instanced:
+		{
+			// Bind the instancing pipeline, and the vertex buffers of both the object & the instance stream
+			rapi.setGraphicsPipeline(gInstancedPipelineState, cmds);
+
+			SPtr<VertexBuffer> vertexBuffers[] = { gVertexBuffer, gInstanceBuffer };
+			rapi.setVertexBuffers(0, vertexBuffers, 2, cmds);
+			rapi.setVertexDeclaration(gInstancedVertexDecl, cmds);
+
+			SPtr<GpuParams> gpuParams = getUniformParams(uniformBlock, gInstancedPipelineState, gInstancedGpuParams,
+				cmds, numGpuObjectsCreated);
+
+			// Draw all the objects using a single draw call
+			rapi.setGpuParams(gpuParams, cmds);
+			rapi.drawIndexed(0, NUM_INDICES, 0, NUM_VERTICES, (UINT32)gObjectTransforms.size(), cmds);
+			numDrawCalls++;
+		}
+			break;
+		case DrawMode::Batched:
+		{
+			rapi.setGraphicsPipeline(gPipelineState, cmds);
+			rapi.setVertexDeclaration(gVertexDecl, cmds);
+
+			SPtr<GpuParams> gpuParams = getUniformParams(uniformBlock, gPipelineState, gGpuParams, cmds,
+				numGpuObjectsCreated);
+			rapi.setGpuParams(gpuParams, cmds);
+
+			// Draw every batch of merged objects using a single draw call
+			for(auto& entry : gBatches)
+			{
+				rapi.setVertexBuffers(0, &entry.vertexBuffer, 1, cmds);
+				rapi.setIndexBuffer(entry.indexBuffer, cmds);
+
+				rapi.drawIndexed(0, entry.numObjects * NUM_INDICES, 0, entry.numObjects * NUM_VERTICES, 1, cmds);
+				numDrawCalls++;
+			}
+		}
+			break;
+		}
+
+		// Anything drawn on top of the objects goes to the last command buffer to execute, so the objects recorded by
+		// other threads don't draw over it
+		const SPtr<CommandBuffer>& lastCmds = gRecordCommandBuffers.empty() ? cmds : gRecordCommandBuffers.back();
+
+		// Draw the streamed ribbons on top of the objects
+		frameStats.numStreamedVertices = 0;
+		frameStats.numStreamDiscards = 0;
+		frameStats.streamTime = 0.0f;
+
+		if(gGeometryStreamer)
+		{
+			streamRibbons(lastCmds, uniformBlock, frameStats, numGpuObjectsCreated);
+			numDrawCalls += Math::divideAndRoundUp(frameStats.numStreamedVertices, RIBBON_VERTICES * RIBBONS_PER_DRAW);
+		}
+
+		// Draw the overlay last, on top of everything else
+		if(gOverlayStreamer)
+			drawQueueOverlay(lastCmds, numDrawCalls, numGpuObjectsCreated);
+
+		// Stop measuring at the end of the last command buffer to execute
+		if(measureGpu)
+			timerQueries.scene->end(lastCmds);
+
+		// Submit the command buffer, followed by the ones recorded by other threads, if any. Command buffers execute in
+		// the order they are submitted, so the objects are drawn in the same order as when recorded on a single thread.
 		rapi.submitCommandBuffer(cmds);
 
-		// Blit the image from the render texture, to the render window
-		rapi.setRenderTarget(gRenderWindow);
+		for(UINT32 i = 1; i < (UINT32)gRecordCommandBuffers.size(); i++)
+			rapi.submitCommandBuffer(gRecordCommandBuffers[i]);
+
+		gRecordCommandBuffers.clear();
+
+		if(!gPerFrameAllocation)
+		{
+			numGpuObjectsCreated += gUniformRing->getStats().numFrameBuffersCreated +
+				gCommandBufferPool->getNumFrameCreated();
+		}
+
+		// The blit & present below are measured separately, as they are the same regardless of how the objects are
+		// drawn
+		frameStats.cpuTime = timer.getMicroseconds() / 1000.0f;
+		frameStats.numHeapAllocs = (UINT32)(MemoryCounter::getNumAllocs() - numAllocs);
+		frameStats.numGpuObjectsCreated = numGpuObjectsCreated;
+		frameStats.numDrawCalls = numDrawCalls;
+		frameStats.numRecordThreads = gNumRecordThreads;
+
+		timer.reset();
+
+		// Copy the frame for capturing, once rendering to it has been submitted
+		frameStats.numCaptureDrops = 0;
+		if(gFrameCapture)
+		{
+			const FrameCaptureStats prevCaptureStats = gFrameCapture->getStats();
+			gFrameCapture->capture(gRenderTarget->getColorTexture(0), frameStats.frameIdx);
+
+			const FrameCaptureStats captureStats = gFrameCapture->getStats();
+			frameStats.numCaptureDrops = (captureStats.numFramesDropped - prevCaptureStats.numFramesDropped) +
+				(captureStats.numWritesDropped - prevCaptureStats.numWritesDropped);
+		}
+
+		// When rendering directly to the window the image is already there, otherwise blit it from the render texture
+		if(!gRenderDirect)
+		{
+			rapi.setRenderTarget(gRenderWindow);
+
+			if(measureGpu)
+				timerQueries.blit->begin();
+
+			// Get the color attachment
+			SPtr<Texture> colorTexture = gRenderTarget->getColorTexture(0);
+
+			// Use the helper RendererUtility to draw a full-screen quad of the provided texture and output it to the
+			// currently bound render target. Internally this uses the same calls we used above, just with a different
+			// pipeline and mesh. The quad covers the whole window, so a render target smaller than the window is
+			// upscaled.
+			gRendererUtility().blit(colorTexture);
 
-		// Get the color attachment
-		SPtr<Texture> colorTexture = gRenderTarget->getColorTexture(0);
+			if(measureGpu)
+				timerQueries.blit->end();
+		}
 
-		// Use the helper RendererUtility to draw a full-screen quad of the provided texture and output it to the currently
-		// bound render target. Internally this uses the same calls we used above, just with a different pipeline and mesh.
-		gRendererUtility().blit(colorTexture);
+		if(measureGpu)
+			timerQueries.pending = true;
 
 		// Present the rendered image to the user
 		rapi.swapBuffers(gRenderWindow);
+
+		frameStats.presentCpuTime = timer.getMicroseconds() / 1000.0f;
+
+		// Hand the statistics over to the main thread
+		{
+			Lock lock(gFrameStatsMutex);
+			gFrameStats.push_back(frameStats);
+		}
 	}
 
 	// Clean up any resources
 	void shutdown()
 	{
+		// Destroying the capture saves the frames still in flight, so do it while their textures are still around
+		if(gFrameCapture)
+		{
+			const FrameCaptureStats captureStats = gFrameCapture->getStats();
+			gFrameCapture = nullptr;
+
+			LOGDBG("Frame capture: " + toString(captureStats.numFramesCaptured) + " frames captured, " +
+				toString(captureStats.numFramesDropped + captureStats.numWritesDropped) + " dropped.");
+		}
+
 		gPipelineState = nullptr;
+		gPipelineCache = nullptr;
 		gSurfaceTex = nullptr;
 		gGpuParams = nullptr;
 		gVertexDecl = nullptr;
@@ -374,69 +988,142 @@ namespace bs { namespace ct
 		gIndexBuffer = nullptr;
 		gRenderTarget = nullptr;
 		gRenderWindow = nullptr;
+		gFrameTarget = nullptr;
+		gGeometryStreamer = nullptr;
+		gOverlayStreamer = nullptr;
+		gQueueOverlayHistory.clear();
 		gSurfaceSampler = nullptr;
+		gInstancedPipelineState = nullptr;
+		gInstancedGpuParams = nullptr;
+		gInstancedVertexDecl = nullptr;
+		gInstanceBuffer = nullptr;
+		gBatches.clear();
+		gRecordCommandBuffers.clear();
+		gObjectDraws.clear();
+
+		for(auto& entry : gFrameTimerQueries)
+		{
+			entry.scene = nullptr;
+			entry.blit = nullptr;
+			entry.pending = false;
+		}
+
+		gUniformRing = nullptr;
+		gCommandBufferPool = nullptr;
+		gRingGpuParams.clear();
+		gRingInstancedGpuParams.clear();
 	}
 
-	/////////////////////////////////////////////////////////////////////////////////////
-	//////////////////////////////////HELPER METHODS/////////////////////////////////////
-	/////////////////////////////////////////////////////////////////////////////////////
-	void writeBoxVertices(const AABox& box, UINT8* positions, UINT8* uvs, UINT32 stride)
+	// Returns statistics about the resources created by setup(), if it has finished
+	bool getSetupStats(SetupStats& output)
 	{
-		AABox::Corner vertOrder[] =
-		{
-			AABox::NEAR_LEFT_BOTTOM,	AABox::NEAR_RIGHT_BOTTOM,	AABox::NEAR_RIGHT_TOP,		AABox::NEAR_LEFT_TOP,
-			AABox::FAR_RIGHT_BOTTOM,	AABox::FAR_LEFT_BOTTOM,		AABox::FAR_LEFT_TOP,		AABox::FAR_RIGHT_TOP,
-			AABox::FAR_LEFT_BOTTOM,		AABox::NEAR_LEFT_BOTTOM,	AABox::NEAR_LEFT_TOP,		AABox::FAR_LEFT_TOP,
-			AABox::NEAR_RIGHT_BOTTOM,	AABox::FAR_RIGHT_BOTTOM,	AABox::FAR_RIGHT_TOP,		AABox::NEAR_RIGHT_TOP,
-			AABox::FAR_LEFT_TOP,		AABox::NEAR_LEFT_TOP,		AABox::NEAR_RIGHT_TOP,		AABox::FAR_RIGHT_TOP,
-			AABox::FAR_LEFT_BOTTOM,		AABox::FAR_RIGHT_BOTTOM,	AABox::NEAR_RIGHT_BOTTOM,	AABox::NEAR_LEFT_BOTTOM
-		};
+		Lock lock(gFrameStatsMutex);
+		output = gSetupStats;
+
+		return gSetupDone;
+	}
 
-		for (auto& entry : vertOrder)
+	// Changes the number of threads the per-object draw calls are recorded on
+	void setRecordThreads(UINT32 numThreads)
+	{
+		gNumRecordThreads = std::max(numThreads, 1U);
+	}
+
+	// Provides the timings of the recent frames, for the queue overlay to draw
+	void setQueueOverlay(const Vector<CoreThreadFrameStats>& history)
+	{
+		gQueueOverlayHistory = history;
+	}
+
+	// Records the per-object draw calls on multiple threads, each recording a slice of the objects into its own command
+	// buffer. The first slice is recorded into the provided command buffer. The other command buffers are stored in
+	// gRecordCommandBuffers, in the order they need to be submitted in.
+	void recordObjectsMultithreaded(const SPtr<CommandBuffer>& cmds, const Matrix4& viewProj,
+		UINT32& numGpuObjectsCreated)
+	{
+		const UINT32 numObjects = (UINT32)gObjectTransforms.size();
+		const UINT32 numSlices = std::min(gNumRecordThreads, numObjects);
+
+		gRecordCommandBuffers.resize(numSlices);
+		gRecordCommandBuffers[0] = cmds;
+		gUniformRing->addFence(cmds);
+
+		for(UINT32 i = 1; i < numSlices; i++)
 		{
-			Vector3 pos = box.getCorner(entry);
-			memcpy(positions, &pos, sizeof(pos));
+			gRecordCommandBuffers[i] = gCommandBufferPool->acquire();
+			gUniformRing->addFence(gRecordCommandBuffers[i]);
+		}
 
-			positions += stride;
+		// Hand out the uniform buffers & parameters of all the objects up front, on the core thread. This way the
+		// recording threads never create any GPU objects, nor need to synchronize access to the ring.
+		gObjectDraws.resize(numObjects);
+		for(auto& entry : gObjectDraws)
+		{
+			entry.uniformBuffer = gUniformRing->allocate();
+			entry.params = getRingGpuParams(gPipelineState, entry.uniformBuffer, numGpuObjectsCreated);
 		}
 
-		for (UINT32 i = 0; i < 6; i++)
+		// Record every slice on its own thread. Slices are contiguous ranges of objects, split evenly.
+		parallelFor(numSlices, 1, [&viewProj, numObjects, numSlices](UINT32 start, UINT32 end)
 		{
-			Vector2 uv;
+			for(UINT32 i = start; i < end; i++)
+			{
+				const UINT32 firstObject = (UINT32)((UINT64)numObjects * i / numSlices);
+				const UINT32 lastObject = (UINT32)((UINT64)numObjects * (i + 1) / numSlices);
+
+				recordObjects(gRecordCommandBuffers[i], viewProj, firstObject, lastObject, i > 0);
+			}
+		});
+	}
+
+	// Records the draw calls of the objects in the [firstObject, lastObject) range, using the uniform buffers and
+	// parameters from gObjectDraws. The command buffer of the first slice already has the render target bound & cleared,
+	// while the others bind it without clearing, keeping the contents rendered by the previous slices.
+	void recordObjects(const SPtr<CommandBuffer>& cmds, const Matrix4& viewProj, UINT32 firstObject, UINT32 lastObject,
+		bool bindRenderTarget)
+	{
+		RenderAPI& rapi = RenderAPI::instance();
+
+		if(bindRenderTarget)
+			rapi.setRenderTarget(gFrameTarget, 0, RT_NONE, cmds);
+
+		// Command buffers don't share any state, so every one needs all of it bound
+		rapi.setGraphicsPipeline(gPipelineState, cmds);
+		rapi.setVertexBuffers(0, &gVertexBuffer, 1, cmds);
+		rapi.setIndexBuffer(gIndexBuffer, cmds);
+		rapi.setVertexDeclaration(gVertexDecl, cmds);
+		rapi.setDrawOperation(DOT_TRIANGLE_LIST, cmds);
 
-			uv = Vector2(0.0f, 1.0f);
-			memcpy(uvs, &uv, sizeof(uv));
-			uvs += stride;
+		UniformBlock uniformBlock;
+		uniformBlock.gTint = Color(1.0f, 1.0f, 1.0f, 0.5f);
 
-			uv = Vector2(1.0f, 1.0f);
-			memcpy(uvs, &uv, sizeof(uv));
-			uvs += stride;
+		for(UINT32 i = firstObject; i < lastObject; i++)
+		{
+			const Matrix4 worldViewProj = viewProj * gObjectTransforms[i];
+			uniformBlock.gMatWVP = gUseHLSL ? worldViewProj : worldViewProj.transpose(); // GLSL uses column major matrices
 
-			uv = Vector2(1.0f, 0.0f);
-			memcpy(uvs, &uv, sizeof(uv));
-			uvs += stride;
+			const ObjectDraw& draw = gObjectDraws[i];
+			draw.uniformBuffer->write(0, &uniformBlock, sizeof(uniformBlock));
 
-			uv = Vector2(0.0f, 0.0f);
-			memcpy(uvs, &uv, sizeof(uv));
-			uvs += stride;
+			rapi.setGpuParams(draw.params, cmds);
+			rapi.drawIndexed(0, NUM_INDICES, 0, NUM_VERTICES, 1, cmds);
 		}
 	}
 
-	void writeBoxIndices(UINT32* indices)
+	// Hands the statistics of the frames rendered since the last call over to the main thread
+	void takeFrameStats(Vector<FrameStats>& output)
 	{
-		for (UINT32 face = 0; face < 6; face++)
-		{
-			UINT32 faceVertOffset = face * 4;
+		// Swap the buffers instead of copying, so both keep their capacity and no allocations are needed after the
+		// first few frames
+		output.clear();
 
-			indices[face * 6 + 0] = faceVertOffset + 2;
-			indices[face * 6 + 1] = faceVertOffset + 1;
-			indices[face * 6 + 2] = faceVertOffset + 0;
-			indices[face * 6 + 3] = faceVertOffset + 0;
-			indices[face * 6 + 4] = faceVertOffset + 3;
-			indices[face * 6 + 5] = faceVertOffset + 2;
-		}
+		Lock lock(gFrameStatsMutex);
+		std::swap(output, gFrameStats);
 	}
 
+	/////////////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////HELPER METHODS/////////////////////////////////////
+	/////////////////////////////////////////////////////////////////////////////////////
 	const char* getVertexProgSource()
 	{
 		if(gUseHLSL)
@@ -518,6 +1205,108 @@ void main()
 		}
 	}
 
+	const char* getInstancedVertexProgSource()
+	{
+		// Same as the regular vertex program, except the world transform comes from the per-instance vertex stream. The
+		// uniform block only contains the view projection matrix. Only the first three rows of the transform are stored,
+		// as the last one is always (0, 0, 0, 1).
+		if(gUseHLSL)
+		{
+			static const char* src = R"(
+cbuffer Params
+{
+	float4x4 gMatWVP;
+	float4 gTint;
+}	
+
+void main(
+	in float3 inPos : POSITION,
+	in float2 uv : TEXCOORD0,
+	in float4 world0 : TEXCOORD1,
+	in float4 world1 : TEXCOORD2,
+	in float4 world2 : TEXCOORD3,
+	out float4 oPosition : SV_Position,
+	out float2 oUv : TEXCOORD0)
+{
+	float4 localPos = float4(inPos.xyz, 1);
+	float4 worldPos = float4(dot(world0, localPos), dot(world1, localPos), dot(world2, localPos), 1);
+
+	oPosition = mul(gMatWVP, worldPos);
+	oUv = uv;
+}
+)";
+
+			return src;
+		}
+		else if(gUseVKSL)
+		{
+			static const char* src = R"(
+layout (binding = 0, std140) uniform Params
+{
+	mat4 gMatWVP;
+	vec4 gTint;
+};
+
+layout (location = 0) in vec3 bs_position;
+layout (location = 1) in vec2 bs_texcoord0;
+layout (location = 2) in vec4 bs_texcoord1;
+layout (location = 3) in vec4 bs_texcoord2;
+layout (location = 4) in vec4 bs_texcoord3;
+
+layout (location = 0) out vec2 texcoord0;
+
+out gl_PerVertex
+{
+	vec4 gl_Position;
+};
+
+void main()
+{
+	vec4 localPos = vec4(bs_position.xyz, 1);
+	vec4 worldPos = vec4(dot(bs_texcoord1, localPos), dot(bs_texcoord2, localPos), dot(bs_texcoord3, localPos), 1);
+
+	gl_Position = gMatWVP * worldPos;
+	texcoord0 = bs_texcoord0;
+}
+)";
+
+			return src;
+		}
+		else
+		{
+			static const char* src = R"(
+layout (std140) uniform Params
+{
+	mat4 gMatWVP;
+	vec4 gTint;
+};
+
+in vec3 bs_position;
+in vec2 bs_texcoord0;
+in vec4 bs_texcoord1;
+in vec4 bs_texcoord2;
+in vec4 bs_texcoord3;
+
+out vec2 texcoord0;
+
+out gl_PerVertex
+{
+	vec4 gl_Position;
+};
+
+void main()
+{
+	vec4 localPos = vec4(bs_position.xyz, 1);
+	vec4 worldPos = vec4(dot(bs_texcoord1, localPos), dot(bs_texcoord2, localPos), dot(bs_texcoord3, localPos), 1);
+
+	gl_Position = gMatWVP * worldPos;
+	texcoord0 = bs_texcoord0;
+}
+)";
+			return src;
+		}
+	}
+
 	const char* getFragmentProgSource()
 	{
 		if (gUseHLSL)
@@ -589,7 +1378,287 @@ void main()
 		}
 	}
 
-	Matrix4 createWorldViewProjectionMatrix()
+	void bindGpuParams(const SPtr<GpuParams>& params, const SPtr<GpuParamBlockBuffer>& uniformBuffer)
+	{
+		// Assign the uniform buffer & texture
+		params->setParamBlockBuffer(GPT_FRAGMENT_PROGRAM, "Params", uniformBuffer);
+		params->setParamBlockBuffer(GPT_VERTEX_PROGRAM, "Params", uniformBuffer);
+
+		params->setTexture(GPT_FRAGMENT_PROGRAM, "gMainTexture", gSurfaceTex);
+
+		// HLSL uses separate sampler states, so we need to use a different name for the sampler
+		if(gUseHLSL)
+			params->setSamplerState(GPT_FRAGMENT_PROGRAM, "gMainTexSamp", gSurfaceSampler);
+		else
+			params->setSamplerState(GPT_FRAGMENT_PROGRAM, "gMainTexture", gSurfaceSampler);
+	}
+
+	SPtr<GpuParams> getUniformParams(const UniformBlock& uniformBlock, const SPtr<GraphicsPipelineState>& pipelineState,
+		const SPtr<GpuParams>& sharedParams, const SPtr<CommandBuffer>& cmds, UINT32& numCreated)
+	{
+		if(gPerFrameAllocation)
+		{
+			// Create a uniform block buffer for holding the uniform variables, and assign it to the shared parameters
+			SPtr<GpuParamBlockBuffer> uniformBuffer = GpuParamBlockBuffer::create(sizeof(UniformBlock));
+			uniformBuffer->write(0, &uniformBlock, sizeof(uniformBlock));
+
+			bindGpuParams(sharedParams, uniformBuffer);
+			numCreated++;
+
+			return sharedParams;
+		}
+
+		// Grab a uniform buffer from the ring, fill it with the uniform variables and let the ring know the command
+		// buffer uses it
+		SPtr<GpuParamBlockBuffer> uniformBuffer = gUniformRing->allocate(&uniformBlock, sizeof(uniformBlock));
+		gUniformRing->addFence(cmds);
+
+		return getRingGpuParams(pipelineState, uniformBuffer, numCreated);
+	}
+
+	SPtr<GpuParams> getRingGpuParams(const SPtr<GraphicsPipelineState>& pipelineState,
+		const SPtr<GpuParamBlockBuffer>& uniformBuffer, UINT32& numCreated)
+	{
+		// Find the parameters referencing the uniform buffer, with the texture already assigned
+		UnorderedMap<GpuParamBlockBuffer*, SPtr<GpuParams>>& ringParams =
+			pipelineState == gInstancedPipelineState ? gRingInstancedGpuParams : gRingGpuParams;
+
+		SPtr<GpuParams>& params = ringParams[uniformBuffer.get()];
+		if(!params)
+		{
+			// First time the ring handed out this buffer, create parameters for it
+			params = GpuParams::create(pipelineState);
+			bindGpuParams(params, uniformBuffer);
+
+			numCreated++;
+		}
+
+		return params;
+	}
+
+	// Generates animated ribbons & streams them to the GPU, drawing them in batches. The number of vertices depends on the
+	// time since the last call, so the requested number of vertices per second is streamed regardless of the frame rate.
+	void streamRibbons(const SPtr<CommandBuffer>& cmds, const UniformBlock& uniformBlock, FrameStats& frameStats,
+		UINT32& numGpuObjectsCreated)
+	{
+		Timer timer;
+
+		const float elapsed = std::min(gStreamTimer.getMicroseconds() / 1000000.0f, 0.1f);
+		gStreamTimer.reset();
+
+		const UINT32 numRibbons = std::max((UINT32)(gStreamRate * elapsed) / RIBBON_VERTICES, 1U);
+		const GeometryStreamerStats& stats = gGeometryStreamer->getStats();
+		const UINT32 numDiscards = stats.numDiscards;
+		const UINT32 numResizes = stats.numResizes;
+
+		gGeometryStreamer->beginFrame();
+
+		RenderAPI& rapi = RenderAPI::instance();
+		rapi.setGraphicsPipeline(gPipelineState, cmds);
+		rapi.setVertexDeclaration(gVertexDecl, cmds);
+
+		SPtr<GpuParams> gpuParams = getUniformParams(uniformBlock, gPipelineState, gGpuParams, cmds,
+			numGpuObjectsCreated);
+		rapi.setGpuParams(gpuParams, cmds);
+
+		const float time = gTime().getTime();
+		const float laneSpacing = 20.0f / numRibbons;
+
+		for(UINT32 firstRibbon = 0; firstRibbon < numRibbons; firstRibbon += RIBBONS_PER_DRAW)
+		{
+			const UINT32 numBatchRibbons = std::min(numRibbons - firstRibbon, RIBBONS_PER_DRAW);
+			StreamedGeometry geometry = gGeometryStreamer->lock(numBatchRibbons * RIBBON_VERTICES,
+				numBatchRibbons * RIBBON_INDICES);
+
+			// Vertices are a position followed by a UV, matching the vertex declaration
+			float* vertices = (float*)geometry.vertices;
+			UINT32* indices = (UINT32*)geometry.indices;
+
+			for(UINT32 i = 0; i < numBatchRibbons; i++)
+			{
+				const UINT32 ribbonIdx = firstRibbon + i;
+				const float phase = time * 3.0f + ribbonIdx * 0.37f;
+				const float z = -10.0f + (ribbonIdx + 0.5f) * laneSpacing;
+
+				for(UINT32 j = 0; j <= RIBBON_SEGMENTS; j++)
+				{
+					const float t = j / (float)RIBBON_SEGMENTS;
+					const float x = -10.0f + 20.0f * t;
+					const float y = Math::sin(Radian(t * Math::TWO_PI * 2.0f + phase)) * 2.0f;
+
+					*vertices++ = x; *vertices++ = y - 0.05f; *vertices++ = z;
+					*vertices++ = t; *vertices++ = 0.0f;
+
+					*vertices++ = x; *vertices++ = y + 0.05f; *vertices++ = z;
+					*vertices++ = t; *vertices++ = 1.0f;
+				}
+
+				// Indices are relative to the first vertex of the batch
+				const UINT32 baseVertex = i * RIBBON_VERTICES;
+				for(UINT32 j = 0; j < RIBBON_SEGMENTS; j++)
+				{
+					const UINT32 vertex = baseVertex + j * 2;
+
+					*indices++ = vertex;
+					*indices++ = vertex + 1;
+					*indices++ = vertex + 2;
+					*indices++ = vertex + 2;
+					*indices++ = vertex + 1;
+					*indices++ = vertex + 3;
+				}
+			}
+
+			gGeometryStreamer->unlock();
+
+			// Bind the buffers after the lock, as an allocation that doesn't fit can replace them
+			SPtr<VertexBuffer> vertexBuffer = gGeometryStreamer->getVertexBuffer();
+			rapi.setVertexBuffers(0, &vertexBuffer, 1, cmds);
+			rapi.setIndexBuffer(gGeometryStreamer->getIndexBuffer(), cmds);
+
+			rapi.drawIndexed(geometry.firstIndex, geometry.numIndices, geometry.firstVertex, geometry.numVertices, 1,
+				cmds);
+		}
+
+		// The space used by this frame is only reused once the command buffer is done executing
+		gGeometryStreamer->addFence(cmds);
+
+		frameStats.numStreamedVertices = stats.numFrameVertices;
+		frameStats.numStreamDiscards = stats.numDiscards - numDiscards;
+		numGpuObjectsCreated += stats.numResizes - numResizes;
+		frameStats.streamTime = timer.getMicroseconds() / 1000.0f;
+	}
+
+	// Draws a graph of the queue timings of the recent frames in the bottom left corner of the frame. Every frame is a
+	// gray bar of its frame time, with the average time its commands waited in the queue, the time spent executing them
+	// and the queue depth drawn in front of it as thinner red, green & yellow bars.
+	void drawQueueOverlay(const SPtr<CommandBuffer>& cmds, UINT32& numDrawCalls, UINT32& numGpuObjectsCreated)
+	{
+		const UINT32 numFrames = (UINT32)gQueueOverlayHistory.size();
+		if(numFrames == 0)
+			return;
+
+		// Bars of a single kind, drawn using one draw call. Left & right are relative to the frame's slot in the graph.
+		struct OverlaySeries
+		{
+			Color color;
+			float left;
+			float right;
+			float(*height)(const CoreThreadFrameStats&);
+		};
+
+		const OverlaySeries series[] =
+		{
+			{ Color(0.5f, 0.5f, 0.5f, 0.6f), 0.0f, 0.9f,
+				[](const CoreThreadFrameStats& stats) { return stats.frameTime / OVERLAY_MAX_TIME; } },
+			{ Color(1.0f, 0.2f, 0.2f, 0.9f), 0.1f, 0.3f,
+				[](const CoreThreadFrameStats& stats) { return stats.avgWaitTime / OVERLAY_MAX_TIME; } },
+			{ Color(0.2f, 1.0f, 0.2f, 0.9f), 0.35f, 0.55f,
+				[](const CoreThreadFrameStats& stats) { return stats.executeTime / OVERLAY_MAX_TIME; } },
+			{ Color(1.0f, 1.0f, 0.2f, 0.9f), 0.6f, 0.8f,
+				[](const CoreThreadFrameStats& stats) { return stats.maxQueueDepth / (float)OVERLAY_MAX_QUEUE_DEPTH; } }
+		};
+
+		const GeometryStreamerStats& stats = gOverlayStreamer->getStats();
+		const UINT32 numResizes = stats.numResizes;
+
+		gOverlayStreamer->beginFrame();
+
+		RenderAPI& rapi = RenderAPI::instance();
+		rapi.setGraphicsPipeline(gPipelineState, cmds);
+		rapi.setVertexDeclaration(gVertexDecl, cmds);
+
+		// Maps the graph's [0, 1] range to the bottom left corner of the frame, in clip space
+		Matrix4 graphToClip(
+			0.9f, 0.0f, 0.0f, -0.95f,
+			0.0f, 0.45f, 0.0f, -0.95f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f);
+		bs::RenderAPI::convertProjectionMatrix(graphToClip, graphToClip);
+
+		UniformBlock uniformBlock;
+		uniformBlock.gMatWVP = gUseHLSL ? graphToClip : graphToClip.transpose(); // GLSL uses column major matrices
+
+		const float slotWidth = 1.0f / numFrames;
+		for(auto& entry : series)
+		{
+			StreamedGeometry geometry = gOverlayStreamer->lock(numFrames * 4, numFrames * 6);
+
+			// Vertices are a position followed by a UV, matching the vertex declaration. The UV points to a white texel
+			// of the texture, so the bars are the color of the tint.
+			float* vertices = (float*)geometry.vertices;
+			UINT32* indices = (UINT32*)geometry.indices;
+
+			for(UINT32 i = 0; i < numFrames; i++)
+			{
+				const float left = (i + entry.left) * slotWidth;
+				const float right = (i + entry.right) * slotWidth;
+				const float top = Math::clamp01(entry.height(gQueueOverlayHistory[i]));
+
+				*vertices++ = left; *vertices++ = 0.0f; *vertices++ = 0.0f; *vertices++ = 0.25f; *vertices++ = 0.25f;
+				*vertices++ = left; *vertices++ = top; *vertices++ = 0.0f; *vertices++ = 0.25f; *vertices++ = 0.25f;
+				*vertices++ = right; *vertices++ = 0.0f; *vertices++ = 0.0f; *vertices++ = 0.25f; *vertices++ = 0.25f;
+				*vertices++ = right; *vertices++ = top; *vertices++ = 0.0f; *vertices++ = 0.25f; *vertices++ = 0.25f;
+
+				const UINT32 vertex = i * 4;
+				*indices++ = vertex;
+				*indices++ = vertex + 1;
+				*indices++ = vertex + 2;
+				*indices++ = vertex + 2;
+				*indices++ = vertex + 1;
+				*indices++ = vertex + 3;
+			}
+
+			gOverlayStreamer->unlock();
+
+			uniformBlock.gTint = entry.color;
+			SPtr<GpuParams> gpuParams = getUniformParams(uniformBlock, gPipelineState, gGpuParams, cmds,
+				numGpuObjectsCreated);
+			rapi.setGpuParams(gpuParams, cmds);
+
+			// Bind the buffers after the lock, as an allocation that doesn't fit can replace them
+			SPtr<VertexBuffer> vertexBuffer = gOverlayStreamer->getVertexBuffer();
+			rapi.setVertexBuffers(0, &vertexBuffer, 1, cmds);
+			rapi.setIndexBuffer(gOverlayStreamer->getIndexBuffer(), cmds);
+
+			rapi.drawIndexed(geometry.firstIndex, geometry.numIndices, geometry.firstVertex, geometry.numVertices, 1,
+				cmds);
+			numDrawCalls++;
+		}
+
+		gOverlayStreamer->addFence(cmds);
+		numGpuObjectsCreated += stats.numResizes - numResizes;
+	}
+
+	GPU_PROGRAM_DESC createGpuProgramDesc(GpuProgramType type, const char* source)
+	{
+		GPU_PROGRAM_DESC desc;
+		desc.type = type;
+		desc.entryPoint = "main";
+		desc.language = gUseHLSL ? "hlsl" : gUseVKSL ? "vksl" : "glsl4_1";
+		desc.source = source;
+
+		return desc;
+	}
+
+	GRAPHICS_PIPELINE_DESC createPipelineDesc(const char* vertexSource)
+	{
+		GRAPHICS_PIPELINE_DESC desc;
+		desc.blendState.renderTargetDesc[0].blendEnable = true;
+		desc.blendState.renderTargetDesc[0].renderTargetWriteMask = 0b0111; // RGB, don't write to alpha
+		desc.blendState.renderTargetDesc[0].blendOp = BO_ADD;
+		desc.blendState.renderTargetDesc[0].srcBlend = BF_SOURCE_ALPHA;
+		desc.blendState.renderTargetDesc[0].dstBlend = BF_INV_SOURCE_ALPHA;
+
+		desc.depthStencilState.depthWriteEnable = false;
+		desc.depthStencilState.depthReadEnable = false;
+
+		desc.vertexProgram = createGpuProgramDesc(GPT_VERTEX_PROGRAM, vertexSource);
+		desc.fragmentProgram = createGpuProgramDesc(GPT_FRAGMENT_PROGRAM, getFragmentProgSource());
+
+		return desc;
+	}
+
+	Matrix4 createViewProjectionMatrix()
 	{
 		Matrix4 proj = Matrix4::projectionPerspective(Degree(75.0f), 16.0f / 9.0f, 0.05f, 1000.0f);
 		bs::RenderAPI::convertProjectionMatrix(proj, proj);
@@ -602,15 +1671,10 @@ void main()
 
 		Matrix4 view = Matrix4::view(cameraPos, cameraRot);
 
+		// Spin all the objects around the center
 		Quaternion rotation(Vector3::UNIT_Y, Degree(gTime().getTime() * 90.0f));
 		Matrix4 world = Matrix4::TRS(Vector3::ZERO, rotation, Vector3::ONE);
 
-		Matrix4 viewProj = proj * view * world;
-
-		// GLSL uses column major matrices, so transpose
-		if(!gUseHLSL)
-			viewProj = viewProj.transpose();
-
-		return viewProj;
+		return proj * view * world;
 	}
 }}
\ No newline at end of file
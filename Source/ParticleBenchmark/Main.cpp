@@ -0,0 +1,890 @@
+// Framework includes
+#include "BsApplication.h"
+#include "Scene/BsSceneObject.h"
+#include "Image/BsColor.h"
+#include "Utility/BsTimer.h"
+
+// Example includes
+#include "BsCommandLine.h"
+#include "BsBenchmarkLog.h"
+#include "BsSimdParticles.h"
+#include "BsParticleSimulator.h"
+#include "BsParticleSort.h"
+#include "BsCpuVectorField.h"
+#include "BsExampleConfig.h"
+#include "BsParallelFor.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This benchmark compares the cost of evolving CPU particles using the SIMD particle simulation, against the scalar
+// approach used by the engine's particle evolvers.
+//
+// Both paths apply the same evolvers as used by the Particles example: texture animation, size and color over lifetime
+// (as used by the smoke effect), a force over lifetime, gravity and plane collisions (as used by the 3D particle effect).
+// The scalar path stores every particle as a single structure and evaluates the curves and the gradient per particle,
+// once per evolver. The SIMD path stores the particle attributes in separate arrays, bakes the curves into lookup
+// tables and processes multiple particles at once. Dead particles are respawned so the particle count stays constant.
+//
+// Every frame the particles are also sorted back to front, as done by ParticleSortMode::Distance. The scalar path uses a
+// comparison sort, while the SIMD path uses the radix sort from ParticleDistanceSorter.
+//
+// For every particle count the scalar path is run first, followed by the SIMD path, each for the same number of frames
+// with a fixed time step. Once done the results are saved in JSON format, including the speed-up of the SIMD path.
+//
+// When started with --scaling the benchmark instead measures how the simulation of many particle systems scales with
+// the number of worker threads. It creates copies of the smoke effect from the Particles example (same emitter and
+// evolvers), simulates them using ParticleSimulator, and runs the same scene once for every thread count. Each run also
+// records a checksum of the final particle state, which must be the same for all the thread counts. Before the first
+// run the benchmark also checks that splitting the particles into tasks of a size that isn't a multiple of the SIMD
+// width gives the same state as a multiple of it. The scaling benchmark can also use the GPU particle effect instead,
+// with its vector field evolver running on the CPU. In that case the vector field sampling of the SIMD path is first
+// compared against the scalar CpuVectorField::sample(), at random positions in and around the field, and the largest
+// difference is recorded.
+//
+// Before every scaling run the particle storage of all the systems is allocated from a single arena and the simulation
+// is fast-forwarded, using ParticleSimulator::prewarm(). Every recorded frame then counts the particle storage
+// allocations made by the simulator, and the growth of its sorting and task buffers, both of which must be zero. When
+// the engine is built with profiling enabled, the heap allocations made through the engine allocators on the main
+// thread are recorded as well. These are never zero, as every step allocates the tasks the work is split into. Without
+// profiling the engine doesn't count allocations, and the heap allocations are reported as unmeasured.
+//
+// The following options are supported:
+// --particle-counts=100000,1000000 - List of particle counts to test. Defaults to 100000,1000000,5000000.
+// --scaling - Run the thread scaling benchmark instead.
+// --scaling-systems=N - Number of particle systems to create for the scaling benchmark. Defaults to 500.
+// --scaling-effect=smoke|vectorfield - Effect to copy in the scaling benchmark, either the smoke effect or the GPU
+//    particle effect with its vector field. Defaults to smoke.
+// --vector-field=path - FGA file to load the vector field from. Defaults to the one used by the Particles example. The
+//    parsed field is cached in a binary file next to it, and the time it took to load is recorded.
+// --vector-field-half - Store the vector field cache using 16-bit floats.
+// --scaling-prewarm=N - Seconds to fast-forward before every scaling run, so the systems reach their full particle
+//    count. Defaults to 5.
+// --sweep-threads=1,2,4 - List of worker thread counts to test in the scaling benchmark. Defaults to 1,2,4,8,16,32.
+// --benchmark-warmup=N - Number of frames to run before recording. Defaults to 10.
+// --benchmark-frames=N - Number of frames to record for each run. Defaults to 100.
+// --benchmark-output=path - Path to the JSON file in which to save the results. Defaults to ParticleBenchmark.json, or
+//    ParticleScaling.json for the scaling benchmark.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+namespace bs
+{
+	UINT32 windowResWidth = 640;
+	UINT32 windowResHeight = 360;
+
+	/** Time step used for every simulated frame, regardless of how long the frame actually took. */
+	constexpr float TIME_STEP = 1.0f / 60.0f;
+
+	/** Number of frames in the smoke sprite sheet used by the Particles example. */
+	constexpr UINT32 NUM_SMOKE_FRAMES = 30;
+
+	/** Point the particles are sorted relative to. */
+	const Vector3 VIEW_POINT(0.0f, 5.0f, -20.0f);
+
+	/** Parses a comma separated list of numbers from the command line option with the provided name. */
+	Vector<UINT32> getListOption(const String& name, const Vector<UINT32>& defaultValues)
+	{
+		const String value = CommandLine::getString(name);
+		if(value.empty())
+			return defaultValues;
+
+		Vector<UINT32> output;
+		for(auto& entry : StringUtil::split(value, ","))
+		{
+			const UINT32 number = parseUINT32(entry, 0);
+			if(number > 0)
+				output.push_back(number);
+		}
+
+		return output.empty() ? defaultValues : output;
+	}
+
+	/** Returns the evolvers used by the smoke effect in the Particles example. */
+	SIMD_PARTICLE_EVOLVERS_DESC getSmokeEvolversDesc()
+	{
+		SIMD_PARTICLE_EVOLVERS_DESC desc;
+		desc.numFrames = NUM_SMOKE_FRAMES;
+		desc.numCycles = 1;
+
+		desc.useSize = true;
+		desc.size = TAnimationCurve<float>(
+			{
+				TKeyframe<float>{1.0f, 0.0f, 1.0f, 0.0f},
+				TKeyframe<float>{4.0f, 1.0f, 0.0f, 1.0f},
+			});
+
+		desc.useColor = true;
+		desc.color = ColorGradient(
+			{
+				ColorGradientKey(Color::White, 0.0f),
+				ColorGradientKey(Color(0.1f, 0.1f, 0.1f, 1.0f), 0.4f)
+			}
+		);
+
+		desc.useForce = true;
+		desc.force = TAnimationCurve<Vector3>(
+			{
+				TKeyframe<Vector3>{Vector3::ZERO, Vector3::ZERO, Vector3::ONE, 0.0f},
+				TKeyframe<Vector3>{Vector3(100.0f, 0.0f, 0.0f), -Vector3::ONE, Vector3::ZERO, 0.5f},
+			});
+
+		return desc;
+	}
+
+	/** Returns the evolvers to apply, matching the ones used in the Particles example. */
+	SIMD_PARTICLE_EVOLVERS_DESC getEvolversDesc()
+	{
+		SIMD_PARTICLE_EVOLVERS_DESC desc = getSmokeEvolversDesc();
+
+		// Same as the 3D particle effect
+		desc.gravity = Vector3(0.0f, -9.81f, 0.0f);
+		desc.collisionPlanes = { Plane(Vector3::UNIT_Y, 0.0f) };
+		desc.collisionRadius = 0.02f;
+
+		return desc;
+	}
+
+	/** Particle stored as a single structure, as used by the scalar path. */
+	struct ScalarParticle
+	{
+		Vector3 position;
+		Vector3 velocity;
+		float size;
+		Color color;
+		float frame;
+		float lifetime;
+		float initialLifetime;
+	};
+
+	/** Evolves the particles one evolver at a time, evaluating the curves for every particle. */
+	void simulateScalar(Vector<ScalarParticle>& particles, const SIMD_PARTICLE_EVOLVERS_DESC& desc, float timeStep)
+	{
+		// Age the particles and respawn the dead ones at rest
+		for(auto& entry : particles)
+		{
+			entry.lifetime -= timeStep;
+			if(entry.lifetime <= 0.0f)
+			{
+				entry.lifetime += entry.initialLifetime;
+				entry.position = Vector3::ZERO;
+				entry.velocity = Vector3::ZERO;
+			}
+		}
+
+		auto getNormalizedTime = [](const ScalarParticle& particle)
+		{
+			return Math::clamp01(1.0f - particle.lifetime / particle.initialLifetime);
+		};
+
+		// ParticleTextureAnimation
+		for(auto& entry : particles)
+		{
+			const float cycle = getNormalizedTime(entry) * desc.numCycles;
+			const float frame = std::floor((cycle - std::floor(cycle)) * desc.numFrames);
+			entry.frame = std::min(frame, (float)(desc.numFrames - 1));
+		}
+
+		// ParticleSize
+		for(auto& entry : particles)
+			entry.size = desc.size.evaluate(getNormalizedTime(entry), false);
+
+		// ParticleColor
+		for(auto& entry : particles)
+			entry.color = Color::fromRGBA(desc.color.evaluate(getNormalizedTime(entry)));
+
+		// ParticleForce
+		for(auto& entry : particles)
+			entry.velocity += desc.force.evaluate(getNormalizedTime(entry), false) * timeStep;
+
+		// ParticleGravity
+		for(auto& entry : particles)
+			entry.velocity += desc.gravity * timeStep;
+
+		// Integrate the position
+		for(auto& entry : particles)
+			entry.position += entry.velocity * timeStep;
+
+		// ParticleCollisions
+		for(auto& plane : desc.collisionPlanes)
+		{
+			for(auto& entry : particles)
+			{
+				const float distance = plane.getDistance(entry.position);
+				if(distance >= desc.collisionRadius)
+					continue;
+
+				entry.position += plane.normal * (desc.collisionRadius - distance);
+
+				const float normalVel = plane.normal.dot(entry.velocity);
+				if(normalVel < 0.0f)
+				{
+					const Vector3 tangentVel = entry.velocity - plane.normal * normalVel;
+					entry.velocity = tangentVel * (1.0f - desc.dampening) - plane.normal * (normalVel * desc.restitution);
+				}
+			}
+		}
+	}
+
+	/** Generates the initial state of a particle with the provided index. Both paths start with the same particles. */
+	ScalarParticle generateParticle(UINT32 idx)
+	{
+		UINT32 state = (idx + 1) * 0x9E3779B9;
+		auto random = [&state]()
+		{
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+
+			return (state & 0xFFFFFF) / (float)0xFFFFFF;
+		};
+
+		ScalarParticle particle;
+		particle.position = Vector3(random() - 0.5f, random() * 2.0f, random() - 0.5f);
+		particle.velocity = Vector3(random() - 0.5f, 1.0f + random(), random() - 0.5f);
+		particle.size = 1.0f;
+		particle.color = Color::White;
+		particle.frame = 0.0f;
+		particle.initialLifetime = 1.0f + random() * 4.0f;
+		particle.lifetime = particle.initialLifetime * random();
+
+		return particle;
+	}
+
+	/** Number of positions the SIMD vector field sampling is compared against the scalar sampling at. */
+	constexpr UINT32 NUM_VECTOR_FIELD_SAMPLES = 4096;
+
+	/** Largest allowed relative difference between the SIMD and the scalar vector field sampling. */
+	constexpr float VECTOR_FIELD_TOLERANCE = 0.001f;
+
+	/**
+	 * Compares the vector field sampling done by the SIMD path against CpuVectorField::sample(), at random positions
+	 * within and around the vector field bounds, both with and without tiling. Returns the largest difference between
+	 * the two, relative to the longest vector in the field.
+	 */
+	float compareVectorFieldSampling(const SPtr<CpuVectorField>& field)
+	{
+		// Sample outside of the bounds as well, so clamping and tiling are covered
+		const AABox& bounds = field->getBounds();
+		const Vector3 sampleMin = bounds.getMin() - bounds.getSize() * 0.5f;
+		const Vector3 sampleSize = bounds.getSize() * 2.0f;
+
+		float maxLength = 0.0f;
+		for(UINT32 i = 0; i < (UINT32)field->getValuesX().size(); i++)
+		{
+			const Vector3 value(field->getValuesX()[i], field->getValuesY()[i], field->getValuesZ()[i]);
+			maxLength = std::max(maxLength, value.length());
+		}
+
+		UINT32 state = 0x9E3779B9;
+		auto random = [&state]()
+		{
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+
+			return (state & 0xFFFFFF) / (float)0xFFFFFF;
+		};
+
+		float maxError = 0.0f;
+		for(bool tile : { false, true })
+		{
+			// With full tightness and no other evolvers, the velocities are set to the sampled vectors
+			SIMD_PARTICLE_EVOLVERS_DESC desc;
+			desc.vectorField.vectorField = field;
+			desc.vectorField.tightness = 1.0f;
+			desc.vectorField.tilingX = tile;
+			desc.vectorField.tilingY = tile;
+			desc.vectorField.tilingZ = tile;
+			desc.respawn = false;
+
+			SimdParticles particles;
+			particles.resize(NUM_VECTOR_FIELD_SAMPLES);
+
+			Vector<Vector3> positions(NUM_VECTOR_FIELD_SAMPLES);
+			for(UINT32 i = 0; i < NUM_VECTOR_FIELD_SAMPLES; i++)
+			{
+				positions[i] = sampleMin + sampleSize * Vector3(random(), random(), random());
+
+				particles.positionX[i] = positions[i].x;
+				particles.positionY[i] = positions[i].y;
+				particles.positionZ[i] = positions[i].z;
+			}
+
+			SimdParticleEvolver evolver(desc);
+			evolver.simulate(particles, TIME_STEP);
+
+			for(UINT32 i = 0; i < NUM_VECTOR_FIELD_SAMPLES; i++)
+			{
+				const Vector3 expected = field->sample(positions[i], tile, tile, tile);
+				const Vector3 actual(particles.velocityX[i], particles.velocityY[i], particles.velocityZ[i]);
+
+				maxError = std::max(maxError, (actual - expected).length());
+			}
+		}
+
+		return maxLength > 0.0f ? maxError / maxLength : maxError;
+	}
+
+	/**
+	 * Simulates the same particle systems with two simulators, one splitting them into tasks of a number of particles
+	 * that isn't a multiple of the SIMD width, and one that is. Returns true if both end up with the same particle
+	 * state.
+	 */
+	bool compareTaskSplitting(const SPtr<SimdParticleEvolver>& evolver)
+	{
+		ParticleSimulator unalignedSimulator(1001);
+		ParticleSimulator alignedSimulator(1024);
+
+		// Enough particles per system for every system to be split into multiple ranges
+		for(UINT32 i = 0; i < 4; i++)
+		{
+			SIMD_PARTICLE_SYSTEM_DESC desc;
+			desc.position = Vector3(i * 2.0f, 0.0f, 0.0f);
+			desc.evolver = evolver;
+			desc.emitter.emissionRate = 2000.0f;
+			desc.emitter.initialSpeed = 1.0f;
+			desc.emitter.initialLifetime = 2.0f;
+			desc.emitter.coneAngle = Degree(10.0f);
+			desc.maxParticles = 5000;
+
+			unalignedSimulator.addSystem(desc);
+			alignedSimulator.addSystem(desc);
+		}
+
+		unalignedSimulator.prewarm(2.0f, TIME_STEP, VIEW_POINT);
+		alignedSimulator.prewarm(2.0f, TIME_STEP, VIEW_POINT);
+
+		return unalignedSimulator.calculateChecksum() == alignedSimulator.calculateChecksum();
+	}
+
+	// Component that drives the benchmark. Runs every combination of particle count and simulation path one by one.
+	class ParticleSimdBenchmark : public Component
+	{
+	public:
+		/** Single combination of settings to benchmark. */
+		struct Config
+		{
+			UINT32 numParticles;
+			bool simd;
+		};
+
+		ParticleSimdBenchmark(const HSceneObject& parent, const Vector<Config>& configs)
+			:Component(parent), mConfigs(configs), mEvolver(getEvolversDesc()), mDesc(getEvolversDesc())
+		{
+			mNumWarmupFrames = CommandLine::getUInt("benchmark-warmup", 10);
+			mNumFrames = std::max(CommandLine::getUInt("benchmark-frames", 100), 1U);
+			mOutputPath = CommandLine::getString("benchmark-output", "ParticleBenchmark.json");
+
+			mLog = bs_shared_ptr_new<BenchmarkLog>("ParticleSimd");
+			startConfig();
+		}
+
+		void update() override
+		{
+			// Nothing left to do, waiting for the application to quit
+			if(mConfigIdx >= (UINT32)mConfigs.size())
+				return;
+
+			const Config& config = mConfigs[mConfigIdx];
+
+			// Simulate a single step and measure how long it took
+			Timer timer;
+			if(config.simd)
+				mEvolver.simulate(mSimdParticles, TIME_STEP);
+			else
+				simulateScalar(mScalarParticles, mDesc, TIME_STEP);
+
+			const float updateTime = timer.getMicroseconds() / 1000.0f;
+
+			// Sort the particles back to front, as done by ParticleSortMode::Distance
+			timer.reset();
+			if(config.simd)
+				sortSimd();
+			else
+				sortScalar();
+
+			const float sortTime = timer.getMicroseconds() / 1000.0f;
+
+			if(mFrameIdx == mNumWarmupFrames)
+			{
+				mLog->beginRun(String(config.simd ? "SIMD " : "Scalar ") + toString(config.numParticles));
+				mLog->setRunProperty("particles", toString(config.numParticles));
+				mLog->setRunProperty("path", config.simd ? "simd" : "scalar");
+				mLog->setRunProperty("instructionSet", config.simd ? SimdParticleEvolver::getInstructionSet() : "Scalar");
+			}
+
+			if(mFrameIdx >= mNumWarmupFrames)
+			{
+				mLog->record("updateMs", updateTime);
+				mLog->record("particlesPerMs", updateTime > 0.0f ? config.numParticles / updateTime : 0.0f);
+				mLog->record("sortMs", sortTime);
+
+				if(config.simd)
+					mLog->record("sortOrderReused", mSorter.wasOrderReused() ? 1.0 : 0.0);
+			}
+
+			mFrameIdx++;
+			if(mFrameIdx == mNumWarmupFrames + mNumFrames)
+			{
+				endConfig();
+
+				mConfigIdx++;
+				if(mConfigIdx < (UINT32)mConfigs.size())
+					startConfig();
+				else
+				{
+					mLog->save(mOutputPath);
+					gApplication().quitRequested();
+				}
+			}
+		}
+
+	private:
+		/** Sorts the scalar path particles using a comparison sort. */
+		void sortScalar()
+		{
+			const UINT32 count = (UINT32)mScalarParticles.size();
+
+			mSortDistances.resize(count);
+			mSortOrder.resize(count);
+			for(UINT32 i = 0; i < count; i++)
+			{
+				mSortDistances[i] = mScalarParticles[i].position.squaredDistance(VIEW_POINT);
+				mSortOrder[i] = i;
+			}
+
+			std::sort(mSortOrder.begin(), mSortOrder.end(),
+				[this](UINT32 a, UINT32 b) { return mSortDistances[a] > mSortDistances[b]; });
+		}
+
+		/** Sorts the SIMD path particles using the radix sort. */
+		void sortSimd()
+		{
+			const UINT32 count = mSimdParticles.getCount();
+
+			mSortDistances.resize(count);
+			for(UINT32 i = 0; i < count; i++)
+			{
+				const Vector3 position(mSimdParticles.positionX[i], mSimdParticles.positionY[i],
+					mSimdParticles.positionZ[i]);
+				mSortDistances[i] = position.squaredDistance(VIEW_POINT);
+			}
+
+			mSorter.sort(mSortDistances.data(), count);
+		}
+
+		/** Creates the particles for the current configuration. */
+		void startConfig()
+		{
+			const Config& config = mConfigs[mConfigIdx];
+			mSorter.reset();
+
+			// Only keep the particles for the path being tested, as the largest sets take up a lot of memory
+			mScalarParticles.clear();
+			mScalarParticles.shrink_to_fit();
+			mSimdParticles = SimdParticles();
+
+			if(config.simd)
+			{
+				mSimdParticles.resize(config.numParticles);
+				for(UINT32 i = 0; i < config.numParticles; i++)
+				{
+					const ScalarParticle particle = generateParticle(i);
+
+					mSimdParticles.positionX[i] = particle.position.x;
+					mSimdParticles.positionY[i] = particle.position.y;
+					mSimdParticles.positionZ[i] = particle.position.z;
+					mSimdParticles.velocityX[i] = particle.velocity.x;
+					mSimdParticles.velocityY[i] = particle.velocity.y;
+					mSimdParticles.velocityZ[i] = particle.velocity.z;
+					mSimdParticles.lifetime[i] = particle.lifetime;
+					mSimdParticles.invInitialLifetime[i] = 1.0f / particle.initialLifetime;
+				}
+			}
+			else
+			{
+				mScalarParticles.resize(config.numParticles);
+				for(UINT32 i = 0; i < config.numParticles; i++)
+					mScalarParticles[i] = generateParticle(i);
+			}
+
+			mFrameIdx = 0;
+		}
+
+		/** Finishes recording the current configuration. */
+		void endConfig()
+		{
+			const Config& config = mConfigs[mConfigIdx];
+			const BenchmarkMetricSummary updateTime = mLog->getSummary("updateMs");
+
+			const BenchmarkMetricSummary sortTime = mLog->getSummary("sortMs");
+
+			// Compare against the scalar run with the same particle count, which always runs first
+			if(!config.simd)
+			{
+				mScalarUpdateTime = updateTime.mean;
+				mScalarSortTime = sortTime.mean;
+			}
+			else
+			{
+				const double speedup = updateTime.mean > 0.0 ? mScalarUpdateTime / updateTime.mean : 0.0;
+				mLog->setRunProperty("speedup", toString(speedup));
+
+				const double sortSpeedup = sortTime.mean > 0.0 ? mScalarSortTime / sortTime.mean : 0.0;
+				mLog->setRunProperty("sortSpeedup", toString(sortSpeedup));
+			}
+
+			mLog->endRun();
+		}
+
+		Vector<Config> mConfigs;
+		SimdParticleEvolver mEvolver;
+		SIMD_PARTICLE_EVOLVERS_DESC mDesc;
+
+		Vector<ScalarParticle> mScalarParticles;
+		SimdParticles mSimdParticles;
+
+		ParticleDistanceSorter mSorter;
+		Vector<float> mSortDistances;
+		Vector<UINT32> mSortOrder;
+
+		SPtr<BenchmarkLog> mLog;
+		UINT32 mNumWarmupFrames = 0;
+		UINT32 mNumFrames = 0;
+		Path mOutputPath;
+
+		UINT32 mConfigIdx = 0;
+		UINT32 mFrameIdx = 0;
+		double mScalarUpdateTime = 0.0;
+		double mScalarSortTime = 0.0;
+	};
+
+	// Component that drives the scaling benchmark. Simulates the same set of particle systems once for every
+	// thread count.
+	class ParticleScalingBenchmark : public Component
+	{
+	public:
+		ParticleScalingBenchmark(const HSceneObject& parent, const Vector<UINT32>& threadCounts)
+			:Component(parent), mThreadCounts(threadCounts)
+		{
+			mNumSystems = std::max(CommandLine::getUInt("scaling-systems", 500), 1U);
+			mPrewarmTime = CommandLine::getFloat("scaling-prewarm", 5.0f);
+			mNumWarmupFrames = CommandLine::getUInt("benchmark-warmup", 10);
+			mNumFrames = std::max(CommandLine::getUInt("benchmark-frames", 100), 1U);
+			mOutputPath = CommandLine::getString("benchmark-output", "ParticleScaling.json");
+
+			// Load the vector field used by the GPU particle effect, if requested
+			if(CommandLine::getString("scaling-effect", "smoke") == "vectorfield")
+			{
+				const Path vectorFieldPath = CommandLine::getString("vector-field",
+					(Path(EXAMPLE_DATA_PATH) + "Particles/VectorField.fga").toString());
+
+				// Parsed from the FGA file on the first run, and loaded from its binary cache afterwards
+				Timer loadTimer;
+				mVectorField = CpuVectorField::load(vectorFieldPath, CommandLine::hasOption("vector-field-half"),
+					&mVectorFieldCached);
+				mVectorFieldLoadTime = loadTimer.getMicroseconds() / 1000.0f;
+
+				if(!mVectorField)
+					LOGWRN("Unable to load the vector field, using the smoke effect instead.");
+				else
+				{
+					// Make sure the SIMD path samples the field the same as the scalar reference
+					mVectorFieldError = compareVectorFieldSampling(mVectorField);
+					if(mVectorFieldError > VECTOR_FIELD_TOLERANCE)
+					{
+						LOGWRN("SIMD vector field sampling doesn't match the scalar sampling, with a relative error "
+							"of " + toString(mVectorFieldError) + ".");
+					}
+				}
+			}
+
+			SIMD_PARTICLE_EVOLVERS_DESC evolversDesc;
+			if(mVectorField)
+			{
+				// Same as the GPU particle effect
+				evolversDesc.vectorField.vectorField = mVectorField;
+				evolversDesc.vectorField.intensity = 3.0f;
+				evolversDesc.vectorField.tightness = 0.0f;
+			}
+			else
+				evolversDesc = getSmokeEvolversDesc();
+
+			evolversDesc.respawn = false;
+
+			mEvolver = bs_shared_ptr_new<SimdParticleEvolver>(evolversDesc);
+			mLog = bs_shared_ptr_new<BenchmarkLog>("ParticleScaling");
+
+			// Make sure the way the particles are split into tasks doesn't affect the result
+			mTaskSplittingMatches = compareTaskSplitting(mEvolver);
+			if(!mTaskSplittingMatches)
+				LOGWRN("Particle state depends on the number of particles per task.");
+
+#if !BS_PROFILING_ENABLED
+			LOGWRN("The engine was built without profiling, so heap allocations can't be counted and won't be "
+				"recorded.");
+#endif
+
+			startConfig();
+		}
+
+		void onDestroyed() override
+		{
+			// Hand the task scheduler back with the number of workers it had before
+			restoreNumTaskWorkers();
+		}
+
+		void update() override
+		{
+			// Nothing left to do, waiting for the application to quit
+			if(mConfigIdx >= (UINT32)mThreadCounts.size())
+				return;
+
+			// Simulate a single step and measure how long it took, and how many allocations it made
+#if BS_PROFILING_ENABLED
+			const UINT64 numAllocs = MemoryCounter::getNumAllocs();
+#endif
+
+			Timer timer;
+			mSimulator.simulate(TIME_STEP, VIEW_POINT);
+
+			const float updateTime = timer.getMicroseconds() / 1000.0f;
+
+#if BS_PROFILING_ENABLED
+			const UINT64 numStepAllocs = MemoryCounter::getNumAllocs() - numAllocs;
+#endif
+
+			if(mFrameIdx == mNumWarmupFrames)
+			{
+				const UINT32 numThreads = mThreadCounts[mConfigIdx];
+
+				mLog->beginRun(toString(numThreads) + " threads");
+				mLog->setRunProperty("threads", toString(numThreads));
+				mLog->setRunProperty("systems", toString(mNumSystems));
+				mLog->setRunProperty("effect", mVectorField ? "vectorfield" : "smoke");
+
+				if(mVectorField)
+				{
+					mLog->setRunProperty("vectorFieldLoadMs", toString(mVectorFieldLoadTime));
+					mLog->setRunProperty("vectorFieldCached", mVectorFieldCached ? "true" : "false");
+					mLog->setRunProperty("vectorFieldError", toString(mVectorFieldError));
+					mLog->setRunProperty("vectorFieldMatches",
+						mVectorFieldError <= VECTOR_FIELD_TOLERANCE ? "true" : "false");
+				}
+				mLog->setRunProperty("hardwareThreads", toString((UINT32)BS_THREAD_HARDWARE_CONCURRENCY));
+				mLog->setRunProperty("prewarmMs", toString(mPrewarmDuration));
+				mLog->setRunProperty("taskSplittingMatches", mTaskSplittingMatches ? "true" : "false");
+
+#if !BS_PROFILING_ENABLED
+				mLog->setRunProperty("heapAllocs", "unmeasured");
+#endif
+			}
+
+			if(mFrameIdx >= mNumWarmupFrames)
+			{
+				const ParticleSimulatorStats& stats = mSimulator.getStats();
+
+				mLog->record("updateMs", updateTime);
+				mLog->record("particles", stats.numParticles);
+				mLog->record("tasks", stats.numTasks);
+				mLog->record("storageAllocs", stats.numStorageAllocations);
+				mLog->record("bufferGrowth", (double)stats.bufferGrowth);
+
+#if BS_PROFILING_ENABLED
+				mLog->record("heapAllocs", (double)numStepAllocs);
+#endif
+			}
+
+			mFrameIdx++;
+			if(mFrameIdx == mNumWarmupFrames + mNumFrames)
+			{
+				endConfig();
+
+				mConfigIdx++;
+				if(mConfigIdx < (UINT32)mThreadCounts.size())
+					startConfig();
+				else
+				{
+					mLog->save(mOutputPath);
+					gApplication().quitRequested();
+				}
+			}
+		}
+
+	private:
+		/** Applies the current thread count, and creates and pre-warms the particle systems. */
+		void startConfig()
+		{
+			setNumTaskWorkers(mThreadCounts[mConfigIdx]);
+
+			// Same emitter as the smoke or the GPU particle effect, with the systems laid out in a grid
+			mSimulator.clear();
+
+			const UINT32 gridSize = (UINT32)std::ceil(std::sqrt((float)mNumSystems));
+			for(UINT32 i = 0; i < mNumSystems; i++)
+			{
+				SIMD_PARTICLE_SYSTEM_DESC desc;
+				desc.position = Vector3((i % gridSize) * 2.0f, 0.0f, (i / gridSize) * 2.0f);
+				desc.evolver = mEvolver;
+
+				if(mVectorField)
+				{
+					desc.emitter.shape = SimdParticleEmitterShape::Sphere;
+					desc.emitter.emissionRate = 400.0f;
+					desc.emitter.initialSpeed = 0.0f;
+					desc.emitter.initialLifetime = 5.0f;
+					desc.emitter.initialSize = 0.01f;
+					desc.emitter.sphereRadius = 0.3f;
+					desc.maxParticles = 10000;
+				}
+				else
+				{
+					desc.rotation = Quaternion(Degree(0), Degree(90), Degree(90));
+					desc.emitter.emissionRate = 20.0f;
+					desc.emitter.initialSpeed = 1.0f;
+					desc.emitter.initialLifetime = 5.0f;
+					desc.emitter.initialSize = 1.0f;
+					desc.emitter.coneAngle = Degree(10.0f);
+				}
+
+				mSimulator.addSystem(desc);
+			}
+
+			// Allocate all the particles up front and fast-forward to the steady state
+			Timer prewarmTimer;
+			mSimulator.prewarm(mPrewarmTime, TIME_STEP, VIEW_POINT);
+			mPrewarmDuration = prewarmTimer.getMicroseconds() / 1000.0f;
+
+			mFrameIdx = 0;
+		}
+
+		/** Finishes recording the current thread count. */
+		void endConfig()
+		{
+			const BenchmarkMetricSummary updateTime = mLog->getSummary("updateMs");
+
+			// Compare against the first thread count
+			if(mConfigIdx == 0)
+				mBaselineUpdateTime = updateTime.mean;
+
+			const double speedup = updateTime.mean > 0.0 ? mBaselineUpdateTime / updateTime.mean : 0.0;
+			mLog->setRunProperty("speedup", toString(speedup));
+
+			// Every run simulates the same steps, so the final state must match regardless of the thread count
+			const UINT64 checksum = mSimulator.calculateChecksum();
+			if(mConfigIdx == 0)
+				mBaselineChecksum = checksum;
+
+			mLog->setRunProperty("checksum", toString(checksum));
+			mLog->setRunProperty("deterministic", checksum == mBaselineChecksum ? "true" : "false");
+
+			// Once pre-warmed, the systems must not grow their particle storage, nor their sorting and task buffers
+			const BenchmarkMetricSummary storageAllocs = mLog->getSummary("storageAllocs");
+			const BenchmarkMetricSummary bufferGrowth = mLog->getSummary("bufferGrowth");
+
+			const bool allocationFree = storageAllocs.max == 0.0 && bufferGrowth.max == 0.0;
+			mLog->setRunProperty("allocationFree", allocationFree ? "true" : "false");
+
+			if(storageAllocs.max > 0.0)
+			{
+				LOGWRN("Particle systems allocated storage after being pre-warmed, with " +
+					toString(mThreadCounts[mConfigIdx]) + " threads.");
+			}
+
+			if(bufferGrowth.max > 0.0)
+			{
+				LOGWRN("Particle simulator grew its sorting or task buffers after being pre-warmed, with " +
+					toString(mThreadCounts[mConfigIdx]) + " threads.");
+			}
+
+			if(checksum != mBaselineChecksum)
+			{
+				LOGWRN("Particle state with " + toString(mThreadCounts[mConfigIdx]) +
+					" threads doesn't match the state of the first run.");
+			}
+
+			mLog->endRun();
+		}
+
+		Vector<UINT32> mThreadCounts;
+		ParticleSimulator mSimulator;
+		SPtr<SimdParticleEvolver> mEvolver;
+		SPtr<CpuVectorField> mVectorField;
+		bool mVectorFieldCached = false;
+		float mVectorFieldLoadTime = 0.0f;
+		float mVectorFieldError = 0.0f;
+		bool mTaskSplittingMatches = true;
+
+		SPtr<BenchmarkLog> mLog;
+		UINT32 mNumSystems = 0;
+		float mPrewarmTime = 0.0f;
+		float mPrewarmDuration = 0.0f;
+		UINT32 mNumWarmupFrames = 0;
+		UINT32 mNumFrames = 0;
+		Path mOutputPath;
+
+		UINT32 mConfigIdx = 0;
+		UINT32 mFrameIdx = 0;
+		double mBaselineUpdateTime = 0.0;
+		UINT64 mBaselineChecksum = 0;
+	};
+
+	/** Set up the component that drives the benchmark. */
+	void setUpBenchmark()
+	{
+		HSceneObject benchmarkSO = SceneObject::create("Benchmark");
+
+		if(CommandLine::hasOption("scaling"))
+		{
+			benchmarkSO->addComponent<ParticleScalingBenchmark>(
+				getListOption("sweep-threads", { 1, 2, 4, 8, 16, 32 }));
+			return;
+		}
+
+		Vector<ParticleSimdBenchmark::Config> configs;
+		for(auto& entry : getListOption("particle-counts", { 100000, 1000000, 5000000 }))
+		{
+			configs.push_back({ entry, false });
+			configs.push_back({ entry, true });
+		}
+
+		benchmarkSO->addComponent<ParticleSimdBenchmark>(configs);
+	}
+}
+
+/** Main entry point into the application. */
+#if BS_PLATFORM == BS_PLATFORM_WIN32
+#include <windows.h>
+
+int CALLBACK WinMain(
+	_In_  HINSTANCE hInstance,
+	_In_  HINSTANCE hPrevInstance,
+	_In_  LPSTR lpCmdLine,
+	_In_  int nCmdShow
+	)
+#else
+int main(int argc, char* argv[])
+#endif
+{
+	using namespace bs;
+
+	// Parse the options the benchmark was started with
+#if BS_PLATFORM == BS_PLATFORM_WIN32
+	CommandLine::parse(__argc, __argv);
+#else
+	CommandLine::parse(argc, argv);
+#endif
+
+	// Initializes the application and creates a window with the specified properties
+	VideoMode videoMode(windowResWidth, windowResHeight);
+	Application::startUp(videoMode, "Particle benchmark", false);
+
+	// Set up the benchmark
+	setUpBenchmark();
+
+	// Runs the main loop that does most of the work. This method will exit once the benchmark is done, or when the user
+	// closes the main window.
+	Application::instance().runMainLoop();
+
+	// When done, clean up
+	Application::shutDown();
+
+	return 0;
+}
\ No newline at end of file
@@ -20,11 +20,23 @@
 #include "Platform/BsCursor.h"
 #include "Input/BsInput.h"
 #include "Utility/BsTime.h"
+#include "GUI/BsCGUIWidget.h"
+#include "GUI/BsGUIPanel.h"
+#include "GUI/BsGUILayoutY.h"
+#include "GUI/BsGUILabel.h"
 
 // Example includes
 #include "BsExampleFramework.h"
 #include "BsFPSWalker.h"
 #include "BsFPSCamera.h"
+#include "BsPhysicsStepper.h"
+#include "BsCommandLine.h"
+#include "BsParticleLOD.h"
+#include "BsCpuVectorField.h"
+#include "BsParticleSimulator.h"
+#include "BsInstancedParticleRenderer.h"
+#include "BsBenchmarkLog.h"
+#include "BsEngineConfig.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This example sets up an environment with three particle systems:
@@ -40,6 +52,21 @@
 // controller and the camera are attached to allow the user to control the character. Finally it sets up three separate
 // particle systems, their creation wrapped in their own creation methods. Finally the cursor is hidden and quit on Esc
 // key press hooked up.
+//
+// The following options are supported:
+// --particle-lod - Throttle the particle systems based on their distance to the camera, and pause the ones out of view,
+//    using the ParticleLOD component. The estimated number of simulated and visible particles is displayed on screen.
+// --particle-lod-full=N - Distance up to which the particle systems emit at their full rate. Defaults to 15.
+// --particle-lod-pause=N - Distance beyond which the particle systems are paused. Defaults to 50.
+// --instanced-particles - Render the 3D particles using instancing. The particles are simulated on the CPU using the
+//    same emitter and evolvers, and the nearby ones are drawn as sphere meshes using a single instanced draw call, while
+//    the ones further away are drawn as camera-facing impostors using another one.
+// --instanced-particle-count=N - Number of 3D particles alive at once when using instancing. Defaults to 250, the same
+//    as the regular 3D particle effect.
+// --impostor-distance=N - Distance beyond which the instanced particles are drawn as impostors. Defaults to 10.
+// --benchmark-frames=N - When using instancing, record the frame time and the instanced particle statistics for N
+//    frames, save them and quit.
+// --benchmark-output=path - Path to the JSON file in which to save the statistics. Defaults to InstancedParticles.json.
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 namespace bs
 {
@@ -77,6 +104,58 @@ namespace bs
 		float mRadius;
 	};
 
+	// Set up a helper component that displays how many particle systems and particles are being simulated by the
+	// particle LOD.
+	class ParticleLODStatus : public Component
+	{
+	public:
+		ParticleLODStatus(const HSceneObject& parent, const HParticleLOD& particleLOD, GUILabel* statusLabel)
+			:Component(parent), mParticleLOD(particleLOD), mStatusLabel(statusLabel)
+		{ }
+
+		void update() override
+		{
+			const ParticleLODStats& stats = mParticleLOD->getStats();
+			mStatusLabel->setContent(HString(u8"Particles: " + toString(stats.numSimulatedParticles) + u8" simulated, " +
+				toString(stats.numVisibleParticles) + u8" visible (" + toString(stats.numSimulated) + u8"/" +
+				toString(stats.numSystems) + u8" systems, " + toString(stats.numPaused) + u8" paused)"));
+		}
+
+	private:
+		HParticleLOD mParticleLOD;
+		GUILabel* mStatusLabel;
+	};
+
+	// Set up a helper component that records the frame time along with the instanced particle statistics, and saves them
+	// once the requested number of frames has been recorded.
+	class InstancedParticleBenchmark : public Component
+	{
+	public:
+		InstancedParticleBenchmark(const HSceneObject& parent, const SPtr<BenchmarkLog>& log, UINT32 numFrames,
+			const Path& outputPath)
+			:Component(parent), mLog(log), mNumFrames(numFrames), mOutputPath(outputPath)
+		{ }
+
+		void update() override
+		{
+			mLog->record("frameMs", gTime().getFrameDelta() * 1000.0f);
+
+			mFrameIdx++;
+			if(mFrameIdx == mNumFrames)
+			{
+				mLog->endRun();
+				mLog->save(mOutputPath);
+				gApplication().quitRequested();
+			}
+		}
+
+	private:
+		SPtr<BenchmarkLog> mLog;
+		UINT32 mNumFrames;
+		UINT32 mFrameIdx = 0;
+		Path mOutputPath;
+	};
+
 	/** Container for all assets used by the particles systems in this example. */
 	struct ParticleSystemAssets
 	{
@@ -139,8 +218,13 @@ namespace bs
 		assets.lightMat->setTexture("gEmissiveMaskTex", gBuiltinResources().getTexture(BuiltinTexture::White));
 		assets.lightMat->setColor("gEmissiveColor", Color::Red * 5.0f);
 
-		//// Import a vector field used in the GPU simulation
-		assets.vectorField = ExampleFramework::loadResource<VectorField>(ExampleResource::VectorField);
+		//// Import a vector field used in the GPU simulation. The FGA file is parsed directly and cached in a binary format
+		//// next to it, which loads much faster than going through the importer. Fall back to the importer if that fails.
+		SPtr<CpuVectorField> cpuVectorField = CpuVectorField::load(Path(EXAMPLE_DATA_PATH) + "Particles/VectorField.fga");
+		if(cpuVectorField)
+			assets.vectorField = cpuVectorField->createResource();
+		else
+			assets.vectorField = ExampleFramework::loadResource<VectorField>(ExampleResource::VectorField);
 
 		//// Import a sphere mesh used for the 3D particles and the light sphere
 		assets.sphereMesh = gBuiltinResources().getMesh(BuiltinMesh::Sphere);
@@ -148,9 +232,12 @@ namespace bs
 		return assets;
 	}
 
-	void setupGPUParticleEffect(const Vector3& pos, const ParticleSystemAssets& assets);
-	void setup3DParticleEffect(const Vector3& pos, const ParticleSystemAssets& assets);
-	void setupSmokeEffect(const Vector3& pos, const ParticleSystemAssets& assets);
+	HParticleSystem setupGPUParticleEffect(const Vector3& pos, const ParticleSystemAssets& assets);
+	HParticleSystem setup3DParticleEffect(const Vector3& pos, const ParticleSystemAssets& assets);
+	HSceneObject setupInstanced3DParticleEffect(const Vector3& pos, const ParticleSystemAssets& assets,
+		const HCamera& camera, const SPtr<BenchmarkLog>& log);
+	HParticleSystem setupSmokeEffect(const Vector3& pos, const ParticleSystemAssets& assets);
+	void setup3DParticleLight(const Vector3& pos, const ParticleSystemAssets& assets);
 
 	/** Set up the scene used by the example, and the camera to view the world through. */
 	void setUpScene()
@@ -180,6 +267,15 @@ namespace bs
 		// Load assets used by the particle systems
 		ParticleSystemAssets assets = loadParticleSystemAssets();
 
+		/************************************************************************/
+		/* 									PHYSICS	                    		*/
+		/************************************************************************/
+
+		// Take over stepping of the physics simulation, so the step rate, number of sub-steps and number of worker
+		// threads can be controlled from the command line (see PhysicsSettings for the available options)
+		HSceneObject physicsSO = SceneObject::create("Physics");
+		HPhysicsStepper physicsStepper = physicsSO->addComponent<PhysicsStepper>(PhysicsSettings::fromCommandLine());
+
 		/************************************************************************/
 		/* 									FLOOR	                    		*/
 		/************************************************************************/
@@ -210,8 +306,10 @@ namespace bs
 		charController->setHeight(1.0f); // + 0.4 * 2 radius = 1.8m height
 		charController->setRadius(0.4f);
 
-		// FPS walker uses default input controls to move the character controller attached to the same object
-		characterSO->addComponent<FPSWalker>();
+		// FPS walker uses default input controls to move the character controller attached to the same object. Make
+		// it move in sync with the physics steps.
+		HFPSWalker fpsWalker = characterSO->addComponent<FPSWalker>();
+		fpsWalker->setStepper(physicsStepper);
 
 		/************************************************************************/
 		/* 									CAMERA	                     		*/
@@ -278,10 +376,78 @@ namespace bs
 		/* 								PARTICLES                       		*/
 		/************************************************************************/
 
-		// Set up different particle systems
-		setup3DParticleEffect(Vector3(-5.0f, 1.0f, 0.0f), assets);
-		setupGPUParticleEffect(Vector3(0.0f, 1.0f, 0.0f), assets);
-		setupSmokeEffect(Vector3(5.0f, 0.0f, 0.0f), assets);
+		// Optionally record statistics about the instanced 3D particles
+		const bool instancedParticles = CommandLine::hasOption("instanced-particles");
+		const UINT32 numBenchmarkFrames = CommandLine::getUInt("benchmark-frames", 0);
+
+		SPtr<BenchmarkLog> benchmarkLog;
+		if(instancedParticles && numBenchmarkFrames > 0)
+			benchmarkLog = bs_shared_ptr_new<BenchmarkLog>("InstancedParticles");
+
+		// Set up different particle systems. The 3D particles can optionally be rendered using instancing instead.
+		HParticleSystem particles3D;
+		if(instancedParticles)
+			setupInstanced3DParticleEffect(Vector3(-5.0f, 1.0f, 0.0f), assets, sceneCamera, benchmarkLog);
+		else
+			particles3D = setup3DParticleEffect(Vector3(-5.0f, 1.0f, 0.0f), assets);
+
+		HParticleSystem particlesGPU = setupGPUParticleEffect(Vector3(0.0f, 1.0f, 0.0f), assets);
+		HParticleSystem particlesSmoke = setupSmokeEffect(Vector3(5.0f, 0.0f, 0.0f), assets);
+
+		/************************************************************************/
+		/* 								PARTICLE LOD                       		*/
+		/************************************************************************/
+
+		// Optionally throttle the particle systems based on their distance to the camera, and pause the ones out of view.
+		// The full emission rates are read from the emitters set up by the effects above.
+		if(CommandLine::hasOption("particle-lod"))
+		{
+			PARTICLE_LOD_DESC lodDesc;
+			lodDesc.fullRateDistance = CommandLine::getFloat("particle-lod-full", lodDesc.fullRateDistance);
+			lodDesc.pauseDistance = CommandLine::getFloat("particle-lod-pause", lodDesc.pauseDistance);
+
+			HSceneObject particleLODSO = SceneObject::create("ParticleLOD");
+			HParticleLOD particleLOD = particleLODSO->addComponent<ParticleLOD>(lodDesc);
+			particleLOD->setCamera(sceneCamera);
+
+			PARTICLE_LOD_SYSTEM_DESC smokeDesc;
+			smokeDesc.radius = 5.0f;
+			particleLOD->track(particlesSmoke, smokeDesc);
+
+			if(particles3D)
+			{
+				PARTICLE_LOD_SYSTEM_DESC particles3DDesc;
+				particles3DDesc.radius = 2.0f;
+				particleLOD->track(particles3D, particles3DDesc);
+			}
+
+			PARTICLE_LOD_SYSTEM_DESC particlesGPUDesc;
+			particlesGPUDesc.radius = 2.0f;
+			particleLOD->track(particlesGPU, particlesGPUDesc);
+
+			// Display the number of simulated and visible particles
+			HSceneObject guiSO = SceneObject::create("GUI");
+			HGUIWidget gui = guiSO->addComponent<CGUIWidget>(sceneCamera);
+
+			GUILayoutY* vertLayout = GUILayoutY::create();
+			GUILabel* lodLabel = vertLayout->addNewElement<GUILabel>(HString(u8"Particles: -"));
+			gui->getPanel()->addElement(vertLayout);
+
+			particleLODSO->addComponent<ParticleLODStatus>(particleLOD, lodLabel);
+		}
+
+		/************************************************************************/
+		/* 								BENCHMARK                       		*/
+		/************************************************************************/
+
+		// Save the statistics and quit once enough frames have been recorded
+		if(benchmarkLog)
+		{
+			const Path outputPath = CommandLine::getString("benchmark-output", "InstancedParticles.json");
+
+			HSceneObject benchmarkSO = SceneObject::create("Benchmark");
+			benchmarkSO->addComponent<InstancedParticleBenchmark>(benchmarkLog, numBenchmarkFrames, outputPath);
+		}
 
 		/************************************************************************/
 		/* 									CURSOR                       		*/
@@ -311,7 +477,7 @@ namespace bs
 	 * from the base and distributed towards a cone shape. After emission particle color, size and velocity is modified
 	 * through particle evolvers.
 	 */
-	void setupSmokeEffect(const Vector3& pos, const ParticleSystemAssets& assets)
+	HParticleSystem setupSmokeEffect(const Vector3& pos, const ParticleSystemAssets& assets)
 	{
 		// Create the particle system scene object and position/orient it
 		HSceneObject particleSystemSO = SceneObject::create("Smoke");
@@ -428,6 +594,8 @@ namespace bs
 
 		// And actually apply the settings
 		particleSystem->setSettings(psSettings);
+
+		return particleSystem;
 	}
 
 	/** 
@@ -435,7 +603,7 @@ namespace bs
 	 * addition of an orbiting point light. Once emitted the particles are evolved through the gravity evolver, ensuring
 	 * they fall down. After which they collide with the ground plane by using the collider evolver.
 	 */
-	void setup3DParticleEffect(const Vector3& pos, const ParticleSystemAssets& assets)
+	HParticleSystem setup3DParticleEffect(const Vector3& pos, const ParticleSystemAssets& assets)
 	{
 		// Create the particle system scene object and position/orient it
 		HSceneObject particleSystemSO = SceneObject::create("3D particles");
@@ -526,24 +694,97 @@ namespace bs
 		particleSystem->setSettings(psSettings);
 
 		// Set up an orbiting light
-		//// Create the scene object, position and scale it
+		setup3DParticleLight(pos, assets);
+
+		return particleSystem;
+	}
+
+	/**
+	 * Sets up the same particles as setup3DParticleEffect(), but simulated on the CPU using ParticleSimulator and rendered
+	 * using InstancedParticleRenderer. All the particles are drawn using a single instanced draw call, with the ones far
+	 * away from the camera drawn as impostors using another one.
+	 */
+	HSceneObject setupInstanced3DParticleEffect(const Vector3& pos, const ParticleSystemAssets& assets,
+		const HCamera& camera, const SPtr<BenchmarkLog>& log)
+	{
+		// Particles live for 5 seconds, so emit enough of them per second to keep the requested number alive
+		const UINT32 numParticles = std::max(CommandLine::getUInt("instanced-particle-count", 250), 1U);
+		const float lifetime = 5.0f;
+
+		// Same evolvers as the 3D particle effect: gravity, followed by collisions with the ground plane
+		SIMD_PARTICLE_EVOLVERS_DESC evolversDesc;
+		evolversDesc.gravity = Vector3(0.0f, -9.81f, 0.0f);
+		evolversDesc.collisionPlanes = { Plane(Vector3::UNIT_Y, 0.0f) };
+		evolversDesc.collisionRadius = 0.02f;
+		evolversDesc.respawn = false;
+
+		// Same emitter as the 3D particle effect
+		SIMD_PARTICLE_SYSTEM_DESC systemDesc;
+		systemDesc.position = pos;
+		systemDesc.rotation = Quaternion(Degree(0), Degree(90), Degree(0));
+		systemDesc.emitter.emissionRate = numParticles / lifetime;
+		systemDesc.emitter.initialSpeed = 1.0f;
+		systemDesc.emitter.initialLifetime = lifetime;
+		systemDesc.emitter.initialSize = 0.02f;
+		systemDesc.emitter.coneAngle = Degree(45.0f);
+		systemDesc.evolver = bs_shared_ptr_new<SimdParticleEvolver>(evolversDesc);
+		systemDesc.sort = false;
+		systemDesc.maxParticles = numParticles;
+
+		SPtr<ParticleSimulator> simulator = bs_shared_ptr_new<ParticleSimulator>();
+		simulator->addSystem(systemDesc);
+
+		// Allocate the particles up front, so the simulation doesn't allocate as the particle count rises
+		simulator->prewarm();
+
+		// Create a scene object that advances the simulation and renders the particles. The renderer advances the
+		// simulation right before packing the particles, so they never lag a frame behind.
+		HSceneObject particleSystemSO = SceneObject::create("Instanced 3D particles");
+
+		INSTANCED_PARTICLE_RENDERER_DESC rendererDesc;
+		rendererDesc.impostorDistance = CommandLine::getFloat("impostor-distance", rendererDesc.impostorDistance);
+
+		HInstancedParticleRenderer renderer = particleSystemSO->addComponent<InstancedParticleRenderer>(rendererDesc);
+		renderer->setSimulator(simulator);
+		renderer->setCamera(camera);
+		renderer->setLog(log);
+
+		if(log)
+		{
+			log->beginRun("instanced");
+			log->setRunProperty("particles", toString(numParticles));
+			log->setRunProperty("impostorDistance", toString(rendererDesc.impostorDistance));
+			log->setRunProperty("renderAPI", BS_RENDER_API_MODULE);
+			log->setRunProperty("device", RenderAPI::getCapabilities(0).deviceName);
+		}
+
+		// Set up an orbiting light
+		setup3DParticleLight(pos, assets);
+
+		return particleSystemSO;
+	}
+
+	/** Sets up a light orbiting the 3D particles, demonstrating they are lit. */
+	void setup3DParticleLight(const Vector3& pos, const ParticleSystemAssets& assets)
+	{
+		// Create the scene object, position and scale it
 		HSceneObject lightSO = SceneObject::create("Radial light");
 		lightSO->setPosition(pos - Vector3(0.0f, 0.8f, 0.0f));
 		lightSO->setScale(Vector3::ONE * 0.02f);
 
-		//// Add the light component, emitting a red light
+		// Add the light component, emitting a red light
 		HLight light = lightSO->addComponent<CLight>();
 		light->setIntensity(30.0f);
 		light->setColor(Color::Red);
 		light->setUseAutoAttenuation(false);
 		light->setAttenuationRadius(20.0f);
 
-		//// Add a sphere using an emissive material to represent the light
+		// Add a sphere using an emissive material to represent the light
 		HRenderable lightSphere = lightSO->addComponent<CRenderable>();
 		lightSphere->setMesh(assets.sphereMesh);
 		lightSphere->setMaterial(assets.lightMat);
 
-		//// Add a component that orbits the light at 1m of its original position
+		// Add a component that orbits the light at 1m of its original position
 		lightSO->addComponent<LightOrbit>(1.0f);
 	}
 
@@ -551,7 +792,7 @@ namespace bs
 	 * Sets up a particle system that uses the GPU particle simulation. Particles are spawned on a surface of a sphere and
 	 * a vector field is used for evolving the particles during their lifetime.
 	 */
-	void setupGPUParticleEffect(const Vector3& pos, const ParticleSystemAssets& assets)
+	HParticleSystem setupGPUParticleEffect(const Vector3& pos, const ParticleSystemAssets& assets)
 	{
 		// Create the particle system scene object and position/orient it
 		HSceneObject particleSystemSO = SceneObject::create("Vector field");
@@ -626,6 +867,8 @@ namespace bs
 
 		// And actually apply the GPU simulation settings
 		particleSystem->setGpuSimulationSettings(gpuSimSettings);
+
+		return particleSystem;
 	}
 }
 
@@ -640,11 +883,18 @@ int CALLBACK WinMain(
 	_In_  int nCmdShow
 	)
 #else
-int main()
+int main(int argc, char* argv[])
 #endif
 {
 	using namespace bs;
 
+	// Parse the options the example was started with
+#if BS_PLATFORM == BS_PLATFORM_WIN32
+	CommandLine::parse(__argc, __argv);
+#else
+	CommandLine::parse(argc, argv);
+#endif
+
 	// Initializes the application and creates a window with the specified properties
 	VideoMode videoMode(windowResWidth, windowResHeight);
 	Application::startUp(videoMode, "Example", false);
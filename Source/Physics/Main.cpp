@@ -9,6 +9,7 @@
 #include "Components/BsCPlaneCollider.h"
 #include "Components/BsCBoxCollider.h"
 #include "Components/BsCSphereCollider.h"
+#include "Components/BsCMeshCollider.h"
 #include "Components/BsCCharacterController.h"
 #include "Components/BsCRigidbody.h"
 #include "GUI/BsCGUIWidget.h"
@@ -26,6 +27,15 @@
 #include "BsExampleFramework.h"
 #include "BsFPSWalker.h"
 #include "BsFPSCamera.h"
+#include "BsPhysicsStepper.h"
+#include "BsProjectilePool.h"
+#include "BsCommandLine.h"
+#include "BsBenchmarkLog.h"
+#include "BsBoxStackBuilder.h"
+#include "BsPhysicsProfiler.h"
+#include "BsPhysicsRecorder.h"
+#include "BsPhysicsQueryBatch.h"
+#include "BsPhysicsLOD.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This example sets up a physical environment in which the user can walk around using the character controller component,
@@ -36,7 +46,40 @@
 // scene, consisting of a floor, and multiple stacks of boxes that can be knocked down. Character controller is created 
 // next, as well as the camera. Components for moving the character controller and the camera are attached to allow the 
 // user to control the character. Finally an input callback is hooked up that shoots spheres when user presses the left 
-// mouse button. 
+// mouse button. The spheres are taken from a fixed size pool, which recycles old spheres once all of them are in use. 
+// The object the user is aiming at is found using a ray cast submitted through a batch of physics queries, which are all
+// executed together in parallel after the physics step.
+//
+// The example can also be started in a stress mode, which replaces the box stacks with a large number of boxes and
+// records physics performance statistics every frame:
+// --stress=wall|pyramid - Enables the stress mode and chooses how the boxes are arranged.
+// --stress-boxes=N - Number of boxes to create, in [1, 50000] range. Defaults to 1000.
+// --stress-no-render - Boxes are created without a renderable, so only the physics cost is measured.
+// --stress-islands - Enables counting of active simulation islands. This has a cost of its own.
+// --benchmark-frames=N - Number of frames to record before the statistics are saved and the example quits. With 0 the
+//   statistics are recorded until the example is closed, and saved when it quits.
+// --benchmark-output=path - Path to the JSON file in which to save the statistics. 
+//
+// Physics stepping can be controlled through the options described in PhysicsSettings (e.g. --physics-substeps=N).
+//
+// Boxes and props far away from the character can be excluded from the simulation, limiting the simulation cost in large
+// scenes such as the ones created in stress mode:
+// --physics-lod=N - Only simulates the bodies within N meters of the character.
+// --physics-lod-cap=N - Simulates at most N bodies, preferring the ones closest to the character.
+// --physics-lod-sleep - Puts the far away bodies to sleep instead of making them kinematic.
+//
+// Additional physical props using an imported mesh can be scattered around the scene. Their physics meshes are cooked 
+// on the first run and saved next to the mesh asset, so subsequent runs only need to load them:
+// --props=N - Number of props to create. Defaults to 0.
+// --props-collision=convex|parts|triangles - Type of physics mesh to use for the props. Convex hull is used by default.
+//   Props using a triangle mesh cannot be moved, as triangle meshes are only supported for static objects.
+//
+// Finally, the character movement and the spheres shot can be recorded and replayed later. The replay runs the simulation
+// at the recorded step rate and compares the results against checksums stored during recording, reporting if the
+// simulation diverged (e.g. after changing the number of physics threads):
+// --record=path - Records the session into the provided file, which is written when the example quits.
+// --replay=path - Replays a previously recorded session. Mouse input is ignored during the replay.
+// --record-checksum-interval=N - How often, in fixed steps, to store a checksum of the simulation. Defaults to 60.
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 namespace bs
 {
@@ -45,6 +88,164 @@ namespace bs
 	UINT32 windowResWidth = 1280;
 	UINT32 windowResHeight = 720;
 
+	/** Maximum number of boxes that can be created in stress mode. */
+	constexpr UINT32 MAX_STRESS_BOXES = 50000;
+
+	// Set up a helper component that displays the physics statistics gathered in stress mode, and saves them once the
+	// requested number of frames has been recorded, or when the example quits before that.
+	class StressBenchmark : public Component
+	{
+	public:
+		StressBenchmark(const HSceneObject& parent, const SPtr<BenchmarkLog>& log, const HPhysicsProfiler& profiler,
+			GUILabel* statsLabel, UINT32 numFrames, const Path& outputPath)
+			:Component(parent), mLog(log), mProfiler(profiler), mStatsLabel(statsLabel), mNumFrames(numFrames)
+			, mOutputPath(outputPath)
+		{ }
+
+		void update() override
+		{
+			const PhysicsFrameStats& stats = mProfiler->getLastFrameStats();
+
+			// Islands are only counted when tracking them is enabled
+			String islands;
+			if(mProfiler->getTrackIslands())
+				islands = toString(stats.numActiveIslands) + u8" islands, ";
+
+			mStatsLabel->setContent(HString(u8"Physics: " + toString(stats.stepTime, 2) + u8"ms, " +
+				toString(stats.numBodies - stats.numSleeping) + u8" awake, " + islands +
+				toString(stats.sleepingRatio * 100.0f, 1) + u8"% sleeping"));
+
+			mFrameIdx++;
+			if(mFrameIdx == mNumFrames)
+			{
+				mLog->save(mOutputPath);
+				mSaved = true;
+
+				gApplication().quitRequested();
+			}
+		}
+
+		void onDestroyed() override
+		{
+			// Save whatever was recorded if the example quits before the requested number of frames, or if no number of
+			// frames was requested at all
+			if(!mSaved)
+			{
+				mLog->save(mOutputPath);
+				mSaved = true;
+			}
+		}
+
+	private:
+		SPtr<BenchmarkLog> mLog;
+		HPhysicsProfiler mProfiler;
+		GUILabel* mStatsLabel;
+		UINT32 mNumFrames;
+		UINT32 mFrameIdx = 0;
+		Path mOutputPath;
+		bool mSaved = false;
+	};
+
+	// Set up a helper component that displays the progress of recording or replaying the session.
+	class RecorderStatus : public Component
+	{
+	public:
+		RecorderStatus(const HSceneObject& parent, const HPhysicsRecorder& recorder, GUILabel* statusLabel)
+			:Component(parent), mRecorder(recorder), mStatusLabel(statusLabel)
+		{ }
+
+		void update() override
+		{
+			const PhysicsRecorderStats& stats = mRecorder->getStats();
+
+			String status;
+			if(mRecorder->getMode() == PhysicsRecorderMode::Record)
+				status = u8"Recording: " + toString(stats.numSteps) + u8" steps, " + toString(stats.numSpawns) + u8" shots";
+			else
+			{
+				status = (stats.finished ? u8"Replay finished: " : u8"Replaying: ") + toString(stats.numSteps) +
+					u8" steps, " + toString(stats.numChecksums) + u8" checks, ";
+
+				if(stats.numMismatches == 0)
+					status += u8"no divergence";
+				else
+				{
+					status += toString(stats.numMismatches) + u8" mismatches (first at step " +
+						toString(stats.firstMismatchStep) + u8")";
+				}
+			}
+
+			mStatusLabel->setContent(HString(status));
+		}
+
+	private:
+		HPhysicsRecorder mRecorder;
+		GUILabel* mStatusLabel;
+	};
+
+	// Set up a helper component that displays what the camera is aiming at. A ray is queued every frame, and its result is
+	// read once the query batch executes.
+	class AimDisplay : public Component
+	{
+	public:
+		AimDisplay(const HSceneObject& parent, const HPhysicsQueryBatch& queryBatch, const HSceneObject& cameraSO,
+			GUILabel* aimLabel)
+			:Component(parent), mQueryBatch(queryBatch), mCameraSO(cameraSO), mAimLabel(aimLabel)
+		{
+			mExecutedConn = mQueryBatch->onExecuted.connect([this]() { displayResult(); });
+		}
+
+		void update() override
+		{
+			const Transform& tfrm = mCameraSO->getTransform();
+			mQueryIdx = mQueryBatch->addRayCast(tfrm.getPosition(), tfrm.getForward(), 100.0f);
+		}
+
+		void onDestroyed() override
+		{
+			mExecutedConn.disconnect();
+		}
+
+	private:
+		void displayResult()
+		{
+			const PhysicsQueryResult& result = mQueryBatch->getResult(mQueryIdx);
+			if(result.hit && result.info.collider)
+			{
+				mAimLabel->setContent(HString(u8"Aiming at: " + result.info.collider->SO()->getName() + u8" (" +
+					toString(result.info.distance, 1) + u8"m)"));
+			}
+			else
+				mAimLabel->setContent(HString(u8"Aiming at: -"));
+		}
+
+		HPhysicsQueryBatch mQueryBatch;
+		HSceneObject mCameraSO;
+		GUILabel* mAimLabel;
+		HEvent mExecutedConn;
+		UINT32 mQueryIdx = 0;
+	};
+
+	// Set up a helper component that displays how many bodies are being simulated by the physics LOD.
+	class PhysicsLODStatus : public Component
+	{
+	public:
+		PhysicsLODStatus(const HSceneObject& parent, const HPhysicsLOD& physicsLOD, GUILabel* statusLabel)
+			:Component(parent), mPhysicsLOD(physicsLOD), mStatusLabel(statusLabel)
+		{ }
+
+		void update() override
+		{
+			const PhysicsLODStats& stats = mPhysicsLOD->getStats();
+			mStatusLabel->setContent(HString(u8"Simulated bodies: " + toString(stats.numSimulated) + u8"/" +
+				toString(stats.numBodies) + u8" (" + toString(stats.numCapped) + u8" over the limit)"));
+		}
+
+	private:
+		HPhysicsLOD mPhysicsLOD;
+		GUILabel* mStatusLabel;
+	};
+
 	/** Set up the scene used by the example, and the camera to view the world through. */
 	void setUpScene()
 	{
@@ -85,6 +286,19 @@ namespace bs
 		// Create a physics material for the sphere geometry, with higher bounciness. Simulates elasticity.
 		HPhysicsMaterial spherePhysicsMaterial = PhysicsMaterial::create(1.0f, 1.0f, 0.5f);
 
+		/************************************************************************/
+		/* 									PHYSICS	                    		*/
+		/************************************************************************/
+
+		// Take over stepping of the physics simulation, so the step rate, number of sub-steps and number of worker
+		// threads can be controlled from the command line (see PhysicsSettings for the available options)
+		HSceneObject physicsSO = SceneObject::create("Physics");
+		HPhysicsStepper physicsStepper = physicsSO->addComponent<PhysicsStepper>(PhysicsSettings::fromCommandLine());
+
+		// Gather ray and shape casts from all the components, and execute them together after every physics step
+		HPhysicsQueryBatch queryBatch = physicsSO->addComponent<PhysicsQueryBatch>();
+		queryBatch->setStepper(physicsStepper);
+
 		/************************************************************************/
 		/* 									FLOOR	                    		*/
 		/************************************************************************/
@@ -107,8 +321,11 @@ namespace bs
 		/* 									BOXES	                    		*/
 		/************************************************************************/
 
+		// Rigidbodies of all the boxes, used for checking whether a replay matches the recording
+		Vector<HRigidbody> boxBodies;
+
 		// Helper method that creates a pyramid of six boxes that can be physically manipulated
-		auto createBoxStack = [=](const Vector3& position, const Quaternion& rotation = Quaternion::IDENTITY)
+		auto createBoxStack = [=, &boxBodies](const Vector3& position, const Quaternion& rotation = Quaternion::IDENTITY)
 		{
 			HSceneObject boxSO[6];
 			for (auto& entry : boxSO)
@@ -131,6 +348,7 @@ namespace bs
 
 				// Add a rigidbody, making the box geometry able to react to interactions with other physical objects
 				HRigidbody boxRigidbody = entry->addComponent<CRigidbody>();
+				boxBodies.push_back(boxRigidbody);
 			}
 
 			// Stack the boxes in a pyramid
@@ -154,9 +372,102 @@ namespace bs
 			}
 		};
 
-		createBoxStack(Vector3::ZERO);
-		createBoxStack(Vector3(6.0f, 0.0f, 3.0f), Quaternion(Degree(0.0f), Degree(-45.0f), Degree(0.0f)));
-		createBoxStack(Vector3(-6.0f, 0.0f, 3.0f), Quaternion(Degree(0.0f), Degree(45.0f), Degree(0.0f)));
+		// In stress mode, replace the three stacks with walls or pyramids built out of many boxes. All the boxes share the
+		// same mesh, material and physics material.
+		const String stressMode = CommandLine::getString("stress");
+		const bool isStressMode = !stressMode.empty();
+
+		BoxStack stressStack;
+		if(!isStressMode)
+		{
+			createBoxStack(Vector3::ZERO);
+			createBoxStack(Vector3(6.0f, 0.0f, 3.0f), Quaternion(Degree(0.0f), Degree(-45.0f), Degree(0.0f)));
+			createBoxStack(Vector3(-6.0f, 0.0f, 3.0f), Quaternion(Degree(0.0f), Degree(45.0f), Degree(0.0f)));
+		}
+		else
+		{
+			BOX_STACK_DESC stressDesc;
+			stressDesc.layout = stressMode == "pyramid" ? BoxStackLayout::Pyramid : BoxStackLayout::Wall;
+			stressDesc.numBoxes = Math::clamp(CommandLine::getUInt("stress-boxes", 1000), 1U, MAX_STRESS_BOXES);
+			stressDesc.render = !CommandLine::hasOption("stress-no-render");
+
+			BoxStackBuilder boxStackBuilder(boxMesh, boxMaterial, boxPhysicsMaterial);
+			stressStack = boxStackBuilder.build(stressDesc);
+			boxBodies = stressStack.bodies;
+		}
+
+		/************************************************************************/
+		/* 									PROPS                        		*/
+		/************************************************************************/
+
+		// Optionally scatter a number of props using an imported mesh around the scene. The physics meshes are cooked once
+		// and saved along with the mesh, after which every prop only references the same loaded physics mesh.
+		const UINT32 numProps = CommandLine::getUInt("props", 0);
+		if(numProps > 0)
+		{
+			const String propsCollision = CommandLine::getString("props-collision");
+
+			ExampleCollisionMesh collisionType = ExampleCollisionMesh::ConvexHull;
+			if(propsCollision == "parts")
+				collisionType = ExampleCollisionMesh::ConvexDecomposition;
+			else if(propsCollision == "triangles")
+				collisionType = ExampleCollisionMesh::TriangleMesh;
+
+			Vector<HPhysicsMesh> propCollisionMeshes;
+			HMesh propMesh = ExampleFramework::loadMesh(ExampleMesh::Pistol, 10.0f, collisionType, &propCollisionMeshes);
+
+			HSceneObject propsSO = SceneObject::create("Props");
+			for(UINT32 i = 0; i < numProps; i++)
+			{
+				HSceneObject propSO = SceneObject::create("Prop");
+				propSO->setParent(propsSO);
+
+				// Spread the props in a ring around the box stacks, stacking them up if there are many
+				const Degree angle(i * 137.5f);
+				const float radius = 10.0f + (i % 8) * 1.5f;
+				propSO->setPosition(Vector3(Math::cos(angle) * radius, 1.0f + (i / 64) * 1.0f, Math::sin(angle) * radius));
+
+				HRenderable propRenderable = propSO->addComponent<CRenderable>();
+				propRenderable->setMesh(propMesh);
+				propRenderable->setMaterial(boxMaterial);
+
+				// Add a collider for every part of the physics mesh. Triangle meshes can only be used by static colliders.
+				for(auto& entry : propCollisionMeshes)
+				{
+					HMeshCollider meshCollider = propSO->addComponent<CMeshCollider>();
+					meshCollider->setMesh(entry);
+					meshCollider->setMaterial(boxPhysicsMaterial);
+					meshCollider->setMass(5.0f / propCollisionMeshes.size());
+				}
+
+				if(collisionType != ExampleCollisionMesh::TriangleMesh)
+				{
+					HRigidbody propRigidbody = propSO->addComponent<CRigidbody>();
+					boxBodies.push_back(propRigidbody);
+				}
+			}
+		}
+
+		/************************************************************************/
+		/* 									PROJECTILES                    		*/
+		/************************************************************************/
+
+		// Set up a pool of spheres the user can shoot. All spheres are created up front and recycled once the pool runs
+		// out, so shooting doesn't keep adding new physics objects to the scene.
+		PROJECTILE_POOL_DESC poolDesc;
+		poolDesc.capacity = 64;
+		poolDesc.mesh = sphereMesh;
+		poolDesc.material = sphereMaterial;
+
+		// Apply the bouncy material
+		poolDesc.physicsMaterial = spherePhysicsMaterial;
+
+		// Set mass to 25kg, and scale the spheres down a bit
+		poolDesc.mass = 25.0f;
+		poolDesc.scale = 0.3f;
+
+		HSceneObject projectilesSO = SceneObject::create("Projectiles");
+		HProjectilePool projectilePool = projectilesSO->addComponent<ProjectilePool>(poolDesc);
 
 		/************************************************************************/
 		/* 									CHARACTER                    		*/
@@ -173,8 +484,10 @@ namespace bs
 		charController->setHeight(1.0f); // + 0.4 * 2 radius = 1.8m height
 		charController->setRadius(0.4f);
 
-		// FPS walker uses default input controls to move the character controller attached to the same object
-		characterSO->addComponent<FPSWalker>();
+		// FPS walker uses default input controls to move the character controller attached to the same object. Make
+		// it move in sync with the physics steps.
+		HFPSWalker fpsWalker = characterSO->addComponent<FPSWalker>();
+		fpsWalker->setStepper(physicsStepper);
 
 		/************************************************************************/
 		/* 									CAMERA	                     		*/
@@ -204,11 +517,18 @@ namespace bs
 		// Set aspect ratio depending on the current resolution
 		sceneCamera->setAspectRatio(windowResWidth / (float)windowResHeight);
 
-		// Add a component that allows the camera to be rotated using the mouse
-		HFPSCamera fpsCamera = sceneCameraSO->addComponent<FPSCamera>();
+		// Add a component that allows the camera to be rotated using the mouse. When replaying a recorded session the
+		// character rotation comes from the recording instead.
+		const Path recordPath = CommandLine::getString("record");
+		const Path replayPath = CommandLine::getString("replay");
 
-		// Set the character controller on the FPS camera, so the component can apply yaw rotation to it
-		fpsCamera->setCharacter(characterSO);
+		if(replayPath.isEmpty())
+		{
+			HFPSCamera fpsCamera = sceneCameraSO->addComponent<FPSCamera>();
+
+			// Set the character controller on the FPS camera, so the component can apply yaw rotation to it
+			fpsCamera->setCharacter(characterSO);
+		}
 
 		// Make the camera a child of the character scene object, and position it roughly at eye level
 		sceneCameraSO->setParent(characterSO);
@@ -235,52 +555,6 @@ namespace bs
 		Cursor::instance().hide();
 		Cursor::instance().clipToWindow(*window);
 
-		/************************************************************************/
-		/* 									INPUT                       		*/
-		/************************************************************************/
-
-		// Hook up input that launches a sphere when user clicks the mouse, and Esc key to quit
-		gInput().onButtonUp.connect([=](const ButtonEvent& ev)
-		{
-			if(ev.buttonCode == BC_MOUSE_LEFT)
-			{
-				// Create the scene object and renderable geometry of the sphere
-				HSceneObject sphereSO = SceneObject::create("Sphere");
-
-				HRenderable sphereRenderable = sphereSO->addComponent<CRenderable>();
-				sphereRenderable->setMesh(sphereMesh);
-				sphereRenderable->setMaterial(sphereMaterial);
-
-				// Create a spherical collider, represting physical geometry
-				HSphereCollider sphereCollider = sphereSO->addComponent<CSphereCollider>();
-
-				// Apply the bouncy material
-				sphereCollider->setMaterial(spherePhysicsMaterial);
-
-				// Set mass to 25kg
-				sphereCollider->setMass(25.0f);
-
-				// Add a rigidbody, making the object interactable
-				HRigidbody sphereRigidbody = sphereSO->addComponent<CRigidbody>();
-				
-				// Position the sphere in front of the character, and scale it down a bit
-				Vector3 spawnPos = characterSO->getTransform().getPosition();
-				spawnPos += sceneCameraSO->getTransform().getForward() * 0.5f;
-				spawnPos.y += 0.5f;
-
-				sphereSO->setPosition(spawnPos);
-				sphereSO->setScale(Vector3(0.3f, 0.3f, 0.3f));
-
-				// Apply force to the sphere, launching it forward in the camera's view direction
-				sphereRigidbody->addForce(sceneCameraSO->getTransform().getForward() * 40.0f, ForceMode::Velocity);
-			}
-			else if(ev.buttonCode == BC_ESCAPE)
-			{
-				// Quit the application when Escape key is pressed
-				gApplication().quitRequested();
-			}
-		});
-
 		/************************************************************************/
 		/* 									GUI		                     		*/
 		/************************************************************************/
@@ -304,8 +578,134 @@ namespace bs
 		vertLayout->addNewElement<GUILabel>(shootString);
 		vertLayout->addNewElement<GUILabel>(quitString);
 
+		// Create a label we'll use for displaying how long it took to spawn the last projectile
+		GUILabel* spawnLatencyLabel = vertLayout->addNewElement<GUILabel>(HString(u8"Spawn latency: -"));
+
+		// Create a label displaying the object the user is aiming at
+		GUILabel* aimLabel = vertLayout->addNewElement<GUILabel>(HString(u8"Aiming at: -"));
+		guiSO->addComponent<AimDisplay>(queryBatch, sceneCameraSO, aimLabel);
+
 		// Register the layout with the main GUI panel, placing the layout in top left corner of the screen by default
 		mainPanel->addElement(vertLayout);
+
+		/************************************************************************/
+		/* 									STRESS MODE                    		*/
+		/************************************************************************/
+
+		SPtr<BenchmarkLog> benchmarkLog;
+		if(isStressMode)
+		{
+			// Create a log that will hold the statistics recorded every frame
+			benchmarkLog = bs_shared_ptr_new<BenchmarkLog>("PhysicsStress");
+			benchmarkLog->beginRun(stressMode);
+			benchmarkLog->setRunProperty("layout", stressMode);
+			benchmarkLog->setRunProperty("numBoxes", toString((UINT32)stressStack.bodies.size()));
+
+			// Add the profiler, and let it measure the steps executed by the stepper
+			HSceneObject benchmarkSO = SceneObject::create("Benchmark");
+			HPhysicsProfiler physicsProfiler = benchmarkSO->addComponent<PhysicsProfiler>(benchmarkLog);
+			physicsProfiler->setStepper(physicsStepper);
+			physicsProfiler->setTrackIslands(CommandLine::hasOption("stress-islands"));
+			physicsProfiler->track(stressStack.bodies);
+
+			// Display the statistics on screen and save them once enough frames have been recorded
+			GUILabel* statsLabel = vertLayout->addNewElement<GUILabel>(HString(u8"Physics: -"));
+
+			const UINT32 numFrames = CommandLine::getUInt("benchmark-frames", 1000);
+			const Path outputPath = CommandLine::getString("benchmark-output", "PhysicsStress.json");
+			benchmarkSO->addComponent<StressBenchmark>(benchmarkLog, physicsProfiler, statsLabel, numFrames, outputPath);
+		}
+
+		/************************************************************************/
+		/* 									PHYSICS LOD                    		*/
+		/************************************************************************/
+
+		// Optionally only simulate the boxes and props near the character. The bodies are evaluated right before every
+		// physics step, so a recorded session replays the same way.
+		if(CommandLine::hasOption("physics-lod"))
+		{
+			PHYSICS_LOD_DESC lodDesc;
+			lodDesc.radius = CommandLine::getFloat("physics-lod", lodDesc.radius);
+			lodDesc.maxSimulatedBodies = CommandLine::getUInt("physics-lod-cap", 0);
+			lodDesc.mode = CommandLine::hasOption("physics-lod-sleep") ? PhysicsLODMode::Sleep : PhysicsLODMode::Kinematic;
+
+			HSceneObject physicsLODSO = SceneObject::create("PhysicsLOD");
+			HPhysicsLOD physicsLOD = physicsLODSO->addComponent<PhysicsLOD>(lodDesc);
+			physicsLOD->setStepper(physicsStepper);
+			physicsLOD->setTarget(characterSO);
+			physicsLOD->track(boxBodies);
+
+			// Record the number of simulated bodies along with the other stress mode statistics
+			physicsLOD->setLog(benchmarkLog);
+
+			GUILabel* lodLabel = vertLayout->addNewElement<GUILabel>(HString(u8"Simulated bodies: -"));
+			physicsLODSO->addComponent<PhysicsLODStatus>(physicsLOD, lodLabel);
+		}
+
+		/************************************************************************/
+		/* 									RECORDING                    		*/
+		/************************************************************************/
+
+		// Record or replay the character movement and the spheres shot. The recorder applies the inputs right before
+		// every physics step, so the replay matches the recording regardless of the frame rate.
+		HPhysicsRecorder physicsRecorder;
+		if(!recordPath.isEmpty() || !replayPath.isEmpty())
+		{
+			const PhysicsRecorderMode recorderMode = replayPath.isEmpty() ?
+				PhysicsRecorderMode::Record : PhysicsRecorderMode::Replay;
+
+			HSceneObject recorderSO = SceneObject::create("Recorder");
+			physicsRecorder = recorderSO->addComponent<PhysicsRecorder>(physicsStepper, recorderMode,
+				recorderMode == PhysicsRecorderMode::Record ? recordPath : replayPath);
+			physicsRecorder->setChecksumInterval(CommandLine::getUInt("record-checksum-interval", 60));
+			physicsRecorder->setProjectilePool(projectilePool);
+			physicsRecorder->setWalker(fpsWalker);
+
+			// Track the boxes as well as the spheres, so the checksums cover everything that can move
+			Vector<HRigidbody> trackedBodies = boxBodies;
+			for(auto& entry : projectilePool->getRigidbodies())
+				trackedBodies.push_back(entry);
+
+			physicsRecorder->track(trackedBodies);
+
+			// Display the recording progress on screen
+			GUILabel* recorderLabel = vertLayout->addNewElement<GUILabel>(HString(u8"Recording: -"));
+			recorderSO->addComponent<RecorderStatus>(physicsRecorder, recorderLabel);
+		}
+
+		/************************************************************************/
+		/* 									INPUT                       		*/
+		/************************************************************************/
+
+		// Hook up input that launches a sphere when user clicks the mouse, and Esc key to quit
+		gInput().onButtonUp.connect([=](const ButtonEvent& ev)
+		{
+			if(ev.buttonCode == BC_MOUSE_LEFT)
+			{
+				// Position the sphere in front of the character
+				Vector3 spawnPos = characterSO->getTransform().getPosition();
+				spawnPos += sceneCameraSO->getTransform().getForward() * 0.5f;
+				spawnPos.y += 0.5f;
+
+				// Grab a sphere from the pool and launch it forward in the camera's view direction. When recording the
+				// spawn is delayed until the next physics step, so it can be replayed at exactly the same point.
+				const Vector3 velocity = sceneCameraSO->getTransform().getForward() * 40.0f;
+				if(physicsRecorder)
+					physicsRecorder->queueSpawn(spawnPos, velocity);
+				else
+					projectilePool->spawn(spawnPos, velocity);
+
+				// Display how long the spawn took
+				const ProjectilePoolStats& stats = projectilePool->getStats();
+				spawnLatencyLabel->setContent(HString(u8"Spawn latency: " + toString(stats.lastSpawnLatency) +
+					u8"us (avg " + toString(stats.getAverageSpawnLatency()) + u8"us)"));
+			}
+			else if(ev.buttonCode == BC_ESCAPE)
+			{
+				// Quit the application when Escape key is pressed
+				gApplication().quitRequested();
+			}
+		});
 	}
 }
 
@@ -320,11 +720,18 @@ int CALLBACK WinMain(
 	_In_  int nCmdShow
 	)
 #else
-int main()
+int main(int argc, char* argv[])
 #endif
 {
 	using namespace bs;
 
+	// Parse the options the example was started with
+#if BS_PLATFORM == BS_PLATFORM_WIN32
+	CommandLine::parse(__argc, __argv);
+#else
+	CommandLine::parse(argc, argv);
+#endif
+
 	// Initializes the application and creates a window with the specified properties
 	VideoMode videoMode(windowResWidth, windowResHeight);
 	Application::startUp(videoMode, "Example", false);
@@ -0,0 +1,281 @@
+// Framework includes
+#include "BsApplication.h"
+#include "Resources/BsBuiltinResources.h"
+#include "Material/BsMaterial.h"
+#include "Components/BsCPlaneCollider.h"
+#include "Physics/BsPhysicsMaterial.h"
+#include "Scene/BsSceneObject.h"
+#include "Threading/BsThreading.h"
+
+// Example includes
+#include "BsCommandLine.h"
+#include "BsBenchmarkLog.h"
+#include "BsBoxStackBuilder.h"
+#include "BsPhysicsProfiler.h"
+#include "BsPhysicsSettings.h"
+#include "BsPhysicsStepper.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This benchmark measures how the physics simulation scales with the number of worker threads, sub-steps and the fixed
+// step rate.
+//
+// For every combination of settings the benchmark builds the same scene consisting of a floor and a large number of boxes
+// arranged in walls, lets the simulation settle for a number of frames and then records the physics step time over a
+// number of frames. The simulation runs one fixed step per frame so that every combination simulates the same amount of
+// time, regardless of how fast it runs. Once all combinations are done the results are saved in JSON format, including
+// the simulation throughput (simulated bodies per second) and the speed-up relative to the single threaded run.
+//
+// The following options are supported:
+// --sweep-threads=1,2,4 - List of worker thread counts to test. Defaults to 1,2,4,8,16,32.
+// --sweep-substeps=1,2 - List of sub-step counts to test. Defaults to 1,2,4.
+// --sweep-rates=60,120 - List of fixed step rates to test. Defaults to 60,120.
+// --benchmark-boxes=N - Number of boxes in the scene. Defaults to 5000.
+// --benchmark-layout=wall|pyramid - How are the boxes arranged. Defaults to wall.
+// --benchmark-warmup=N - Number of frames to run before recording. Defaults to 60.
+// --benchmark-frames=N - Number of frames to record for each combination. Defaults to 300.
+// --benchmark-output=path - Path to the JSON file in which to save the results. Defaults to PhysicsScaling.json.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+namespace bs
+{
+	UINT32 windowResWidth = 640;
+	UINT32 windowResHeight = 360;
+
+	/** Parses a comma separated list of numbers from the command line option with the provided name. */
+	Vector<UINT32> getListOption(const String& name, const Vector<UINT32>& defaultValues)
+	{
+		const String value = CommandLine::getString(name);
+		if(value.empty())
+			return defaultValues;
+
+		Vector<UINT32> output;
+		for(auto& entry : StringUtil::split(value, ","))
+		{
+			const UINT32 number = parseUINT32(entry, 0);
+			if(number > 0)
+				output.push_back(number);
+		}
+
+		return output.empty() ? defaultValues : output;
+	}
+
+	// Component that drives the benchmark. It goes through all the combinations of settings one by one, rebuilding the
+	// scene for each and recording the physics statistics.
+	class PhysicsScalingBenchmark : public Component
+	{
+	public:
+		PhysicsScalingBenchmark(const HSceneObject& parent, const Vector<PhysicsSettings>& configs,
+			const BoxStackBuilder& builder, const BOX_STACK_DESC& stackDesc)
+			:Component(parent), mConfigs(configs), mBuilder(builder), mStackDesc(stackDesc)
+		{
+			mNumWarmupFrames = CommandLine::getUInt("benchmark-warmup", 60);
+			mNumFrames = std::max(CommandLine::getUInt("benchmark-frames", 300), 1U);
+			mOutputPath = CommandLine::getString("benchmark-output", "PhysicsScaling.json");
+
+			mLog = bs_shared_ptr_new<BenchmarkLog>("PhysicsScaling");
+		}
+
+		void onInitialized() override
+		{
+			// Set up the stepper. The first configuration will be applied once it starts.
+			mStepper = SO()->addComponent<PhysicsStepper>(mConfigs[0]);
+
+			// Set up the profiler that measures the steps executed by the stepper
+			mProfiler = SO()->addComponent<PhysicsProfiler>();
+			mProfiler->setStepper(mStepper);
+
+			startConfig();
+		}
+
+		void update() override
+		{
+			// Nothing left to do, waiting for the application to quit
+			if(mConfigIdx >= (UINT32)mConfigs.size())
+				return;
+
+			// Move on to the next combination once enough frames have been recorded
+			if(mFrameIdx == mNumWarmupFrames + mNumFrames)
+			{
+				endConfig();
+
+				mConfigIdx++;
+				if(mConfigIdx < (UINT32)mConfigs.size())
+					startConfig();
+				else
+				{
+					mLog->save(mOutputPath);
+					gApplication().quitRequested();
+				}
+
+				return;
+			}
+
+			// Start recording once the warm-up is done
+			if(mFrameIdx == mNumWarmupFrames)
+			{
+				const PhysicsSettings& settings = mConfigs[mConfigIdx];
+
+				mLog->beginRun(toString(settings.numWorkerThreads) + " threads, " + toString(settings.numSubsteps) +
+					" substeps, " + toString(settings.fixedStepRate) + " Hz");
+				mLog->setRunProperty("threads", toString(settings.numWorkerThreads));
+				mLog->setRunProperty("substeps", toString(settings.numSubsteps));
+				mLog->setRunProperty("rate", toString(settings.fixedStepRate));
+				mLog->setRunProperty("boxes", toString((UINT32)mStack.bodies.size()));
+				mLog->setRunProperty("hardwareThreads", toString((UINT32)BS_THREAD_HARDWARE_CONCURRENCY));
+
+				mProfiler->setLog(mLog);
+			}
+
+			mFrameIdx++;
+		}
+
+	private:
+		/** Applies the current settings and creates the scene to simulate. */
+		void startConfig()
+		{
+			mStepper->setSettings(mConfigs[mConfigIdx]);
+
+			mStack = mBuilder.build(mStackDesc);
+			mProfiler->track(mStack.bodies);
+
+			mFrameIdx = 0;
+		}
+
+		/** Finishes recording the current settings and destroys the scene. */
+		void endConfig()
+		{
+			mProfiler->setLog(nullptr);
+
+			// Calculate the throughput as the number of bodies simulated per second of step time
+			const PhysicsSettings& settings = mConfigs[mConfigIdx];
+			const BenchmarkMetricSummary stepTime = mLog->getSummary("physicsStepMs");
+
+			const double throughput = stepTime.mean > 0.0 ? mStack.bodies.size() / (stepTime.mean / 1000.0) : 0.0;
+			mLog->setRunProperty("bodiesPerSecond", toString(throughput));
+
+			// Compare against the run with the lowest thread count using the same sub-step count and step rate
+			if(mConfigIdx == 0 || mConfigs[mConfigIdx - 1].numSubsteps != settings.numSubsteps ||
+				mConfigs[mConfigIdx - 1].fixedStepRate != settings.fixedStepRate)
+			{
+				mBaselineThroughput = throughput;
+			}
+
+			const double speedup = mBaselineThroughput > 0.0 ? throughput / mBaselineThroughput : 0.0;
+			mLog->setRunProperty("speedup", toString(speedup));
+			mLog->endRun();
+
+			mProfiler->clear();
+			mStack.root->destroy();
+			mStack = BoxStack();
+		}
+
+		Vector<PhysicsSettings> mConfigs;
+		BoxStackBuilder mBuilder;
+		BOX_STACK_DESC mStackDesc;
+
+		HPhysicsStepper mStepper;
+		HPhysicsProfiler mProfiler;
+		SPtr<BenchmarkLog> mLog;
+		BoxStack mStack;
+
+		UINT32 mNumWarmupFrames = 0;
+		UINT32 mNumFrames = 0;
+		Path mOutputPath;
+
+		UINT32 mConfigIdx = 0;
+		UINT32 mFrameIdx = 0;
+		double mBaselineThroughput = 0.0;
+	};
+
+	/** Set up the scene and the component that drives the benchmark. */
+	void setUpBenchmark()
+	{
+		// Grab the builtin box mesh and a plain material for the boxes. Boxes are not rendered by default, but the
+		// builder still needs them in case rendering is enabled.
+		HMesh boxMesh = gBuiltinResources().getMesh(BuiltinMesh::Box);
+		HMaterial boxMaterial = Material::create(gBuiltinResources().getBuiltinShader(BuiltinShader::Standard));
+
+		// Use the same non-bouncy physics material as the Physics example
+		HPhysicsMaterial boxPhysicsMaterial = PhysicsMaterial::create(1.0f, 1.0f, 0.0f);
+
+		// Add a plane collider that will prevent the boxes going through the floor
+		HSceneObject floorSO = SceneObject::create("Floor");
+		HPlaneCollider planeCollider = floorSO->addComponent<CPlaneCollider>();
+		planeCollider->setMaterial(boxPhysicsMaterial);
+
+		// Describe the box stacks to simulate
+		BOX_STACK_DESC stackDesc;
+		stackDesc.layout = CommandLine::getString("benchmark-layout") == "pyramid" ?
+			BoxStackLayout::Pyramid : BoxStackLayout::Wall;
+		stackDesc.numBoxes = CommandLine::getUInt("benchmark-boxes", 5000);
+		stackDesc.render = false;
+
+		// Build the list of all the combinations of settings to test, with the thread count changing the fastest so that
+		// the runs using the same sub-step count and rate are next to each other
+		const Vector<UINT32> threadCounts = getListOption("sweep-threads", { 1, 2, 4, 8, 16, 32 });
+		const Vector<UINT32> substepCounts = getListOption("sweep-substeps", { 1, 2, 4 });
+		const Vector<UINT32> rates = getListOption("sweep-rates", { 60, 120 });
+
+		Vector<PhysicsSettings> configs;
+		for(auto& rate : rates)
+		{
+			for(auto& numSubsteps : substepCounts)
+			{
+				for(auto& numThreads : threadCounts)
+				{
+					PhysicsSettings settings;
+					settings.numWorkerThreads = numThreads;
+					settings.numSubsteps = numSubsteps;
+					settings.fixedStepRate = (float)rate;
+					settings.lockstep = true;
+
+					configs.push_back(settings);
+				}
+			}
+		}
+
+		BoxStackBuilder builder(boxMesh, boxMaterial, boxPhysicsMaterial);
+
+		HSceneObject benchmarkSO = SceneObject::create("Benchmark");
+		benchmarkSO->addComponent<PhysicsScalingBenchmark>(configs, builder, stackDesc);
+	}
+}
+
+/** Main entry point into the application. */
+#if BS_PLATFORM == BS_PLATFORM_WIN32
+#include <windows.h>
+
+int CALLBACK WinMain(
+	_In_  HINSTANCE hInstance,
+	_In_  HINSTANCE hPrevInstance,
+	_In_  LPSTR lpCmdLine,
+	_In_  int nCmdShow
+	)
+#else
+int main(int argc, char* argv[])
+#endif
+{
+	using namespace bs;
+
+	// Parse the options the benchmark was started with
+#if BS_PLATFORM == BS_PLATFORM_WIN32
+	CommandLine::parse(__argc, __argv);
+#else
+	CommandLine::parse(argc, argv);
+#endif
+
+	// Initializes the application and creates a window with the specified properties
+	VideoMode videoMode(windowResWidth, windowResHeight);
+	Application::startUp(videoMode, "Physics benchmark", false);
+
+	// Set up the benchmark scene
+	setUpBenchmark();
+
+	// Runs the main loop that does most of the work. This method will exit once the benchmark is done, or when the user
+	// closes the main window.
+	Application::instance().runMainLoop();
+
+	// When done, clean up
+	Application::shutDown();
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,273 @@
+// Framework includes
+#include "BsApplication.h"
+#include "Resources/BsBuiltinResources.h"
+#include "Material/BsMaterial.h"
+#include "Components/BsCCamera.h"
+#include "Components/BsCRenderable.h"
+#include "Components/BsCPlaneCollider.h"
+#include "Components/BsCCharacterController.h"
+#include "Physics/BsPhysicsMaterial.h"
+#include "RenderAPI/BsRenderWindow.h"
+#include "Scene/BsSceneObject.h"
+#include "Threading/BsThreading.h"
+
+// Example includes
+#include "BsCommandLine.h"
+#include "BsBenchmarkLog.h"
+#include "BsPhysicsProfiler.h"
+#include "BsPhysicsSettings.h"
+#include "BsPhysicsStepper.h"
+#include "BsWalkerSystem.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// This benchmark measures the cost of moving a large number of AI controlled characters using the walker system.
+//
+// The scene consists of the same ground plane as used in the Physics example, with a grid of character controllers placed
+// on top of it. All the characters are driven by a single WalkerSystem component, which makes them wander towards random
+// points on the plane. The simulation runs one fixed step per frame, and after a number of warm-up frames the time spent
+// calculating the walker velocities, moving the character controllers and stepping the simulation is recorded every
+// frame. Once done the results are saved in JSON format.
+//
+// The following options are supported:
+// --walkers=N - Number of walkers to create. Defaults to 2000.
+// --walkers-per-task=N - Number of walkers processed by a single worker task. Defaults to 256.
+// --walkers-no-render - Walkers are created without a renderable, so only the movement cost is measured.
+// --benchmark-warmup=N - Number of frames to run before recording. Defaults to 60.
+// --benchmark-frames=N - Number of frames to record. Defaults to 600.
+// --benchmark-output=path - Path to the JSON file in which to save the results. Defaults to WalkerBenchmark.json.
+//
+// Physics stepping can be controlled through the options described in PhysicsSettings (e.g. --physics-threads=N).
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+namespace bs
+{
+	constexpr float GROUND_PLANE_SCALE = 50.0f;
+
+	/** Distance between neighbouring walkers when they're first placed. */
+	constexpr float WALKER_SPACING = 1.0f;
+
+	UINT32 windowResWidth = 1280;
+	UINT32 windowResHeight = 720;
+
+	// Component that records the walker and physics statistics every frame, and saves them once enough frames have been
+	// recorded.
+	class WalkerBenchmark : public Component
+	{
+	public:
+		WalkerBenchmark(const HSceneObject& parent, const HWalkerSystem& walkerSystem, const HPhysicsProfiler& profiler,
+			const SPtr<BenchmarkLog>& log)
+			:Component(parent), mWalkerSystem(walkerSystem), mProfiler(profiler), mLog(log)
+		{
+			mNumWarmupFrames = CommandLine::getUInt("benchmark-warmup", 60);
+			mNumFrames = std::max(CommandLine::getUInt("benchmark-frames", 600), 1U);
+			mOutputPath = CommandLine::getString("benchmark-output", "WalkerBenchmark.json");
+		}
+
+		void update() override
+		{
+			if(mFrameIdx == mNumWarmupFrames + mNumFrames)
+				return;
+
+			// Start recording once the warm-up is done
+			if(mFrameIdx == mNumWarmupFrames)
+				mProfiler->setLog(mLog);
+
+			if(mFrameIdx >= mNumWarmupFrames)
+			{
+				const WalkerSystemStats& stats = mWalkerSystem->getStats();
+				mLog->record("walkerThinkMs", stats.thinkTime);
+				mLog->record("walkerMoveMs", stats.moveTime);
+				mLog->record("groundedWalkers", stats.numGrounded);
+			}
+
+			mFrameIdx++;
+			if(mFrameIdx == mNumWarmupFrames + mNumFrames)
+			{
+				mProfiler->setLog(nullptr);
+
+				mLog->save(mOutputPath);
+				gApplication().quitRequested();
+			}
+		}
+
+	private:
+		HWalkerSystem mWalkerSystem;
+		HPhysicsProfiler mProfiler;
+		SPtr<BenchmarkLog> mLog;
+
+		UINT32 mNumWarmupFrames = 0;
+		UINT32 mNumFrames = 0;
+		Path mOutputPath;
+		UINT32 mFrameIdx = 0;
+	};
+
+	/** Set up the scene, the walkers and the component that drives the benchmark. */
+	void setUpBenchmark()
+	{
+		/************************************************************************/
+		/* 									ASSETS	                    		*/
+		/************************************************************************/
+
+		HShader shader = gBuiltinResources().getBuiltinShader(BuiltinShader::Standard);
+		HMaterial planeMaterial = Material::create(shader);
+		HMaterial walkerMaterial = Material::create(shader);
+
+		HMesh planeMesh = gBuiltinResources().getMesh(BuiltinMesh::Quad);
+		HMesh walkerMesh = gBuiltinResources().getMesh(BuiltinMesh::Box);
+
+		// Use the same non-bouncy physics material as the Physics example
+		HPhysicsMaterial floorPhysicsMaterial = PhysicsMaterial::create(1.0f, 1.0f, 0.0f);
+
+		/************************************************************************/
+		/* 									PHYSICS	                    		*/
+		/************************************************************************/
+
+		// Run exactly one physics step per frame, so every run simulates the same amount of time
+		PhysicsSettings physicsSettings = PhysicsSettings::fromCommandLine();
+		physicsSettings.lockstep = true;
+
+		HSceneObject physicsSO = SceneObject::create("Physics");
+		HPhysicsStepper physicsStepper = physicsSO->addComponent<PhysicsStepper>(physicsSettings);
+
+		/************************************************************************/
+		/* 									FLOOR	                    		*/
+		/************************************************************************/
+
+		// Same floor plane as in the Physics example
+		HSceneObject floorSO = SceneObject::create("Floor");
+		HRenderable floorRenderable = floorSO->addComponent<CRenderable>();
+		floorRenderable->setMesh(planeMesh);
+		floorRenderable->setMaterial(planeMaterial);
+
+		floorSO->setScale(Vector3(GROUND_PLANE_SCALE, 1.0f, GROUND_PLANE_SCALE));
+
+		HPlaneCollider planeCollider = floorSO->addComponent<CPlaneCollider>();
+		planeCollider->setMaterial(floorPhysicsMaterial);
+
+		/************************************************************************/
+		/* 									WALKERS	                    		*/
+		/************************************************************************/
+
+		// Let the walkers wander over the entire floor, leaving a small margin around the edges
+		const float halfSize = GROUND_PLANE_SCALE * 0.5f - 1.0f;
+
+		WALKER_SYSTEM_DESC walkerDesc;
+		walkerDesc.areaExtents = Vector2(halfSize, halfSize);
+		walkerDesc.walkersPerTask = CommandLine::getUInt("walkers-per-task", walkerDesc.walkersPerTask);
+
+		HSceneObject walkersSO = SceneObject::create("Walkers");
+		HWalkerSystem walkerSystem = walkersSO->addComponent<WalkerSystem>(walkerDesc);
+		walkerSystem->setStepper(physicsStepper);
+
+		// Place the walkers in a grid in the middle of the floor
+		const UINT32 numWalkers = std::max(CommandLine::getUInt("walkers", 2000), 1U);
+		const bool render = !CommandLine::hasOption("walkers-no-render");
+
+		const UINT32 numColumns = (UINT32)std::ceil(std::sqrt((float)numWalkers));
+		const float gridOffset = (numColumns - 1) * WALKER_SPACING * 0.5f;
+
+		for(UINT32 i = 0; i < numWalkers; i++)
+		{
+			const UINT32 column = i % numColumns;
+			const UINT32 row = i / numColumns;
+
+			HSceneObject walkerSO = SceneObject::create("Walker");
+			walkerSO->setParent(walkersSO);
+			walkerSO->setPosition(Vector3(column * WALKER_SPACING - gridOffset, 1.0f, row * WALKER_SPACING - gridOffset));
+
+			// Same capsule dimensions as the character in the Physics example, but thinner so they fit in the grid
+			HCharacterController controller = walkerSO->addComponent<CCharacterController>();
+			controller->setHeight(1.0f);
+			controller->setRadius(0.3f);
+
+			if(render)
+			{
+				// Render the walker as a box roughly the size of its capsule. The renderable is placed on a child object
+				// so the scale doesn't affect the controller.
+				HSceneObject bodySO = SceneObject::create("Body");
+				bodySO->setParent(walkerSO);
+				bodySO->setScale(Vector3(0.6f, 1.6f, 0.6f));
+
+				HRenderable walkerRenderable = bodySO->addComponent<CRenderable>();
+				walkerRenderable->setMesh(walkerMesh);
+				walkerRenderable->setMaterial(walkerMaterial);
+			}
+
+			walkerSystem->add(controller);
+		}
+
+		/************************************************************************/
+		/* 									CAMERA	                     		*/
+		/************************************************************************/
+
+		// Look down at the floor from above, so all the walkers are visible
+		HSceneObject sceneCameraSO = SceneObject::create("SceneCamera");
+
+		HCamera sceneCamera = sceneCameraSO->addComponent<CCamera>();
+		sceneCamera->getViewport()->setTarget(gApplication().getPrimaryWindow());
+		sceneCamera->setNearClipDistance(0.1f);
+		sceneCamera->setFarClipDistance(1000);
+		sceneCamera->setAspectRatio(windowResWidth / (float)windowResHeight);
+
+		sceneCameraSO->setPosition(Vector3(0.0f, 35.0f, 40.0f));
+		sceneCameraSO->lookAt(Vector3::ZERO);
+
+		/************************************************************************/
+		/* 									BENCHMARK                    		*/
+		/************************************************************************/
+
+		SPtr<BenchmarkLog> benchmarkLog = bs_shared_ptr_new<BenchmarkLog>("WalkerBenchmark");
+		benchmarkLog->beginRun(toString(numWalkers) + " walkers");
+		benchmarkLog->setRunProperty("walkers", toString(numWalkers));
+		benchmarkLog->setRunProperty("walkersPerTask", toString(walkerDesc.walkersPerTask));
+		benchmarkLog->setRunProperty("threads", toString(physicsSettings.numWorkerThreads));
+		benchmarkLog->setRunProperty("hardwareThreads", toString((UINT32)BS_THREAD_HARDWARE_CONCURRENCY));
+		benchmarkLog->setRunProperty("render", render ? "true" : "false");
+
+		// Measure the physics steps, which include the cost of resolving the walker movement
+		HSceneObject benchmarkSO = SceneObject::create("Benchmark");
+		HPhysicsProfiler physicsProfiler = benchmarkSO->addComponent<PhysicsProfiler>();
+		physicsProfiler->setStepper(physicsStepper);
+
+		benchmarkSO->addComponent<WalkerBenchmark>(walkerSystem, physicsProfiler, benchmarkLog);
+	}
+}
+
+/** Main entry point into the application. */
+#if BS_PLATFORM == BS_PLATFORM_WIN32
+#include <windows.h>
+
+int CALLBACK WinMain(
+	_In_  HINSTANCE hInstance,
+	_In_  HINSTANCE hPrevInstance,
+	_In_  LPSTR lpCmdLine,
+	_In_  int nCmdShow
+	)
+#else
+int main(int argc, char* argv[])
+#endif
+{
+	using namespace bs;
+
+	// Parse the options the benchmark was started with
+#if BS_PLATFORM == BS_PLATFORM_WIN32
+	CommandLine::parse(__argc, __argv);
+#else
+	CommandLine::parse(argc, argv);
+#endif
+
+	// Initializes the application and creates a window with the specified properties
+	VideoMode videoMode(windowResWidth, windowResHeight);
+	Application::startUp(videoMode, "Walker benchmark", false);
+
+	// Set up the benchmark scene
+	setUpBenchmark();
+
+	// Runs the main loop that does most of the work. This method will exit once the benchmark is done, or when the user
+	// closes the main window.
+	Application::instance().runMainLoop();
+
+	// When done, clean up
+	Application::shutDown();
+
+	return 0;
+}
\ No newline at end of file